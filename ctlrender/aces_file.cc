@@ -58,121 +58,135 @@
 #if defined( HAVE_ACESFILE )
 #include <aces_Writer.h>
 #include <stdexcept>
-#include <half.h>
+#include <memory>
+#include <vector>
+#include "half_row.hh"
 
-void aces_write(const char *name, float scale, 
+namespace {
+
+// Hands the image to aces_Writer a scanline at a time as the bands come
+// in, converting each row to half on the way rather than staging the
+// whole frame.
+class aces_band_writer: public band_writer {
+	public:
+		aces_band_writer(const char *name, float scale,
+		                 uint32_t _width, uint32_t height, uint32_t _channels) :
+			width(_width), channels(_channels), open(true) {
+			if (scale == 0.0f) scale = 1.0f;
+			rscale = 1.0f / scale;
+
+			std::vector<std::string> filenames;
+			filenames.push_back( name );
+
+			MetaWriteClip writeParams;
+
+			writeParams.duration				= 1;
+			writeParams.outputFilenames			= filenames;
+
+			writeParams.outputRows				= height;
+			writeParams.outputCols				= width;
+
+			writeParams.hi = x.getDefaultHeaderInfo();
+			writeParams.hi.originalImageFlag	= 1;
+			writeParams.hi.software				= "ctlrender";
+
+			writeParams.hi.channels.clear();
+			switch ( channels )
+			{
+				case 3:
+					writeParams.hi.channels.resize(3);
+					writeParams.hi.channels[0].name = "B";
+					writeParams.hi.channels[1].name = "G";
+					writeParams.hi.channels[2].name = "R";
+					break;
+				case 4:
+					writeParams.hi.channels.resize(4);
+					writeParams.hi.channels[0].name = "A";
+					writeParams.hi.channels[1].name = "B";
+					writeParams.hi.channels[2].name = "G";
+					writeParams.hi.channels[3].name = "R";
+					break;
+				case 6:
+				case 8:
+					throw std::invalid_argument("Stereo RGB support not yet implemented");
+				default:
+					throw std::invalid_argument("Only RGB, RGBA or stereo RGB[A] file supported");
+					break;
+			}
+
+			DynamicMetadata dynamicMeta;
+			dynamicMeta.imageIndex = 0;
+			dynamicMeta.imageCounter = 0;
+
+			x.configure ( writeParams );
+			x.newImageObject ( dynamicMeta );
+
+			row.resize((size_t)width*channels);
+		}
+
+		// An image that wasn't finished with close() is not saved, so
+		// an error part way through leaves no truncated file behind.
+		virtual ~aces_band_writer() {
+		}
+
+		virtual void write(const ctl::dpx::fb<float> &pixels, uint32_t y) {
+			write_rows(pixels.ptr(), y, pixels.height());
+		}
+
+		// Stores rows scanlines of width*channels floats starting at y.
+		void write_rows(const float *pixels, uint32_t y, uint32_t rows) {
+			size_t samples = (size_t)width*channels;
+
+			for (uint32_t i = 0; i < rows; i++) {
+				half_row((uint16_t *)&row[0], pixels + samples*i, rscale, samples);
+				x.storeHalfRow ( &row[0], y + i );
+			}
+		}
+
+		virtual void close() {
+			if (open) {
+				open = false;
+				x.saveImageObject ( );
+			}
+		}
+
+	private:
+		aces_Writer x;
+		uint32_t width;
+		uint32_t channels;
+		float rscale;
+		bool open;
+		std::vector<halfBytes> row;
+};
+
+}
+
+band_writer *aces_open_band_writer(const char *name, float scale,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t channels, format_t *format) {
+	return new aces_band_writer(name, scale, width, height, channels);
+}
+
+void aces_write(const char *name, float scale,
                uint32_t width, uint32_t height, uint32_t channels,
                const float *pixels,
                format_t *format) {
+	aces_band_writer writer(name, scale, width, height, channels);
 
-	std::vector<halfBytes> scaled_pixels;
-	
-    {
-        float const *in = pixels;
-        if (scale == 0.0f) scale = 1.0f;
-        
-        scaled_pixels.resize(height*width*channels);
-        halfBytes *out = &scaled_pixels[0];
-        for(size_t i=0; i<scaled_pixels.size(); i++) {
-			half tmpV( *(in++) / scale );
-            *(out++)=tmpV.bits();
-        }
-    }
-
-    halfBytes *in = &scaled_pixels[0];
-	
-    std::vector<std::string> filenames;
-	filenames.push_back( name );
-	
-	aces_Writer x;
-	
-	MetaWriteClip writeParams;
-	
-	writeParams.duration				= 1;	
-	writeParams.outputFilenames			= filenames;
-	
-	writeParams.outputRows				= height;
-	writeParams.outputCols				= width;	
-	
-	writeParams.hi = x.getDefaultHeaderInfo();	
-	writeParams.hi.originalImageFlag	= 1;	
-	writeParams.hi.software				= "ctlrender";
-
-	writeParams.hi.channels.clear();
-	switch ( channels )
-	{
-		case 3:
-			writeParams.hi.channels.resize(3);
-			writeParams.hi.channels[0].name = "B";
-			writeParams.hi.channels[1].name = "G";
-			writeParams.hi.channels[2].name = "R";
-			break;
-		case 4:
-			writeParams.hi.channels.resize(4);
-			writeParams.hi.channels[0].name = "A";
-			writeParams.hi.channels[1].name = "B";
-			writeParams.hi.channels[2].name = "G";
-			writeParams.hi.channels[3].name = "R";
-			break;
-		case 6:
-			throw std::invalid_argument("Stereo RGB support not yet implemented");
-//			writeParams.hi.channels.resize(6);
-//			writeParams.hi.channels[0].name = "B";
-//			writeParams.hi.channels[1].name = "G";
-//			writeParams.hi.channels[2].name = "R";
-//			writeParams.hi.channels[3].name = "left.B";
-//			writeParams.hi.channels[4].name = "left.G";
-//			writeParams.hi.channels[5].name = "left.R";
-//			break;
-		case 8:
-			throw std::invalid_argument("Stereo RGB support not yet implemented");
-//			writeParams.hi.channels.resize(8);
-//			writeParams.hi.channels[0].name = "A";
-//			writeParams.hi.channels[1].name = "B";
-//			writeParams.hi.channels[2].name = "G";
-//			writeParams.hi.channels[3].name = "R";
-//			writeParams.hi.channels[4].name = "left.A";
-//			writeParams.hi.channels[5].name = "left.B";
-//			writeParams.hi.channels[6].name = "left.G";
-//			writeParams.hi.channels[7].name = "left.R";
-//			break;
-		default:
-			throw std::invalid_argument("Only RGB, RGBA or stereo RGB[A] file supported");
-			break;
-	}
-
-	DynamicMetadata dynamicMeta;
-	dynamicMeta.imageIndex = 0;
-	dynamicMeta.imageCounter = 0;
-	
-	x.configure ( writeParams );
-	x.newImageObject ( dynamicMeta );		
-
-	for ( uint32 row = 0; row < height; row++) {
-		halfBytes *rgbData = in + width*channels*row;
-		x.storeHalfRow ( rgbData, row ); 
-	}
-
-#if 0
-	std::cout << "saving aces file" << std::endl;
-	std::cout << "size " << width << "x" << height << "x" << channels << std::endl;
-	std::cout << "size " << writeParams.outputCols << "x" << writeParams.outputRows << std::endl;
-	std::cout << "duration " << writeParams.duration << std::endl;
-	std::cout << writeParams.hi;
-	std::cout << "\ndynamic meta" << std::endl;
-	std::cout << "imageIndex " << dynamicMeta.imageIndex << std::endl;
-	std::cout << "imageCounter " << dynamicMeta.imageCounter << std::endl;
-	std::cout << "timeCode " << dynamicMeta.timeCode << std::endl;
-	std::cout << "keyCode " << dynamicMeta.keyCode << std::endl;
-	std::cout << "capDate " << dynamicMeta.capDate << std::endl;
-	std::cout << "uuid " << dynamicMeta.uuid << std::endl;
-#endif
-
-	x.saveImageObject ( );	
+	writer.write_rows(pixels, 0, height);
+	writer.close();
 }
 
 #else 
 
+band_writer *aces_open_band_writer(const char *name, float scale,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t channels, format_t *format)
+{
+	std::cerr << "AcesContainer library not found" << std::endl;
+	return NULL;
+}
+
 void aces_write(const char *name, float scale,
                 uint32_t width, uint32_t height, uint32_t channels,
                 const float *pixels,
@@ -182,5 +196,3 @@ void aces_write(const char *name, float scale,
 }
 
 #endif
-
-
@@ -56,10 +56,17 @@
 #define CTL_UTIL_CTLRENDER_ACESFILE_INCLUDE
 
 #include <format.hh>
+#include "band.hh"
 
 void aces_write(const char *name, float scale,
                 uint32_t width, uint32_t height, uint32_t channels,
                 const float *pixels,
                 format_t *format);
 
+// Streaming variant of the above, rows are converted and handed to the
+// ACES container writer as the bands come in.
+band_writer *aces_open_band_writer(const char *name, float scale,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t channels, format_t *format);
+
 #endif
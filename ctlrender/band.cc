@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#include "band.hh"
+#include "dpx_file.hh"
+#include "tiff_file.hh"
+#include "exr_file.hh"
+#include "aces_file.hh"
+#include <Iex.h>
+#include <string.h>
+
+band_reader::~band_reader()
+{
+}
+
+bool band_reader::half_samples() const
+{
+	return FALSE;
+}
+
+void band_reader::read_half(ctl::dpx::fb<half> *pixels, uint32_t y)
+{
+	THROW(Iex::LogicExc, "This file format can not be read as half samples.");
+}
+
+std::vector<std::string> band_reader::channel_names() const
+{
+	return std::vector<std::string>();
+}
+
+void band_reader::select_channels(const std::vector<size_t> &channels)
+{
+	THROW(Iex::LogicExc, "This file format has no named channels to select.");
+}
+
+band_writer::~band_writer()
+{
+}
+
+void band_writer::close()
+{
+}
+
+namespace {
+
+// Used for formats that we can only decode all at once (the TIFF layouts
+// that go through the failsafe reader). The whole image is held, but
+// everything downstream of the reader still works in bands.
+class whole_image_reader: public band_reader
+{
+public:
+	whole_image_reader() {}
+
+	bool open(const char *name, float scale, format_t *format)
+	{
+		return exr_read(name, scale, &image, format) ||
+		       tiff_read(name, scale, &image, format);
+	}
+
+	virtual uint32_t width() const { return image.width(); }
+	virtual uint32_t height() const { return image.height(); }
+	virtual uint32_t depth() const { return image.depth(); }
+
+	virtual void read(ctl::dpx::fb<float> *pixels, uint32_t y)
+	{
+		size_t row = (size_t)image.width() * image.depth();
+		memcpy(pixels->ptr(), image.ptr() + row * y,
+		       sizeof(float) * row * pixels->height());
+	}
+
+private:
+	ctl::dpx::fb<float> image;
+};
+
+// Used for formats whose writers need the whole image (DPX). Bands are
+// collected and the image is written out on close().
+class whole_image_writer: public band_writer
+{
+public:
+	whole_image_writer(const char *_name, float _scale,
+	                   uint32_t width, uint32_t height, uint32_t depth,
+	                   format_t *_format) :
+		name(_name), scale(_scale), format(_format)
+	{
+		image.init(width, height, depth);
+	}
+
+	virtual void write(const ctl::dpx::fb<float> &pixels, uint32_t y)
+	{
+		size_t row = (size_t)image.width() * image.depth();
+		memcpy(image.ptr() + row * y, pixels.ptr(),
+		       sizeof(float) * row * pixels.height());
+	}
+
+	virtual void close()
+	{
+		dpx_write(name, scale, image, format);
+	}
+
+private:
+	const char *name;
+	float scale;
+	format_t *format;
+	ctl::dpx::fb<float> image;
+};
+
+}
+
+band_reader *open_band_reader(const char *inputFile, float scale,
+                              format_t *format)
+{
+	band_reader *reader;
+
+	// DPX is recognized by its magic number and always streams. The other
+	// streaming readers return NULL for files they can't (or won't) read
+	// a band at a time.
+	if (dpx_check(inputFile))
+	{
+		return dpx_open_band_reader(inputFile, scale, format);
+	}
+	reader = exr_open_band_reader(inputFile, scale, format);
+	if (reader != NULL)
+	{
+		return reader;
+	}
+	reader = tiff_open_band_reader(inputFile, scale, format);
+	if (reader != NULL)
+	{
+		return reader;
+	}
+
+	whole_image_reader *whole = new whole_image_reader;
+	if (!whole->open(inputFile, scale, format))
+	{
+		delete whole;
+		return NULL;
+	}
+	return whole;
+}
+
+band_writer *open_band_writer(const char *outputFile, float scale,
+                              uint32_t width, uint32_t height, uint32_t depth,
+                              format_t *format, Compression *compression)
+{
+	if (!strncmp(format->ext, "exr", 3))
+	{
+		return exr_open_band_writer(outputFile, scale, width, height, depth,
+		                            format, compression);
+	}
+	else if (!strncmp(format->ext, "tiff", 3))
+	{
+		return tiff_open_band_writer(outputFile, scale, width, height, depth,
+		                             format, compression);
+	}
+	else if (!strncmp(format->ext, "aces", 3))
+	{
+		return aces_open_band_writer(outputFile, scale, width, height, depth,
+		                             format);
+	}
+	else if (!strncmp(format->ext, "adx", 3) ||
+	         !strncmp(format->ext, "dpx", 3))
+	{
+		return new whole_image_writer(outputFile, scale, width, height, depth,
+		                              format);
+	}
+	return NULL;
+}
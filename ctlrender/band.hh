@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(CTL_UTIL_CTLRENDER_BAND_INCLUDE)
+#define CTL_UTIL_CTLRENDER_BAND_INCLUDE
+
+#include "main.hh"
+#include <dpx.hh>
+#include <string>
+#include <vector>
+
+// A band is a run of whole scanlines of an image, held in a
+// ctl::dpx::fb<float> that is only as tall as the band. Readers and
+// writers hand out / take bands top to bottom so that a transform only
+// ever needs one band of pixels in memory at a time.
+
+// Source of scanline bands. Formats that can decode a range of scanlines
+// (EXR, scanline TIFF) implement this directly, everything else is read
+// as a whole image and handed out a band at a time.
+class band_reader
+{
+public:
+	virtual ~band_reader();
+
+	virtual uint32_t width() const = 0;
+	virtual uint32_t height() const = 0;
+	virtual uint32_t depth() const = 0;
+
+	// Reads scanlines [y, y + pixels->height()) into pixels. pixels must
+	// already be initialized to width() x rows x depth(). Bands must be
+	// requested in increasing y order.
+	virtual void read(ctl::dpx::fb<float> *pixels, uint32_t y) = 0;
+
+	// Formats that store half samples (EXR) can also hand them out as
+	// they are stored, without widening them to float. The input scale is
+	// not applied to these, that is left to whoever consumes the samples.
+	// read_half() may only be used if half_samples() is true.
+	virtual bool half_samples() const;
+	virtual void read_half(ctl::dpx::fb<half> *pixels, uint32_t y);
+
+	// Formats with named channels (EXR) list every channel that can be
+	// read here, R, G, B and A first. Other formats return an empty list.
+	// select_channels() then picks which of those (by index into the list)
+	// make up the bands, in that order, and depth() follows the selection.
+	// Channels that aren't selected are never decoded. By default only
+	// R, G, B and A are selected.
+	virtual std::vector<std::string> channel_names() const;
+	virtual void select_channels(const std::vector<size_t> &channels);
+};
+
+// Sink for scanline bands. Bands must be written in increasing y order
+// and must cover the whole image before close() is called.
+class band_writer
+{
+public:
+	virtual ~band_writer();
+
+	virtual void write(const ctl::dpx::fb<float> &pixels, uint32_t y) = 0;
+
+	// Flushes anything still buffered and closes the file.
+	virtual void close();
+};
+
+// Opens inputFile with the first reader that recognizes it. Returns NULL
+// if the format is unknown. src_bps in format is filled out.
+band_reader *open_band_reader(const char *inputFile, float scale,
+                              format_t *format);
+
+// Opens outputFile for writing an image of the given size in the format
+// described by format->ext. Returns NULL if the format is unknown.
+band_writer *open_band_writer(const char *outputFile, float scale,
+                              uint32_t width, uint32_t height, uint32_t depth,
+                              format_t *format, Compression *compression);
+
+#endif
@@ -55,29 +55,41 @@
 #include <stdio.h>
 #include <string.h>
 
+#if defined(HAVE_LIBTIFF)
+#include <tiff.h>
+#define TIFF_COMPRESSION(scheme) COMPRESSION_##scheme
+#else
+#define TIFF_COMPRESSION(scheme) 0
+#endif
+
+// TIFF has no equivalent of the PIZ, PXR24 and B44 schemes, TIFF files
+// are left uncompressed for those.
 #if defined(HAVE_OPENEXR)
 #include <ImfCompression.h>
 
-const Compression Compression::no_compression = { "NO_COMPRESSION", Imf::NO_COMPRESSION };
+const Compression Compression::no_compression = { "NO_COMPRESSION", Imf::NO_COMPRESSION, TIFF_COMPRESSION(NONE) };
 
 const Compression Compression::supported_compression_schemes[] =
 {
-    { "NONE",   Imf::NO_COMPRESSION      },
-    { "RLE",    Imf::RLE_COMPRESSION     },
-    { "ZIPS",   Imf::ZIPS_COMPRESSION    },
-    { "ZIP",    Imf::ZIP_COMPRESSION     },
-    { "PIZ",    Imf::PIZ_COMPRESSION     },
-    { "PXR24",  Imf::PXR24_COMPRESSION   },
-    { "B44",    Imf::B44_COMPRESSION     },
-    { "B44A",   Imf::B44A_COMPRESSION    }
+    { "NONE",   Imf::NO_COMPRESSION,    TIFF_COMPRESSION(NONE)          },
+    { "RLE",    Imf::RLE_COMPRESSION,   TIFF_COMPRESSION(PACKBITS)      },
+    { "ZIPS",   Imf::ZIPS_COMPRESSION,  TIFF_COMPRESSION(ADOBE_DEFLATE) },
+    { "ZIP",    Imf::ZIP_COMPRESSION,   TIFF_COMPRESSION(ADOBE_DEFLATE) },
+    { "PIZ",    Imf::PIZ_COMPRESSION,   TIFF_COMPRESSION(NONE)          },
+    { "PXR24",  Imf::PXR24_COMPRESSION, TIFF_COMPRESSION(NONE)          },
+    { "B44",    Imf::B44_COMPRESSION,   TIFF_COMPRESSION(NONE)          },
+    { "B44A",   Imf::B44A_COMPRESSION,  TIFF_COMPRESSION(NONE)          }
 };
 
 #else
 
-const Compression Compression::no_compression = { "NO_COMPRESSION", 0 };
+const Compression Compression::no_compression = { "NO_COMPRESSION", 0, TIFF_COMPRESSION(NONE) };
 const Compression Compression::supported_compression_schemes[] =
 {
-    { "NONE",   0  }
+    { "NONE",   0, TIFF_COMPRESSION(NONE)          },
+    { "RLE",    0, TIFF_COMPRESSION(PACKBITS)      },
+    { "ZIPS",   0, TIFF_COMPRESSION(ADOBE_DEFLATE) },
+    { "ZIP",    0, TIFF_COMPRESSION(ADOBE_DEFLATE) }
 };
 
 #endif
@@ -57,6 +57,7 @@
 struct Compression {
     char const *name;
     int exrCompressionScheme;
+    int tiffCompressionScheme;
     
     // compressionNamed will return no_compression if no matching
     // scheme is found in supported_compression_schemes.
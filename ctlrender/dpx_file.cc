@@ -56,24 +56,74 @@
 
 #include <dpx.hh>
 #include <fstream>
+#include <memory>
 
-bool dpx_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
-              format_t *format) {
+bool dpx_check(const char *name) {
 	std::ifstream file;
-	ctl::dpx dpxheader;
 
 	file.open(name);
 
-	if(!ctl::dpx::check_magic(&file)) {
-		return 0;
+	return ctl::dpx::check_magic(&file);
+}
+
+namespace {
+
+class dpx_band_reader: public band_reader {
+	public:
+		dpx_band_reader(float _scale) : scale(_scale) {}
+
+		bool open(const char *name) {
+			return file.open(name);
+		}
+
+		virtual uint32_t width() const {
+			return file.header().pixels_per_line;
+		}
+		virtual uint32_t height() const {
+			return file.header().lines_per_element;
+		}
+		virtual uint32_t depth() const { return file.channels(0); }
+
+		int src_bps() const {
+			return file.header().elements[0].bits_per_sample;
+		}
+
+		virtual void read(ctl::dpx::fb<float> *pixels, uint32_t y) {
+			file.read(0, y, pixels, scale);
+			pixels->swizzle(file.header().elements[0].descriptor, FALSE);
+		}
+
+	private:
+		ctl::mapped_dpx file;
+		float scale;
+};
+
+}
+
+band_reader *dpx_open_band_reader(const char *name, float scale,
+                                  format_t *format) {
+	dpx_band_reader *reader=new dpx_band_reader(scale);
+
+	if(!reader->open(name)) {
+		delete reader;
+		return NULL;
 	}
-	
-	dpxheader.read(&file);	
-	dpxheader.read(&file, 0, pixels, scale);
 
-	format->src_bps=dpxheader.elements[0].bits_per_sample;
-	pixels->swizzle(dpxheader.elements[0].descriptor, FALSE);
+	format->src_bps=reader->src_bps();
+	return reader;
+}
+
+bool dpx_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
+              format_t *format) {
+	std::unique_ptr<band_reader> reader(dpx_open_band_reader(name, scale,
+	                                                         format));
+
+	if(reader.get()==NULL) {
+		return 0;
+	}
 
+	pixels->init(reader->width(), reader->height(), reader->depth());
+	reader->read(pixels, 0);
 	return 1;
 }
 
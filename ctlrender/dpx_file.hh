@@ -57,7 +57,10 @@
 
 #include <dpx.hh>
 #include "main.hh"
+#include "band.hh"
 
+// True if name is a DPX file.
+bool dpx_check(const char *name);
 bool dpx_read(const char *name, float scale,
               ctl::dpx::fb<float> *pixels,
               format_t *format);
@@ -65,4 +68,9 @@ void dpx_write(const char *name, float scale,
                const ctl::dpx::fb<float> &pixels,
                format_t *format);
 
+// Streaming variant of dpx_read. The file is memory mapped and each band
+// is decoded straight out of the mapping. NULL if name is not a DPX file.
+band_reader *dpx_open_band_reader(const char *name, float scale,
+                                  format_t *format);
+
 #endif
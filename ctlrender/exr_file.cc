@@ -61,10 +61,17 @@
 #include <ImfArray.h>
 #include <ImfHeader.h>
 #include <ImfChannelList.h>
+#include <ImfThreading.h>
 #include <Iex.h>
+#include <fstream>
+#include <memory>
+#include <string.h>
+#include <thread>
+#include <vector>
 
-bool exr_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
-              format_t *format) {
+namespace {
+
+bool exr_check(const char *name) {
 	std::ifstream ins;
 	unsigned int magic, endian;
 
@@ -81,180 +88,339 @@ bool exr_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
 			return 0;
 		}
 	}
-	//////////////////////////
-    
-    Imf::InputFile file(name);
-    Imath::Box2i dw = file.header().dataWindow();
-    
-    if (file.header().channels().begin().channel().type == Imf::HALF)
-        format->src_bps=16;
-    else
-        format->src_bps=32;
-        
-    int width = dw.max.x - dw.min.x + 1;
-    int height = dw.max.y - dw.min.y + 1;
-    
-    pixels->init(width, height, 4);
-    Imf::PixelType pixelType = Imf::FLOAT;
-    
-    int xstride = sizeof (*pixels->ptr()) * pixels->depth();
-    int ystride = sizeof (*pixels->ptr()) * pixels->depth() * pixels->width();
-    
-    Imf::FrameBuffer frameBuffer;
-    frameBuffer.insert ("R",
-                        Imf::Slice (pixelType,
-                                    (char *) pixels->ptr(),
-                                    xstride, ystride,
-                                    1, 1,
-                                    0.0));
-    
-    frameBuffer.insert ("G",
-                        Imf::Slice (pixelType,
-                                    (char *) (pixels->ptr()+1),
-                                    xstride, ystride,
-                                    1, 1,
-                                    0.0));
-    
-    frameBuffer.insert ("B",
-                        Imf::Slice (pixelType,
-                                    (char *) (pixels->ptr()+2),
-                                    xstride, ystride,
-                                    1, 1,
-                                    0.0));
-    
-    frameBuffer.insert ("A",
-                        Imf::Slice (pixelType,
-                                    (char *) (pixels->ptr()+3),
-                                    xstride, ystride,
-                                    1, 1,
-                                    1.0));
-    
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(dw.min.y, dw.max.y);
-    
-	if(scale==0.0 || scale==1.0) {
-		return 1;
+	return 1;
+}
+
+const char *exr_channel_names[] = { "R", "G", "B", "A" };
+
+// OpenEXR only decodes / encodes the chunks of a readPixels() or
+// writePixels() call in parallel once it has been given a thread pool,
+// which by default it isn't.
+void exr_init_threads() {
+	if(Imf::globalThreadCount()==0) {
+		unsigned int threads=std::thread::hardware_concurrency();
+		if(threads>1) {
+			Imf::setGlobalThreadCount(threads);
+		}
+	}
+}
+
+// Decodes a range of scanlines at a time straight into the caller's band,
+// either as 32-bit float or as half samples. The band holds the selected
+// channels in order, R, G, B and A by default (missing ones are filled in
+// by OpenEXR); any other channel in the file can be selected by name.
+class exr_band_reader: public band_reader {
+	public:
+		exr_band_reader(const char *name, float _scale) :
+			file(name), scale(_scale) {
+			dw=file.header().dataWindow();
+
+			for(int c=0; c<4; c++) {
+				names.push_back(exr_channel_names[c]);
+				selected.push_back(c);
+			}
+
+			// Subsampled channels have no sample for most pixels of a
+			// band, so only full resolution ones are offered.
+			const Imf::ChannelList &channels=file.header().channels();
+			for(Imf::ChannelList::ConstIterator i=channels.begin();
+			    i!=channels.end(); ++i) {
+				if(i.channel().xSampling!=1 || i.channel().ySampling!=1) {
+					continue;
+				}
+				if(is_rgba(i.name())) {
+					continue;
+				}
+				names.push_back(i.name());
+			}
+		}
+
+		virtual uint32_t width() const { return dw.max.x-dw.min.x+1; }
+		virtual uint32_t height() const { return dw.max.y-dw.min.y+1; }
+		virtual uint32_t depth() const { return selected.size(); }
+
+		int src_bps() const {
+			if(file.header().channels().begin().channel().type==Imf::HALF)
+				return 16;
+			return 32;
+		}
+
+		// True if every selected channel that is in the file is half.
+		virtual bool half_samples() const {
+			const Imf::ChannelList &channels=file.header().channels();
+			bool found=false;
+
+			for(size_t c=0; c<selected.size(); c++) {
+				const Imf::Channel *channel=
+					channels.findChannel(names[selected[c]].c_str());
+				if(channel==NULL) {
+					continue;
+				}
+				if(channel->type!=Imf::HALF) {
+					return false;
+				}
+				found=true;
+			}
+			return found;
+		}
+
+		virtual std::vector<std::string> channel_names() const {
+			return names;
+		}
+
+		virtual void select_channels(const std::vector<size_t> &channels) {
+			for(size_t c=0; c<channels.size(); c++) {
+				if(channels[c]>=names.size()) {
+					THROW(Iex::ArgExc, "EXR channel index " << channels[c] <<
+					      " is out of range (the file has " << names.size() <<
+					      " channels).");
+				}
+			}
+			selected=channels;
+		}
+
+		virtual void read(ctl::dpx::fb<float> *pixels, uint32_t y) {
+			// Half channels that need scaling are decoded as half and
+			// widened here with the scale applied in the same loop,
+			// rather than widened by OpenEXR and scaled in another pass.
+			if(scale!=0.0 && scale!=1.0 && half_samples()) {
+				if(halfs.width()!=pixels->width() ||
+				   halfs.height()!=pixels->height() ||
+				   halfs.depth()!=pixels->depth()) {
+					halfs.init(pixels->width(), pixels->height(),
+					           pixels->depth());
+				}
+				read_half(&halfs, y);
+
+				const half *h=halfs.ptr();
+				float *p=pixels->ptr();
+				for(uint64_t i=0; i<pixels->count(); i++) {
+					p[i]=(float)h[i]*scale;
+				}
+				return;
+			}
+
+			read_slices(Imf::FLOAT, (char *)pixels->ptr(), sizeof(float),
+			            pixels->width(), pixels->height(), pixels->depth(), y);
+
+			if(scale==0.0 || scale==1.0) {
+				return;
+			}
+
+			// 32 bit channels come out of OpenEXR as they are stored,
+			// so there is no conversion to fold the scale into.
+			float *p=pixels->ptr();
+			for(uint64_t i=0; i<pixels->count(); i++) {
+				*p=*p*scale;
+				p++;
+			}
+		}
+
+		virtual void read_half(ctl::dpx::fb<half> *pixels, uint32_t y) {
+			read_slices(Imf::HALF, (char *)pixels->ptr(), sizeof(half),
+			            pixels->width(), pixels->height(), pixels->depth(), y);
+		}
+
+	private:
+		static bool is_rgba(const char *name) {
+			for(int c=0; c<4; c++) {
+				if(strcmp(name, exr_channel_names[c])==0) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void read_slices(Imf::PixelType type, char *pixels, size_t sample,
+		                 uint32_t width, uint32_t height, uint32_t depth,
+		                 uint32_t y) {
+			ptrdiff_t xstride=sample*depth;
+			ptrdiff_t ystride=xstride*width;
+
+			// The slices are addressed in data window coordinates, so
+			// the base is moved back to where (dw.min.x, dw.min.y+y)
+			// lands on the first pixel of the band.
+			char *base=pixels-dw.min.x*xstride-
+			           (dw.min.y+(ptrdiff_t)y)*ystride;
+
+			// Only the channels with a slice are decoded, the rest of
+			// the file is skipped over.
+			Imf::FrameBuffer frameBuffer;
+			for(uint32_t c=0; c<depth && c<selected.size(); c++) {
+				frameBuffer.insert(names[selected[c]].c_str(),
+				                   Imf::Slice(type,
+				                              base+c*sample,
+				                              xstride, ystride,
+				                              1, 1,
+				                              selected[c]==3 ? 1.0 : 0.0));
+			}
+
+			file.setFrameBuffer(frameBuffer);
+			file.readPixels(dw.min.y+y, dw.min.y+y+height-1);
+		}
+
+		Imf::InputFile file;
+		Imath::Box2i dw;
+		float scale;
+		std::vector<std::string> names;
+		std::vector<size_t> selected;
+		ctl::dpx::fb<half> halfs;
+};
+
+Imf::Header exr_header(uint32_t width, uint32_t height, uint32_t depth,
+                       Imf::PixelType pixelType, Compression *compression) {
+	Imf::Header header(width, height);
+	header.compression()=(Imf::Compression)compression->exrCompressionScheme;
+
+	for(uint32_t c=0; c<depth && c<4; c++) {
+		header.channels().insert(exr_channel_names[c], Imf::Channel(pixelType));
 	}
+	return header;
+}
+
+// Encodes bands of float pixels as they arrive as either 32-bit float or
+// 16-bit half channels.
+class exr_band_writer: public band_writer {
+	public:
+		exr_band_writer(const char *name, float _scale,
+		                uint32_t width, uint32_t height, uint32_t depth,
+		                Imf::PixelType _pixelType, Compression *compression) :
+			file(name, exr_header(width, height, depth, _pixelType, compression)),
+			pixelType(_pixelType), scale(_scale) {
+			if(scale==0.0) {
+				scale=1.0;
+			}
+		}
+
+		virtual void write(const ctl::dpx::fb<float> &pixels, uint32_t y) {
+			const float *fIn=pixels.ptr();
+			Imf::PixelType sliceType=pixelType;
+			const char *base;
+			ptrdiff_t xstride;
+
+			// Unscaled floats are handed to OpenEXR as they are, it
+			// converts them to half as part of the (threaded) encode.
+			if(pixelType==Imf::HALF && scale!=1.0) {
+				halfs.resize(pixels.count());
+				for(uint64_t i=0; i<pixels.count(); i++) {
+					halfs[i]=*(fIn++)/scale;
+				}
+				base=(const char *)&halfs[0];
+				xstride=sizeof(half)*pixels.depth();
+			} else if(scale!=1.0) {
+				floats.resize(pixels.count());
+				for(uint64_t i=0; i<pixels.count(); i++) {
+					floats[i]=*(fIn++)/scale;
+				}
+				base=(const char *)&floats[0];
+				xstride=sizeof(float)*pixels.depth();
+			} else {
+				base=(const char *)fIn;
+				xstride=sizeof(float)*pixels.depth();
+				sliceType=Imf::FLOAT;
+			}
 
-	float *p=pixels->ptr();
-	for(uint64_t i=0; i<pixels->count(); i++) {
-		*p=*p*scale;
-		p++;
+			ptrdiff_t ystride=xstride*pixels.width();
+			size_t sample=xstride/pixels.depth();
+			base=base-(ptrdiff_t)y*ystride;
+
+			Imf::FrameBuffer frameBuffer;
+			for(uint32_t c=0; c<pixels.depth() && c<4; c++) {
+				frameBuffer.insert(exr_channel_names[c],
+				                   Imf::Slice(sliceType,
+				                              (char *)(base+c*sample),
+				                              xstride, ystride));
+			}
+
+			file.setFrameBuffer(frameBuffer);
+			file.writePixels(pixels.height());
+		}
+
+	private:
+		Imf::OutputFile file;
+		Imf::PixelType pixelType;
+		float scale;
+		std::vector<half> halfs;
+		std::vector<float> floats;
+};
+
+}
+
+band_reader *exr_open_band_reader(const char *name, float scale,
+                                  format_t *format) {
+	if(!exr_check(name)) {
+		return NULL;
 	}
-	return 1;
+
+	exr_init_threads();
+
+	exr_band_reader *reader=new exr_band_reader(name, scale);
+	format->src_bps=reader->src_bps();
+	return reader;
 }
 
-void exr_write32(const char *name, float scale, const ctl::dpx::fb<float> &pixels, Compression *compression)
-{
-    int depth = pixels.depth();
-    float width = pixels.width();
-    float height = pixels.height();
-    float const *pixelPtr = pixels.ptr();
-    
-	ctl::dpx::fb<float> scaled_pixels;
-    if (scale != 0.0 && scale != 1.0) {
-        scaled_pixels.init(pixels.height(), pixels.width(), pixels.depth());
-        scaled_pixels.alpha(1.0);
-        
-        const float *fIn=pixels.ptr();
-        float *out=scaled_pixels.ptr();
-        
-        for(uint64_t i=0; i<pixels.count(); i++) {
-            *(out++)=*(fIn++)/scale;
-        }
-        
-        depth = scaled_pixels.depth();
-        width = scaled_pixels.width();
-        height = scaled_pixels.height();
-        pixelPtr = scaled_pixels.ptr();
-    }
-    
-    Imf::PixelType pixelType = Imf::FLOAT;
-    
-    Imf::Header header(width, height);
-    header.compression() = (Imf::Compression)compression->exrCompressionScheme;
-    
-    header.channels().insert("R", Imf::Channel(pixelType));
-    header.channels().insert("G", Imf::Channel(pixelType));
-    header.channels().insert("B", Imf::Channel(pixelType));
-    
-    if (depth == 4)
-        header.channels().insert("A", Imf::Channel(pixelType));
-    
-    Imf::OutputFile file (name, header);
-    
-    Imf::FrameBuffer frameBuffer;
-    
-    int xstride = sizeof (*pixelPtr) * depth;
-    int ystride = sizeof (*pixelPtr) * depth * width;
-    
-    frameBuffer.insert ("R",
-                        Imf::Slice (pixelType,
-                                    (char *) pixelPtr,
-                                    xstride, ystride));
-    
-    frameBuffer.insert ("G",
-                        Imf::Slice (pixelType,
-                                    (char *) (pixelPtr+1),
-                                    xstride, ystride));
-    
-    frameBuffer.insert ("B",
-                        Imf::Slice (pixelType,
-                                    (char *) (pixelPtr+2),
-                                    xstride, ystride));
-    
-    if (depth == 4)
-        frameBuffer.insert ("A",
-                            Imf::Slice (pixelType,
-                                        (char *) (pixelPtr+3),
-                                        xstride, ystride));
-    
-    file.setFrameBuffer (frameBuffer);
-    file.writePixels (height);
+band_writer *exr_open_band_writer(const char *name, float scale,
+                                  uint32_t width, uint32_t height,
+                                  uint32_t depth, format_t *format,
+                                  Compression *compression) {
+	Imf::PixelType pixelType;
+
+	if(format->bps == 32) {
+		pixelType=Imf::FLOAT;
+	}
+	else if(format->bps == 16) {
+		pixelType=Imf::HALF;
+	}
+	else {
+		THROW(Iex::ArgExc, "EXR files only support 16 or 32 bps at the moment.");
+	}
+
+	exr_init_threads();
+
+	return new exr_band_writer(name, scale, width, height, depth,
+	                           pixelType, compression);
 }
 
-void exr_write16(const char *name, float scale, const ctl::dpx::fb<float> &pixels, Compression *compression) {
-	if (scale == 0.0) scale = 1.0;
-
-    ctl::dpx::fb<half> scaled_pixels;
-    scaled_pixels.init(pixels.height(), pixels.width(), pixels.depth());
-    scaled_pixels.alpha(1.0);
-    
-    const float *fIn=pixels.ptr();
-    half *out=scaled_pixels.ptr();
-    
-    // Yes... I should lookup table this. I *know*!
-    for(uint64_t i=0; i<pixels.count(); i++) {
-        *(out++)=*(fIn++)/scale;
-    }
-    
-	uint8_t channels=scaled_pixels.depth();
-    const half *in=scaled_pixels.ptr();
-    
-	Imf::RgbaOutputFile file(name, pixels.width(), pixels.height(),
-	                         channels==4 ? Imf::WRITE_RGBA : Imf::WRITE_RGB, 1, Imath::V2f (0, 0), 1,
-	                         Imf::INCREASING_Y, (Imf::Compression)compression->exrCompressionScheme);
-    
-	file.setFrameBuffer((Imf::Rgba *)in, 1, pixels.width());
-	file.writePixels(pixels.height());
+bool exr_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
+              format_t *format) {
+	std::unique_ptr<band_reader> reader(exr_open_band_reader(name, scale, format));
+
+	if(reader.get()==NULL) {
+		return 0;
+	}
+
+	pixels->init(reader->width(), reader->height(), reader->depth());
+	reader->read(pixels, 0);
+	return 1;
 }
 
 void exr_write(const char *name, float scale, const ctl::dpx::fb<float> &pixels,
                format_t *format, Compression *compression)
 {
-    if(format->bps == 32) {
-        exr_write32(name, scale, pixels, compression);
-    }
-    else if(format->bps == 16) {
-        exr_write16(name, scale, pixels, compression);
-    }
-    else {
-        THROW(Iex::ArgExc, "EXR files only support 16 or 32 bps at the moment.");
-    }
+	std::unique_ptr<band_writer> writer(exr_open_band_writer(name, scale,
+	                                                       pixels.width(),
+	                                                       pixels.height(),
+	                                                       pixels.depth(),
+	                                                       format,
+	                                                       compression));
+	writer->write(pixels, 0);
+	writer->close();
 }
 
 #else
 
+band_reader *exr_open_band_reader(const char *name, float scale,
+                                  format_t *format) {
+	return NULL;
+}
+
+band_writer *exr_open_band_writer(const char *name, float scale,
+                                  uint32_t width, uint32_t height,
+                                  uint32_t depth, format_t *format,
+                                  Compression *compression) {
+	return NULL;
+}
+
 bool exr_read(const char *name, float scale,
               ctl::dpx::fb<float> *pixels,
               format_t *bpp) {
@@ -263,7 +429,7 @@ bool exr_read(const char *name, float scale,
 
 void exr_write(const char *name, float scale,
                const ctl::dpx::fb<float> &pixels,
-               format_t *format) {
+               format_t *format, Compression *compression) {
 }
 
 #endif
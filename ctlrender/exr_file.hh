@@ -56,6 +56,7 @@
 #define CTL_UTIL_CTLRENDER_EXR_INCLUDE
 
 #include "main.hh"
+#include "band.hh"
 #include <dpx.hh>
 
 bool exr_read(const char *name, float scale,
@@ -66,4 +67,13 @@ void exr_write(const char *name, float scale,
                format_t *format,
                Compression *compression);
 
+// Streaming variants of the above. The reader is NULL if name is not an
+// EXR file.
+band_reader *exr_open_band_reader(const char *name, float scale,
+                                  format_t *format);
+band_writer *exr_open_band_writer(const char *name, float scale,
+                                  uint32_t width, uint32_t height,
+                                  uint32_t depth, format_t *format,
+                                  Compression *compression);
+
 #endif
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+#include "half_row.hh"
+#include <half.h>
+
+// The F16C code is compiled for that instruction set regardless of the
+// compiler flags, and only called once the CPU has been found to have it.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HALF_ROW_F16C 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void half_row_generic(uint16_t *out, const float *in, float scale,
+                      size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		half h(in[i] * scale);
+		out[i] = h.bits();
+	}
+}
+
+#if defined(HALF_ROW_F16C)
+
+__attribute__((target("avx,f16c")))
+void half_row_f16c_impl(uint16_t *out, const float *in, float scale,
+                        size_t count)
+{
+	__m256 vscale = _mm256_set1_ps(scale);
+	size_t i = 0;
+
+	for ( ; i + 8 <= count; i += 8)
+	{
+		__m256 v = _mm256_mul_ps(_mm256_loadu_ps(in + i), vscale);
+		_mm_storeu_si128((__m128i *)(out + i),
+		                 _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+	}
+
+	half_row_generic(out + i, in + i, scale, count - i);
+}
+
+bool cpu_has_f16c()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+}
+
+#endif
+
+}
+
+bool half_row_f16c()
+{
+#if defined(HALF_ROW_F16C)
+	static const bool f16c = cpu_has_f16c();
+
+	return f16c;
+#else
+	return false;
+#endif
+}
+
+void half_row(uint16_t *out, const float *in, float scale, size_t count)
+{
+#if defined(HALF_ROW_F16C)
+	if (half_row_f16c())
+	{
+		half_row_f16c_impl(out, in, scale, count);
+		return;
+	}
+#endif
+
+	half_row_generic(out, in, scale, count);
+}
@@ -167,6 +167,9 @@ const format_t &find_format(const char *fmt, const char *message = NULL)
 }
 
 int verbosity = 1;
+bool use_jit = false;
+uint32_t band_rows = 0;
+uint32_t tiff_tile_size = 0;
 
 int main(int argc, const char **argv)
 {
@@ -421,6 +424,63 @@ int main(int argc, const char **argv)
 			{
 				force_overwrite_output_file = TRUE;
 			}
+			else if (!strcmp(argv[0], "-jit"))
+			{
+				use_jit = true;
+			}
+			else if (!strcmp(argv[0], "-band"))
+			{
+				if (argc == 1)
+				{
+					fprintf(stderr,
+							"The -band option requires an additional option "
+							"specifying the number of\nscanlines to process at "
+							"a time.\n");
+					exit(1);
+				}
+				else
+				{
+					char *end = NULL;
+					long rows = strtol(argv[1], &end, 10);
+					if ((end != NULL && *end != 0) || rows < 0)
+					{
+						fprintf(stderr,
+								"Unable to parse '%s' as a scanline count "
+								"for the '-band' argument\n",
+								argv[1]);
+						exit(1);
+					}
+					band_rows = rows;
+					argv++;
+					argc--;
+				}
+			}
+			else if (!strcmp(argv[0], "-tile"))
+			{
+				if (argc == 1)
+				{
+					fprintf(stderr,
+							"The -tile option requires an additional option "
+							"specifying the size of\nthe TIFF tiles to write.\n");
+					exit(1);
+				}
+				else
+				{
+					char *end = NULL;
+					long size = strtol(argv[1], &end, 10);
+					if ((end != NULL && *end != 0) || size < 0 || size % 16 != 0)
+					{
+						fprintf(stderr,
+								"Unable to parse '%s' as a tile size (a "
+								"multiple of 16) for the\n'-tile' argument\n",
+								argv[1]);
+						exit(1);
+					}
+					tiff_tile_size = size;
+					argv++;
+					argc--;
+				}
+			}
 			else if (!strncmp(argv[0], "-noalpha", 2))
 			{
 				noalpha = TRUE;
@@ -61,6 +61,13 @@
 #include <compression.hh>
 
 extern int verbosity;
+extern bool use_jit;
+// Number of scanlines read, transformed and written at a time. 0 means
+// the whole image.
+extern uint32_t band_rows;
+// Width and height of the tiles TIFF files are written with. 0 writes
+// strips.
+extern uint32_t tiff_tile_size;
 
 // Defined in usage.cc
 void usage(const char *section=NULL);
@@ -60,27 +60,20 @@
 #include <tiffio.h>
 #include <sys/param.h>
 #include <math.h>
+#include <string.h>
 #include <Iex.h>
-#include <alloca.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
-void tiff_read_multiplane(TIFF *t, float scale, ctl::dpx::fb<float> * pixels);
-void tiff_read_interleaved(TIFF *t, float scale, ctl::dpx::fb<float> * pixels);
 void tiff_read_failsafe(TIFF *t, float scale, ctl::dpx::fb<float> * pixels);
 
 void tiff_interleave_int8(float *row, int offset, float scale,
                           uint8_t *r, int r_stride, uint8_t *g, int g_stride,
                           uint8_t *b, int b_stride, uint8_t *a, int a_stride,
                           uint32_t width);
-                           
-void tiff_interleave_int16(float *row, int offset, float scale,
-                           uint16_t *r, int r_stride, uint16_t *g, int g_stride,
-                           uint16_t *b, int b_stride, uint16_t *a, int a_stride,
-                           uint32_t width);
-
-void tiff_interleave_float(float *row, float scale,
-                           float *r, int r_stride, float *g, int g_stride,
-                           float *b, int b_stride, float *a, int a_stride,
-                           uint32_t width);
 
 void ErrorHandler(const char *module, const char *fmt, va_list ap) {
 	fprintf(stderr, "Unable to read tiff file: ");
@@ -92,60 +85,48 @@ void WarningHandler(const char *module, const char *fmt, va_list ap) {
 //	vfprintf(stderr, fmt, ap);
 }
 
-bool tiff_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
-               format_t *format) {
-	TIFF *t;
-	uint16_t samples_per_pixel;
+enum tiff_layout_t {
+	tiff_layout_failsafe,
+	tiff_layout_strips,
+	tiff_layout_tiles
+};
+
+// 8 and 16 bit integer and 32 bit float RGB(A) or greyscale samples are
+// decoded a strip or tile at a time in their own bit depth, whatever the
+// compression. Anything else (palette, YCbCr, 1 bit...) is left to
+// TIFFReadRGBAImage, which only gives 8 bit RGBA.
+tiff_layout_t tiff_layout(TIFF *t, format_t *format) {
 	uint16_t bits_per_sample;
 	uint16_t sample_format;
-	uint16_t planar_config;
 	uint16_t photometric;
 	uint16_t orientation;
+	bool samples_ok;
 
-	TIFFSetErrorHandler(ErrorHandler);
-	TIFFSetWarningHandler(WarningHandler);
-
-	t=TIFFOpen(name, "r");
-	if(t==NULL) {
-		// This is set if the file is not a tiff, we just sort of punt.
-		return FALSE;
-	}
-
-	TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLESPERPIXEL, &samples_per_pixel);
 	TIFFGetFieldDefaulted(t, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
 	format->src_bps=bits_per_sample;
 	TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLEFORMAT, &sample_format);
 	TIFFGetFieldDefaulted(t, TIFFTAG_PHOTOMETRIC, &photometric);
 	TIFFGetFieldDefaulted(t, TIFFTAG_ORIENTATION, &orientation);
 
-//	tiff_read_failsafe(t, scale, pixels);
-//	return TRUE;
-
-	if(!(bits_per_sample==16 && sample_format<3) &&
-	   !(bits_per_sample==32 && sample_format==3) &&
-	   photometric!=PHOTOMETRIC_RGB &&
-	   orientation!=ORIENTATION_TOPLEFT &&
-	   orientation!=ORIENTATION_BOTLEFT) {
+	samples_ok=((bits_per_sample==8 || bits_per_sample==16) &&
+	            (sample_format==SAMPLEFORMAT_UINT ||
+	             sample_format==SAMPLEFORMAT_INT)) ||
+	           (bits_per_sample==32 && sample_format==SAMPLEFORMAT_IEEEFP);
 
+	if(!samples_ok ||
+	   (photometric!=PHOTOMETRIC_RGB && photometric!=PHOTOMETRIC_MINISBLACK) ||
+	   (orientation!=ORIENTATION_TOPLEFT && orientation!=ORIENTATION_BOTLEFT)) {
 		if(bits_per_sample!=8) {
 			fprintf(stderr, "falling back to failsafe TIFF reader. Reading "
 			        "as \n8 bits per sample RGBA.\n");
 		}
-		tiff_read_failsafe(t, scale, pixels);
-		TIFFClose(t);
-		return TRUE;
+		return tiff_layout_failsafe;
 	}
 
-	TIFFGetField(t, TIFFTAG_PLANARCONFIG, &planar_config);
-	if(planar_config==PLANARCONFIG_CONTIG) {
-		tiff_read_interleaved(t, scale, pixels);
-	} else if(planar_config==PLANARCONFIG_SEPARATE) {
-		tiff_read_multiplane(t, scale, pixels);
+	if(TIFFIsTiled(t)) {
+		return tiff_layout_tiles;
 	}
-
-	TIFFClose(t);
-
-	return TRUE;
+	return tiff_layout_strips;
 }
 
 void tiff_interleave_int8(float *o, int offset, float scale,
@@ -183,292 +164,68 @@ void tiff_interleave_int8(float *o, int offset, float scale,
 	}
 }
 
-                           
-void tiff_interleave_int16(float *o, uint16_t offset, float scale,
-                           uint16_t *r, int r_stride, uint16_t *g, int g_stride,
-                           uint16_t *b, int b_stride, uint16_t *a, int a_stride,
-                           uint32_t width) {
-	uint32_t i;
-	float f;
-
-	if(scale==0) {
-		scale=65535.0;
-	}
-
-	for(i=0; i<width; i++) {
-		if(r!=NULL) {
-			f=*r+offset;
-			r=r+r_stride;
-			*(o++)=f/scale;
-		}
-		if(g!=NULL) {
-			f=*g+offset;
-			g=g+g_stride;
-			*(o++)=f/scale;
-		}
-		if(b!=NULL) {
-			f=*b+offset;
-			b=b+b_stride;
-			*(o++)=f/scale;
-		}
-		if(a!=NULL) {
-			f=*a+offset;
-			a=a+a_stride;
-			*(o++)=f/scale;
-		}
-	}
-}
-
-void tiff_interleave_float(float *o, float scale,
-                           float *r, int r_stride, float *g, int g_stride,
-                           float *b, int b_stride, float *a, int a_stride,
-                           uint32_t width) {
+// Converts count samples of a decoded strip or tile to float, storing
+// every o_stride'th float. Integer samples are divided by scale (255 or
+// 65535 by default), signed ones are offset to be positive first.
+void tiff_convert_samples(float *o, int o_stride, const uint8_t *in,
+                          uint16_t bits_per_sample, uint16_t sample_format,
+                          float scale, uint32_t count) {
 	uint32_t i;
 	float f;
 
-	if(scale==0) {
-		scale=1.0;
-	}
-
-	for(i=0; i<width; i++) {
-		if(r!=NULL) {
-			f=*r;
-			r=r+r_stride;
-			*(o++)=f/scale;
-		}
-		if(g!=NULL) {
-			f=*g;
-			g=g+g_stride;
-			*(o++)=f/scale;
-		}
-		if(b!=NULL) {
-			f=*b;
-			b=b+b_stride;
-			*(o++)=f/scale;
-		}
-		if(a!=NULL) {
-			f=*a;
-			a=a+a_stride;
-			*(o++)=f/scale;
-		}
-	}
-}
-
-void tiff_read_multiplane(TIFF *t, float scale, ctl::dpx::fb<float> * pixels) {
-	uint8_t *scanline_buffer_uint8[4];
-	uint16_t *scanline_buffer_uint16[4];
-	float *scanline_buffer_float[4];
-	uint16_t samples_per_pixel;
-	uint16_t bits_per_sample;
-	uint32_t w;
-	uint32_t h;
-	uint16_t sample_format;
-	uint16_t offset;
-	uint16_t orientation;
-	tsize_t scanline_size;
-	float *row_ptr;
-	uint32_t row;
-	uint32_t orientation_offset;
-	uint16_t d;
-
-	TIFFGetFieldDefaulted(t, TIFFTAG_IMAGEWIDTH, &w);
-	TIFFGetFieldDefaulted(t, TIFFTAG_IMAGELENGTH, &h);
-	TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLESPERPIXEL, &samples_per_pixel);
-	TIFFGetFieldDefaulted(t, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
-	TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLEFORMAT, &sample_format);
-	TIFFGetFieldDefaulted(t, TIFFTAG_ORIENTATION, &orientation);
-
-	pixels->init(w, h, samples_per_pixel);
-
-	orientation_offset=0;
-	if(orientation==ORIENTATION_LEFTTOP) {
-		// We only deal with the bottom->top flip, not the other orientation
-		// modes (the actual check for this is in tiff_read).
-		orientation_offset=(uint32_t)-h;
-	}
-
-	scanline_size=TIFFScanlineSize(t);
 	if(bits_per_sample==8) {
-		for(row=0; row<4; row++) {
-			if(row<samples_per_pixel) {
-				scanline_buffer_uint8[row]=(uint8_t *)alloca(scanline_size);
-				for(d=0; d<w; d++) {
-					scanline_buffer_uint8[row][d]= row==3 ? 255 : 0;
-				}
-			} else {
-				scanline_buffer_uint8[row]=NULL;
-			}
-		}
-		for(;row<4; row++) {
+		if(scale==0) {
+			scale=255.0;
 		}
-		offset=0;
-		if(sample_format==2) {
-			offset=1<<7;
-		}
-		for(row=0; row<h; row++) {
-			for(d=0; d<samples_per_pixel; d++) {
-				TIFFReadScanline(t, scanline_buffer_uint8[d],
-				                 row+orientation_offset, d);
-			}
-			row_ptr=pixels->ptr()+row*pixels->width()*pixels->depth();
-			tiff_interleave_int8(row_ptr, offset, scale,
-			                     scanline_buffer_uint8[0], 1,
-			                     scanline_buffer_uint8[1], 1,
-			                     scanline_buffer_uint8[2], 1,
-			                     scanline_buffer_uint8[3], 1,
-			                     w);
-		}
-	} else if(bits_per_sample==16) {
-		for(row=0; row<4; row++) {
-			if(row<samples_per_pixel) {
-				scanline_buffer_uint16[row]=(uint16_t *)alloca(scanline_size);
-				for(d=0; d<w; d++) {
-					scanline_buffer_uint16[row][d]= row==3 ? 65535 : 0;
-				}
-			} else {
-				scanline_buffer_uint16[row]=NULL;
+		if(sample_format==SAMPLEFORMAT_INT) {
+			const int8_t *s=(const int8_t *)in;
+			for(i=0; i<count; i++) {
+				f=*(s++)+128;
+				*o=f/scale;
+				o=o+o_stride;
 			}
-		}
-		offset=0;
-		if(sample_format==2) {
-			offset=1<<15;
-		}
-		for(row=0; row<h; row++) {
-			for(d=0; d<samples_per_pixel; d++) {
-				TIFFReadScanline(t, scanline_buffer_uint16[d],
-				                 row+orientation_offset, d);
+		} else {
+			const uint8_t *s=in;
+			for(i=0; i<count; i++) {
+				f=*(s++);
+				*o=f/scale;
+				o=o+o_stride;
 			}
-			row_ptr=pixels->ptr()+row*pixels->width()*pixels->depth();
-			tiff_interleave_int16(row_ptr, offset, scale,
-			                      scanline_buffer_uint16[0], 1,
-			                      scanline_buffer_uint16[1], 1,
-			                      scanline_buffer_uint16[2], 1,
-			                      scanline_buffer_uint16[3], 1,
-			                      w);
 		}
-	} else if(sample_format==3) {
-		for(row=0; row<4; row++) {
-			if(row<samples_per_pixel) {
-				scanline_buffer_float[row]=(float *)alloca(scanline_size);
-				for(d=0; d<w; d++) {
-					scanline_buffer_float[row][d]= row==3 ? 1.0 : 0.0;
-				}
-			} else {
-				scanline_buffer_float[row]=NULL;
-			}
+	} else if(bits_per_sample==16) {
+		if(scale==0) {
+			scale=65535.0;
 		}
-		for(row=0; row<h; row++) {
-			for(d=0; d<samples_per_pixel; d++) {
-				TIFFReadScanline(t, scanline_buffer_float[d],
-				                 row+orientation_offset, d);
+		if(sample_format==SAMPLEFORMAT_INT) {
+			const int16_t *s=(const int16_t *)in;
+			for(i=0; i<count; i++) {
+				f=*(s++)+32768;
+				*o=f/scale;
+				o=o+o_stride;
 			}
-			row_ptr=pixels->ptr()+row*pixels->width()*pixels->depth();
-			tiff_interleave_float(row_ptr, scale,
-			                      scanline_buffer_float[0], 1,
-			                      scanline_buffer_float[1], 1,
-			                      scanline_buffer_float[2], 1,
-			                      scanline_buffer_float[3], 1,
-			                      w);
-		}
-	}
-}
-
-void tiff_read_interleaved(TIFF *t, float scale, ctl::dpx::fb<float> * pixels) {
-	uint8_t *scanline_buffer_uint8;
-	uint16_t *scanline_buffer_uint16;
-	float *scanline_buffer_float;
-	uint16_t samples_per_pixel;
-	uint16_t bits_per_sample;
-	uint32_t w;
-	uint32_t h;
-	uint16_t sample_format;
-	uint16_t offset;
-	uint32_t row;
-	float *row_ptr;
-
-	TIFFGetFieldDefaulted(t, TIFFTAG_IMAGEWIDTH, &w);
-	TIFFGetFieldDefaulted(t, TIFFTAG_IMAGELENGTH, &h);
-	TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLESPERPIXEL, &samples_per_pixel);
-	TIFFGetFieldDefaulted(t, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
-	TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLEFORMAT, &sample_format);
-	pixels->init(w, h, samples_per_pixel);
-
-	if(bits_per_sample==8) {
-		scanline_buffer_uint8=(uint8_t *)alloca(TIFFScanlineSize(t));
-		offset=0;
-		if(sample_format==2) {
-			offset=127;
-		}
-		for(row=0; row<h; row++) {
-			TIFFReadScanline(t, scanline_buffer_uint8, row, 0);
-			row_ptr=pixels->ptr()+row*pixels->width()*pixels->depth();
-			if(samples_per_pixel==3) {
-				tiff_interleave_int8(row_ptr, offset, scale,
-				                     scanline_buffer_uint8+0, 3,
-				                     scanline_buffer_uint8+1, 3,
-				                     scanline_buffer_uint8+2, 3,
-				                     NULL, 0,
-				                     w);
-			} else {
-				tiff_interleave_int8(row_ptr, offset, scale,
-				                     scanline_buffer_uint8+0, 4,
-				                     scanline_buffer_uint8+1, 4,
-				                     scanline_buffer_uint8+2, 4,
-				                     scanline_buffer_uint8+3, 4,
-				                     w);
+		} else {
+			const uint16_t *s=(const uint16_t *)in;
+			for(i=0; i<count; i++) {
+				f=*(s++);
+				*o=f/scale;
+				o=o+o_stride;
 			}
 		}
-	} else if(bits_per_sample==16) {
-		scanline_buffer_uint16=(uint16_t *)alloca(TIFFScanlineSize(t));
-		offset=0;
-		if(sample_format==2) {
-			offset=32767;
-		}
-		for(row=0; row<h; row++) {
-			TIFFReadScanline(t, scanline_buffer_uint16, row, 0);
-			row_ptr=pixels->ptr()+row*pixels->width()*pixels->depth();
-			if(samples_per_pixel==3) {
-				tiff_interleave_int16(row_ptr, offset, scale,
-				                      scanline_buffer_uint16+0, 3,
-				                      scanline_buffer_uint16+1, 3,
-				                      scanline_buffer_uint16+2, 3,
-				                      NULL, 0,
-				                      w);
-			} else {
-				tiff_interleave_int16(row_ptr, offset, scale,
-				                      scanline_buffer_uint16+0, 4,
-				                      scanline_buffer_uint16+1, 4,
-				                      scanline_buffer_uint16+2, 4,
-				                      scanline_buffer_uint16+3, 4,
-				                      w);
-			}
+	} else {
+		const float *s=(const float *)in;
+		if(scale==0) {
+			scale=1.0;
 		}
-	} else if(sample_format==3) {
-		scanline_buffer_float=(float *)alloca(TIFFScanlineSize(t));
-		for(row=0; row<h; row++) {
-			TIFFReadScanline(t, scanline_buffer_float, row, 0);
-			row_ptr=pixels->ptr()+row*pixels->width()*pixels->depth();
-			if(samples_per_pixel==3) {
-				tiff_interleave_float(row_ptr, scale,
-				                      scanline_buffer_float+0, 3,
-				                      scanline_buffer_float+1, 3,
-				                      scanline_buffer_float+2, 3,
-				                      NULL, 0,
-				                      w);
-			} else {
-				tiff_interleave_float(row_ptr, scale,
-				                      scanline_buffer_float+0, 4,
-				                      scanline_buffer_float+1, 4,
-				                      scanline_buffer_float+2, 4,
-				                      scanline_buffer_float+3, 4,
-				                      w);
-			}
+		for(i=0; i<count; i++) {
+			f=*(s++);
+			*o=f/scale;
+			o=o+o_stride;
 		}
 	}
 }
 
 void tiff_read_failsafe(TIFF *t, float scale, ctl::dpx::fb<float> *pixels) {
-	uint8_t *temp_buffer;
+	std::vector<uint32_t> temp_buffer;
 	uint8_t *flip;
 	uint32_t i;
 	uint32_t w, h;
@@ -477,12 +234,12 @@ void tiff_read_failsafe(TIFF *t, float scale, ctl::dpx::fb<float> *pixels) {
 	TIFFGetFieldDefaulted(t, TIFFTAG_IMAGELENGTH, &h);
 	pixels->init(w, h, 4);
 
-	temp_buffer=(uint8_t *)alloca(w*h*4);
-	TIFFReadRGBAImage(t, w, h, (uint32 *)temp_buffer, 0);
+	temp_buffer.resize((size_t)w*h);
+	TIFFReadRGBAImage(t, w, h, (uint32 *)&temp_buffer[0], 0);
 
 	for(i=0; i<h; i++) {
-		flip=temp_buffer+sizeof(uint32_t)*w*(h-i-1);
-		tiff_interleave_int8(pixels->ptr()+w*i*4, 0, scale,
+		flip=(uint8_t *)&temp_buffer[(size_t)w*(h-i-1)];
+		tiff_interleave_int8(pixels->ptr()+(size_t)w*i*4, 0, scale,
 		                     flip+0, 4, flip+1, 4, flip+2, 4, flip+3, 4, w);
 	}
 }
@@ -552,15 +309,555 @@ void tiff_convert_float(float *out, const float *in,
 #endif
 }
 
-void tiff_write(const char *name, float scale,
-                const ctl::dpx::fb<float> &pixels,
-                format_t *format) {
+namespace {
+
+// Strips (or tiles) are decoded and encoded independently of each other,
+// so a band's worth of them is spread over as many threads as there are
+// cores.
+unsigned int tiff_threads(size_t chunks) {
+	unsigned int threads=std::thread::hardware_concurrency();
+
+	if(threads==0) {
+		threads=1;
+	}
+	if(threads>chunks) {
+		threads=chunks;
+	}
+	return threads;
+}
+
+// Calls fn(worker, i) for every i in [0, count), worker being which of
+// threads threads (0 is the calling one) is running it.
+template<class F>
+void tiff_parallel(unsigned int threads, size_t count, const F &fn) {
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> pool;
+
+	auto work=[&](unsigned int worker) {
+		for(size_t i=next++; i<count; i=next++) {
+			fn(worker, i);
+		}
+	};
+
+	for(unsigned int worker=1; worker<threads; worker++) {
+		pool.push_back(std::thread(work, worker));
+	}
+	work(0);
+	for(size_t i=0; i<pool.size(); i++) {
+		pool[i].join();
+	}
+}
+
+// A strip or tile: its top left pixel and, for planar files, the sample
+// (plane) it holds.
+struct tiff_chunk_t {
+	uint32_t x;
+	uint32_t y;
+	uint16_t plane;
+};
+
+// Reads a band at a time by decoding the strips or tiles that cover it.
+// libtiff keeps its decoder state in the TIFF handle, so every thread past
+// the first one opens the file again. A strip or tile that straddles two
+// bands is decoded for both.
+class tiff_band_reader: public band_reader {
+	public:
+		tiff_band_reader(const char *_name, TIFF *t, float _scale,
+		                 tiff_layout_t layout) :
+			name(_name), scale(_scale) {
+			uint16_t planar_config;
+			uint16_t orientation;
+
+			handles.push_back(t);
+			TIFFGetFieldDefaulted(t, TIFFTAG_IMAGEWIDTH, &w);
+			TIFFGetFieldDefaulted(t, TIFFTAG_IMAGELENGTH, &h);
+			TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLESPERPIXEL, &samples_per_pixel);
+			TIFFGetFieldDefaulted(t, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
+			TIFFGetFieldDefaulted(t, TIFFTAG_SAMPLEFORMAT, &sample_format);
+			TIFFGetFieldDefaulted(t, TIFFTAG_PLANARCONFIG, &planar_config);
+			TIFFGetFieldDefaulted(t, TIFFTAG_ORIENTATION, &orientation);
+
+			tiled=layout==tiff_layout_tiles;
+			if(tiled) {
+				TIFFGetField(t, TIFFTAG_TILEWIDTH, &chunk_w);
+				TIFFGetField(t, TIFFTAG_TILELENGTH, &chunk_h);
+				chunk_size=TIFFTileSize(t);
+			} else {
+				chunk_w=w;
+				TIFFGetFieldDefaulted(t, TIFFTAG_ROWSPERSTRIP, &chunk_h);
+				if(chunk_h==0 || chunk_h>h) {
+					chunk_h=h;
+				}
+				chunk_size=TIFFStripSize(t);
+			}
+
+			planes=planar_config==PLANARCONFIG_SEPARATE ? samples_per_pixel : 1;
+			flip=orientation==ORIENTATION_BOTLEFT;
+		}
+
+		virtual ~tiff_band_reader() {
+			for(size_t i=0; i<handles.size(); i++) {
+				TIFFClose(handles[i]);
+			}
+		}
+
+		virtual uint32_t width() const { return w; }
+		virtual uint32_t height() const { return h; }
+		virtual uint32_t depth() const { return samples_per_pixel; }
+
+		virtual void read(ctl::dpx::fb<float> *pixels, uint32_t y) {
+			std::vector<tiff_chunk_t> chunks;
+			tiff_chunk_t chunk;
+			uint32_t first=y;
+			uint32_t last=y+pixels->height();
+
+			// Bottom to top files store the band's rows at the other end.
+			if(flip) {
+				first=h-last;
+				last=h-y;
+			}
+
+			for(chunk.plane=0; chunk.plane<planes; chunk.plane++) {
+				for(chunk.y=first-first%chunk_h; chunk.y<last; chunk.y+=chunk_h) {
+					for(chunk.x=0; chunk.x<w; chunk.x+=chunk_w) {
+						chunks.push_back(chunk);
+					}
+				}
+			}
+
+			unsigned int threads=tiff_threads(chunks.size());
+			while(handles.size()<threads) {
+				TIFF *t=TIFFOpen(name.c_str(), "r");
+				if(t==NULL) {
+					break;
+				}
+				handles.push_back(t);
+			}
+			if(threads>handles.size()) {
+				threads=handles.size();
+			}
+			buffers.resize(threads);
+
+			std::atomic<bool> failed(false);
+			tiff_parallel(threads, chunks.size(),
+			              [&](unsigned int worker, size_t i) {
+				if(!decode(worker, chunks[i], pixels, y, first, last)) {
+					failed=true;
+				}
+			});
+			if(failed) {
+				THROW(Iex::InputExc, "Unable to decode TIFF file " << name << ".");
+			}
+		}
+
+	private:
+		// Decodes chunk and converts its rows in [first, last) (in file
+		// order) into the band that starts at image row y.
+		bool decode(unsigned int worker, const tiff_chunk_t &chunk,
+		            ctl::dpx::fb<float> *pixels, uint32_t y,
+		            uint32_t first, uint32_t last) {
+			TIFF *t=handles[worker];
+			std::vector<uint8_t> &buffer=buffers[worker];
+			tsize_t size;
+
+			buffer.resize(chunk_size);
+			if(tiled) {
+				size=TIFFReadEncodedTile(t, TIFFComputeTile(t, chunk.x, chunk.y,
+				                                            0, chunk.plane),
+				                         &buffer[0], chunk_size);
+			} else {
+				size=TIFFReadEncodedStrip(t, TIFFComputeStrip(t, chunk.y,
+				                                              chunk.plane),
+				                          &buffer[0], chunk_size);
+			}
+			if(size<0) {
+				return false;
+			}
+
+			uint32_t samples=planes==1 ? samples_per_pixel : 1;
+			uint32_t cols=w-chunk.x<chunk_w ? w-chunk.x : chunk_w;
+			size_t line=(size_t)chunk_w*samples*(bits_per_sample/8);
+			uint32_t row=first>chunk.y ? first : chunk.y;
+
+			for(; row<last && row<chunk.y+chunk_h; row++) {
+				uint32_t image_row=flip ? h-1-row : row;
+				float *o=pixels->ptr()+
+				         ((size_t)(image_row-y)*w+chunk.x)*samples_per_pixel+
+				         chunk.plane;
+				tiff_convert_samples(o, planes==1 ? 1 : samples_per_pixel,
+				                     &buffer[0]+(row-chunk.y)*line,
+				                     bits_per_sample, sample_format, scale,
+				                     cols*samples);
+			}
+			return true;
+		}
+
+		std::string name;
+		float scale;
+		std::vector<TIFF *> handles;
+		std::vector<std::vector<uint8_t> > buffers;
+		uint32_t w;
+		uint32_t h;
+		uint16_t samples_per_pixel;
+		uint16_t bits_per_sample;
+		uint16_t sample_format;
+		uint16_t planes;
+		bool tiled;
+		bool flip;
+		uint32_t chunk_w;
+		uint32_t chunk_h;
+		tsize_t chunk_size;
+};
+
+// Strips are written this big (or a single scanline if that is bigger).
+const size_t tiff_strip_bytes=256*1024;
+
+uint16_t tiff_predictor(uint16_t compression, uint16_t bits_per_sample) {
+	if(compression!=COMPRESSION_ADOBE_DEFLATE && compression!=COMPRESSION_LZW) {
+		return PREDICTOR_NONE;
+	}
+	return bits_per_sample==32 ? PREDICTOR_FLOATINGPOINT : PREDICTOR_HORIZONTAL;
+}
+
+// Sets up everything but the size of the strips or tiles.
+void tiff_set_fields(TIFF *t, uint32_t width, uint32_t height, uint32_t depth,
+                     uint16_t bits_per_sample, uint16_t compression) {
+	TIFFSetField(t, TIFFTAG_SAMPLESPERPIXEL, depth);
+	TIFFSetField(t, TIFFTAG_BITSPERSAMPLE, bits_per_sample);
+	TIFFSetField(t, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+	TIFFSetField(t, TIFFTAG_IMAGEWIDTH, width);
+	TIFFSetField(t, TIFFTAG_IMAGELENGTH, height);
+	TIFFSetField(t, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+	TIFFSetField(t, TIFFTAG_SAMPLEFORMAT, bits_per_sample==32 ? 3 : 1);
+	TIFFSetField(t, TIFFTAG_COMPRESSION, compression);
+	if(tiff_predictor(compression, bits_per_sample)!=PREDICTOR_NONE) {
+		TIFFSetField(t, TIFFTAG_PREDICTOR,
+		             tiff_predictor(compression, bits_per_sample));
+	}
+}
+
+// A TIFF in memory, used to run libtiff's encoder on a single strip or
+// tile away from the file being written.
+struct tiff_memory_t {
+	std::vector<uint8_t> data;
+	toff_t pos;
+};
+
+tsize_t tiff_memory_read(thandle_t handle, tdata_t buf, tsize_t size) {
+	tiff_memory_t *memory=(tiff_memory_t *)handle;
+
+	if(memory->pos>=memory->data.size()) {
+		return 0;
+	}
+	if((toff_t)size>memory->data.size()-memory->pos) {
+		size=memory->data.size()-memory->pos;
+	}
+	memcpy(buf, &memory->data[memory->pos], size);
+	memory->pos+=size;
+	return size;
+}
+
+tsize_t tiff_memory_write(thandle_t handle, tdata_t buf, tsize_t size) {
+	tiff_memory_t *memory=(tiff_memory_t *)handle;
+
+	if(memory->pos+size>memory->data.size()) {
+		memory->data.resize(memory->pos+size);
+	}
+	memcpy(&memory->data[memory->pos], buf, size);
+	memory->pos+=size;
+	return size;
+}
+
+toff_t tiff_memory_seek(thandle_t handle, toff_t offset, int whence) {
+	tiff_memory_t *memory=(tiff_memory_t *)handle;
+
+	if(whence==SEEK_CUR) {
+		offset+=memory->pos;
+	} else if(whence==SEEK_END) {
+		offset+=memory->data.size();
+	}
+	memory->pos=offset;
+	return offset;
+}
+
+int tiff_memory_close(thandle_t handle) {
+	return 0;
+}
+
+toff_t tiff_memory_size(thandle_t handle) {
+	return ((tiff_memory_t *)handle)->data.size();
+}
+
+int tiff_memory_map(thandle_t handle, tdata_t *base, toff_t *size) {
+	return 0;
+}
+
+void tiff_memory_unmap(thandle_t handle, tdata_t base, toff_t size) {
+}
+
+// Writes bands as whole strips or tiles. Rows that don't make up a whole
+// strip (or row of tiles) yet are held on to until the next band. The
+// strips are converted and compressed in parallel, and then written out
+// in order as raw data.
+class tiff_band_writer: public band_writer {
+	public:
+		tiff_band_writer(TIFF *_t, float _scale, uint16_t _bits_per_sample,
+		                 uint16_t _compression,
+		                 uint32_t _width, uint32_t _height, uint32_t _depth,
+		                 uint32_t tile_size) :
+			t(_t), scale(_scale), bits_per_sample(_bits_per_sample),
+			compression(_compression),
+			width(_width), height(_height), depth(_depth),
+			held_y(0), held_rows(0) {
+			tiled=tile_size!=0;
+			if(tiled) {
+				chunk_w=tile_size;
+				chunk_h=tile_size;
+				TIFFSetField(t, TIFFTAG_TILEWIDTH, chunk_w);
+				TIFFSetField(t, TIFFTAG_TILELENGTH, chunk_h);
+			} else {
+				size_t line=(size_t)width*depth*(bits_per_sample/8);
+				chunk_w=width;
+				chunk_h=tiff_strip_bytes/line;
+				if(chunk_h==0) {
+					chunk_h=1;
+				}
+				if(chunk_h>height) {
+					chunk_h=height;
+				}
+				TIFFSetField(t, TIFFTAG_ROWSPERSTRIP, chunk_h);
+			}
+		}
+
+		virtual ~tiff_band_writer() {
+			close();
+		}
+
+		// Bands arrive in order, so y is always held_y+held_rows.
+		virtual void write(const ctl::dpx::fb<float> &pixels, uint32_t y) {
+			size_t row=(size_t)width*depth;
+
+			held.resize((held_rows+pixels.height())*row);
+			memcpy(&held[held_rows*row], pixels.ptr(),
+			       sizeof(float)*row*pixels.height());
+			held_rows+=pixels.height();
+
+			uint32_t ready=held_rows-held_rows%chunk_h;
+			if(held_y+held_rows==height) {
+				ready=held_rows;
+			}
+			if(ready==0) {
+				return;
+			}
+
+			encode_rows(ready);
+
+			memmove(&held[0], &held[ready*row],
+			        sizeof(float)*(held_rows-ready)*row);
+			held_rows-=ready;
+			held_y+=ready;
+			held.resize(held_rows*row);
+		}
+
+		virtual void close() {
+			if(t!=NULL) {
+				TIFFClose(t);
+				t=NULL;
+			}
+		}
+
+	private:
+		// Encodes and writes the strips (or rows of tiles) that make up
+		// the first rows held rows.
+		void encode_rows(uint32_t rows) {
+			std::vector<tiff_chunk_t> chunks;
+			tiff_chunk_t chunk;
+
+			chunk.plane=0;
+			for(chunk.y=held_y; chunk.y<held_y+rows; chunk.y+=chunk_h) {
+				for(chunk.x=0; chunk.x<width; chunk.x+=chunk_w) {
+					chunks.push_back(chunk);
+				}
+			}
+
+			unsigned int threads=tiff_threads(chunks.size());
+			buffers.resize(threads);
+			encoded.resize(chunks.size());
+
+			std::atomic<bool> failed(false);
+			tiff_parallel(threads, chunks.size(),
+			              [&](unsigned int worker, size_t i) {
+				if(!encode(chunks[i], &buffers[worker], &encoded[i])) {
+					failed=true;
+				}
+			});
+			if(failed) {
+				THROW(Iex::IoExc, "Unable to compress TIFF data.");
+			}
+
+			for(size_t i=0; i<chunks.size(); i++) {
+				tsize_t size;
+				if(tiled) {
+					size=TIFFWriteRawTile(t, TIFFComputeTile(t, chunks[i].x,
+					                                         chunks[i].y, 0, 0),
+					                      &encoded[i][0], encoded[i].size());
+				} else {
+					size=TIFFWriteRawStrip(t, TIFFComputeStrip(t, chunks[i].y, 0),
+					                       &encoded[i][0], encoded[i].size());
+				}
+				if(size<0) {
+					THROW(Iex::IoExc, "Unable to write TIFF data.");
+				}
+			}
+		}
+
+		// Converts the samples of chunk to the file's bit depth and (when
+		// the file is compressed) runs them through libtiff's encoder in
+		// a TIFF of its own. Tiles at the edges are padded with zeroes.
+		bool encode(const tiff_chunk_t &chunk, std::vector<uint8_t> *buffer,
+		            std::vector<uint8_t> *out) {
+			uint32_t cols=width-chunk.x<chunk_w ? width-chunk.x : chunk_w;
+			uint32_t rows=chunk_h;
+			size_t line=(size_t)chunk_w*depth*(bits_per_sample/8);
+			std::vector<uint8_t> *samples=
+				compression==COMPRESSION_NONE ? out : buffer;
+
+			if(!tiled && height-chunk.y<rows) {
+				rows=height-chunk.y;
+			}
+			samples->assign(line*rows, 0);
+
+			for(uint32_t row=0; row<rows && chunk.y+row<height; row++) {
+				const float *in=&held[((size_t)(chunk.y+row-held_y)*width+
+				                       chunk.x)*depth];
+				uint8_t *data=&(*samples)[0]+row*line;
+
+				if(bits_per_sample==8) {
+					tiff_convert_uint8(data, in, scale, cols*depth);
+				} else if(bits_per_sample==16) {
+					tiff_convert_uint16((uint16_t *)data, in, scale, cols*depth);
+				} else {
+					tiff_convert_float((float *)data, in, scale, cols*depth);
+				}
+			}
+
+			if(compression==COMPRESSION_NONE) {
+				return true;
+			}
+
+			tiff_memory_t memory;
+			memory.pos=0;
+			TIFF *m=TIFFClientOpen("memory", "w", (thandle_t)&memory,
+			                       tiff_memory_read, tiff_memory_write,
+			                       tiff_memory_seek, tiff_memory_close,
+			                       tiff_memory_size,
+			                       tiff_memory_map, tiff_memory_unmap);
+			if(m==NULL) {
+				return false;
+			}
+
+			tiff_set_fields(m, chunk_w, rows, depth, bits_per_sample, compression);
+			tsize_t size;
+			if(tiled) {
+				TIFFSetField(m, TIFFTAG_TILEWIDTH, chunk_w);
+				TIFFSetField(m, TIFFTAG_TILELENGTH, chunk_h);
+				size=TIFFWriteEncodedTile(m, 0, &(*samples)[0], samples->size());
+			} else {
+				TIFFSetField(m, TIFFTAG_ROWSPERSTRIP, rows);
+				size=TIFFWriteEncodedStrip(m, 0, &(*samples)[0], samples->size());
+			}
+
+			uint64_t *offsets=NULL;
+			uint64_t *counts=NULL;
+			bool ok=size>=0 &&
+			        TIFFGetField(m, tiled ? TIFFTAG_TILEOFFSETS : TIFFTAG_STRIPOFFSETS,
+			                     &offsets) &&
+			        TIFFGetField(m, tiled ? TIFFTAG_TILEBYTECOUNTS : TIFFTAG_STRIPBYTECOUNTS,
+			                     &counts) &&
+			        offsets[0]+counts[0]<=memory.data.size();
+			if(ok) {
+				out->assign(memory.data.begin()+offsets[0],
+				            memory.data.begin()+offsets[0]+counts[0]);
+			}
+			TIFFCleanup(m);
+			return ok;
+		}
+
+		TIFF *t;
+		float scale;
+		uint16_t bits_per_sample;
+		uint16_t compression;
+		uint32_t width;
+		uint32_t height;
+		uint32_t depth;
+		bool tiled;
+		uint32_t chunk_w;
+		uint32_t chunk_h;
+		std::vector<float> held;
+		uint32_t held_y;
+		uint32_t held_rows;
+		std::vector<std::vector<uint8_t> > buffers;
+		std::vector<std::vector<uint8_t> > encoded;
+};
+
+}
+
+bool tiff_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
+               format_t *format) {
+	TIFF *t;
+	tiff_layout_t layout;
+
+	TIFFSetErrorHandler(ErrorHandler);
+	TIFFSetWarningHandler(WarningHandler);
+
+	t=TIFFOpen(name, "r");
+	if(t==NULL) {
+		// This is set if the file is not a tiff, we just sort of punt.
+		return FALSE;
+	}
+
+	layout=tiff_layout(t, format);
+	if(layout==tiff_layout_failsafe) {
+		tiff_read_failsafe(t, scale, pixels);
+		TIFFClose(t);
+		return TRUE;
+	}
+
+	tiff_band_reader reader(name, t, scale, layout);
+	pixels->init(reader.width(), reader.height(), reader.depth());
+	reader.read(pixels, 0);
+
+	return TRUE;
+}
+
+band_reader *tiff_open_band_reader(const char *name, float scale,
+                                   format_t *format) {
+	TIFF *t;
+	tiff_layout_t layout;
+
+	TIFFSetErrorHandler(ErrorHandler);
+	TIFFSetWarningHandler(WarningHandler);
+
+	t=TIFFOpen(name, "r");
+	if(t==NULL) {
+		return NULL;
+	}
+
+	layout=tiff_layout(t, format);
+	if(layout==tiff_layout_failsafe) {
+		TIFFClose(t);
+		return NULL;
+	}
+
+	return new tiff_band_reader(name, t, scale, layout);
+}
+
+band_writer *tiff_open_band_writer(const char *name, float scale,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t depth, format_t *format,
+                                   Compression *compression) {
 	TIFF *t;
 	uint16_t bits_per_sample;
-	tdata_t scanline_buffer;
-	uint32_t y;
-	uint8_t channel;
-	const float *row;
 
 	TIFFSetErrorHandler(ErrorHandler);
 	TIFFSetWarningHandler(WarningHandler);
@@ -575,57 +872,54 @@ void tiff_write(const char *name, float scale,
 		      "(integer) or 32 bps (float).");
 	}
 
+	if(tiff_tile_size%16!=0) {
+		THROW(Iex::ArgExc, "TIFF tiles must be a multiple of 16 pixels wide.");
+	}
+
 	t=TIFFOpen(name, "w");
 	if(t==NULL) {
-		// What went wrong
+		THROW(Iex::IoExc, "Unable to open TIFF file " << name << " for writing.");
 	}
 
-	TIFFSetField(t, TIFFTAG_SAMPLESPERPIXEL, pixels.depth());
-	TIFFSetField(t, TIFFTAG_BITSPERSAMPLE, bits_per_sample);
-	TIFFSetField(t, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-	TIFFSetField(t, TIFFTAG_IMAGEWIDTH, pixels.width());
-	TIFFSetField(t, TIFFTAG_IMAGELENGTH, pixels.height());
-	TIFFSetField(t, TIFFTAG_ROWSPERSTRIP, 1);
-	TIFFSetField(t, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-	// Worst case...
-	scanline_buffer=alloca(sizeof(float)*pixels.depth()*pixels.width());
+	tiff_set_fields(t, width, height, depth, bits_per_sample,
+	                compression->tiffCompressionScheme);
 
-	if(bits_per_sample==8) {
-		TIFFSetField(t, TIFFTAG_SAMPLEFORMAT, 1);
-		for(y=0; y<pixels.height(); y++) {
-			row=pixels.ptr()+y*pixels.width()*pixels.depth();
-			tiff_convert_uint8((uint8_t *)scanline_buffer, row,
-			                   scale, pixels.depth()*pixels.width());
-			TIFFWriteScanline(t, scanline_buffer, y, 0);
-		}
-	} else if(bits_per_sample==16) {
-		TIFFSetField(t, TIFFTAG_SAMPLEFORMAT, 1);
-		for(y=0; y<pixels.height(); y++) {
-			row=pixels.ptr()+y*pixels.width()*pixels.depth();
-			tiff_convert_uint16((uint16_t *)scanline_buffer, row,
-			                    scale, pixels.depth()*pixels.width());
-			TIFFWriteScanline(t, scanline_buffer, y, channel);
-		}
-	} else if(bits_per_sample==32) {
-		TIFFSetField(t, TIFFTAG_SAMPLEFORMAT, 3);
-		for(y=0; y<pixels.height(); y++) {
-			row=pixels.ptr()+y*pixels.width()*pixels.depth();
-			tiff_convert_float((float *)scanline_buffer, row,
-			                   scale, pixels.depth()*pixels.width());
-			TIFFWriteScanline(t, scanline_buffer, y, channel);
-		}
-	}
+	return new tiff_band_writer(t, scale, bits_per_sample,
+	                            compression->tiffCompressionScheme,
+	                            width, height, depth, tiff_tile_size);
+}
 
-	TIFFClose(t);
+void tiff_write(const char *name, float scale,
+                const ctl::dpx::fb<float> &pixels,
+                format_t *format, Compression *compression) {
+	std::unique_ptr<band_writer> writer(tiff_open_band_writer(name, scale,
+	                                                          pixels.width(),
+	                                                          pixels.height(),
+	                                                          pixels.depth(),
+	                                                          format,
+	                                                          compression));
+	writer->write(pixels, 0);
+	writer->close();
 }
 
 #else
+band_reader *tiff_open_band_reader(const char *name, float scale,
+                                   format_t *format) {
+	return NULL;
+}
+band_writer *tiff_open_band_writer(const char *name, float scale,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t depth, format_t *format,
+                                   Compression *compression) {
+	return NULL;
+}
 bool tiff_read(const char *name, float scale, ctl::dpx::fb<float> *pixels,
                format_t *bps) {
 	return FALSE;
 }
 void tiff_write(const char *name, float scale,
-                const ctl::dpx::fb<float> &pixels, format_t *format) {
+                const ctl::dpx::fb<float> &pixels, format_t *format,
+                Compression *compression) {
 	// thow tiff is unsupported message.
 }
 #endif
@@ -56,6 +56,7 @@
 #define CTL_UTIL_CTLRENDER_TIFF_INCLUDE
 
 #include "main.hh"
+#include "band.hh"
 #include <dpx.hh>
 
 bool tiff_read(const char *name, float scale,
@@ -63,6 +64,15 @@ bool tiff_read(const char *name, float scale,
                format_t *format);
 void tiff_write(const char *name, float scale,
                 const ctl::dpx::fb<float> &pixels,
-                format_t *format);
+                format_t *format, Compression *compression);
+
+// Streaming variants of the above. The reader is NULL if name is not a
+// TIFF file, or is one that can only be read as a whole image.
+band_reader *tiff_open_band_reader(const char *name, float scale,
+                                   format_t *format);
+band_writer *tiff_open_band_writer(const char *name, float scale,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t depth, format_t *format,
+                                   Compression *compression);
 
 #endif
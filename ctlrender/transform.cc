@@ -57,14 +57,21 @@
 #include "tiff_file.hh"
 #include "exr_file.hh"
 #include "aces_file.hh"
+#include "band.hh"
 #include <dpx.hh>
 #include <CtlRcPtr.h>
 #include <CtlFunctionCall.h>
 #include <CtlSimdInterpreter.h>
+#include <CtlCodeNativeInterpreter.h>
 #include <CtlStdType.h>
 #include <exception>
+#include <string>
+#include <map>
+#include <memory>
+#include <vector>
 #include <Iex.h>
 #include <string.h>
+#include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -72,53 +79,143 @@ class CTLResult;
 typedef Ctl::RcPtr<CTLResult> CTLResultPtr;
 
 // class which holds the data resulting from a CTL transform
+//
+// Varying float data that lives in an image (or scratch) buffer is not
+// copied: pixels points at the first sample and stride is the distance
+// between samples, in floats. data then only carries the name and type
+// and holds no elements. A packet view only holds the samples of the
+// packet that is being processed.
+//
+// Input channels read as half (see band_reader::half_samples) are views
+// the same way, through halfs instead of pixels. scale is then the input
+// scale still to be applied to them (0 for none).
 class CTLResult: public Ctl::RcObject
 {
 public:
 	CTLResult();
 	virtual ~CTLResult();
 
+	float *at(size_t offset) const
+	{
+		return pixels + (packet ? 0 : offset) * stride;
+	}
+
 	Ctl::TypeStoragePtr data;
 	bool external;
 	std::string alt_name;
+	float *pixels;
+	half *halfs;
+	float scale;
+	size_t stride;
+	bool packet;
 };
 
 CTLResult::CTLResult() :
 		Ctl::RcObject()
 {
 	external = FALSE;
+	pixels = NULL;
+	halfs = NULL;
+	scale = 0.0;
+	stride = 0;
+	packet = FALSE;
 }
 
 CTLResult::~CTLResult()
 {
 }
 
-typedef std::list<CTLResultPtr> CTLResults;
+typedef std::vector<CTLResultPtr> CTLResults;
+
+class CTLScript;
+typedef Ctl::RcPtr<CTLScript> CTLScriptPtr;
+
+// A loaded CTL script and the function call used to run it. These are
+// created once per transform() so that streaming the image in bands does
+// not reload (or recompile, with -jit) the script for every band.
+class CTLScript: public Ctl::RcObject
+{
+public:
+	std::shared_ptr<Ctl::SimdInterpreter> interpreter;
+	Ctl::FunctionCallPtr fn;
+
+	// Varying float outputs that don't go straight into the output image
+	// are written here, one packet at a time and one channel per output.
+	ctl::dpx::fb<float> scratch;
+
+	// inputs[i] is the index of the result input argument i reads from
+	// (-1 for its default value). These are looked up in resolved_inputs
+	// (shared by every image the script runs on) or resolved by name on
+	// the first band, and reused from then on. outputs[i] is the result
+	// output argument i is written to, set up for every band by
+	// bind_ctl_outputs.
+	std::vector<int> inputs;
+	bool inputs_resolved;
+	std::map<std::string, std::vector<int> > *resolved_inputs;
+	CTLResults outputs;
+
+	CTLScript() : inputs_resolved(false), resolved_inputs(NULL) {}
+};
 
+typedef std::list<CTLScriptPtr> CTLScripts;
+
+// Scripts that have already been loaded, by file name. transform() runs
+// once per image; an image after the first shares the interpreter of the
+// earlier load and gets a clone of its function call, which has its own
+// argument registers but skips the function lookup.
+//
+// inputs holds the input bindings (see CTLScript::inputs) resolved so far,
+// by the layout of the results the script reads (see ctl_results_layout).
+// Images with the same channels and parameters share them.
+struct LoadedCTLScript
+{
+	std::shared_ptr<Ctl::SimdInterpreter> interpreter;
+	Ctl::FunctionCallPtr fn;
+	std::map<std::string, std::vector<int> > inputs;
+};
+
+typedef std::map<std::string, LoadedCTLScript> LoadedCTLScripts;
+
+static LoadedCTLScripts &loaded_ctl_scripts()
+{
+	// Deliberately never destroyed, so that the interpreters are not torn
+	// down after the CTL library's own static data at exit.
+	static LoadedCTLScripts *scripts = new LoadedCTLScripts;
+	return *scripts;
+}
+
+
+// Returns the index of the result an input argument called name reads
+// from, or -1 if there is none.
+int find_ctl_result(const CTLResults &ctl_results, const std::string &name)
+{
+	for (size_t i = 0; i < ctl_results.size(); i++)
+	{
+		if (ctl_results[i]->data->name() == name || ctl_results[i]->alt_name == name)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
 
 // This function is used to add to the result list parameters that
 // are specified on the command line. A parameter that has been returned
 // by a CTL function takes precedence
 void add_parameter_value_to_ctl_results(CTLResults *ctl_results, const ctl_parameter_t &ctl_parameter)
 {
-	CTLResults::iterator results_iter;
-	Ctl::ArrayTypePtr array;
 	Ctl::DataTypePtr type;
 	CTLResultPtr ctl_result;
+	int index;
 
-	// lookup a named data element that matches the parameter name.
-	for (results_iter = ctl_results->begin(); results_iter != ctl_results->end(); results_iter++)
-	{
-		if ((*results_iter)->data->name() == ctl_parameter.name)
-		{
-			break;
-		}
-	}
+	// lookup a data element that an input argument with the parameter's
+	// name would read from.
+	index = find_ctl_result(*ctl_results, ctl_parameter.name);
 
-	if (results_iter != ctl_results->end())
+	if (index >= 0)
 	{
 		// result data found
-		ctl_result = *results_iter;
+		ctl_result = (*ctl_results)[index];
 
 		// if result data was set by a CTL function (i.e. external == false), we preserve its value
 		if (!ctl_result->external)
@@ -153,27 +250,56 @@ void add_parameter_value_to_ctl_results(CTLResults *ctl_results, const ctl_param
 			ctl_result->data->set(&(ctl_parameter.value[i]), 0, 0, 1, "%d", i);
 		}
 	}
-	ctl_results->push_back(ctl_result);
 }
 
-void set_ctl_function_argument_from_ctl_results(Ctl::FunctionArgPtr *arg, const CTLResults &ctl_results, size_t offset, size_t count)
+// Feeds a half input channel to dst. Half arguments read the samples in
+// place, anything else gets them converted into its own buffer, with the
+// input scale folded into that conversion.
+void set_ctl_function_argument_half(const Ctl::FunctionArgPtr &dst, const CTLResultPtr &ctl_result, size_t offset, size_t count)
 {
-	CTLResults::const_iterator results_iter;
-	Ctl::TypeStoragePtr src;
-	Ctl::FunctionArgPtr dst;
-
-	dst = *arg;
+	const half *pixels = ctl_result->halfs + offset * ctl_result->stride;
+	size_t stride = ctl_result->stride;
+	float scale = ctl_result->scale;
 
-	for (results_iter = ctl_results.begin(); results_iter != ctl_results.end(); results_iter++)
+	if (!dst->isVarying())
+	{
+		count = 1;
+		if (offset != 0)
+		{
+			return;
+		}
+	}
+	else if (scale == 0.0 || scale == 1.0)
 	{
-		if ((*results_iter)->data->name() == dst->name() || (*results_iter)->alt_name == dst->name())
+		if (dst->type().cast<Ctl::HalfType>().refcount() != 0 &&
+			dst->bind((char *) pixels, sizeof(half) * stride))
 		{
-			break;
+			return;
 		}
 	}
+	dst->unbind();
+
+	if (scale == 0.0 || scale == 1.0)
+	{
+		dst->set(pixels, sizeof(half) * stride, 0, count);
+		return;
+	}
 
-	if (results_iter == ctl_results.end())
+	std::vector<float> scaled(count);
+	for (size_t i = 0; i < count; i++)
 	{
+		scaled[i] = (float) pixels[i * stride] * scale;
+	}
+	dst->set(&scaled[0], sizeof(float), 0, count);
+}
+
+void set_ctl_function_argument(const Ctl::FunctionArgPtr &dst, const CTLResultPtr &ctl_result, size_t offset, size_t count)
+{
+	Ctl::TypeStoragePtr src;
+
+	if (ctl_result.refcount() == 0)
+	{
+		dst->unbind();
 		if (dst->hasDefaultValue())
 		{
 			dst->setDefaultValue();
@@ -186,7 +312,40 @@ void set_ctl_function_argument_from_ctl_results(Ctl::FunctionArgPtr *arg, const
 		return;
 	}
 
-	src = (*results_iter)->data;
+	if (ctl_result->halfs != NULL)
+	{
+		set_ctl_function_argument_half(dst, ctl_result, offset, count);
+		return;
+	}
+
+	if (ctl_result->pixels != NULL)
+	{
+		const float *pixels = ctl_result->at(offset);
+		size_t stride = ctl_result->stride;
+
+		if (!dst->isVarying())
+		{
+			if (offset == 0)
+			{
+				dst->set(pixels, 0, 0, 1);
+			}
+			return;
+		}
+
+		// Float arguments read straight from the image, anything else
+		// gets converted into the argument's own buffer.
+		if (dst->type().cast<Ctl::FloatType>().refcount() != 0 &&
+			dst->bind((char *) pixels, sizeof(float) * stride))
+		{
+			return;
+		}
+		dst->unbind();
+		dst->set(pixels, sizeof(float) * stride, 0, count);
+		return;
+	}
+
+	dst->unbind();
+	src = ctl_result->data;
 	if (!dst->isVarying())
 	{
 		if (offset == 0)
@@ -211,126 +370,28 @@ void set_ctl_function_argument_from_ctl_results(Ctl::FunctionArgPtr *arg, const
 	}
 }
 
-void set_ctl_results_from_ctl_function_argument(CTLResults *ctl_results, const Ctl::FunctionArgPtr &arg, size_t offset, size_t count, size_t total)
+CTLScriptPtr load_ctl_transform(const ctl_operation_t &ctl_operation)
 {
-	CTLResults::iterator results_iter;
-	CTLResultPtr ctl_result;
-
-	for (results_iter = ctl_results->begin(); results_iter != ctl_results->end(); results_iter++)
-	{
-		if ((*results_iter)->data->name() == arg->name())
-		{
-			break;
-		}
-	}
-
-//	fprintf(stderr, "copying %d@%d (total %d) of %s\n", count, offset, total, arg->name().c_str());
-	if (!arg->isVarying())
-	{
-		// For constant return arguments we only do this the first time
-		// through
-		if (offset != 0)
-		{
-			return;
-		}
-		total = 1;
-		count = 1;
-	}
+	CTLScriptPtr script = CTLScriptPtr(new CTLScript());
 
-	// Since the ctl_results list gets rebuilt after the end of ctl_run_transform
-	// we don't have to worry about having this function getting called
-	// twice with the FunctionArgPtr having different types (for a given
-	// output argument name).
-	if (results_iter != ctl_results->end())
+	LoadedCTLScripts::iterator loaded =
+		loaded_ctl_scripts().find(ctl_operation.filename);
+	if (loaded != loaded_ctl_scripts().end())
 	{
-		ctl_result = *results_iter;
-
-		std::string inputName;
-		if (arg->name() == "rOut")
-		{
-			inputName = "rIn";
-		}
-		else if (arg->name() == "gOut")
-		{
-			inputName = "gIn";
-		}
-		else if (arg->name() == "bOut")
-		{
-			inputName = "bIn";
-		}
-		else if (arg->name() == "aOut")
-		{
-			inputName = "aIn";
-		}
-
-		if (!inputName.empty())
-		{
-			for (results_iter = ctl_results->begin(); results_iter != ctl_results->end(); results_iter++)
-			{
-				if ((*results_iter)->data->name() == inputName)
-				{
-					break;
-				}
-			}
-
-			if (results_iter != ctl_results->end())
-			{
-				CTLResultPtr ctl_result_output_to_input;
-				ctl_result_output_to_input = *results_iter;
-				ctl_result_output_to_input->data->copy(arg, 0, offset, count);
-			}
-
-		}
-	}
-	else
-	{
-		ctl_result = CTLResultPtr(new CTLResult());
-		ctl_result->data = new Ctl::DataArg(arg->name(), arg->type(), total);
-		ctl_results->push_back(ctl_result);
-
-		std::string inputName;
-		if (arg->name() == "rOut")
-		{
-			inputName = "rIn";
-		}
-		else if (arg->name() == "gOut")
-		{
-			inputName = "gIn";
-		}
-		else if (arg->name() == "bOut")
-		{
-			inputName = "bIn";
-		}
-		else if (arg->name() == "aOut")
-		{
-			inputName = "aIn";
-		}
-
-		if (!inputName.empty())
-		{
-			CTLResultPtr ctl_result_input;
-
-			ctl_result_input = CTLResultPtr(new CTLResult());
-			ctl_result_input->data = new Ctl::DataArg(inputName, arg->type(), total);
-			ctl_results->push_back(ctl_result_input);
-			ctl_result_input->data->copy(arg, 0, offset, count);
-		}
+		script->interpreter = loaded->second.interpreter;
+		script->fn = loaded->second.fn->clone();
+		script->resolved_inputs = &loaded->second.inputs;
+		return script;
 	}
 
-	ctl_result->data->copy(arg, 0, offset, count);
-}
-
-void run_ctl_transform(const ctl_operation_t &ctl_operation, CTLResults *ctl_results, size_t count)
-{
-	Ctl::SimdInterpreter interpreter;
-	Ctl::FunctionCallPtr fn;
+	script->interpreter.reset(use_jit ? new Ctl::NativeInterpreter : new Ctl::SimdInterpreter);
+	Ctl::SimdInterpreter &interpreter = *script->interpreter;
+	Ctl::FunctionCallPtr &fn = script->fn;
 	Ctl::FunctionArgPtr arg;
-	CTLResults::iterator results_iter;
 	char *name = NULL;
 	char *module;
 	char *slash;
 	char *dot;
-	CTLResults new_ctl_results;
 
 	try
 	{
@@ -393,6 +454,16 @@ void run_ctl_transform(const ctl_operation_t &ctl_operation, CTLResults *ctl_res
 		{
 			fprintf(stderr, "   ctl script file: %s\n", ctl_operation.filename);
 			fprintf(stderr, "     function name: %s\n", fn->name().c_str());
+			if (use_jit)
+			{
+				Ctl::NativeInterpreter &native = static_cast<Ctl::NativeInterpreter &>(interpreter);
+				fprintf(stderr, "       native code: %s\n", native.isNative(fn->name()) ? "yes" : "no");
+				std::string errors = native.buildErrors();
+				if (!errors.empty())
+				{
+					fprintf(stderr, "%s\n", errors.c_str());
+				}
+			}
 
 			for (size_t i = 0; i < fn->numInputArgs(); i++)
 			{
@@ -440,176 +511,618 @@ void run_ctl_transform(const ctl_operation_t &ctl_operation, CTLResults *ctl_res
 			}
 			fprintf(stderr, "\n");
 		}
+	}
+	catch (...)
+	{
+//		if(name!=NULL) {
+//			free(name);
+//		}
+		throw;
+	}
 
-		//	fprintf(stderr, "%d samples to go.\n", count);
+	LoadedCTLScript &cached = loaded_ctl_scripts()[ctl_operation.filename];
+	cached.interpreter = script->interpreter;
+	cached.fn = script->fn;
+	script->resolved_inputs = &cached.inputs;
 
-		size_t offset = 0;
-		while (offset < count)
+	return script;
+}
+
+enum have_channel_e
+{
+	// These need to be in the order that you want them in the file...
+	have_x = 0,
+	have_y = 1,
+	have_z = 2,
+	have_r = 3,
+	have_g = 4,
+	have_b = 5,
+	have_a = 6,
+	have_xout = 8,
+	have_yout = 9,
+	have_zout = 10,
+	have_rout = 11,
+	have_gout = 12,
+	have_bout = 13,
+	have_aout = 14,
+	mask_x = 1 << have_x,
+	mask_y = 1 << have_y,
+	mask_z = 1 << have_z,
+	mask_r = 1 << have_r,
+	mask_g = 1 << have_g,
+	mask_b = 1 << have_b,
+	mask_a = 1 << have_a,
+	mask_xout = 1 << have_xout,
+	mask_yout = 1 << have_yout,
+	mask_zout = 1 << have_zout,
+	mask_rout = 1 << have_rout,
+	mask_gout = 1 << have_gout,
+	mask_bout = 1 << have_bout,
+	mask_aout = 1 << have_aout,
+	have_none = 33,
+};
+
+// These need to be in the order for preferred output formats...
+// The DPX colorimetric is in the top 8 bits
+static const int tests[] =
+{
+		(51 << 24) | (mask_rout | mask_gout | mask_bout | mask_aout), (50 << 24)
+		| (mask_rout | mask_gout | mask_bout), (158 << 24)
+		| (mask_xout | mask_yout | mask_zout | mask_aout), (157 << 24)
+		| (mask_xout | mask_yout | mask_zout), (159 << 24)
+		| (mask_yout | mask_aout), (6 << 24) | (mask_yout), (162 << 24)
+		| (mask_gout | mask_aout), (2 << 24) | (mask_gout), (161 << 24)
+		| (mask_bout | mask_aout), (3 << 24) | (mask_bout), (160 << 24)
+		| (mask_rout | mask_aout), (1 << 24) | (mask_rout), (4 << 24)
+		| (mask_aout),
+
+        (51 << 24) | (mask_r | mask_g | mask_b | mask_a), (50 << 24)
+		| (mask_r | mask_g | mask_b), (158 << 24)
+		| (mask_x | mask_y | mask_z | mask_a), (159 << 24)
+		| (mask_y | mask_a), (6 << 24) | (mask_y), (162 << 24)
+		| (mask_g | mask_a), (2 << 24) | (mask_g), (161 << 24)
+		| (mask_b | mask_a), (3 << 24) | (mask_b), (160 << 24)
+		| (mask_r | mask_a), (1 << 24) | (mask_r), (4 << 24) | (mask_a),
+
+        0
+};
+
+// Maps a CTL output argument name to the image channel it provides.
+have_channel_e output_channel(const char *channel_name)
+{
+	if (0)
+	{
+	}
+//	else if(!strcasecmp("X", channel_name)) { return have_x; }
+//	else if(!strcasecmp("Y", channel_name)) { return have_y; }
+//	else if(!strcasecmp("Z", channel_name)) { return have_z; }
+//	else if(!strcasecmp("A", channel_name)) { return have_a; }
+//	else if(!strcasecmp("R", channel_name)) { return have_r; }
+//	else if(!strcasecmp("G", channel_name)) { return have_g; }
+//	else if(!strcasecmp("B", channel_name)) { return have_b; }
+//	else if(!strcasecmp("outX", channel_name)) { return have_xout; }
+//	else if(!strcasecmp("outY", channel_name)) { return have_yout; }
+//	else if(!strcasecmp("outZ", channel_name)) { return have_zout; }
+	else if (!strcasecmp("aOut", channel_name))
+	{
+		return have_aout;
+	}
+	else if (!strcasecmp("rOut", channel_name))
+	{
+		return have_rout;
+	}
+	else if (!strcasecmp("gOut", channel_name))
+	{
+		return have_gout;
+	}
+	else if (!strcasecmp("bOut", channel_name))
+	{
+		return have_bout;
+	}
+	return have_none;
+}
+
+// Picks the preferred output layout out of the available channels.
+// Returns the matching tests[] entry, or 0 if there is none.
+int select_output_channels(int channels_mask)
+{
+	for (uint8_t c = 0; tests[c] != 0; c++)
+	{
+		if ((channels_mask & tests[c] & 0x00ffffff) == (tests[c] & 0x00ffffff))
 		{
-			size_t pass = interpreter.maxSamples();
-			if (pass > (count - offset))
-			{
-				pass = (count - offset);
-			}
-//		fprintf(stderr, "at offset %d doing %d samples\n", offset, pass);
-			for (size_t i = 0; i < fn->numInputArgs(); i++)
-			{
-				arg = fn->inputArg(i);
-				set_ctl_function_argument_from_ctl_results(&arg, *ctl_results, offset, pass);
-			}
+			return tests[c];
+		}
+	}
+	return 0;
+}
+
+// Number of channels in a layout returned by select_output_channels, or
+// the position of channel in it.
+uint8_t output_channel_count(int channels_mask, int channel = 24)
+{
+	uint8_t channel_count = 0;
+	for (int c = 0; c < channel; c++)
+	{
+		if (channels_mask & (1 << c))
+		{
+			channel_count++;
+		}
+	}
+	return channel_count;
+}
 
-			fn->callFunction(pass);
+// The layout mkimage() will produce from the output arguments of fn, so
+// the outputs can be written straight into the output image.
+int predict_output_channels(const Ctl::FunctionCallPtr &fn)
+{
+	int channels_mask = 0;
 
-			for (size_t i = 0; i < fn->numOutputArgs(); i++)
+	for (size_t i = 0; i < fn->numOutputArgs(); i++)
+	{
+		const Ctl::FunctionArgPtr &arg = fn->outputArg(i);
+		have_channel_e channel = output_channel(arg->name().c_str());
+
+		if (channel == have_none || !arg->isVarying())
+		{
+			continue;
+		}
+		if (arg->type().cast<Ctl::HalfType>().refcount() == 0
+				&& arg->type().cast<Ctl::FloatType>().refcount() == 0)
+		{
+			continue;
+		}
+		channels_mask = channels_mask | (1 << channel);
+	}
+	return select_output_channels(channels_mask);
+}
+
+// Sets up the results for the outputs of a script before it runs, in
+// script->outputs and at the end of ctl_results. Varying float outputs
+// that are part of the output image layout (output_channels, 0 if there
+// is no output image) point into output_buffer, the other varying float
+// outputs into the script's scratch buffer, which holds a packet of count
+// samples. The output arguments are bound to these for every packet.
+// Anything else is copied into a result of total samples after every
+// packet.
+void bind_ctl_outputs(CTLScript *script, CTLResults *ctl_results, size_t count, size_t total,
+                      ctl::dpx::fb<float> *output_buffer, int output_channels)
+{
+	const Ctl::FunctionCallPtr &fn = script->fn;
+	uint8_t output_count = output_channel_count(output_channels);
+	uint8_t scratch_count = 0;
+
+	script->outputs.assign(fn->numOutputArgs(), CTLResultPtr());
+
+	for (size_t i = 0; i < fn->numOutputArgs(); i++)
+	{
+		const Ctl::FunctionArgPtr &arg = fn->outputArg(i);
+		CTLResultPtr ctl_result = CTLResultPtr(new CTLResult());
+		have_channel_e channel = output_channel(arg->name().c_str());
+
+		if (!arg->isVarying() || arg->type().cast<Ctl::FloatType>().refcount() == 0)
+		{
+			ctl_result->data = new Ctl::DataArg(arg->name(), arg->type(), arg->isVarying() ? total : 1);
+		}
+		else if (channel != have_none && (output_channels & (1 << channel)))
+		{
+			ctl_result->data = new Ctl::DataArg(arg->name(), arg->type(), 0);
+			ctl_result->pixels = output_buffer->ptr() + output_channel_count(output_channels, channel);
+			ctl_result->stride = output_count;
+		}
+		else
+		{
+			ctl_result->data = new Ctl::DataArg(arg->name(), arg->type(), 0);
+			ctl_result->stride = scratch_count++;
+			ctl_result->packet = TRUE;
+		}
+
+		// the outputs of one script are the inputs of the next.
+		if (channel == have_rout)
+		{
+			ctl_result->alt_name = "rIn";
+		}
+		else if (channel == have_gout)
+		{
+			ctl_result->alt_name = "gIn";
+		}
+		else if (channel == have_bout)
+		{
+			ctl_result->alt_name = "bIn";
+		}
+		else if (channel == have_aout)
+		{
+			ctl_result->alt_name = "aIn";
+		}
+
+		script->outputs[i] = ctl_result;
+		ctl_results->push_back(ctl_result);
+	}
+
+	if (scratch_count > 0 &&
+		(script->scratch.width() != count || script->scratch.depth() != scratch_count))
+	{
+		script->scratch.init(count, 1, scratch_count);
+	}
+
+	for (size_t i = 0; i < fn->numOutputArgs(); i++)
+	{
+		CTLResultPtr ctl_result = script->outputs[i];
+		if (ctl_result->packet)
+		{
+			ctl_result->pixels = script->scratch.ptr() + ctl_result->stride;
+			ctl_result->stride = scratch_count;
+		}
+	}
+}
+
+// The names of ctl_results in order, which is all that resolving the input
+// arguments of a script against them depends on.
+std::string ctl_results_layout(const CTLResults &ctl_results)
+{
+	std::string layout;
+
+	for (size_t i = 0; i < ctl_results.size(); i++)
+	{
+		layout += ctl_results[i]->data->name();
+		layout += '\0';
+		layout += ctl_results[i]->alt_name;
+		layout += '\0';
+	}
+	return layout;
+}
+
+// Resolves the results the input arguments of a script read from (see
+// CTLScript::inputs), or reuses what an earlier image with the same
+// layout of results resolved.
+void resolve_ctl_inputs(CTLScript *script, const CTLResults &ctl_results)
+{
+	const Ctl::FunctionCallPtr &fn = script->fn;
+	std::vector<int> *resolved = NULL;
+
+	if (script->resolved_inputs != NULL)
+	{
+		std::string layout = ctl_results_layout(ctl_results);
+		std::map<std::string, std::vector<int> >::iterator found = script->resolved_inputs->find(layout);
+
+		if (found != script->resolved_inputs->end())
+		{
+			script->inputs = found->second;
+			script->inputs_resolved = TRUE;
+			return;
+		}
+		resolved = &(*script->resolved_inputs)[layout];
+	}
+
+	script->inputs.resize(fn->numInputArgs());
+	for (size_t i = 0; i < fn->numInputArgs(); i++)
+	{
+		script->inputs[i] = find_ctl_result(ctl_results, fn->inputArg(i)->name());
+	}
+	script->inputs_resolved = TRUE;
+
+	if (resolved != NULL)
+	{
+		*resolved = script->inputs;
+	}
+}
+
+// Runs one packet of pass samples at offset through script. The inputs
+// come from ctl_results.
+void run_ctl_packet(CTLScript *script, const CTLResults &ctl_results, size_t offset, size_t pass)
+{
+	const Ctl::FunctionCallPtr &fn = script->fn;
+	Ctl::FunctionArgPtr arg;
+
+	for (size_t i = 0; i < fn->numInputArgs(); i++)
+	{
+		int index = script->inputs[i];
+		set_ctl_function_argument(fn->inputArg(i), index < 0 ? CTLResultPtr() : ctl_results[index], offset, pass);
+	}
+
+	for (size_t i = 0; i < fn->numOutputArgs(); i++)
+	{
+		const CTLResultPtr &ctl_result = script->outputs[i];
+		arg = fn->outputArg(i);
+		if (ctl_result->pixels != NULL)
+		{
+			arg->bind((char *) ctl_result->at(offset), sizeof(float) * ctl_result->stride);
+		}
+		else
+		{
+			arg->unbind();
+		}
+	}
+
+	fn->callFunction(pass);
+
+	for (size_t i = 0; i < fn->numOutputArgs(); i++)
+	{
+		const CTLResultPtr &ctl_result = script->outputs[i];
+		arg = fn->outputArg(i);
+		if (ctl_result->pixels != NULL)
+		{
+			continue;
+		}
+		// For constant return arguments we only do this the first time
+		// through
+		if (!arg->isVarying())
+		{
+			if (offset == 0)
 			{
-				//printf("setting results from function argument\n");
-				set_ctl_results_from_ctl_function_argument(&new_ctl_results, fn->outputArg(i), offset, pass, count);
+				ctl_result->data->copy(arg, 0, 0, 1);
 			}
+			continue;
+		}
+		ctl_result->data->copy(arg, 0, offset, pass);
+	}
+}
+
+// Runs the scripts over count samples of ctl_results. Rather than running
+// each script over all the samples in turn, every packet goes through the
+// whole chain while it is still in cache. The float outputs of a script
+// are bound to a packet sized buffer that the next script reads in place,
+// so only the first script reads and the last one writes image memory.
+// When output_channels is not 0 the outputs of the last script that make
+// up the output image go straight into output_buffer.
+void run_ctl_transforms(const CTLScripts &ctl_scripts, const CTLOperations &ctl_operations,
+                        const CTLParameters &global_parameters, CTLResults *ctl_results, size_t count,
+                        ctl::dpx::fb<float> *output_buffer, int output_channels)
+{
+	CTLScripts::const_iterator scripts_iter;
+	CTLOperations::const_iterator operations_iter;
+	CTLParameters::const_iterator parameters_iter;
+	size_t stages = ctl_scripts.size();
+	size_t packet = 0;
+	size_t k;
+
+	if (stages == 0)
+	{
+		return;
+	}
 
-			offset = offset + pass;
+	for (scripts_iter = ctl_scripts.begin(); scripts_iter != ctl_scripts.end(); scripts_iter++)
+	{
+		if (packet == 0 || (*scripts_iter)->interpreter->maxSamples() < packet)
+		{
+			packet = (*scripts_iter)->interpreter->maxSamples();
 		}
-		*ctl_results = new_ctl_results;
 	}
-	catch (...)
+
+	// results[k] are the inputs of script k, results[stages] the
+	// outputs of the last one.
+	std::vector<CTLResults> results(stages + 1);
+	results[0] = *ctl_results;
+
+	scripts_iter = ctl_scripts.begin();
+	operations_iter = ctl_operations.begin();
+	for (k = 0; k < stages; k++, scripts_iter++, operations_iter++)
 	{
-//		if(name!=NULL) {
-//			free(name);
-//		}
-		throw;
+		CTLScript *script = scripts_iter->pointer();
+
+		for (parameters_iter = global_parameters.begin(); parameters_iter != global_parameters.end(); parameters_iter++)
+		{
+			add_parameter_value_to_ctl_results(&results[k], *parameters_iter);
+		}
+		for (parameters_iter = operations_iter->local.begin(); parameters_iter != operations_iter->local.end(); parameters_iter++)
+		{
+			add_parameter_value_to_ctl_results(&results[k], *parameters_iter);
+		}
+
+		if (!script->inputs_resolved)
+		{
+			resolve_ctl_inputs(script, results[k]);
+		}
+
+		if (k + 1 == stages)
+		{
+			bind_ctl_outputs(script, &results[k + 1], packet, count, output_buffer, output_channels);
+		}
+		else
+		{
+			bind_ctl_outputs(script, &results[k + 1], packet, count, NULL, 0);
+		}
 	}
+
+	//	fprintf(stderr, "%d samples to go.\n", count);
+
+	size_t offset = 0;
+	while (offset < count)
+	{
+		size_t pass = packet;
+		if (pass > (count - offset))
+		{
+			pass = (count - offset);
+		}
+//		fprintf(stderr, "at offset %d doing %d samples\n", offset, pass);
+		scripts_iter = ctl_scripts.begin();
+		for (k = 0; k < stages; k++, scripts_iter++)
+		{
+			run_ctl_packet(scripts_iter->pointer(), results[k], offset, pass);
+		}
+
+		offset = offset + pass;
+	}
+	*ctl_results = results[stages];
 }
 
 
 // Creates a new ctl result object from the image buffer (fb parameter) passed in
-// Copies a new CTL result (block of data) from the framebuffer fb.
-CTLResultPtr mkresult(const char *name, const char *alt_name, const ctl::dpx::fb<float> &fb, size_t offset)
+// The result is a view of channel offset of the framebuffer fb, nothing is copied.
+CTLResultPtr mkresult(const char *name, const char *alt_name, ctl::dpx::fb<float> &fb, size_t offset)
 {
 	CTLResultPtr new_result = CTLResultPtr(new CTLResult());
 
-	// DataArg represents a raw block of data
-	// XXX - seems like last argument to Ctl::DataArg should be (fb.pixels() + offset) because the argument represents the data size (i.e. number of bytes)
-	new_result->data = Ctl::DataArgPtr(new Ctl::DataArg(name, Ctl::DataTypePtr(new Ctl::StdFloatType()), fb.pixels()));
+	new_result->data = Ctl::DataArgPtr(new Ctl::DataArg(name, Ctl::DataTypePtr(new Ctl::StdFloatType()), 0));
 
 	if (alt_name != NULL)
 	{
 		new_result->alt_name = alt_name;
 	}
 
-	new_result->data->set(fb.ptr() + offset, sizeof(float) * fb.depth(), 0, fb.pixels());
+	new_result->pixels = fb.ptr() + offset;
+	new_result->stride = fb.depth();
 
 	return new_result;
 }
 
-void mkimage(ctl::dpx::fb<float> *image_buffer, const CTLResults &ctl_results, format_t *image_format)
+// Same as above for a channel of a band read as half samples, scale is
+// the input scale still to be applied to them.
+CTLResultPtr mkresult_half(const char *name, const char *alt_name, ctl::dpx::fb<half> &fb, size_t offset, float scale)
 {
-	enum have_channel_e
-	{
-		// These need to be in the order that you want them in the file...
-		have_x = 0,
-		have_y = 1,
-		have_z = 2,
-		have_r = 3,
-		have_g = 4,
-		have_b = 5,
-		have_a = 6,
-		have_xout = 8,
-		have_yout = 9,
-		have_zout = 10,
-		have_rout = 11,
-		have_gout = 12,
-		have_bout = 13,
-		have_aout = 14,
-		mask_x = 1 << have_x,
-		mask_y = 1 << have_y,
-		mask_z = 1 << have_z,
-		mask_r = 1 << have_r,
-		mask_g = 1 << have_g,
-		mask_b = 1 << have_b,
-		mask_a = 1 << have_a,
-		mask_xout = 1 << have_xout,
-		mask_yout = 1 << have_yout,
-		mask_zout = 1 << have_zout,
-		mask_rout = 1 << have_rout,
-		mask_gout = 1 << have_gout,
-		mask_bout = 1 << have_bout,
-		mask_aout = 1 << have_aout,
-		have_none = 33,
-	};
+	CTLResultPtr new_result = CTLResultPtr(new CTLResult());
+
+	new_result->data = Ctl::DataArgPtr(new Ctl::DataArg(name, Ctl::DataTypePtr(new Ctl::StdHalfType()), 0));
+
+	if (alt_name != NULL)
+	{
+		new_result->alt_name = alt_name;
+	}
+
+	new_result->halfs = fb.ptr() + offset;
+	new_result->stride = fb.depth();
+	new_result->scale = scale;
 
+	return new_result;
+}
+
+static const char *input_channel_names[] = { "rIn", "gIn", "bIn", "aIn" };
+
+// A channel of the input image as the first script sees it. Channels are
+// read by name (rIn, gIn, bIn and aIn for the first four, the file's own
+// channel name followed by In for any other named channel) and by position
+// in the file (c00In, c01In...).
+struct input_channel_t
+{
+	std::string name;
+	std::string alt_name;
+};
+
+// Turns an EXR channel name such as "diffuse.R" into something a CTL
+// argument can be called ("diffuse_R").
+std::string ctl_identifier(const std::string &channel_name)
+{
+	std::string identifier;
+
+	for (size_t i = 0; i < channel_name.size(); i++)
+	{
+		char c = channel_name[i];
+		if (isalnum((unsigned char) c) || c == '_')
+		{
+			identifier += c;
+		}
+		else
+		{
+			identifier += '_';
+		}
+	}
+	if (identifier.empty() || isdigit((unsigned char) identifier[0]))
+	{
+		identifier = "_" + identifier;
+	}
+	return identifier;
+}
+
+// Lists every channel reader can provide, in file order.
+std::vector<input_channel_t> input_channels(const band_reader *reader)
+{
+	std::vector<std::string> channel_names = reader->channel_names();
+	uint32_t count = channel_names.empty() ? reader->depth() : channel_names.size();
+	std::vector<input_channel_t> channels(count);
+	char cname[16];
+
+	for (uint32_t c = 0; c < count; c++)
+	{
+		snprintf(cname, sizeof(cname), "c%02dIn", c);
+		if (c < 4)
+		{
+			channels[c].name = input_channel_names[c];
+			channels[c].alt_name = cname;
+		}
+		else if (!channel_names.empty())
+		{
+			channels[c].name = ctl_identifier(channel_names[c]) + "In";
+			channels[c].alt_name = cname;
+		}
+		else
+		{
+			channels[c].name = cname;
+		}
+	}
+	return channels;
+}
+
+// True if fn has an input argument that reads channel.
+bool reads_input_channel(const Ctl::FunctionCallPtr &fn, const input_channel_t &channel)
+{
+	for (size_t i = 0; i < fn->numInputArgs(); i++)
+	{
+		const std::string &name = fn->inputArg(i)->name();
+		if (name == channel.name || (!channel.alt_name.empty() && name == channel.alt_name))
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// True if every varying argument of fn that reads the input image is a
+// half, so half samples can be bound to them as they are read rather than
+// being widened to float and narrowed back.
+bool wants_half_input(const Ctl::FunctionCallPtr &fn, const std::vector<input_channel_t> &channels)
+{
+	bool found = FALSE;
+
+	for (size_t i = 0; i < fn->numInputArgs(); i++)
+	{
+		const Ctl::FunctionArgPtr &arg = fn->inputArg(i);
+		bool reads_input = FALSE;
+
+		for (size_t c = 0; c < channels.size(); c++)
+		{
+			if (arg->name() == channels[c].name || arg->name() == channels[c].alt_name)
+			{
+				reads_input = TRUE;
+				break;
+			}
+		}
+		if (!arg->isVarying() || !reads_input)
+		{
+			continue;
+		}
+		if (arg->type().cast<Ctl::HalfType>().refcount() == 0)
+		{
+			return FALSE;
+		}
+		found = TRUE;
+	}
+	return found;
+}
+
+void mkimage(ctl::dpx::fb<float> *image_buffer, const CTLResults &ctl_results, format_t *image_format)
+{
 	CTLResults::const_iterator results_iter;
 	CTLResultPtr channels[16];
 	int channels_mask;
 	have_channel_e channel;
-	const char *channel_name;
 	uint8_t on_channel;
 	uint8_t channel_count;
 	uint8_t c;
 	CTLResultPtr ctl_result;
 
-	// These need to be in the order for preferred output formats...
-	// The DPX colorimetric is in the top 8 bits
-	int tests[] =
-	{
-			(51 << 24) | (mask_rout | mask_gout | mask_bout | mask_aout), (50 << 24)
-			| (mask_rout | mask_gout | mask_bout), (158 << 24)
-			| (mask_xout | mask_yout | mask_zout | mask_aout), (157 << 24)
-			| (mask_xout | mask_yout | mask_zout), (159 << 24)
-			| (mask_yout | mask_aout), (6 << 24) | (mask_yout), (162 << 24)
-			| (mask_gout | mask_aout), (2 << 24) | (mask_gout), (161 << 24)
-			| (mask_bout | mask_aout), (3 << 24) | (mask_bout), (160 << 24)
-			| (mask_rout | mask_aout), (1 << 24) | (mask_rout), (4 << 24)
-			| (mask_aout),
-
-	        (51 << 24) | (mask_r | mask_g | mask_b | mask_a), (50 << 24)
-			| (mask_r | mask_g | mask_b), (158 << 24)
-			| (mask_x | mask_y | mask_z | mask_a), (159 << 24)
-			| (mask_y | mask_a), (6 << 24) | (mask_y), (162 << 24)
-			| (mask_g | mask_a), (2 << 24) | (mask_g), (161 << 24)
-			| (mask_b | mask_a), (3 << 24) | (mask_b), (160 << 24)
-			| (mask_r | mask_a), (1 << 24) | (mask_r), (4 << 24) | (mask_a),
-
-	        0
-	};
-
 	channels_mask = 0;
 	for (results_iter = ctl_results.begin(); results_iter != ctl_results.end(); results_iter++)
 	{
 		ctl_result = *results_iter;
-		if (!ctl_result->data->isVarying() && ctl_result->data->elements() != image_buffer->pixels())
+		if (ctl_result->pixels == NULL && !ctl_result->data->isVarying() &&
+			ctl_result->data->elements() != image_buffer->pixels())
 		{
 			continue;
 		}
-		channel = have_none;
-		channel_name = ctl_result->data->name().c_str();
-		if (0)
+		if (ctl_result->packet)
 		{
+			continue;
 		}
-//		else if(!strcasecmp("X", channel_name)) { channel=have_x; } 
-//		else if(!strcasecmp("Y", channel_name)) { channel=have_y; } 
-//		else if(!strcasecmp("Z", channel_name)) { channel=have_z; } 
-//		else if(!strcasecmp("A", channel_name)) { channel=have_a; } 
-//		else if(!strcasecmp("R", channel_name)) { channel=have_r; } 
-//		else if(!strcasecmp("G", channel_name)) { channel=have_g; } 
-//		else if(!strcasecmp("B", channel_name)) { channel=have_b; } 
-//		else if(!strcasecmp("outX", channel_name)) { channel=have_xout; } 
-//		else if(!strcasecmp("outY", channel_name)) { channel=have_yout; } 
-//		else if(!strcasecmp("outZ", channel_name)) { channel=have_zout; } 
-		else if (!strcasecmp("aOut", channel_name))
-		{
-			channel = have_aout;
-		}
-		else if (!strcasecmp("rOut", channel_name))
-		{
-			channel = have_rout;
-		}
-		else if (!strcasecmp("gOut", channel_name))
-		{
-			channel = have_gout;
-		}
-		else if (!strcasecmp("bOut", channel_name))
-		{
-			channel = have_bout;
-		}
+		channel = output_channel(ctl_result->data->name().c_str());
 
 		if (channel == have_none)
 		{
@@ -625,32 +1138,22 @@ void mkimage(ctl::dpx::fb<float> *image_buffer, const CTLResults &ctl_results, f
 		channels_mask = channels_mask | (1 << channel);
 	}
 
-	for (c = 0; tests[c] != 0; c++)
-	{
-		if ((channels_mask & tests[c] & 0x00ffffff) == (tests[c] & 0x00ffffff))
-		{
-			channels_mask = tests[c];
-			break;
-		}
-	}
-
-	if (tests[c] == 0)
+	channels_mask = select_output_channels(channels_mask);
+	if (channels_mask == 0)
 	{
 		THROW(Iex::ArgExc, "Unable to determine what channels from the CTL script output should be saved.");
 	}
 
-	channel_count = 0;
-	for (c = 0; c < 24; c++)
-	{
-		if (channels_mask & (1 << c))
-		{
-			channel_count++;
-		}
-	}
+	channel_count = output_channel_count(channels_mask);
 
+	// Views may point into image_buffer itself, so a buffer of a different
+	// shape is assembled on the side first.
+	std::vector<float> reshaped;
+	float *pixels = image_buffer->ptr();
 	if (image_buffer->depth() != channel_count)
 	{
-		image_buffer->init(image_buffer->width(), image_buffer->height(), channel_count);
+		reshaped.resize(image_buffer->pixels() * channel_count);
+		pixels = &reshaped[0];
 	}
 
 	on_channel = 0;
@@ -658,11 +1161,32 @@ void mkimage(ctl::dpx::fb<float> *image_buffer, const CTLResults &ctl_results, f
 	{
 		if (channels_mask & (1 << c))
 		{
-			channels[c]->data->get(image_buffer->ptr() + on_channel, sizeof(float) * channel_count, 0, image_buffer->pixels());
+			ctl_result = channels[c];
+			if (ctl_result->pixels == NULL)
+			{
+				ctl_result->data->get(pixels + on_channel, sizeof(float) * channel_count, 0, image_buffer->pixels());
+			}
+			else if (ctl_result->pixels != pixels + on_channel || ctl_result->stride != channel_count)
+			{
+				const float *in = ctl_result->pixels;
+				float *out = pixels + on_channel;
+				for (uint64_t p = 0; p < image_buffer->pixels(); p++)
+				{
+					*out = *in;
+					in = in + ctl_result->stride;
+					out = out + channel_count;
+				}
+			}
 			on_channel++;
 		}
 	}
 
+	if (!reshaped.empty())
+	{
+		image_buffer->init(image_buffer->width(), image_buffer->height(), channel_count);
+		memcpy(image_buffer->ptr(), &reshaped[0], sizeof(float) * reshaped.size());
+	}
+
 	if (image_format->descriptor == 0)
 	{
 		image_format->descriptor = (channels_mask & 0xff000000) >> 24;
@@ -686,6 +1210,7 @@ void transform(const char *inputFile, const char *outputFile,
 	CTLParameters::const_iterator parameters_iter;
 	uint8_t i;
 	std::string error;
+	ctl::dpx::fb<float> input_buffer;
 	ctl::dpx::fb<float> image_buffer;
 
 	if (verbosity > 1)
@@ -755,9 +1280,8 @@ void transform(const char *inputFile, const char *outputFile,
 		fprintf(stderr, "\n");
 	}
 
-	if (!dpx_read(inputFile, input_scale, &image_buffer, image_format) &&
-		!exr_read(inputFile, input_scale, &image_buffer, image_format) &&
-		!tiff_read(inputFile, input_scale, &image_buffer, image_format))
+	std::unique_ptr<band_reader> reader(open_band_reader(inputFile, input_scale, image_format));
+	if (reader.get() == NULL)
 	{
 		fprintf(stderr, "unable to read file %s (unknown format).\n", inputFile);
 		exit(1);
@@ -772,87 +1296,136 @@ void transform(const char *inputFile, const char *outputFile,
 		image_format->bps = image_format->src_bps;
 	}
 
-	CTLResults ctl_results;
-
-	if (image_buffer.depth() > 0)
-	{
-		ctl_results.push_back(mkresult("rIn", "c00In", image_buffer, 0));
-	}
-	if (image_buffer.depth() > 1)
+	CTLScripts ctl_scripts;
+	for (operations_iter = ctl_operations.begin(); operations_iter != ctl_operations.end(); operations_iter++)
 	{
-		ctl_results.push_back(mkresult("gIn", "c01In", image_buffer, 1));
+		ctl_scripts.push_back(load_ctl_transform(*operations_iter));
 	}
-	if (image_buffer.depth() > 2)
+
+	// The last script writes its image outputs straight into image_buffer
+	int output_channels = 0;
+	if (!ctl_scripts.empty())
 	{
-		ctl_results.push_back(mkresult("bIn", "c02In", image_buffer, 2));
+		output_channels = predict_output_channels(ctl_scripts.back()->fn);
 	}
-	if (image_buffer.depth() > 3)
+
+	// Formats with named channels (EXR) only decode the channels the first
+	// script reads, whatever layers they come from. Without scripts the
+	// image is copied through as RGBA.
+	std::vector<input_channel_t> channels = input_channels(reader.get());
+	if (!ctl_scripts.empty() && !reader->channel_names().empty())
 	{
-		ctl_results.push_back(mkresult("aIn", "c03In", image_buffer, 3));
+		std::vector<input_channel_t> read_channels;
+		std::vector<size_t> selected;
+
+		for (size_t c = 0; c < channels.size(); c++)
+		{
+			if (reads_input_channel(ctl_scripts.front()->fn, channels[c]))
+			{
+				read_channels.push_back(channels[c]);
+				selected.push_back(c);
+			}
+		}
+		reader->select_channels(selected);
+		channels = read_channels;
 	}
 
-	char name[16];
+	// Half samples (EXR) are only kept as they are if the first script
+	// takes them as halfs.
+	bool half_input = !ctl_scripts.empty() && reader->half_samples() &&
+	                  wants_half_input(ctl_scripts.front()->fn, channels);
+	ctl::dpx::fb<half> input_halfs;
 
-	for (i = 4; i < image_buffer.depth(); i++)
+	uint32_t rows = band_rows;
+	if (rows == 0 || rows > reader->height())
 	{
-		memset(name, 0, sizeof(name));
-		snprintf(name, sizeof(name) - 1, "c%02dIn", i);
-		ctl_results.push_back(mkresult(name, NULL, image_buffer, i));
+		rows = reader->height();
 	}
 
-	for (operations_iter = ctl_operations.begin(); operations_iter != ctl_operations.end(); operations_iter++)
+	std::unique_ptr<band_writer> writer;
+
+	for (uint32_t y = 0; y < reader->height(); y = y + rows)
 	{
-		ctl_operation = *operations_iter;
-		for (parameters_iter = global_parameters.begin(); parameters_iter != global_parameters.end(); parameters_iter++)
+		uint32_t band_height = reader->height() - y;
+		if (band_height > rows)
 		{
-			add_parameter_value_to_ctl_results(&ctl_results, *parameters_iter);
+			band_height = rows;
 		}
-		for (parameters_iter = ctl_operation.local.begin(); parameters_iter != ctl_operation.local.end(); parameters_iter++)
+
+		uint32_t depth = reader->depth();
+		size_t count = (size_t) reader->width() * band_height;
+
+		if (half_input)
 		{
-			add_parameter_value_to_ctl_results(&ctl_results, *parameters_iter);
+			if (input_halfs.height() != band_height)
+			{
+				input_halfs.init(reader->width(), band_height, depth);
+			}
+			reader->read_half(&input_halfs, y);
+		}
+		else
+		{
+			if (input_buffer.height() != band_height)
+			{
+				input_buffer.init(reader->width(), band_height, depth);
+			}
+			reader->read(&input_buffer, y);
 		}
 
-		// Output is used to pass output parameters from script to the next.
-		run_ctl_transform(*operations_iter, &ctl_results, image_buffer.pixels());
-	}
+		// The alpha squish reshapes the output buffer, so it is only reused
+		// as is when it still has the layout the scripts write.
+		uint32_t output_depth = output_channels ? output_channel_count(output_channels) : depth;
+		if (image_buffer.height() != band_height || image_buffer.depth() != output_depth)
+		{
+			image_buffer.init(reader->width(), band_height, output_depth);
+		}
 
-	mkimage(&image_buffer, ctl_results, image_format);
+		CTLResults ctl_results;
 
-	if (output_scale != 0.0)
-	{
-		output_scale = output_scale / 1.0;
-	}
-	if (image_format->squish)
-	{
-		image_buffer.swizzle(0, TRUE);
-	}
+		for (size_t c = 0; c < channels.size(); c++)
+		{
+			const char *channel_name = channels[c].name.c_str();
+			const char *alt_name = channels[c].alt_name.empty() ? NULL : channels[c].alt_name.c_str();
 
-//    std::cout << image_format->ext << std::endl;
-  if (!strncmp(image_format->ext, "aces", 3))
-  {
-      aces_write(outputFile, output_scale,
-                 image_buffer.width(), image_buffer.height(), image_buffer.depth(),
-                 image_buffer.ptr(), image_format);
-  }
-  else if (!strncmp(image_format->ext, "exr", 3))
-	{
-		exr_write(outputFile, output_scale, image_buffer, image_format, compression);
-	}
-	else if (!strncmp(image_format->ext, "adx", 3))
-	{
-		dpx_write(outputFile, output_scale, image_buffer, image_format);
-	}
-	else if (!strncmp(image_format->ext, "dpx", 3))
-	{
-		dpx_write(outputFile, output_scale, image_buffer, image_format);
-	}
-	else if (!strncmp(image_format->ext, "tiff", 3))
-	{
-		tiff_write(outputFile, output_scale, image_buffer, image_format);
+			if (half_input)
+			{
+				ctl_results.push_back(mkresult_half(channel_name, alt_name, input_halfs, c, input_scale));
+			}
+			else
+			{
+				ctl_results.push_back(mkresult(channel_name, alt_name, input_buffer, c));
+			}
+		}
+
+		run_ctl_transforms(ctl_scripts, ctl_operations, global_parameters, &ctl_results,
+		                   count, &image_buffer, output_channels);
+
+		mkimage(&image_buffer, ctl_results, image_format);
+
+		if (image_format->squish)
+		{
+			image_buffer.swizzle(0, TRUE);
+		}
+
+		// The output depth (and with it the file layout) is only known once
+		// the first band has been through the scripts.
+		if (writer.get() == NULL)
+		{
+			writer.reset(open_band_writer(outputFile, output_scale,
+			                              reader->width(), reader->height(),
+			                              image_buffer.depth(),
+			                              image_format, compression));
+			if (writer.get() == NULL)
+			{
+				fprintf(stderr, "unable to write a %s file (unknown format).\n", image_format->ext);
+				exit(1);
+			}
+		}
+		writer->write(image_buffer, y);
 	}
-	else
+
+	if (writer.get() != NULL)
 	{
-		fprintf(stderr, "unable to write a %s file (unknown format).\n", image_format->ext);
-		exit(1);
+		writer->close();
 	}
 }
@@ -95,8 +95,9 @@ void usage(const char *section) {
 "                          format. Details on this are provided with\n"
 "                          '-help format'\n"
 "\n"
-"    -compression <type>   Specifies OpenEXR compression type. Value will\n"
-"                          be ignored when not saving an exr file\n"
+"    -compression <type>   Specifies OpenEXR compression type. TIFF files\n"
+"                          are compressed with the closest TIFF scheme,\n"
+"                          other formats ignore it. See\n"
 "                          '-help compression'\n"
 "\n"
 "    -ctl <filename>       Specifies the name of a CTL file to be applied\n"
@@ -108,6 +109,21 @@ void usage(const char *section) {
 "    -param2 ...           Details on this and similar options are provided\n"
 "    -param3 ...           with '-help param'\n"
 "\n"
+"    -jit                  Compiles the CTL scripts to native code with the\n"
+"                          system C++ compiler before running them. Falls\n"
+"                          back to the interpreter when that isn't possible.\n"
+"\n"
+"    -band <rows>          Reads, transforms and writes the image <rows>\n"
+"                          scanlines at a time, so memory use is bounded by\n"
+"                          the band rather than the image. DPX, EXR and\n"
+"                          TIFF input and EXR, TIFF and ACES output are\n"
+"                          streamed a band at a time, other formats are\n"
+"                          buffered whole. The default (0) processes the\n"
+"                          whole image at once.\n"
+"\n"
+"    -tile <size>          Writes TIFF files as <size> by <size> tiles\n"
+"                          (a multiple of 16) rather than strips.\n"
+"\n"
 "    -verbose              Increases the level of output verbosity.\n"
 "    -quiet                Decreases the level of output verbosity.\n"
 "");
@@ -199,6 +215,16 @@ void usage(const char *section) {
 "    OpenEXR support must be enabled for the '-compression' option to be\n"
 "    meaningful. Please see build documentation for details.\n"
 "");
+#endif
+#if defined(HAVE_LIBTIFF)
+        fprintf(stdout, ""
+"\n"
+"tiff compression:\n"
+"\n"
+"    TIFF files are compressed with ZIP (deflate) for ZIP and ZIPS, and\n"
+"    with PackBits for RLE. Any other scheme, including the default, writes\n"
+"    uncompressed TIFF files.\n"
+"");
 #endif
 	} else if(!strncmp(section, "ctl", 1)) {
 		fprintf(stdout, ""
@@ -207,6 +233,13 @@ void usage(const char *section) {
 "    'B', and 'A' (optional) channels, and produce output as 'R', 'G', and\n"
 "    'B', and 'A' (if required) channels. In the event of a single channel\n"
 "    input file only the 'G' channel will be used.\n"
+"\n"
+"    The input channels are also available by position as 'c00In', 'c01In'\n"
+"    and so on. Any other channel of an OpenEXR file, in any layer, can be\n"
+"    read by naming an input argument after it with every character that\n"
+"    is not a letter, digit or '_' replaced by '_' and 'In' appended\n"
+"    ('diffuse.R' is read as 'diffuse_RIn', 'Z' as 'ZIn'). Only the\n"
+"    channels the first ctl file reads are decoded.\n"
 "");
 //"    The *LAST* function in the file is the function that will be called to\n"
 //"    provide the transform. This is to maintain compatability with scripts\n"
@@ -0,0 +1,911 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A world-wide, royalty-free, non-exclusive right to distribute, copy,
+// modify, create derivatives, and use, in source and binary forms, is
+// hereby granted, subject to acceptance of this license. Performance of
+// any of the aforementioned acts indicates acceptance to be bound by the
+// following terms and conditions:
+// 
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty.
+// 
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty
+//     in the documentation and/or other materials provided with the
+//     distribution.
+// 
+//   * Nothing in this license shall be deemed to grant any rights to
+//     trademarks, copyrights, patents, trade secrets or any other
+//     intellectual property of A.M.P.A.S. or any contributors, except
+//     as expressly stated herein, and neither the name of A.M.P.A.S.
+//     nor of any other contributors to this software, may be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission of A.M.P.A.S. or contributor,
+//     as appropriate.
+// 
+// This license shall be governed by the laws of the State of California,
+// and subject to the jurisdiction of the courts therein.
+// 
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO
+// EVENT SHALL A.M.P.A.S., ANY CONTRIBUTORS OR DISTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+// IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "CtlCodeC99Language.h"
+#include "CtlCodeLContext.h"
+#include "CtlCodeType.h"
+#include <CtlSymbolTable.h>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace Ctl
+{
+
+C99Generator::C99Generator( void )
+		: CCommonLanguage()
+{
+}
+
+
+////////////////////////////////////////
+
+
+C99Generator::~C99Generator( void )
+{
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::initStdLibrary( void )
+{
+	CCommonLanguage::initStdLibrary();
+
+	// half is a float in C, see addStandardDefinitions
+	myStdNames["HALF_MAX"] = "65504.0f";
+	myStdNames["HALF_MIN"] = "5.96046448e-08f";
+	myStdNames["HALF_EPSILON"] = "0.00097656f";
+	myStdNames["HALF_POS_INF"] = "HUGE_VALF";
+	myStdNames["HALF_NEG_INF"] = "(-HUGE_VALF)";
+	myStdNames["HALF_NAN"] = "NAN";
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsPrecision( Precision p ) const
+{
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+C99Generator::getBatchEntryPoints( void )
+{
+	std::stringstream batch;
+
+	for ( MainRoutineMap::const_iterator i = myMainRoutines.begin(); i != myMainRoutines.end(); ++i )
+	{
+		const std::string &name = i->first;
+		const std::string &nsName = i->second.first;
+		const SymbolInfoPtr &fnInfo = i->second.second;
+		FunctionTypePtr functionType = fnInfo->functionType();
+		const ParamVector &params = functionType->parameters();
+
+		batch << "\nvoid batch_" << name << "( size_t _count";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( parm.varying )
+			{
+				CDataType_e t = parm.type->cDataType();
+				if ( t != FloatTypeEnum && t != HalfTypeEnum )
+					throw std::logic_error( "Unhandled varying type" );
+				batch << ", " << ( parm.access == RWA_READ ? "const " : "" )
+					  << "ctl_number_t * restrict " << parm.name;
+				continue;
+			}
+
+			switch ( parm.type->cDataType() )
+			{
+				case FloatTypeEnum: batch << ", ctl_number_t " << parm.name; break;
+				case BoolTypeEnum: batch << ", bool " << parm.name; break;
+				default:
+					throw std::logic_error( "Sorry, argument type to main function for argument '" + parm.name + "' not yet handled" );
+			}
+		}
+		batch <<
+			" )\n"
+			"{\n"
+			"#pragma omp simd\n"
+			"    for ( size_t _i = 0; _i < _count; ++_i )\n"
+			"    {\n";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( ! parm.varying )
+				continue;
+			batch << "        ctl_number_t " << parm.name << "_v";
+			if ( parm.access != RWA_WRITE )
+				batch << " = " << parm.name << "[_i]";
+			batch << ";\n";
+		}
+		batch << "        " << nsName << "( ";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( p > 0 ) batch << ", ";
+			if ( parm.varying && parm.access != RWA_READ )
+				batch << '&';
+			batch << parm.name << ( parm.varying ? "_v" : "" );
+		}
+		batch << " );\n";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( parm.varying && parm.access != RWA_READ )
+				batch << "        " << parm.name << "[_i] = " << parm.name << "_v;\n";
+		}
+		batch <<
+			"    }\n"
+			"}\n";
+	}
+
+	return batch.str();
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+C99Generator::getDriver( void )
+{
+	std::stringstream driver;
+
+	driver <<
+		"/* Automatically generated driver code */\n"
+		"\n"
+		"#include <stddef.h>\n"
+		"#include <stdlib.h>\n"
+		"#ifndef _WIN32\n"
+		"# include <pthread.h>\n"
+		"# include <unistd.h>\n"
+		"# ifdef __linux__\n"
+		"#  include <sched.h>\n"
+		"# endif\n"
+		"#endif\n"
+		"\n"
+		"/* Planar batch entry points: one array per varying argument,\n"
+		"   uniform arguments passed once for the whole batch */\n";
+	driver << getBatchEntryPoints();
+
+	driver <<
+		"\n"
+		"/* Must be called once before anything else, sets up the\n"
+		"   module level variables */\n"
+		"void ctl_init( void )\n"
+		"{\n";
+	for ( size_t i = 0; i != myInitFunctions.size(); ++i )
+		driver << "    " << myInitFunctions[i] << "();\n";
+	driver <<
+		"}\n"
+		"\n"
+		"/* Interleaved images are processed in tiles of rows handed out\n"
+		"   from a shared counter by the threads of the apply functions */\n"
+		"static int ctl_tile_rows = 8;\n"
+		"static int ctl_pin_threads = 0;\n"
+		"void ctl_set_tile_rows( int rows ) { ctl_tile_rows = rows > 0 ? rows : 1; }\n"
+		"void ctl_set_pin_threads( int pin ) { ctl_pin_threads = pin; }\n"
+		"\n"
+		"typedef void (*ctl_rows_func_t)( const void *args, float *img, int w, int c, int startY, int endY );\n"
+		"typedef struct\n"
+		"{\n"
+		"    ctl_rows_func_t func;\n"
+		"    const void *args;\n"
+		"    float *img;\n"
+		"    int w, h, c;\n"
+		"    int tile;\n"
+		"    volatile int nextRow;\n"
+		"} ctl_work_t;\n"
+		"\n"
+		"static void ctl_run_tiles( ctl_work_t *work )\n"
+		"{\n"
+		"    for ( ;; )\n"
+		"    {\n"
+		"#ifdef _WIN32\n"
+		"        int startY = work->nextRow;\n"
+		"        work->nextRow += work->tile;\n"
+		"#else\n"
+		"        int startY = __sync_fetch_and_add( &work->nextRow, work->tile );\n"
+		"#endif\n"
+		"        if ( startY >= work->h ) return;\n"
+		"        int endY = startY + work->tile < work->h ? startY + work->tile : work->h;\n"
+		"        work->func( work->args, work->img, work->w, work->c, startY, endY );\n"
+		"    }\n"
+		"}\n"
+		"\n"
+		"#ifndef _WIN32\n"
+		"static void *ctl_thread_main( void *work )\n"
+		"{\n"
+		"    ctl_run_tiles( (ctl_work_t *)work );\n"
+		"    return NULL;\n"
+		"}\n"
+		"#endif\n"
+		"\n"
+		"static void ctl_run( ctl_work_t *work, int nThreads )\n"
+		"{\n"
+		"    work->tile = ctl_tile_rows;\n"
+		"    work->nextRow = 0;\n"
+		"#ifndef _WIN32\n"
+		"    if ( nThreads < 0 ) nThreads = (int)sysconf( _SC_NPROCESSORS_ONLN );\n"
+		"    if ( nThreads > 1 )\n"
+		"    {\n"
+		"        pthread_t *threads = (pthread_t *)malloc( sizeof( pthread_t ) * (size_t)( nThreads - 1 ) );\n"
+		"        int started = 0;\n"
+		"        for ( int i = 0; threads && i < nThreads - 1; ++i, ++started )\n"
+		"        {\n"
+		"            if ( pthread_create( &threads[i], NULL, &ctl_thread_main, work ) != 0 )\n"
+		"                break;\n"
+		"#ifdef __linux__\n"
+		"            if ( ctl_pin_threads )\n"
+		"            {\n"
+		"                long nCPU = sysconf( _SC_NPROCESSORS_ONLN );\n"
+		"                cpu_set_t cpus;\n"
+		"                CPU_ZERO( &cpus );\n"
+		"                CPU_SET( (size_t)( i + 1 ) % (size_t)( nCPU > 0 ? nCPU : 1 ), &cpus );\n"
+		"                pthread_setaffinity_np( threads[i], sizeof( cpus ), &cpus );\n"
+		"            }\n"
+		"#endif\n"
+		"        }\n"
+		"        ctl_run_tiles( work );\n"
+		"        for ( int i = 0; i < started; ++i )\n"
+		"            pthread_join( threads[i], NULL );\n"
+		"        free( threads );\n"
+		"        return;\n"
+		"    }\n"
+		"#endif\n"
+		"    ctl_run_tiles( work );\n"
+		"}\n";
+
+	for ( MainRoutineMap::const_iterator i = myMainRoutines.begin(); i != myMainRoutines.end(); ++i )
+	{
+		const std::string &name = i->first;
+		const SymbolInfoPtr &fnInfo = i->second.second;
+		FunctionTypePtr functionType = fnInfo->functionType();
+		const ParamVector &params = functionType->parameters();
+		std::vector<std::string> chanIn, chanOut, outOnly;
+		std::vector<const Param *> uniforms;
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( ! parm.varying )
+			{
+				uniforms.push_back( &parm );
+				continue;
+			}
+			if ( parm.access != RWA_WRITE )
+				chanIn.push_back( parm.name );
+			if ( parm.access != RWA_READ )
+				chanOut.push_back( parm.name );
+			if ( parm.access == RWA_WRITE )
+				outOnly.push_back( parm.name );
+		}
+		if ( chanIn.size() != chanOut.size() )
+			throw std::logic_error( "Unhandled different number of image channels in and out" );
+
+		std::string argsType = name + "_args_t";
+		driver << "\ntypedef struct\n{\n";
+		for ( size_t u = 0; u != uniforms.size(); ++u )
+		{
+			if ( uniforms[u]->type->cDataType() == BoolTypeEnum )
+				driver << "    bool " << uniforms[u]->name << ";\n";
+			else
+				driver << "    ctl_number_t " << uniforms[u]->name << ";\n";
+		}
+		if ( uniforms.empty() )
+			driver << "    int unused;\n";
+		driver << "} " << argsType << ";\n";
+
+		std::vector<std::string> planes( chanIn );
+		planes.insert( planes.end(), outOnly.begin(), outOnly.end() );
+		size_t nc = chanIn.size();
+		driver <<
+			"\n"
+			"static void rows_" << name << "( const void *vargs, float *img, int w, int c, int startY, int endY )\n"
+			"{\n"
+			"    const " << argsType << " *args = (const " << argsType << " *)vargs;\n"
+			"    int nc = c < " << nc << " ? c : " << nc << ";\n"
+			"    size_t linesize = (size_t)w * (size_t)c;\n"
+			"    ctl_number_t *planes = (ctl_number_t *)malloc( sizeof( ctl_number_t ) * (size_t)w * " << std::max( planes.size(), size_t( 1 ) ) << " );\n"
+			"    if ( ! planes ) return;\n"
+			"    (void)args;\n";
+		for ( size_t p = 0; p != planes.size(); ++p )
+			driver << "    ctl_number_t *" << planes[p] << "_p = planes + " << p << " * (size_t)w;\n";
+		driver <<
+			"    img += (size_t)startY * linesize;\n"
+			"    for ( int y = startY; y < endY; ++y, img += linesize )\n"
+			"    {\n"
+			"        for ( int x = 0; x < w; ++x )\n"
+			"        {\n";
+		for ( size_t k = 0; k != nc; ++k )
+			driver << "            " << chanIn[k] << "_p[x] = ( " << k << " < nc ) ? img[(size_t)x * c + " << k << "] : (ctl_number_t)0;\n";
+		driver <<
+			"        }\n"
+			"        batch_" << name << "( (size_t)w";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			if ( params[p].varying )
+				driver << ", " << params[p].name << "_p";
+			else
+				driver << ", args->" << params[p].name;
+		}
+		driver <<
+			" );\n"
+			"        for ( int x = 0; x < w; ++x )\n"
+			"        {\n";
+		for ( size_t k = 0; k != nc; ++k )
+			driver << "            if ( " << k << " < nc ) img[(size_t)x * c + " << k << "] = (float)" << chanOut[k] << "_p[x];\n";
+		driver <<
+			"        }\n"
+			"    }\n"
+			"    free( planes );\n"
+			"}\n"
+			"\n"
+			"/* Applies " << name << " in place to an interleaved image, nThreads < 0\n"
+			"   uses one thread per CPU */\n"
+			"void apply_" << name << "( const " << argsType << " *args, float *pixels, int width, int height, int channels, int nThreads )\n"
+			"{\n"
+			"    ctl_work_t work;\n"
+			"    if ( width <= 0 || height <= 0 || channels <= 0 ) return;\n"
+			"    work.func = &rows_" << name << ";\n"
+			"    work.args = args;\n"
+			"    work.img = pixels;\n"
+			"    work.w = width;\n"
+			"    work.h = height;\n"
+			"    work.c = channels;\n"
+			"    ctl_run( &work, nThreads );\n"
+			"}\n";
+	}
+
+	return driver.str();
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+C99Generator::getTestHarness( void )
+{
+	std::stringstream harness;
+
+	// main routines with arguments the batch entry points can't
+	// take only get the initializer checks
+	std::string batch;
+	try
+	{
+		batch = getBatchEntryPoints();
+	}
+	catch ( const std::logic_error & )
+	{
+		batch.clear();
+	}
+
+	std::vector<std::string> routines;
+	if ( ! batch.empty() )
+	{
+		harness << batch <<
+			"\n"
+			"#include <stdio.h>\n"
+			"#include <stdlib.h>\n"
+			"#include <string.h>\n"
+			"\n"
+			"static int harnessRead( FILE *in, ctl_number_t *v )\n"
+			"{\n"
+			"    double d;\n"
+			"    if ( fscanf( in, \"%lf\", &d ) != 1 ) return 0;\n"
+			"    *v = (ctl_number_t)d;\n"
+			"    return 1;\n"
+			"}\n";
+
+		for ( MainRoutineMap::const_iterator i = myMainRoutines.begin(); i != myMainRoutines.end(); ++i )
+		{
+			const std::string &name = i->first;
+			const SymbolInfoPtr &fnInfo = i->second.second;
+			FunctionTypePtr functionType = fnInfo->functionType();
+			const ParamVector &params = functionType->parameters();
+
+			harness <<
+				"\n"
+				"static int run_" << name << "( FILE *in, FILE *out )\n"
+				"{\n"
+				"    size_t count, k;\n"
+				"    int ok = 1;\n"
+				"    if ( fscanf( in, \"%zu\", &count ) != 1 ) return 2;\n";
+			for ( size_t p = 0, N = params.size(); p != N; ++p )
+			{
+				const Param &parm = params[p];
+				if ( parm.varying )
+					harness << "    ctl_number_t *v_" << parm.name << " = (ctl_number_t *)calloc( count + 1, sizeof( ctl_number_t ) );\n";
+				else if ( parm.type->cDataType() == BoolTypeEnum )
+					harness << "    bool u_" << parm.name << " = false;\n";
+				else
+					harness << "    ctl_number_t u_" << parm.name << " = 0;\n";
+			}
+			for ( size_t p = 0, N = params.size(); p != N; ++p )
+			{
+				const Param &parm = params[p];
+				if ( parm.access == RWA_WRITE )
+					continue;
+				if ( parm.varying )
+					harness << "    for ( k = 0; k != count; ++k ) ok = ok && v_" << parm.name << " && harnessRead( in, &v_" << parm.name << "[k] );\n";
+				else if ( parm.type->cDataType() == BoolTypeEnum )
+					harness << "    { int b = 0; ok = ok && fscanf( in, \"%d\", &b ) == 1; u_" << parm.name << " = b != 0; }\n";
+				else
+					harness << "    ok = ok && harnessRead( in, &u_" << parm.name << " );\n";
+			}
+			harness << "    if ( ok )\n"
+				"    {\n"
+				"        batch_" << name << "( count";
+			for ( size_t p = 0, N = params.size(); p != N; ++p )
+			{
+				const Param &parm = params[p];
+				harness << ", " << ( parm.varying ? "v_" : "u_" ) << parm.name;
+			}
+			harness << " );\n";
+			for ( size_t p = 0, N = params.size(); p != N; ++p )
+			{
+				const Param &parm = params[p];
+				if ( parm.varying && parm.access != RWA_READ )
+					harness << "        for ( k = 0; k != count; ++k ) fprintf( out, \"%.9g\\n\", (double)v_" << parm.name << "[k] );\n";
+			}
+			harness << "    }\n";
+			for ( size_t p = 0, N = params.size(); p != N; ++p )
+			{
+				const Param &parm = params[p];
+				if ( parm.varying )
+					harness << "    free( v_" << parm.name << " );\n";
+			}
+			harness <<
+				"    return ok ? 0 : 2;\n"
+				"}\n";
+			routines.push_back( name );
+		}
+	}
+
+	harness <<
+		"\n"
+		"/* Automatically generated test harness: runs the module\n"
+		"   initializers, which is where the CTL tests do their work, and\n"
+		"   fails if any assertion did.\n"
+		"\n"
+		"   Given <routine> <infile> <outfile>, it then calls the batch\n"
+		"   entry point of the main routine: infile holds the sample count\n"
+		"   followed by the input arguments in declaration order (count\n"
+		"   values for a varying argument, one for a uniform argument),\n"
+		"   and the varying outputs are written to outfile in declaration\n"
+		"   order, one value per line */\n"
+		"int main( int argc, char *argv[] )\n"
+		"{\n";
+	for ( size_t i = 0; i != myInitFunctions.size(); ++i )
+		harness << "    " << myInitFunctions[i] << "();\n";
+	harness <<
+		"    if ( ctl_assert_failures )\n"
+		"    {\n"
+		"        fprintf( stderr, \"%d assertion failure(s)\\n\", ctl_assert_failures );\n"
+		"        return 1;\n"
+		"    }\n"
+		"    if ( argc == 4 )\n"
+		"    {\n"
+		"        int status = 2;\n";
+	if ( ! routines.empty() )
+	{
+		harness <<
+			"        FILE *in = fopen( argv[2], \"r\" );\n"
+			"        FILE *out = fopen( argv[3], \"w\" );\n"
+			"        if ( in && out )\n"
+			"        {\n";
+		for ( size_t i = 0; i != routines.size(); ++i )
+		{
+			harness <<
+				"            " << ( i ? "else " : "" ) << "if ( ! strcmp( argv[1], \"" << routines[i] << "\" ) )\n"
+				"                status = run_" << routines[i] << "( in, out );\n";
+		}
+		harness <<
+			"        }\n"
+			"        if ( in ) fclose( in );\n"
+			"        if ( out && fclose( out ) != 0 ) status = 2;\n";
+	}
+	harness <<
+		"        if ( status == 2 )\n"
+		"            fprintf( stderr, \"cannot run %s\\n\", argv[1] );\n"
+		"        return status;\n"
+		"    }\n"
+		"    return 0;\n"
+		"}\n";
+
+	return harness.str();
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::outputInitCode( const std::string &modName, const std::string &initCode )
+{
+	myInitFunctions.push_back( modName + "_init" );
+	CCommonLanguage::outputInitCode( modName, initCode );
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::addStandardIncludes( void )
+{
+	// the driver pins threads with the GNU affinity calls, which
+	// have to be asked for before the first system header
+	curStream() <<
+		"\n#if defined(__linux__) && ! defined(_GNU_SOURCE)"
+		"\n# define _GNU_SOURCE"
+		"\n#endif"
+		"\n#include <math.h>"
+		"\n#include <stdint.h>"
+		"\n#include <limits.h>"
+		"\n#include <float.h>"
+		"\n#include <stdbool.h>"
+		"\n#include <stddef.h>"
+		"\n#include <stdio.h>";
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::addStandardDefinitions( void )
+{
+	// there is no 16 bit float in C, so half values live in a float
+	// and are rounded to half precision whenever something is
+	// converted to half, which is what the interpreter does too
+	curStream() <<
+		"\ntypedef float half;\n"
+		"\n"
+		"static inline half ctl_to_half( float v )\n"
+		"{\n"
+		"    union { float f; uint32_t i; } u;\n"
+		"    float a = fabsf( v );\n"
+		"    if ( isnan( v ) )\n"
+		"        return v;\n"
+		"    if ( a >= 65520.0f )\n"
+		"        return v < 0.0f ? -HUGE_VALF : HUGE_VALF;\n"
+		"    if ( a < 6.10351562e-05f )\n"
+		"        return nearbyintf( v * 16777216.0f ) / 16777216.0f;\n"
+		"    u.f = v;\n"
+		"    u.i += 0xfffu + ( ( u.i >> 13 ) & 1u );\n"
+		"    u.i &= ~0x1fffu;\n"
+		"    return u.f;\n"
+		"}\n"
+		"\n"
+		"static int ctl_assert_failures = 0;\n";
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string &precSuffix )
+{
+	types[StdType::Int] = TypeDefinition( "int", "" );
+	types[StdType::Float] = TypeDefinition( "ctl_number_t", "" );
+	CCommonLanguage::defineStandardTypes( types, funcPref, precSuffix );
+
+	// same layouts, C needs the typedefs to use the bare names
+	for ( std::map<StdType, TypeDefinition>::iterator i = types.begin(); i != types.end(); ++i )
+	{
+		TypeDefinition &t = i->second;
+		if ( t.declare.compare( 0, 7, "struct " ) == 0 )
+			t.declare = "typedef " + t.declare.substr( 0, t.declare.size() - 1 ) + " " + t.name + ";";
+		// ctl_vec3f_t is built with make_vec3f, there are no constructors
+		if ( t.maker.empty() && t.name.compare( 0, 4, "ctl_" ) == 0 && ! t.declare.empty() )
+			t.maker = "make_" + t.name.substr( 4, t.name.size() - 6 );
+	}
+
+	types[StdType::Chromaticities] = TypeDefinition( "Chromaticities", "typedef struct Chromaticities { ctl_vec2f_t red; ctl_vec2f_t green; ctl_vec2f_t blue; ctl_vec2f_t white; } Chromaticities;" );
+	types[StdType::Chromaticities].moduleUsage[NULL].types.insert( "ctl_vec2f_t" );
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::getStandardPrintBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix )
+{
+	d.push_back( FunctionDefinition( "assert", funcPref + "void assert( bool v ) { if ( ! v ) { ++ctl_assert_failures; fprintf( stderr, \"Assertion failure\\n\" ); } }" ) );
+	d.push_back( FunctionDefinition( "print_bool", funcPref + "void print_bool( bool v ) { fputs( v ? \"true\" : \"false\", stdout ); }" ) );
+	d.push_back( FunctionDefinition( "print_int", funcPref + "void print_int( int v ) { printf( \"%d\", v ); }" ) );
+	d.push_back( FunctionDefinition( "print_unsigned_int", funcPref + "void print_unsigned_int( unsigned int v ) { printf( \"%u\", v ); }" ) );
+	d.push_back( FunctionDefinition( "print_half", funcPref + "void print_half( half v ) { printf( \"%g\", (double)v ); }" ) );
+	d.push_back( FunctionDefinition( "print_float", funcPref + "void print_float( ctl_number_t v ) { printf( \"%g\", (double)v ); }" ) );
+	d.push_back( FunctionDefinition( "print_string", funcPref + "void print_string( const char *v ) { fputs( v, stdout ); }" ) );
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::getStandardHalfBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix )
+{
+	d.push_back( FunctionDefinition( "exp_h", funcPref + "half exp_h( ctl_number_t v ) { return ctl_to_half( (float)( exp" + precSuffix + "( v ) ) ); }" ) );
+	d.push_back( FunctionDefinition( "log_h", funcPref + "ctl_number_t log_h( half v ) { return log" + precSuffix + "( v ); }" ) );
+	d.push_back( FunctionDefinition( "log10_h", funcPref + "ctl_number_t log10_h( half v ) { return log10" + precSuffix + "( v ); }" ) );
+	d.push_back( FunctionDefinition( "pow_h", funcPref + "half pow_h( half x, ctl_number_t y ) { return ctl_to_half( (float)( pow" + precSuffix + "( x, y ) ) ); }" ) );
+	d.push_back( FunctionDefinition( "pow10_h", funcPref + "half pow10_h( ctl_number_t y ) { return ctl_to_half( (float)( pow" + precSuffix + "( (ctl_number_t)(10.0), y ) ) ); }" ) );
+
+	d.push_back( FunctionDefinition( "isfinite_h", funcPref + "bool isfinite_h( half v ) { return fabsf( v ) <= 65504.0f; }" ) );
+	d.push_back( FunctionDefinition( "isnormal_h", funcPref + "bool isnormal_h( half v ) { return fabsf( v ) >= 6.10351562e-05f && fabsf( v ) <= 65504.0f; }" ) );
+	d.push_back( FunctionDefinition( "isnan_h", funcPref + "bool isnan_h( half v ) { return isnan( v ); }" ) );
+	d.push_back( FunctionDefinition( "isinf_h", funcPref + "bool isinf_h( half v ) { return isinf( v ); }" ) );
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::usesFunctionInitializers( void ) const
+{
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsModuleDynamicInitialization( void ) const
+{
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsNamespaces( void ) const
+{
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsHalfType( void ) const
+{
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsReferences( void ) const
+{
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsPointers( void ) const
+{
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsStructOperators( void ) const
+{
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsArrayInitializers( void ) const
+{
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::supportsVectorSubscripts( void ) const
+{
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+C99Generator::needsStructTypedefs( void ) const
+{
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+C99Generator::constructNamespaceTag( const std::string &modName )
+{
+	return modName + "_";
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::getInlineKeyword( void ) const
+{
+	static std::string kInline = "inline";
+	return kInline;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::getFunctionPrefix( void ) const
+{
+	static std::string kPrefix = "static";
+	return kPrefix;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::getGlobalPrefix( void ) const
+{
+	static std::string kGlobal = "static";
+	return kGlobal;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::getBoolTypeName( void ) const
+{
+	static std::string kType = "bool";
+	return kType;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::getBoolLiteral( bool v ) const
+{
+	static std::string kBoolTrue = "true";
+	static std::string kBoolFalse = "false";
+	if ( v )
+		return kBoolTrue;
+	return kBoolFalse;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::getConstLiteral( bool ) const
+{
+	static std::string kConst = "const";
+	return kConst;
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::startCast( const char *type )
+{
+	curStream() << "(" << type << ")( ";
+}
+
+
+////////////////////////////////////////
+
+
+void
+C99Generator::startToHalf( void )
+{
+	curStream() << "ctl_to_half( ";
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::beginComment( void ) const
+{
+	static std::string kComment = "/*";
+	return kComment;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::beginCommentLine( void ) const
+{
+	static std::string kComment = "//";
+	return kComment;
+}
+
+
+////////////////////////////////////////
+
+
+const std::string &
+C99Generator::endComment( void ) const
+{
+	static std::string kComment = " */";
+	return kComment;
+}
+
+} // namespace Ctl
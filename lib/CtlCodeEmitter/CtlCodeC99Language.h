@@ -48,19 +48,69 @@
 #ifndef INCLUDED_CTL_CODE_C99_LANGUAGE_H
 #define INCLUDED_CTL_CODE_C99_LANGUAGE_H
 
-#include "CtlCodeLanguageGenerator.h"
+#include "CtlCodeCCommonLanguage.h"
 
 namespace Ctl
 {
 
-class C99Generator : public LanguageGenerator
+// Plain C99 output: no namespaces, references or operator
+// overloading, so module names become prefixes, output arguments
+// become pointers and the vector / matrix types are plain structs
+class C99Generator : public CCommonLanguage
 {
 public:
 	C99Generator( void );
 	virtual ~C99Generator( void );
-	
+
+	virtual void initStdLibrary( void );
+
+	virtual bool supportsPrecision( Precision p ) const;
+
+	virtual std::string getDriver( void );
+	virtual std::string getTestHarness( void );
+
+protected:
+	virtual void outputInitCode( const std::string &modName, const std::string &initCode );
+	virtual void addStandardIncludes( void );
+	virtual void addStandardDefinitions( void );
+	virtual void defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string &precSuffix );
+	virtual void getStandardPrintBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
+	virtual void getStandardHalfBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
+
+	virtual bool usesFunctionInitializers( void ) const;
+	virtual bool supportsModuleDynamicInitialization( void ) const;
+	virtual bool supportsNamespaces( void ) const;
+	virtual bool supportsHalfType( void ) const;
+	virtual bool supportsReferences( void ) const;
+	virtual bool supportsPointers( void ) const;
+	virtual bool supportsStructOperators( void ) const;
+	virtual bool supportsArrayInitializers( void ) const;
+	virtual bool supportsVectorSubscripts( void ) const;
+	virtual bool needsStructTypedefs( void ) const;
+
+	virtual std::string constructNamespaceTag( const std::string &modName );
+	virtual const std::string &getInlineKeyword( void ) const;
+	virtual const std::string &getFunctionPrefix( void ) const;
+	virtual const std::string &getGlobalPrefix( void ) const;
+	virtual const std::string &getBoolTypeName( void ) const;
+	virtual const std::string &getBoolLiteral( bool v ) const;
+	virtual const std::string &getConstLiteral( bool isGlobal ) const;
+	virtual void startCast( const char *type );
+	virtual void startToHalf( void );
+
+	virtual const std::string &beginComment( void ) const;
+	virtual const std::string &beginCommentLine( void ) const;
+	virtual const std::string &endComment( void ) const;
+
+private:
+	// planar batch_<name> functions for the main routines, used by
+	// the driver
+	std::string getBatchEntryPoints( void );
+
+	// modules that got a <module>_init function, in emission order
+	std::vector<std::string> myInitFunctions;
 };
 
-}
+} // namespace Ctl
 
 #endif // INCLUDED_CTL_CODE_C99_LANGUAGE_H
@@ -51,6 +51,9 @@
 #include "CtlCodeType.h"
 #include "CtlCodeAddr.h"
 #include "CtlCodeModule.h"
+#include <CtlSimdInterpreter.h>
+#include <CtlSimdAddr.h>
+#include <CtlSimdReg.h>
 #include <iomanip>
 #include <limits>
 #include <half.h>
@@ -126,7 +129,7 @@ CCommonLanguage::initStdLibrary( void )
 	popStream();
 	stdMod.prefix = prefixBuf.str();
 	
-	myStdMathFuncs["isinfinite_f"] = "isfinite";
+	myStdMathFuncs["isfinite_f"] = "isfinite";
 	myStdMathFuncs["isnormal_f"] = "isnormal";
 	myStdMathFuncs["isnan_f"] = "isnan";
 	myStdMathFuncs["isinf_f"] = "isinf";
@@ -208,6 +211,15 @@ CCommonLanguage::addStandardIncludes( void )
 ////////////////////////////////////////
 
 
+void
+CCommonLanguage::addStandardDefinitions( void )
+{
+}
+
+
+////////////////////////////////////////
+
+
 void
 CCommonLanguage::initStandardLibraryBodies( ModuleDefinition &stdMod )
 {
@@ -466,26 +478,26 @@ CCommonLanguage::getStandardMathBodies( FuncDeclList &d, const std::string &func
 "ctl_mat33f_t add_f33_f33( " + argmattype33 + "a, " + argmattype33 + "b )\n"
 "{\n"
 "    ctl_mat33f_t r;\n"
-"    r.vals[0][0] = a.vals[0][0] * b.vals[0][0];\n"
-"    r.vals[0][1] = a.vals[0][1] * b.vals[0][1];\n"
-"    r.vals[0][2] = a.vals[0][2] * b.vals[0][2];\n"
-"    r.vals[1][0] = a.vals[1][0] * b.vals[1][0];\n"
-"    r.vals[1][1] = a.vals[1][1] * b.vals[1][1];\n"
-"    r.vals[1][2] = a.vals[1][2] * b.vals[1][2];\n"
-"    r.vals[2][0] = a.vals[2][0] * b.vals[2][0];\n"
-"    r.vals[2][1] = a.vals[2][1] * b.vals[2][1];\n"
-"    r.vals[2][2] = a.vals[2][2] * b.vals[2][2];\n"
+"    r.vals[0][0] = a.vals[0][0] + b.vals[0][0];\n"
+"    r.vals[0][1] = a.vals[0][1] + b.vals[0][1];\n"
+"    r.vals[0][2] = a.vals[0][2] + b.vals[0][2];\n"
+"    r.vals[1][0] = a.vals[1][0] + b.vals[1][0];\n"
+"    r.vals[1][1] = a.vals[1][1] + b.vals[1][1];\n"
+"    r.vals[1][2] = a.vals[1][2] + b.vals[1][2];\n"
+"    r.vals[2][0] = a.vals[2][0] + b.vals[2][0];\n"
+"    r.vals[2][1] = a.vals[2][1] + b.vals[2][1];\n"
+"    r.vals[2][2] = a.vals[2][2] + b.vals[2][2];\n"
 "    return r;\n}" ) );
 	d.back().moduleUsage[NULL].types.insert( "ctl_mat33f_t" );
 
 	d.push_back( FunctionDefinition( "invert_f33", funcPref +
 "ctl_mat33f_t invert_f33( " + argmattype33 + "a )\n"
 "{\n"
-"    ctl_mat33f_t r = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};\n"
+"    ctl_mat33f_t r = make_mat33f( 1, 0, 0, 0, 1, 0, 0, 0, 1 );\n"
 "    ctl_number_t det = a.vals[0][0] * a.vals[1][1] * a.vals[2][2] + a.vals[0][1] * a.vals[1][2] * a.vals[2][0] + a.vals[0][2] * a.vals[1][0] * a.vals[2][1] - a.vals[2][0] * a.vals[1][1] * a.vals[0][2] - a.vals[2][1] * a.vals[1][2] * a.vals[0][0] - a.vals[2][2] * a.vals[1][0] * a.vals[0][1];\n"
 "    if ( fabs" + precSuffix + "( det ) > " + myStdNames["FLT_EPSILON"] + " )\n"
 "    {\n"
-"        det = ctl_number_t(1.0) / det;\n"
+"        det = (ctl_number_t)(1.0) / det;\n"
 "        r.vals[0][0] = ( a.vals[1][1] * a.vals[2][2] - a.vals[1][2] * a.vals[2][1] ) * det;\n"
 "        r.vals[0][1] = ( a.vals[0][2] * a.vals[2][1] - a.vals[0][1] * a.vals[2][2] ) * det;\n"
 "        r.vals[0][2] = ( a.vals[0][1] * a.vals[1][2] - a.vals[0][2] * a.vals[1][1] ) * det;\n"
@@ -498,12 +510,12 @@ CCommonLanguage::getStandardMathBodies( FuncDeclList &d, const std::string &func
 "    } else { \n"
 "        assert( false );\n"
 "        r.vals[0][0] = r.vals[1][1] = r.vals[2][2] = (ctl_number_t)(1.0);\n"
-"        r.vals[0][1] = ctl_number_t(0);\n"
-"        r.vals[0][2] = ctl_number_t(0);\n"
-"        r.vals[1][0] = ctl_number_t(0);\n"
-"        r.vals[1][2] = ctl_number_t(0);\n"
-"        r.vals[2][0] = ctl_number_t(0);\n"
-"        r.vals[2][1] = ctl_number_t(0);\n"
+"        r.vals[0][1] = (ctl_number_t)(0);\n"
+"        r.vals[0][2] = (ctl_number_t)(0);\n"
+"        r.vals[1][0] = (ctl_number_t)(0);\n"
+"        r.vals[1][2] = (ctl_number_t)(0);\n"
+"        r.vals[2][0] = (ctl_number_t)(0);\n"
+"        r.vals[2][1] = (ctl_number_t)(0);\n"
 "    }\n"
 "    return r;\n}" ) );
 	d.back().moduleUsage[NULL].types.insert( "ctl_mat33f_t" );
@@ -635,8 +647,8 @@ CCommonLanguage::getStandardMathBodies( FuncDeclList &d, const std::string &func
 	d.push_back( FunctionDefinition( "invert_f44", funcPref +
 "ctl_mat44f_t invert_f44( " + argmattype44 + "a )\n"
 "{\n"
-"    ctl_mat44f_t s = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};\n"
-"    ctl_mat44f_t t = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};\n"
+"    ctl_mat44f_t s = make_mat44f( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 );\n"
+"    ctl_mat44f_t t = make_mat44f( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 );\n"
 "    int i, j, k;\n"
 "    for ( i = 0; i < 4; ++i )\n"
 "        for ( j = 0; j < 4; ++j )\n"
@@ -817,24 +829,24 @@ CCommonLanguage::getStandardColorBodies( FuncDeclList &d, const std::string &fun
 	// These are a straight crib from IlmCtlSimd for the luv routines
 	// to try to retain/ compatibility, but if we have higher
 	// precision data types should we do more?
-	d.push_back( FunctionDefinition( "_cspace_f", funcPref + "ctl_number_t _cspace_f( ctl_number_t x ) { if ( x > ctl_number_t( 0.008856 ) ) return pow" + precSuffix + "( x, ctl_number_t(1.0/3.0) ); return ctl_number_t(7.787) * x + ctl_number_t(16.0/116.0); }" ) );
-	d.push_back( FunctionDefinition( "_cspace_fInverse", funcPref + "ctl_number_t _cspace_fInverse( ctl_number_t t ) { if ( t > ctl_number_t(0.206892) ) return t * t * t; return ctl_number_t(1.0/7.787) * ( t - ctl_number_t(16.0/116.0) ); }" ) );
-	d.push_back( FunctionDefinition( "_cspace_uprime", funcPref + "ctl_number_t _cspace_uprime( " + argvectype3 +"XYZ ) { return ( XYZ.x * ctl_number_t(4) ) / ( XYZ.x + ctl_number_t(15) * XYZ.y + ctl_number_t(3) * XYZ.z ); }" ) );
+	d.push_back( FunctionDefinition( "_cspace_f", funcPref + "ctl_number_t _cspace_f( ctl_number_t x ) { if ( x > (ctl_number_t)(0.008856) ) return pow" + precSuffix + "( x, (ctl_number_t)(1.0/3.0) ); return (ctl_number_t)(7.787) * x + (ctl_number_t)(16.0/116.0); }" ) );
+	d.push_back( FunctionDefinition( "_cspace_fInverse", funcPref + "ctl_number_t _cspace_fInverse( ctl_number_t t ) { if ( t > (ctl_number_t)(0.206892) ) return t * t * t; return (ctl_number_t)(1.0/7.787) * ( t - (ctl_number_t)(16.0/116.0) ); }" ) );
+	d.push_back( FunctionDefinition( "_cspace_uprime", funcPref + "ctl_number_t _cspace_uprime( " + argvectype3 +"XYZ ) { return ( XYZ.x * (ctl_number_t)(4) ) / ( XYZ.x + (ctl_number_t)(15) * XYZ.y + (ctl_number_t)(3) * XYZ.z ); }" ) );
 	d.back().moduleUsage[NULL].types.insert( "ctl_vec3f_t" );
-	d.push_back( FunctionDefinition( "_cspace_vprime", funcPref + "ctl_number_t _cspace_vprime( " + argvectype3 +"XYZ ) { return ( XYZ.y * ctl_number_t(9) ) / ( XYZ.x + ctl_number_t(15) * XYZ.y + ctl_number_t(3) * XYZ.z ); }" ) );
+	d.push_back( FunctionDefinition( "_cspace_vprime", funcPref + "ctl_number_t _cspace_vprime( " + argvectype3 +"XYZ ) { return ( XYZ.y * (ctl_number_t)(9) ) / ( XYZ.x + (ctl_number_t)(15) * XYZ.y + (ctl_number_t)(3) * XYZ.z ); }" ) );
 	d.back().moduleUsage[NULL].types.insert( "ctl_vec3f_t" );
 
 	d.push_back( FunctionDefinition( "RGBtoXYZ", funcPref +
 "ctl_mat44f_t RGBtoXYZ( " + argchrom + "chroma, ctl_number_t Y )\n"
 "{\n"
-"    const ctl_number_t one = ctl_number_t(1);\n"
+"    const ctl_number_t one = (ctl_number_t)(1);\n"
 "    ctl_number_t X = chroma.white.x * Y / chroma.white.y;\n"
 "    ctl_number_t Z = (one - chroma.white.x - chroma.white.y) * Y / chroma.white.y;\n"
 "    ctl_number_t d = chroma.red.x * (chroma.blue.y - chroma.green.y) + chroma.blue.x * (chroma.green.y - chroma.red.y) + chroma.green.x * (chroma.red.y - chroma.blue.y);\n"
 "    ctl_number_t Sr = (X * (chroma.blue.y - chroma.green.y) - chroma.green.x * (Y * (chroma.blue.y - one) + chroma.blue.y * (X + Z)) + chroma.blue.x * (Y * (chroma.green.y - one) + chroma.green.y * (X + Z))) / d;\n"
 "    ctl_number_t Sg = (X * (chroma.red.y - chroma.blue.y) + chroma.red.x * (Y * (chroma.blue.y - one) + chroma.blue.y * (X + Z)) - chroma.blue.x * (Y * (chroma.red.y - one) + chroma.red.y * (X + Z))) / d;\n"
 "    ctl_number_t Sb = (X * (chroma.green.y - chroma.red.y) - chroma.red.x * (Y * (chroma.green.y - one) + chroma.green.y * (X + Z)) + chroma.green.x * (Y * (chroma.red.y - one) + chroma.red.y * (X + Z))) / d;\n"
-"    ctl_mat44f_t M = {{{1, 0, 0, 0,}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};\n"
+"    ctl_mat44f_t M = make_mat44f( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 );\n"
 "    M.vals[0][0] = Sr * chroma.red.x;\n"
 "    M.vals[0][1] = Sr * chroma.red.y;\n"
 "    M.vals[0][2] = Sr * (1 - chroma.red.x - chroma.red.y);\n"
@@ -864,9 +876,9 @@ CCommonLanguage::getStandardColorBodies( FuncDeclList &d, const std::string &fun
 "ctl_vec3f_t XYZtoLuv( " + argvectype3 + "XYZ, " + argvectype3 + "XYZn )\n"
 "{\n"
 "    ctl_vec3f_t r;\n"
-"    r.x = ctl_number_t(116) * _cspace_f( XYZ.y / XYZn.y ) - ctl_number_t(16);\n"
-"    r.y = ctl_number_t(13) * r.x * ( _cspace_uprime( XYZ ) - _cspace_uprime( XYZn ) );\n"
-"    r.z = ctl_number_t(13) * r.x * ( _cspace_vprime( XYZ ) - _cspace_vprime( XYZn ) );\n"
+"    r.x = (ctl_number_t)(116) * _cspace_f( XYZ.y / XYZn.y ) - (ctl_number_t)(16);\n"
+"    r.y = (ctl_number_t)(13) * r.x * ( _cspace_uprime( XYZ ) - _cspace_uprime( XYZn ) );\n"
+"    r.z = (ctl_number_t)(13) * r.x * ( _cspace_vprime( XYZ ) - _cspace_vprime( XYZn ) );\n"
 "    return r;\n"
 "}" ) );
 	d.back().moduleUsage[NULL].types.insert( "ctl_vec3f_t" );
@@ -897,9 +909,9 @@ CCommonLanguage::getStandardColorBodies( FuncDeclList &d, const std::string &fun
 "{\n"
 "    ctl_vec3f_t r;\n"
 "    ctl_number_t tmpY = _cspace_f( XYZ.y / XYZn.y );\n"
-"    r.x = ctl_number_t(116) * tmpY - ctl_number_t(16);\n"
-"    r.y = ctl_number_t(500) * ( _cspace_f( XYZ.x / XYZn.x ) -  tmpY );\n"
-"    r.z = ctl_number_t(200) * ( tmpY - _cspace_f( XYZ.z / XYZn.z ) );\n"
+"    r.x = (ctl_number_t)(116) * tmpY - (ctl_number_t)(16);\n"
+"    r.y = (ctl_number_t)(500) * ( _cspace_f( XYZ.x / XYZn.x ) -  tmpY );\n"
+"    r.z = (ctl_number_t)(200) * ( tmpY - _cspace_f( XYZ.z / XYZn.z ) );\n"
 "    return r;\n"
 "}" ) );
 	d.back().moduleUsage[NULL].types.insert( "ctl_vec3f_t" );
@@ -909,9 +921,9 @@ CCommonLanguage::getStandardColorBodies( FuncDeclList &d, const std::string &fun
 "ctl_vec3f_t LabtoXYZ( " + argvectype3 + "Lab, " + argvectype3 + "XYZn )\n"
 "{\n"
 "    ctl_vec3f_t r;\n"
-"    ctl_number_t fY = (Lab.x + ctl_number_t(16)) / ctl_number_t(116);\n"
-"    ctl_number_t fX = Lab.y / ctl_number_t(500) + fY;\n"
-"    ctl_number_t fZ = fY - Lab.z / ctl_number_t(200);\n"
+"    ctl_number_t fY = (Lab.x + (ctl_number_t)(16)) / (ctl_number_t)(116);\n"
+"    ctl_number_t fX = Lab.y / (ctl_number_t)(500) + fY;\n"
+"    ctl_number_t fZ = fY - Lab.z / (ctl_number_t)(200);\n"
 "    r.x = XYZn.x * _cspace_fInverse( fX );\n"
 "    r.y = XYZn.y * _cspace_fInverse( fY );\n"
 "    r.z = XYZn.z * _cspace_fInverse( fZ );\n"
@@ -1058,16 +1070,26 @@ CCommonLanguage::getStandardInterpBodies( FuncDeclList &d, const std::string &fu
 
 	if ( supportsHalfType() )
 	{
-		if ( ! supportsReferences() )
-			throw std::logic_error( "Support half type but not references???" );
-
-		d.push_back( FunctionDefinition( "lookup3D_h", funcPref + "void lookup3D_h( const ctl_number_t table[], const ctl_vec3i_t &size, const ctl_vec3f_t &pMin, const ctl_vec3f_t &pMax, const half &p0, const half &p1, const half &p2, half &o0, half &o1, half &o2 )\n"
+		if ( supportsReferences() )
+		{
+			d.push_back( FunctionDefinition( "lookup3D_h", funcPref + "void lookup3D_h( const ctl_number_t table[], const ctl_vec3i_t &size, const ctl_vec3f_t &pMin, const ctl_vec3f_t &pMax, const half &p0, const half &p1, const half &p2, half &o0, half &o1, half &o2 )\n"
 "{\n"
 "    ctl_vec3f_t out = lookup3D_f3( table, size, pMin, pMax, make_vec3f( p0, p1, p2 ) );\n"
 "    o0 = out.x;\n"
 "    o1 = out.y;\n"
 "    o2 = out.z;\n"
 "}" ) );
+		}
+		else
+		{
+			d.push_back( FunctionDefinition( "lookup3D_h", funcPref + "void lookup3D_h( const ctl_number_t table[], ctl_vec3i_t size, ctl_vec3f_t pMin, ctl_vec3f_t pMax, half p0, half p1, half p2, half *o0, half *o1, half *o2 )\n"
+"{\n"
+"    ctl_vec3f_t out = lookup3D_f3( table, size, pMin, pMax, make_vec3f( p0, p1, p2 ) );\n"
+"    *o0 = out.x;\n"
+"    *o1 = out.y;\n"
+"    *o2 = out.z;\n"
+"}" ) );
+		}
 		d.back().moduleUsage[NULL].types.insert( "ctl_vec3f_t" );
 		d.back().moduleUsage[NULL].types.insert( "ctl_vec3i_t" );
 		d.back().moduleUsage[NULL].functions.insert( "lookup3D_f3" );
@@ -1103,10 +1125,10 @@ CCommonLanguage::getStandardInterpBodies( FuncDeclList &d, const std::string &fu
 "        else if ( table[k][0] < p ) i = k;\n"
 "        else j = k;\n"
 "    }\n"
-"    const ctl_number_t kHalf = ctl_number_t(0.5);\n"
-"    const ctl_number_t kOne = ctl_number_t(1);\n"
-"    const ctl_number_t kTwo = ctl_number_t(2);\n"
-"    const ctl_number_t kThree = ctl_number_t(3);\n"
+"    const ctl_number_t kHalf = (ctl_number_t)(0.5);\n"
+"    const ctl_number_t kOne = (ctl_number_t)(1);\n"
+"    const ctl_number_t kTwo = (ctl_number_t)(2);\n"
+"    const ctl_number_t kThree = (ctl_number_t)(3);\n"
 "    ctl_number_t dx = ( table[i+1][0] - table[i][0] );\n"
 "    ctl_number_t dy = ( table[i+1][1] - table[i][1] );\n"
 "    ctl_number_t m0, m1;\n"
@@ -1301,7 +1323,10 @@ CCommonLanguage::getCode( bool calledOnly )
 				fC = curMod.fwdCode->str();
 			if ( curMod.funCode )
 				fnC = curMod.funCode->str();
-			if ( tC.empty() && vC.empty() && fC.empty() && fnC.empty() )
+			// the standard library namespace is always opened since
+			// every module pulls it in with a using directive
+			if ( tC.empty() && vC.empty() && fC.empty() && fnC.empty() &&
+				 curMod.module != NULL )
 				continue;
 
 			if ( ! curMod.prefix.empty() )
@@ -1678,6 +1703,7 @@ CCommonLanguage::stdLibraryAndSetup( void )
 	addStandardIncludes();
 	newlineAndIndent();
 	curStream() << "\ntypedef " << getPrecisionType() << " ctl_number_t;\n";
+	addStandardDefinitions();
 	popStream();
 	return libSetupB.str();
 }
@@ -1848,6 +1874,11 @@ CCommonLanguage::function( CodeLContext &ctxt, const CodeFunctionNode &f )
 	myCurModuleUsage = &(funDecl.moduleUsage);
 
 	myCurOutputVars.clear();
+	myCurLocalNames.clear();
+	myCurLocalRenames.clear();
+	for ( size_t i = 0, N = params.size(); i != N; ++i )
+		myCurLocalNames[params[i].name] = 1;
+
 	std::string funcName = removeNSQuals( f.name );
 	bool isMain = funcName == myCurModuleName;
 	if ( funcName == "main" )
@@ -1858,7 +1889,9 @@ CCommonLanguage::function( CodeLContext &ctxt, const CodeFunctionNode &f )
 
 	if ( isMain )
 	{
-		std::string nsName = myCurModuleName + "::" + funcName;
+		std::string nsName = myModPrefix + funcName;
+		if ( supportsNamespaces() )
+			nsName = myCurModuleName + "::" + funcName;
 		registerMainRoutine( funcName, nsName, f.info );
 
 		// and put it in a header file in case someone cares
@@ -2050,6 +2083,96 @@ bool CCommonLanguage::isConstExpr(const ExprNodePtr& expr) const
     return true;
 }
 
+ExprNodePtr
+CCommonLanguage::precalculate( CodeLContext &ctxt, const std::string &name, const DataTypePtr &t, int lineNumber )
+{
+	if ( ! myConstantInterpreter )
+		return ExprNodePtr();
+
+	SymbolInfoPtr info = myConstantInterpreter->getSymbol( name );
+	if ( ! info || info->isWritable() )
+		return ExprNodePtr();
+
+	SimdDataAddrPtr addr = info->addr();
+	if ( ! addr || ! addr->reg() || addr->reg()->isVarying() )
+		return ExprNodePtr();
+
+	const SimdReg &reg = *( addr->reg() );
+	ExprNodeVector elements;
+	if ( ! precalculateRecurse( ctxt, info->type(), reg[0], lineNumber, elements ) )
+		return ExprNodePtr();
+
+	if ( elements.size() == 1 && ! info->type().is_subclass<ArrayType>() &&
+		 ! info->type().is_subclass<StructType>() )
+		return elements[0];
+
+	ExprNodePtr retval = ctxt.newValueNode( lineNumber, elements );
+	retval->type = t;
+	return retval;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+CCommonLanguage::precalculateRecurse( CodeLContext &ctxt, const DataTypePtr &t, const char *data,
+									  int lineNumber, ExprNodeVector &elements )
+{
+	// elements are listed flattened in declaration order, the same
+	// way valueRecurse walks them
+	switch ( t->cDataType() )
+	{
+		case BoolTypeEnum:
+			elements.push_back( ctxt.newBoolLiteralNode( lineNumber, *reinterpret_cast<const bool *>( data ) ) );
+			return true;
+		case IntTypeEnum:
+			elements.push_back( ctxt.newIntLiteralNode( lineNumber, *reinterpret_cast<const int *>( data ) ) );
+			return true;
+		case UIntTypeEnum:
+			elements.push_back( ctxt.newUIntLiteralNode( lineNumber, *reinterpret_cast<const unsigned int *>( data ) ) );
+			return true;
+		case HalfTypeEnum:
+			elements.push_back( ctxt.newHalfLiteralNode( lineNumber, *reinterpret_cast<const half *>( data ) ) );
+			return true;
+		case FloatTypeEnum:
+			elements.push_back( ctxt.newFloatLiteralNode( lineNumber, *reinterpret_cast<const float *>( data ) ) );
+			return true;
+		case ArrayTypeEnum:
+		{
+			ArrayTypePtr arrType = t.cast<ArrayType>();
+			if ( arrType->size() <= 0 )
+				return false;
+			size_t eSize = arrType->elementSize();
+			for ( int i = 0; i < arrType->size(); ++i )
+			{
+				if ( ! precalculateRecurse( ctxt, arrType->elementType(), data + i * eSize, lineNumber, elements ) )
+					return false;
+			}
+			return true;
+		}
+		case StructTypeEnum:
+		{
+			StructTypePtr structType = t.cast<StructType>();
+			for ( MemberVectorConstIterator it = structType->members().begin();
+				  it != structType->members().end(); ++it )
+			{
+				if ( ! precalculateRecurse( ctxt, it->type, data + it->offset, lineNumber, elements ) )
+					return false;
+			}
+			return true;
+		}
+		default:
+			break;
+	}
+
+	return false;
+}
+
+
+////////////////////////////////////////
+
+
 void
 CCommonLanguage::variable( CodeLContext &ctxt, const CodeVariableNode &v )
 {
@@ -2062,6 +2185,19 @@ CCommonLanguage::variable( CodeLContext &ctxt, const CodeVariableNode &v )
 			return;
 
 		bool doConst = ! v.info->isWritable();
+
+		// computed constants (spline coefficients, inverted matrices,
+		// ...) have already been evaluated by the interpreter, so
+		// bake the values in rather than the code computing them
+		ExprNodePtr initV = v.initialValue;
+		if ( initV && doConst && v.name.find( '$' ) == std::string::npos &&
+			 ! isConstExpr( initV ) )
+		{
+			ExprNodePtr literal = precalculate( ctxt, v.name, v.info->type(), v.lineNumber );
+			if ( literal )
+				initV = literal;
+		}
+
 		bool overrideInit = false;
 		if ( usesFunctionInitializers() )
 		{
@@ -2069,7 +2205,7 @@ CCommonLanguage::variable( CodeLContext &ctxt, const CodeVariableNode &v )
 			// for everything. In old c++, some things have to be
 			// initialized in a function. if we use one of those, we
 			// can't initialize ourselves that quickly...
-			if ( usesUninitLocalGlobals( v.initialValue ) )
+			if ( usesUninitLocalGlobals( initV ) )
 			{
 				doConst = false;
 				overrideInit = true;
@@ -2127,20 +2263,13 @@ CCommonLanguage::variable( CodeLContext &ctxt, const CodeVariableNode &v )
 		}
 		else
 		{
-//		    if (v.initialValue.is_subclass<CodeCallNode>()) {
-//		        auto callNode = v.initialValue.cast<CodeCallNode>();
-//                precalculate(callNode->function->name, callNode->arguments);
-//		    }
 			myGlobalInitType[v.name] = initT;
 			myGlobalVariables.insert( v.name );
 			if (v.name == "CINEMA_BLACK") {
 			    int a = 0;
                 (void)a;
 			}
-			const auto precalculated = !isConstExpr(v.initialValue) && precalculate(v.name, {});
-            if (!precalculated) {
-                globDef.delayedInit = doInit(initT, ctxt, v.info->type(), v.initialValue, v.name);
-            }
+			globDef.delayedInit = doInit( initT, ctxt, v.info->type(), initV, v.name );
 			popStream();
 			globDef.declare = varDeclB.str();
 		}
@@ -2160,11 +2289,20 @@ CCommonLanguage::variable( CodeLContext &ctxt, const CodeVariableNode &v )
 	    if (!ctxt.isLoop()) {
             newlineAndIndent();
         }
-		InitType initT = variable( ctxt, v.name, v.info->type(),
+		std::string varName = v.name;
+		int &nameCount = myCurLocalNames[v.name];
+		if ( nameCount++ > 0 )
+		{
+			std::stringstream renameB;
+			renameB << v.name << "_" << nameCount;
+			varName = renameB.str();
+			myCurLocalRenames[v.info.pointer()] = varName;
+		}
+		InitType initT = variable( ctxt, varName, v.info->type(),
 								   ! v.info->isWritable() && isConstExpr(v.initialValue), false, false, false );
 
 		std::string delInit = doInit( initT, ctxt, v.info->type(),
-									  v.initialValue, v.name );
+									  v.initialValue, varName );
 		if ( ! delInit.empty() )
 			throw std::logic_error( "Delayed init on normal variable" );
 	}
@@ -2195,9 +2333,13 @@ CCommonLanguage::assignment( CodeLContext &ctxt, const CodeAssignmentNode &v )
 void
 CCommonLanguage::expr( CodeLContext &ctxt, const CodeExprStatementNode &v )
 {
-	newlineAndIndent();
+	if (!ctxt.isLoop()) {
+        newlineAndIndent();
+    }
 	v.expr->generateCode( ctxt );
-	curStream() << ';';
+	if (!ctxt.isLoop()) {
+        curStream() << ';';
+    }
 }
 
 
@@ -2316,7 +2458,15 @@ CCommonLanguage::loop( CodeLContext &ctxt, const CodeForNode &v )
     newlineAndIndent();
     ctxt.setLoop(true);
     curStream() << "for ( ";
+    std::stringstream initB;
+    pushStream( initB );
     v.init->generateCode(ctxt);
+    popStream();
+    // declarations terminate themselves, assignments don't
+    const std::string initS = initB.str();
+    curStream() << initS;
+    if ( initS.empty() || initS[initS.size() - 1] != ';' )
+        curStream() << ';';
     curStream() << " ";
     BoolTypePtr boolType = ctxt.newBoolType();
     boolType->generateCastFrom( v.cond, ctxt );
@@ -2403,6 +2553,8 @@ CCommonLanguage::index( CodeLContext &ctxt, const CodeArrayIndexNode &v )
 	root->generateCode( ctxt );
 	if ( !arrInfo.isCore && arrInfo.sizes.size() > 1 && !supportsStructOperators() )
 		curStream() << ".vals";
+	else if ( arrInfo.isCore && arrInfo.sizes.back() < 0 && !supportsVectorSubscripts() )
+		curStream() << ".vals";
 
 	curStream() << '[';
 	bool needAdd = false;
@@ -2511,6 +2663,10 @@ CCommonLanguage::name( CodeLContext &ctxt, const CodeNameNode &v )
 	
 	std::string outname = removeNSQuals( v.name );
 
+	// names the parser couldn't resolve (code with errors in it)
+	if ( ! v.info )
+		throw std::logic_error( "Unresolved name '" + v.name + "'" );
+
 	if ( v.info->isFunction() )
 	{
 		const Module *m = v.info->module();
@@ -2556,6 +2712,10 @@ CCommonLanguage::name( CodeLContext &ctxt, const CodeNameNode &v )
 		return;
 	}
 
+	std::map<const SymbolInfo *, std::string>::const_iterator r = myCurLocalRenames.find( v.info.pointer() );
+	if ( r != myCurLocalRenames.end() )
+		outname = r->second;
+
 	i = myStdNames.find( outname );
 	if ( i != myStdNames.end() )
 		curStream() << i->second;
@@ -2617,7 +2777,9 @@ CCommonLanguage::halfLit( CodeLContext &ctxt, const CodeHalfLiteralNode &v )
 		throw std::logic_error( "Language does not support half" );
 	}
 
-    curStream() << "half( " << std::setprecision( std::numeric_limits<half>::digits ) << static_cast<float>( v.value ) << "F )";
+	startToHalf();
+	curStream() << std::scientific << std::setprecision( std::numeric_limits<float>::digits10 ) << static_cast<float>( v.value ) << 'F';
+	endCoersion();
 }
 
 
@@ -2627,7 +2789,15 @@ CCommonLanguage::halfLit( CodeLContext &ctxt, const CodeHalfLiteralNode &v )
 void
 CCommonLanguage::floatLit( CodeLContext &ctxt, const CodeFloatLiteralNode &v )
 {
-    curStream() << std::fixed << std::setprecision( std::numeric_limits<float>::digits ) << static_cast<float>( v.value ) << getPrecisionTypeSuffix();
+	float f = static_cast<float>( v.value );
+	if ( f != f )
+		curStream() << "NAN";
+	else if ( f > std::numeric_limits<float>::max() )
+		curStream() << "HUGE_VALF";
+	else if ( f < -std::numeric_limits<float>::max() )
+		curStream() << "(-HUGE_VALF)";
+	else
+		curStream() << std::fixed << std::setprecision( std::numeric_limits<float>::digits ) << f << getPrecisionTypeSuffix();
 }
 
 
@@ -2679,7 +2849,7 @@ CCommonLanguage::call( CodeLContext &ctxt, const CodeCallNode &v )
             newlineAndIndent();
 	    }
     }
-	else if (v.function->name.find("assert") != std::string::npos) {
+	else if (v.function->name.find("assert") != std::string::npos && !supportsPrint()) {
         curStream() << "// ";
 	}
 
@@ -3014,10 +3184,13 @@ CCommonLanguage::valueRecurse( CodeLContext &ctxt,
                 return;
 		    }
 
+			// in C a struct member is initialized by a single struct
+			// valued expression, braces would descend into its members
+			bool braceItem = !doCtor || ( isSubItem && ( supportsStructConstructors() || !supportsPointers() ) );
 			bool doBrace = false;
 			if ( myCurInitType == ASSIGN )
 			{
-				if ( isSubItem || !doCtor )
+				if ( braceItem )
 					curStream() << "{ ";
 				if ( nItems > 1 && nPerCollapseChunk > 1 && !doCtor )
 					doBrace = true;
@@ -3088,10 +3261,10 @@ CCommonLanguage::valueRecurse( CodeLContext &ctxt,
 				if ( lineEveryItem )
 				{
 					newlineAndIndent();
-					if ( isSubItem || !doCtor )
+					if ( braceItem )
 						curStream() << "}";
 				}
-				else if ( isSubItem || !doCtor )
+				else if ( braceItem )
 					curStream() << " }";
 			}
 		}
@@ -3168,9 +3341,9 @@ CCommonLanguage::variable( CodeLContext &ctxt,
         (void)a;
     }
 	InitType retval = ASSIGN;
-    auto byValue = supportsReferences() || !supportsPointers();
+    auto byValue = !supportsReferences() && !supportsPointers();
 
-    if (isInput && isWritable) {
+    if (isInput && isWritable && byValue) {
         curStream() << "out ";
     }
 
@@ -3834,12 +4007,18 @@ CCommonLanguage::collapseArray( const ArrayTypePtr &arrPtr )
 		}
 		else if ( coreTypePtr.is_subclass<IntType>() )
 			coreType = "int";
+		else if ( coreTypePtr.is_subclass<UIntType>() )
+			coreType = "unsigned int";
+		else if ( coreTypePtr.is_subclass<BoolType>() )
+			coreType = getBoolTypeName();
+		else if ( coreTypePtr.is_subclass<StructType>() )
+			coreType = removeNSQuals( coreTypePtr.cast<StructType>()->name() );
 		else
 			throw std::logic_error( "Currently unhandled core data type for array" );
 
 		if ( asize.size() == 2 && asize[0] == asize[1] &&
 			 ( asize[0] == 3 || asize[0] == 4 ) &&
-			 coreType != "int" )
+			 ( coreType == "ctl_number_t" || coreType == "half" ) )
 		{
 			if ( asize[0] == 3 )
 			{
@@ -3870,7 +4049,8 @@ CCommonLanguage::collapseArray( const ArrayTypePtr &arrPtr )
 		    // Should initialize without structure braces {}
             newInfo.isCore = true;
         }
-		else if ( asize.size() == 1 )
+		else if ( asize.size() == 1 &&
+				  ( coreType == "ctl_number_t" || coreType == "half" || coreType == "int" ) )
 		{
 			std::string &maker = newInfo.maker;
 			// huh, if we do large tables with c++ objects, i.e. 3D luts,
@@ -3879,11 +4059,14 @@ CCommonLanguage::collapseArray( const ArrayTypePtr &arrPtr )
 			// could wait for g++ to finish a -O3 build...
 			// so let's just do giant number table in those scenarios
 			const auto setArrayInfo = [&](StdType type) {
-                const auto& typeInfo = myModules.front().types[type];
+                const auto typeIt = myModules.front().types.find(type);
+                if ( typeIt == myModules.front().types.end() )
+                    return;
+                const auto& typeInfo = typeIt->second;
                 if ( !supportsStructConstructors() ) {
                     maker = typeInfo.maker;
                 } else {
-                    maker = coreType;
+                    maker = typeInfo.name;
                 }
                 newInfo.isCore = true;
                 coreType = typeInfo.name;
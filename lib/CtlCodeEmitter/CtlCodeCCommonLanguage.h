@@ -219,6 +219,8 @@ protected:
 	virtual void traverseAndEmit( const std::map<const Module *, size_t> &indexmap, FunctionDefinition &func, bool fwdOnly = false );
 
 	virtual void addStandardIncludes( void );
+	// anything the standard library needs right after ctl_number_t
+	virtual void addStandardDefinitions( void );
 	virtual void initStandardLibraryBodies( ModuleDefinition &m );
 	virtual void defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string &precSuffix );
 	virtual void getStandardMathBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
@@ -240,6 +242,8 @@ protected:
 	virtual bool supportsStructOperators( void ) const = 0;
     virtual bool supportsStructConstructors( void ) const { return supportsStructOperators(); }
     virtual bool supportsArrayInitializers( void ) const { return false; }
+	// whether the built-in vector types can be indexed directly
+	virtual bool supportsVectorSubscripts( void ) const { return true; }
 	virtual bool needsStructTypedefs( void ) const = 0;
     virtual bool supportsPrint() const { return true; }
 
@@ -310,6 +314,12 @@ protected:
 
     bool isConstExpr(const ExprNodePtr& expr) const;
 
+	// literal value of a global computed by the constant interpreter,
+	// NULL if there is no such value
+	ExprNodePtr precalculate( CodeLContext &ctxt, const std::string &name, const DataTypePtr &t, int lineNumber );
+	bool precalculateRecurse( CodeLContext &ctxt, const DataTypePtr &t, const char *data,
+							  int lineNumber, ExprNodeVector &elements );
+
 	struct ArrayInfo
 	{
 		std::vector<int> sizes;
@@ -339,6 +349,11 @@ protected:
 	std::map<std::string, std::string> myGlobalLiterals;
 	std::map<std::string, std::string> myDefaultMappings;
 	std::set<std::string> myCurOutputVars;
+	// CTL flattens nested blocks into the enclosing statement list,
+	// so locals that shadow an earlier local in the same function
+	// are renamed on output
+	std::map<std::string, int> myCurLocalNames;
+	std::map<const SymbolInfo *, std::string> myCurLocalRenames;
 
 	ArrayInfoContainer myArrayTypes;
 	// functions that can't be inline...
@@ -90,6 +90,138 @@ CPPGenerator::supportsPrecision( Precision p ) const
 ////////////////////////////////////////
 
 
+namespace
+{
+
+// the prelude is guarded so that batch entry points emitted one at
+// a time can be put in the same file
+const char *theBatchPrelude =
+	"#ifndef CTL_RESTRICT\n"
+	"# if defined(__GNUC__) || defined(_MSC_VER)\n"
+	"#  define CTL_RESTRICT __restrict\n"
+	"# else\n"
+	"#  define CTL_RESTRICT\n"
+	"# endif\n"
+	"#endif\n"
+	"#include <cstddef>\n";
+
+} // empty namespace
+
+
+std::string
+CPPGenerator::getBatchEntryPoints( void )
+{
+	std::stringstream batch;
+
+	batch <<
+		"\n"
+		"// Planar batch entry points: one array per varying argument,\n"
+		"// uniform arguments passed once for the whole batch\n"
+		<< theBatchPrelude;
+
+	for ( MainRoutineMap::const_iterator i = myMainRoutines.begin(); i != myMainRoutines.end(); ++i )
+		batch << batchEntryPoint( i->first, i->second.first, i->second.second );
+
+	return batch.str();
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+CPPGenerator::getBatchEntryPoint( const std::string &name )
+{
+	MainRoutineMap::const_iterator i = myMainRoutines.find( name );
+	if ( i == myMainRoutines.end() )
+		return std::string();
+
+	try
+	{
+		return theBatchPrelude + batchEntryPoint( i->first, i->second.first, i->second.second );
+	}
+	catch ( const std::logic_error & )
+	{
+		return std::string();
+	}
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+CPPGenerator::batchEntryPoint( const std::string &name,
+							   const std::string &nsName,
+							   const SymbolInfoPtr &fnInfo )
+{
+	std::stringstream batch;
+	FunctionTypePtr functionType = fnInfo->functionType();
+	const ParamVector &params = functionType->parameters();
+
+	batch << "\nvoid batch_" << name << "( size_t _count";
+	for ( size_t p = 0, N = params.size(); p != N; ++p )
+	{
+		const Param &parm = params[p];
+		if ( parm.varying )
+		{
+			CDataType_e t = parm.type->cDataType();
+			if ( t != FloatTypeEnum && t != HalfTypeEnum )
+				throw std::logic_error( "Unhandled varying type" );
+			batch << ", " << ( parm.access == RWA_READ ? "const " : "" )
+				  << "ctl_number_t * CTL_RESTRICT " << parm.name;
+			continue;
+		}
+
+		switch ( parm.type->cDataType() )
+		{
+			case FloatTypeEnum: batch << ", ctl_number_t " << parm.name; break;
+			case BoolTypeEnum: batch << ", bool " << parm.name; break;
+			default:
+				throw std::logic_error( "Sorry, argument type to main function for argument '" + parm.name + "' not yet handled" );
+		}
+	}
+	batch <<
+		" )\n"
+		"{\n"
+		"#pragma omp simd\n"
+		"    for ( size_t _i = 0; _i < _count; ++_i )\n"
+		"    {\n";
+	for ( size_t p = 0, N = params.size(); p != N; ++p )
+	{
+		const Param &parm = params[p];
+		if ( ! parm.varying )
+			continue;
+		batch << "        " << ( parm.type->cDataType() == HalfTypeEnum ? "half " : "ctl_number_t " )
+			  << parm.name << "_v";
+		if ( parm.access != RWA_WRITE )
+			batch << " = " << parm.name << "[_i]";
+		batch << ";\n";
+	}
+	batch << "        " << nsName << "( ";
+	for ( size_t p = 0, N = params.size(); p != N; ++p )
+	{
+		if ( p > 0 ) batch << ", ";
+		batch << params[p].name << ( params[p].varying ? "_v" : "" );
+	}
+	batch << " );\n";
+	for ( size_t p = 0, N = params.size(); p != N; ++p )
+	{
+		const Param &parm = params[p];
+		if ( parm.varying && parm.access != RWA_READ )
+			batch << "        " << parm.name << "[_i] = " << parm.name << "_v;\n";
+	}
+	batch <<
+		"    }\n"
+		"}\n";
+
+	return batch.str();
+}
+
+
+////////////////////////////////////////
+
+
 std::string
 CPPGenerator::getDriver( void )
 {
@@ -101,6 +233,7 @@ CPPGenerator::getDriver( void )
 		"#include <string>\n"
 		"#include <stdexcept>\n"
 		"#include <dpx.hh>\n";
+	driver << getBatchEntryPoints();
 	if ( myCPP11Mode )
 	{
 		
@@ -108,10 +241,17 @@ CPPGenerator::getDriver( void )
 			"#include <thread>\n"
 			"#include <mutex>\n"
 			"#include <condition_variable>\n"
+			"#include <atomic>\n"
+			"#ifdef __linux__\n"
+			"# include <pthread.h>\n"
+			"# include <sched.h>\n"
+			"# include <unistd.h>\n"
+			"#endif\n"
 			"\n"
 			"static std::condition_variable theWaitCond;\n"
 			"static std::condition_variable theWorkCond;\n"
-			"static size_t theFinishCount = 0;\n";
+			"static size_t theFinishCount = 0;\n"
+			"static std::atomic<int> theNextRow( 0 );\n";
 	}
 	else
 	{
@@ -121,11 +261,13 @@ CPPGenerator::getDriver( void )
 			"#endif\n"
 			"#include <errno.h>\n"
 			"#include <pthread.h>\n"
+			"#include <sched.h>\n"
 			"#include <unistd.h>\n"
 			"\n\n"
 			"static pthread_cond_t theWaitCond;\n"
 			"static pthread_cond_t theWorkCond;\n"
-			"static size_t theFinishCount = 0;\n";
+			"static size_t theFinishCount = 0;\n"
+			"static volatile int theNextRow = 0;\n";
 	}
 
 	driver <<
@@ -133,6 +275,40 @@ CPPGenerator::getDriver( void )
 		"typedef void(*dispatchFuncPtr)( int, int, ctl::dpx::fb<float> & );\n"
 		"static std::vector<dispatchFuncPtr> theWorkFunc;\n"
 		"static ctl::dpx::fb<float> *theWorkImage = NULL;\n"
+		"static int theTileRows = 8;\n"
+		"static bool thePinThreads = false;\n"
+		"\n"
+		"// The image is processed in tiles of theTileRows rows handed out\n"
+		"// from a shared counter, so threads that hit cheap rows simply\n"
+		"// take more tiles instead of idling at the end of a fixed band\n"
+		"static void runTiles( dispatchFuncPtr func, ctl::dpx::fb<float> &img )\n"
+		"{\n"
+		"    int h = img.height();\n"
+		"    int tile = theTileRows;\n"
+		"    while ( true )\n"
+		"    {\n";
+	if ( myCPP11Mode )
+		driver << "        int startY = theNextRow.fetch_add( tile );\n";
+	else
+		driver << "        int startY = __sync_fetch_and_add( &theNextRow, tile );\n";
+	driver <<
+		"        if ( startY >= h ) return;\n"
+		"        int endY = startY + tile < h ? startY + tile : h;\n"
+		"        (*func)( startY, endY, img );\n"
+		"    }\n"
+		"}\n"
+		"\n"
+		"#ifdef __linux__\n"
+		"static void pinThread( pthread_t thread, size_t i )\n"
+		"{\n"
+		"    long nCPU = sysconf( _SC_NPROCESSORS_ONLN );\n"
+		"    if ( nCPU < 1 ) return;\n"
+		"    cpu_set_t cpus;\n"
+		"    CPU_ZERO( &cpus );\n"
+		"    CPU_SET( i % size_t( nCPU ), &cpus );\n"
+		"    pthread_setaffinity_np( thread, sizeof( cpus ), &cpus );\n"
+		"}\n"
+		"#endif\n"
 		"\n";
 
 	if ( myCPP11Mode )
@@ -147,10 +323,8 @@ CPPGenerator::getDriver( void )
 			"    {\n"
 			"        dispatchFuncPtr curFunc = nullptr;\n"
 			"        ctl::dpx::fb<float> *curImg = nullptr;\n"
-			"        size_t nThreads = 1;\n"
 			"        {\n"
 			"            std::unique_lock<std::mutex> lk( theMutex );\n"
-			"            nThreads = theThreads.size();\n"
 			"            while ( ! theWorkFunc[i] )\n"
 			"            {\n"
 			"                if ( theThreads.empty() ) return;\n"
@@ -163,11 +337,7 @@ CPPGenerator::getDriver( void )
 			"        }\n"
 			"        if ( curFunc && curImg )\n"
 			"        {\n"
-			"            size_t nPer = ( curImg->height() + nThreads - 1 ) / nThreads;\n"
-			"            int startY = nPer * i;\n"
-			"            int endY = nPer * (i + 1);\n"
-			"            if ( i == nThreads - 1 ) endY = curImg->height();\n"
-			"            (*curFunc)( startY, endY, *curImg );\n"
+			"            runTiles( curFunc, *curImg );\n"
 			"            std::unique_lock<std::mutex> lk( theMutex );\n"
 			"            ++theFinishCount;\n"
 			"            theWaitCond.notify_one();\n"
@@ -189,7 +359,6 @@ CPPGenerator::getDriver( void )
 			"        dispatchFuncPtr curFunc = NULL;\n"
 			"        ctl::dpx::fb<float> *curImg = NULL;\n"
 			"        pthread_mutex_lock( &theMutex );\n"
-			"        size_t nThreads = theThreads.size();\n"
 			"        while ( ! theWorkFunc[i] )\n"
 			"        {\n"
 			"            if ( theThreads.empty() ) { pthread_mutex_unlock( &theMutex ); return NULL; }\n"
@@ -202,11 +371,7 @@ CPPGenerator::getDriver( void )
 			"        pthread_mutex_unlock( &theMutex );\n"
 			"        if ( curFunc && curImg )\n"
 			"        {\n"
-			"            size_t nPer = ( curImg->height() + nThreads - 1 ) / nThreads;\n"
-			"            int startY = nPer * i;\n"
-			"            int endY = nPer * (i + 1);\n"
-			"            if ( i == nThreads - 1 ) endY = curImg->height();\n"
-			"            (*curFunc)( startY, endY, *curImg );\n"
+			"            runTiles( curFunc, *curImg );\n"
 			"            pthread_mutex_lock( &theMutex );\n"
 			"            ++theFinishCount;\n"
 			"            pthread_cond_signal( &theWaitCond );\n"
@@ -237,7 +402,6 @@ CPPGenerator::getDriver( void )
 	for ( MainRoutineMap::const_iterator i = myMainRoutines.begin(); i != myMainRoutines.end(); ++i )
 	{
 		const std::string &name = i->first;
-		const std::string &nsName = i->second.first;
 		const SymbolInfoPtr &fnInfo = i->second.second;
 		FunctionTypePtr functionType = fnInfo->functionType();
 		const ParamVector &params = functionType->parameters();
@@ -298,6 +462,14 @@ CPPGenerator::getDriver( void )
 		for ( size_t i = 0; i != fargs.size(); ++i )
 			driver << "static ctl_number_t " << cName << "_" << fargs[i] << "_number = 0;\n";
 
+		// rows are split into planar scratch buffers so the work
+		// happens in the vectorizable batch function
+		std::vector<std::string> planes;
+		for ( int i = 0; i < maxCin; ++i )
+			planes.push_back( chanMapIn[i] );
+		for ( size_t i = 0; i != outargs.size(); ++i )
+			planes.push_back( outargs[i] );
+
 		driver <<
 			"static void dispatch_" << name << "( int startY, int endY, ctl::dpx::fb<float> &pixels )\n"
 			"{\n"
@@ -305,83 +477,46 @@ CPPGenerator::getDriver( void )
 			"    int w = pixels.width();\n"
 			"    int c = pixels.depth();\n"
 			"    int linesize = w * c;\n"
-			"    img += startY * linesize;\n";
-		if ( ! inargs.empty() )
-		{
-			driver << "    ctl_number_t ";
-			for ( size_t i = 0; i != inargs.size(); ++i )
-			{
-				if ( i > 0 ) driver << ", ";
-				driver << inargs[i];
-			}
-			driver << ";\n";
-		}
-		if ( ! inoutargs.empty() )
+			"    if ( c == 0 || w == 0 ) return;\n"
+			"    int nc = c < " << maxCin << " ? c : " << maxCin << ";\n"
+			"    img += startY * linesize;\n"
+			"    std::vector<ctl_number_t> planes( " << std::max( planes.size(), size_t( 1 ) ) << " * size_t( w ) );\n";
+		for ( size_t i = 0; i != planes.size(); ++i )
+			driver << "    ctl_number_t *" << planes[i] << "_p = &planes[" << i << " * size_t( w )];\n";
+		driver <<
+			"    for ( int y = startY; y < endY; ++y, img += linesize )\n"
+			"    {\n"
+			"        for ( int x = 0; x < w; ++x )\n"
+			"        {\n";
+		for ( int i = 0; i < maxCin; ++i )
+			driver << "            " << chanMapIn[i] << "_p[x] = ( " << i << " < nc ) ? img[x * c + " << i << "] : ctl_number_t( 0 );\n";
+		driver <<
+			"        }\n"
+			"        batch_" << name << "( size_t( w )";
+		for ( size_t i = 0, N = params.size(); i != N; ++i )
 		{
-			driver << "    ctl_number_t ";
-			for ( size_t i = 0; i != inoutargs.size(); ++i )
+			const Param &parm = params[i];
+			if ( parm.varying )
 			{
-				if ( i > 0 ) driver << ", ";
-				driver << inoutargs[i];
+				driver << ", " << parm.name << "_p";
+				continue;
 			}
-			driver << ";\n";
-		}
-		if ( ! outargs.empty() )
-		{
-			driver << "    ctl_number_t ";
-			for ( size_t i = 0; i != outargs.size(); ++i )
+			switch ( parm.type->cDataType() )
 			{
-				if ( i > 0 ) driver << ", ";
-				driver << outargs[i];
+				case FloatTypeEnum: driver << ", " << cName << "_" << parm.name << "_number"; break;
+				case BoolTypeEnum: driver << ", " << cName << "_" << parm.name << "_flag"; break;
+				default:
+					throw std::logic_error( "Sorry, argument type to main function for argument '" + parm.name + "' not yet handled" );
 			}
-			driver << ";\n";
 		}
-			
 		driver <<
-			"    switch ( c )\n"
-			"    {\n"
-			"        case 0: return;\n";
-		for ( int curC = 1; curC <= maxCin; ++curC )
-		{
-			driver << "        case " << curC << ":\n";
-			if ( curC == maxCin )
-				driver << "        default:\n";
-
-			driver <<
-				"            for ( int y = startY; y < endY; ++y )\n"
-				"                for ( int x = 0; x < w; ++x, img += c )\n"
-				"                {\n";
-			for ( int i = 0; i < curC; ++i )
-				driver << "                    " << chanMapIn[i] << " = img[" << i << "];\n";
-			for ( int i = curC; i < maxCin; ++i )
-				driver << "                    " << chanMapIn[i] << " = 0.0;\n";
-			driver << "                    " << nsName << "( ";
-			for ( size_t i = 0, N = params.size(); i != N; ++i )
-			{
-				if ( i > 0 ) driver << ", ";
-
-				const Param &parm = params[i];
-				if ( parm.varying )
-				{
-					driver << parm.name;
-					continue;
-				}
-				switch ( parm.type->cDataType() )
-				{
-					case FloatTypeEnum: driver << cName << "_" << parm.name << "_number"; break;
-					case BoolTypeEnum: driver << cName << "_" << parm.name << "_flag"; break;
-					default:
-						throw std::logic_error( "Sorry, argument type to main function for argument '" + parm.name + "' not yet handled" );
-				}
-			}
-			driver << " );\n";
-			for ( int i = 0; i < curC; ++i )
-				driver << "                    img[" << i << "] = " << chanMapOut[i] << ";\n";
-			driver <<
-				"                }\n"
-				"            break;\n";
-		}
+			" );\n"
+			"        for ( int x = 0; x < w; ++x )\n"
+			"        {\n";
+		for ( int i = 0; i < maxCout; ++i )
+			driver << "            if ( " << i << " < nc ) img[x * c + " << i << "] = " << chanMapOut[i] << "_p[x];\n";
 		driver <<
+			"        }\n"
 			"    }\n"
 			"}\n";
 		driver <<
@@ -419,7 +554,7 @@ CPPGenerator::getDriver( void )
 			"::setArgument( const std::string &arg, double v ) const\n"
 			"{\n";
 		for ( size_t i = 0; i != fargs.size(); ++i )
-			driver << "    if ( arg == \"" << fargs[i] << "\" ) " << cName << "_" << flags[i] << "_number = v;\n";
+			driver << "    if ( arg == \"" << fargs[i] << "\" ) " << cName << "_" << fargs[i] << "_number = v;\n";
 		driver <<
 			"}\n";
 
@@ -439,8 +574,12 @@ CPPGenerator::getDriver( void )
 				"        theWorkFunc[i] = &dispatch_" << name << ";\n"
 				"    theWorkImage = &pixels;\n"
 				"    theFinishCount = 0;\n"
+				"    theNextRow = 0;\n"
 				"    theWorkCond.notify_all();\n"
 				"    size_t N = theThreads.size();\n"
+				"    lk.unlock();\n"
+				"    runTiles( &dispatch_" << name << ", pixels );\n"
+				"    lk.lock();\n"
 				"    while ( theFinishCount != N ) theWaitCond.wait( lk );\n"
 				"    theWorkImage = NULL;\n";
 		}
@@ -459,7 +598,11 @@ CPPGenerator::getDriver( void )
 				"        theWorkFunc[i] = &dispatch_" << name << ";\n"
 				"    theWorkImage = &pixels;\n"
 				"    theFinishCount = 0;\n"
+				"    theNextRow = 0;\n"
 				"    pthread_cond_broadcast( &theWorkCond );\n"
+				"    pthread_mutex_unlock( &theMutex );\n"
+				"    runTiles( &dispatch_" << name << ", pixels );\n"
+				"    pthread_mutex_lock( &theMutex );\n"
 				"    while ( theFinishCount != N ) pthread_cond_wait( &theWaitCond, &theMutex );\n"
 				"    theWorkImage = NULL;\n"
 				"    theFinishCount = 0;\n"
@@ -478,6 +621,10 @@ CPPGenerator::getDriver( void )
 		"	Driver( void );\n"
 		"	~Driver( void );\n"
 		"	bool usesThreads( void ) const;\n"
+		"	// rows per unit of work, and whether worker threads are bound\n"
+		"	// to one CPU each; set before calling init\n"
+		"	void setTileRows( int rows );\n"
+		"	void setPinThreads( bool pin );\n"
 		"	void init( int threads );\n"
 		"	void shutdown( void );\n"
 		"	const std::vector<Function *> &getFunctions( void );\n"
@@ -485,6 +632,8 @@ CPPGenerator::getDriver( void )
 		"Driver::Driver( void ) {}\n"
 		"Driver::~Driver( void ) { shutdown(); }\n"
 		"bool Driver::usesThreads( void ) const { return true; }\n"
+		"void Driver::setTileRows( int rows ) { theTileRows = rows > 0 ? rows : 1; }\n"
+		"void Driver::setPinThreads( bool pin ) { thePinThreads = pin; }\n"
 		"const std::vector<Function *> &Driver::getFunctions( void )\n"
 		"{\n"
 		"    static std::vector<Function *> theFuncs;\n"
@@ -511,7 +660,12 @@ CPPGenerator::getDriver( void )
 			"    {\n"
 			"        theWorkFunc.resize( nThreads );\n"
 			"        for ( size_t i = 0, N = theThreads.size(); i != N; ++i )\n"
+			"        {\n"
 			"            theThreads[i] = std::thread( &threadLoop, i );\n"
+			"#ifdef __linux__\n"
+			"            if ( thePinThreads ) pinThread( theThreads[i].native_handle(), i );\n"
+			"#endif\n"
+			"        }\n"
 			"    }\n"
 			"}\n"
 			"void Driver::shutdown( void )\n"
@@ -543,7 +697,12 @@ CPPGenerator::getDriver( void )
 			"    {\n"
 			"        theWorkFunc.resize( nThreads );\n"
 			"        for ( size_t i = 0, N = theThreads.size(); i != N; ++i )\n"
+			"        {\n"
 			"            pthread_create( &theThreads[i], NULL, &threadLoop, reinterpret_cast<void *>( i ) );\n"
+			"#ifdef __linux__\n"
+			"            if ( thePinThreads ) pinThread( theThreads[i], i );\n"
+			"#endif\n"
+			"        }\n"
 			"    }\n"
 			"    pthread_mutex_unlock( &theMutex );\n"
 			"}\n"
@@ -582,6 +741,200 @@ CPPGenerator::getDriver( void )
 ////////////////////////////////////////
 
 
+std::string
+CPPGenerator::getTestHarness( void )
+{
+	std::stringstream harness;
+
+	harness << getBatchEntryPoints();
+	harness <<
+		"\n"
+		"// Automatically generated test harness: runs each batch entry\n"
+		"// point and the SIMD interpreter on the same random input and\n"
+		"// reports the largest relative difference. The CTL modules are\n"
+		"// found through CTL_MODULE_PATH.\n"
+		"//\n"
+		"// usage: <program> [count [tolerance]]\n"
+		"\n"
+		"#include <CtlSimdInterpreter.h>\n"
+		"#include <CtlFunctionCall.h>\n"
+		"#include <CtlType.h>\n"
+		"#include <Iex.h>\n"
+		"#include <vector>\n"
+		"#include <cmath>\n"
+		"#include <cstdio>\n"
+		"#include <cstdlib>\n"
+		"\n"
+		"static void harnessSet( Ctl::FunctionArgPtr &arg, size_t i, ctl_number_t v )\n"
+		"{\n"
+		"    if ( arg->type().cast<Ctl::HalfType>() )\n"
+		"        reinterpret_cast<half *>( arg->data() )[i] = half( float( v ) );\n"
+		"    else\n"
+		"        reinterpret_cast<float *>( arg->data() )[i] = float( v );\n"
+		"}\n"
+		"static ctl_number_t harnessGet( Ctl::FunctionArgPtr &arg, size_t i )\n"
+		"{\n"
+		"    if ( ! arg->isVarying() ) i = 0;\n"
+		"    if ( arg->type().cast<Ctl::HalfType>() )\n"
+		"        return float( reinterpret_cast<half *>( arg->data() )[i] );\n"
+		"    return reinterpret_cast<float *>( arg->data() )[i];\n"
+		"}\n"
+		"static double harnessError( ctl_number_t a, ctl_number_t b )\n"
+		"{\n"
+		"    double d = std::fabs( double( a ) - double( b ) );\n"
+		"    double m = std::fabs( double( b ) );\n"
+		"    return m > 1.0 ? d / m : d;\n"
+		"}\n";
+
+	std::vector<std::string> tests;
+	for ( MainRoutineMap::const_iterator i = myMainRoutines.begin(); i != myMainRoutines.end(); ++i )
+	{
+		const std::string &name = i->first;
+		const SymbolInfoPtr &fnInfo = i->second.second;
+		FunctionTypePtr functionType = fnInfo->functionType();
+		const ParamVector &params = functionType->parameters();
+
+		harness <<
+			"\n"
+			"static int test_" << name << "( size_t count, double tolerance )\n"
+			"{\n"
+			"    Ctl::SimdInterpreter interp;\n"
+			"    interp.loadModule( \"" << name << "\" );\n"
+			"    Ctl::FunctionCallPtr call;\n"
+			"    try { call = interp.newFunctionCall( \"main\" ); }\n"
+			"    catch ( const Iex::ArgExc & ) { call = interp.newFunctionCall( \"" << name << "\" ); }\n"
+			"    Ctl::FunctionArgPtr arg;\n";
+
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( parm.varying )
+			{
+				harness << "    std::vector<ctl_number_t> v_" << parm.name << "( count );\n";
+				if ( parm.access != RWA_WRITE )
+					harness << "    for ( size_t k = 0; k != count; ++k ) v_" << parm.name << "[k] = ctl_number_t( rand() ) / ctl_number_t( RAND_MAX );\n";
+				if ( parm.access != RWA_READ )
+					harness << "    std::vector<ctl_number_t> ref_" << parm.name << "( v_" << parm.name << " );\n";
+				continue;
+			}
+
+			// uniforms use the defaults from the CTL code
+			harness << "    arg = call->findInputArg( \"" << parm.name << "\" );\n";
+			switch ( parm.type->cDataType() )
+			{
+				case FloatTypeEnum:
+					harness <<
+						"    if ( arg->hasDefaultValue() ) arg->setDefaultValue(); else harnessSet( arg, 0, 0.5 );\n"
+						"    ctl_number_t u_" << parm.name << " = harnessGet( arg, 0 );\n";
+					break;
+				case BoolTypeEnum:
+					harness <<
+						"    if ( arg->hasDefaultValue() ) arg->setDefaultValue(); else *reinterpret_cast<bool *>( arg->data() ) = false;\n"
+						"    bool u_" << parm.name << " = *reinterpret_cast<bool *>( arg->data() );\n";
+					break;
+				default:
+					throw std::logic_error( "Sorry, argument type to main function for argument '" + parm.name + "' not yet handled" );
+			}
+		}
+
+		harness << "    batch_" << name << "( count";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( parm.varying )
+				harness << ", count ? &v_" << parm.name << "[0] : NULL";
+			else
+				harness << ", u_" << parm.name;
+		}
+		harness << " );\n";
+
+		harness <<
+			"    size_t maxSamples = interp.maxSamples();\n"
+			"    for ( size_t off = 0; off < count; off += maxSamples )\n"
+			"    {\n"
+			"        size_t n = count - off < maxSamples ? count - off : maxSamples;\n";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( ! parm.varying || parm.access == RWA_WRITE )
+				continue;
+			if ( parm.access == RWA_READ )
+				harness << "        arg = call->findInputArg( \"" << parm.name << "\" );\n";
+			else
+				harness << "        arg = call->findOutputArg( \"" << parm.name << "\" );\n";
+			harness <<
+				"        arg->setVarying( true );\n"
+				"        for ( size_t k = 0; k != n; ++k ) harnessSet( arg, k, ";
+			if ( parm.access == RWA_READ )
+				harness << "v_" << parm.name;
+			else
+				harness << "ref_" << parm.name;
+			harness << "[off + k] );\n";
+		}
+		harness << "        call->callFunction( n );\n";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( ! parm.varying || parm.access == RWA_READ )
+				continue;
+			harness <<
+				"        arg = call->findOutputArg( \"" << parm.name << "\" );\n"
+				"        for ( size_t k = 0; k != n; ++k ) ref_" << parm.name << "[off + k] = harnessGet( arg, k );\n";
+		}
+		harness <<
+			"    }\n"
+			"    double maxErr = 0.0;\n";
+		for ( size_t p = 0, N = params.size(); p != N; ++p )
+		{
+			const Param &parm = params[p];
+			if ( ! parm.varying || parm.access == RWA_READ )
+				continue;
+			harness <<
+				"    for ( size_t k = 0; k != count; ++k )\n"
+				"    {\n"
+				"        double e = harnessError( v_" << parm.name << "[k], ref_" << parm.name << "[k] );\n"
+				"        if ( ! ( e <= maxErr ) ) maxErr = e;\n"
+				"    }\n";
+		}
+		harness <<
+			"    bool ok = maxErr <= tolerance;\n"
+			"    printf( \"" << name << ": max error %g %s\\n\", maxErr, ok ? \"ok\" : \"FAILED\" );\n"
+			"    return ok ? 0 : 1;\n"
+			"}\n";
+		tests.push_back( "test_" + name );
+	}
+
+	harness <<
+		"\n"
+		"int main( int argc, char *argv[] )\n"
+		"{\n"
+		"    size_t count = 100000;\n"
+		"    double tolerance = 1e-4;\n"
+		"    if ( argc > 1 ) count = strtoul( argv[1], NULL, 10 );\n"
+		"    if ( argc > 2 ) tolerance = atof( argv[2] );\n"
+		"    srand( 1 );\n"
+		"    int failures = 0;\n"
+		"    try\n"
+		"    {\n";
+	for ( size_t i = 0; i != tests.size(); ++i )
+		harness << "        failures += " << tests[i] << "( count, tolerance );\n";
+	harness <<
+		"    }\n"
+		"    catch ( const std::exception &e )\n"
+		"    {\n"
+		"        fprintf( stderr, \"%s\\n\", e.what() );\n"
+		"        return 2;\n"
+		"    }\n"
+		"    return failures ? 1 : 0;\n"
+		"}\n";
+
+	return harness.str();
+}
+
+
+////////////////////////////////////////
+
+
 void
 CPPGenerator::addStandardIncludes( void )
 {
@@ -595,157 +948,161 @@ CPPGenerator::addStandardIncludes( void )
 ////////////////////////////////////////
 
 
-//void
-//CPPGenerator::defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string & precSuffix )
-//{
-//	types.push_back( TypeDefinition( "ctl_vec2f_t",
-//"struct ctl_vec2f_t\n"
-//"{\n"
-//"    inline ctl_vec2f_t( void ) : x( 0 ), y( 0 ) {}\n"
-//"    inline ctl_vec2f_t( ctl_number_t a, ctl_number_t b ) : x( a ), y( b ) {}\n"
-//"    inline ctl_number_t &operator[]( int i ) { return vals[i]; }\n"
-//"    inline ctl_number_t operator[]( int i ) const { return vals[i]; }\n"
-//"    union\n"
-//"    {\n"
-//"        ctl_number_t vals[2];\n"
-//"        struct\n"
-//"        {\n"
-//"            ctl_number_t x;\n"
-//"            ctl_number_t y;\n"
-//"        };\n"
-//"    };\n"
-//"};" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_vec2i_t",
-//"struct ctl_vec2i_t\n"
-//"{\n"
-//"    inline ctl_vec2i_t( void ) : x( 0 ), y( 0 ) {}\n"
-//"    inline ctl_vec2i_t( int a, int b ) : x( a ), y( b ) {}\n"
-//"    inline int &operator[]( int i ) { return vals[i]; }\n"
-//"    inline int operator[]( int i ) const { return vals[i]; }\n"
-//"    union\n"
-//"    {\n"
-//"        int vals[2];\n"
-//"        struct\n"
-//"        {\n"
-//"            int x;\n"
-//"            int y;\n"
-//"        };\n"
-//"    };\n"
-//"};", funcPref + "ctl_vec2i_t make_vec2i( int x, int y ) { return ctl_vec2i_t( x, y ); }" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_vec3f_t",
-//"struct ctl_vec3f_t\n"
-//"{\n"
-//"    inline ctl_vec3f_t( void ) : x( 0 ), y( 0 ), z( 0 ) {}\n"
-//"    inline ctl_vec3f_t( ctl_number_t a, ctl_number_t b, ctl_number_t c ) : x( a ), y( b ), z( c ) {}\n"
-//"    inline ctl_number_t &operator[]( int i ) { return vals[i]; }\n"
-//"    inline ctl_number_t operator[]( int i ) const { return vals[i]; }\n"
-//"    union\n"
-//"    {\n"
-//"        ctl_number_t vals[3];\n"
-//"        struct\n"
-//"        {\n"
-//"            ctl_number_t x;\n"
-//"            ctl_number_t y;\n"
-//"            ctl_number_t z;\n"
-//"        };\n"
-//"    };\n"
-//"};", funcPref + "ctl_vec3f_t make_vec3f( ctl_number_t x, ctl_number_t y, ctl_number_t z ) { return ctl_vec3f_t( x, y, z ); }" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_vec3i_t",
-//"struct ctl_vec3i_t\n"
-//"{\n"
-//"    inline ctl_vec3i_t( void ) : x( 0 ), y( 0 ), z( 0 ) {}\n"
-//"    inline ctl_vec3i_t( int a, int b, int c ) : x( a ), y( b ), z( c ) {}\n"
-//"    inline int &operator[]( int i ) { return vals[i]; }\n"
-//"    inline int operator[]( int i ) const { return vals[i]; }\n"
-//"    union\n"
-//"    {\n"
-//"        int vals[3];\n"
-//"        struct\n"
-//"        {\n"
-//"            int x;\n"
-//"            int y;\n"
-//"            int z;\n"
-//"        };\n"
-//"    };\n"
-//"};", funcPref + "ctl_vec3i_t make_vec3i( int x, int y, int z ) { return ctl_vec3i_t( x, y, z ); }" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_vec4f_t",
-//"struct ctl_vec4f_t\n"
-//"{\n"
-//"    inline ctl_vec4f_t( void ) : x( 0 ), y( 0 ), z( 0 ), w( 0 ) {}\n"
-//"    inline ctl_vec4f_t( ctl_number_t a, ctl_number_t b, ctl_number_t c, ctl_number_t d ) : x( a ), y( b ), z( c ), w( d ) {}\n"
-//"    inline ctl_number_t &operator[]( int i ) { return vals[i]; }\n"
-//"    inline ctl_number_t operator[]( int i ) const { return vals[i]; }\n"
-//"    union\n"
-//"    {\n"
-//"        ctl_number_t vals[4];\n"
-//"        struct\n"
-//"        {\n"
-//"            ctl_number_t x;\n"
-//"            ctl_number_t y;\n"
-//"            ctl_number_t z;\n"
-//"            ctl_number_t w;\n"
-//"        };\n"
-//"    };\n"
-//"};" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_vec4i_t",
-//"struct ctl_vec4i_t\n"
-//"{\n"
-//"    inline ctl_vec4i_t( void ) : x( 0 ), y( 0 ), z( 0 ), w( 0 ) {}\n"
-//"    inline ctl_vec4i_t( int a, int b, int c, int d ) : x( a ), y( b ), z( c ), w( d ) {}\n"
-//"    inline int &operator[]( int i ) { return vals[i]; }\n"
-//"    inline int operator[]( int i ) const { return vals[i]; }\n"
-//"    union\n"
-//"    {\n"
-//"        int vals[4];\n"
-//"        struct\n"
-//"        {\n"
-//"            int x;\n"
-//"            int y;\n"
-//"            int z;\n"
-//"            int w;\n"
-//"        };\n"
-//"    };\n"
-//"};" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_mat33f_t",
-//"struct ctl_mat33f_t\n"
-//"{\n"
-//"    inline ctl_mat33f_t( void ) { identity(); }\n"
-//"    inline ctl_mat33f_t( ctl_number_t m00, ctl_number_t m01, ctl_number_t m02, ctl_number_t m10, ctl_number_t m11, ctl_number_t m12, ctl_number_t m20, ctl_number_t m21, ctl_number_t m22 ) { vals[0][0] = m00; vals[0][1] = m01; vals[0][2] = m02; vals[1][0] = m10; vals[1][1] = m11; vals[1][2] = m12; vals[2][0] = m20; vals[2][1] = m21; vals[2][2] = m22; }\n"
-//"    inline void identity( void ) { vals[0][0] = vals[1][1] = vals[2][2] = ctl_number_t(1); vals[0][1] = vals[0][2] = vals[1][0] = vals[1][1] = vals[1][2] = vals[2][0] = vals[2][1] = vals[2][2] = ctl_number_t(0); }\n"
-//"    inline ctl_number_t *operator[]( int i ) { return vals[i]; }\n"
-//"    inline const ctl_number_t *operator[]( int i ) const { return vals[i]; }\n"
-//"    ctl_number_t vals[3][3];\n"
-//"};" ) );
-//
-//	types.push_back( TypeDefinition( "ctl_mat44f_t",
-//"struct ctl_mat44f_t\n"
-//"{\n"
-//"    inline ctl_mat44f_t( void ) { identity(); }\n"
-//"    inline ctl_mat44f_t( ctl_number_t m00, ctl_number_t m01, ctl_number_t m02, ctl_number_t m03, ctl_number_t m10, ctl_number_t m11, ctl_number_t m12, ctl_number_t m13, ctl_number_t m20, ctl_number_t m21, ctl_number_t m22, ctl_number_t m23, ctl_number_t m30, ctl_number_t m31, ctl_number_t m32, ctl_number_t m33 ) { vals[0][0] = m00; vals[0][1] = m01; vals[0][2] = m02; vals[0][3] = m03; vals[1][0] = m10; vals[1][1] = m11; vals[1][2] = m12; vals[1][3] = m13; vals[2][0] = m20; vals[2][1] = m21; vals[2][2] = m22; vals[2][3] = m23; vals[3][0] = m30; vals[3][1] = m31; vals[3][2] = m32; vals[3][3] = m33; }\n"
-//"    inline void identity( void )\n"
-//"    {\n"
-//"        for ( int i = 0; i < 4; ++i )\n"
-//"            for ( int j = 0; j < 4; ++j )\n"
-//"                vals[i][j] = (i == j) ? ctl_number_t(1) : ctl_number_t(0);\n"
-//"    }\n"
-//"    inline ctl_number_t *operator[]( int i ) { return vals[i]; }\n"
-//"    inline const ctl_number_t *operator[]( int i ) const { return vals[i]; }\n"
-//"    ctl_number_t vals[4][4];\n"
-//"};" ) );
-//
-//	types.push_back( TypeDefinition( "Chromaticities", "struct Chromaticities { ctl_vec2f_t red; ctl_vec2f_t green; ctl_vec2f_t blue; ctl_vec2f_t white; };" ) );
-//	types.back().moduleUsage[NULL].types.insert( "ctl_vec2f_t" );
+void
+CPPGenerator::defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string & precSuffix )
+{
+	types[StdType::Int] = TypeDefinition( "int", "" );
+	types[StdType::Float] = TypeDefinition( "ctl_number_t", "" );
+
+	types[StdType::Vec2f] = TypeDefinition( "ctl_vec2f_t",
+"struct ctl_vec2f_t\n"
+"{\n"
+"    inline ctl_vec2f_t( void ) : x( 0 ), y( 0 ) {}\n"
+"    inline ctl_vec2f_t( ctl_number_t a, ctl_number_t b ) : x( a ), y( b ) {}\n"
+"    inline ctl_number_t &operator[]( int i ) { return vals[i]; }\n"
+"    inline ctl_number_t operator[]( int i ) const { return vals[i]; }\n"
+"    union\n"
+"    {\n"
+"        ctl_number_t vals[2];\n"
+"        struct\n"
+"        {\n"
+"            ctl_number_t x;\n"
+"            ctl_number_t y;\n"
+"        };\n"
+"    };\n"
+"};", funcPref + "ctl_vec2f_t make_vec2f( ctl_number_t x, ctl_number_t y ) { return ctl_vec2f_t( x, y ); }" );
+
+	types[StdType::Vec2i] = TypeDefinition( "ctl_vec2i_t",
+"struct ctl_vec2i_t\n"
+"{\n"
+"    inline ctl_vec2i_t( void ) : x( 0 ), y( 0 ) {}\n"
+"    inline ctl_vec2i_t( int a, int b ) : x( a ), y( b ) {}\n"
+"    inline int &operator[]( int i ) { return vals[i]; }\n"
+"    inline int operator[]( int i ) const { return vals[i]; }\n"
+"    union\n"
+"    {\n"
+"        int vals[2];\n"
+"        struct\n"
+"        {\n"
+"            int x;\n"
+"            int y;\n"
+"        };\n"
+"    };\n"
+"};", funcPref + "ctl_vec2i_t make_vec2i( int x, int y ) { return ctl_vec2i_t( x, y ); }" );
+
+	types[StdType::Vec3f] = TypeDefinition( "ctl_vec3f_t",
+"struct ctl_vec3f_t\n"
+"{\n"
+"    inline ctl_vec3f_t( void ) : x( 0 ), y( 0 ), z( 0 ) {}\n"
+"    inline ctl_vec3f_t( ctl_number_t a, ctl_number_t b, ctl_number_t c ) : x( a ), y( b ), z( c ) {}\n"
+"    inline ctl_number_t &operator[]( int i ) { return vals[i]; }\n"
+"    inline ctl_number_t operator[]( int i ) const { return vals[i]; }\n"
+"    union\n"
+"    {\n"
+"        ctl_number_t vals[3];\n"
+"        struct\n"
+"        {\n"
+"            ctl_number_t x;\n"
+"            ctl_number_t y;\n"
+"            ctl_number_t z;\n"
+"        };\n"
+"    };\n"
+"};", funcPref + "ctl_vec3f_t make_vec3f( ctl_number_t x, ctl_number_t y, ctl_number_t z ) { return ctl_vec3f_t( x, y, z ); }" );
+
+	types[StdType::Vec3i] = TypeDefinition( "ctl_vec3i_t",
+"struct ctl_vec3i_t\n"
+"{\n"
+"    inline ctl_vec3i_t( void ) : x( 0 ), y( 0 ), z( 0 ) {}\n"
+"    inline ctl_vec3i_t( int a, int b, int c ) : x( a ), y( b ), z( c ) {}\n"
+"    inline int &operator[]( int i ) { return vals[i]; }\n"
+"    inline int operator[]( int i ) const { return vals[i]; }\n"
+"    union\n"
+"    {\n"
+"        int vals[3];\n"
+"        struct\n"
+"        {\n"
+"            int x;\n"
+"            int y;\n"
+"            int z;\n"
+"        };\n"
+"    };\n"
+"};", funcPref + "ctl_vec3i_t make_vec3i( int x, int y, int z ) { return ctl_vec3i_t( x, y, z ); }" );
+
+	types[StdType::Vec4f] = TypeDefinition( "ctl_vec4f_t",
+"struct ctl_vec4f_t\n"
+"{\n"
+"    inline ctl_vec4f_t( void ) : x( 0 ), y( 0 ), z( 0 ), w( 0 ) {}\n"
+"    inline ctl_vec4f_t( ctl_number_t a, ctl_number_t b, ctl_number_t c, ctl_number_t d ) : x( a ), y( b ), z( c ), w( d ) {}\n"
+"    inline ctl_number_t &operator[]( int i ) { return vals[i]; }\n"
+"    inline ctl_number_t operator[]( int i ) const { return vals[i]; }\n"
+"    union\n"
+"    {\n"
+"        ctl_number_t vals[4];\n"
+"        struct\n"
+"        {\n"
+"            ctl_number_t x;\n"
+"            ctl_number_t y;\n"
+"            ctl_number_t z;\n"
+"            ctl_number_t w;\n"
+"        };\n"
+"    };\n"
+"};", funcPref + "ctl_vec4f_t make_vec4f( ctl_number_t x, ctl_number_t y, ctl_number_t z, ctl_number_t w ) { return ctl_vec4f_t( x, y, z, w ); }" );
+
+	types[StdType::Vec4i] = TypeDefinition( "ctl_vec4i_t",
+"struct ctl_vec4i_t\n"
+"{\n"
+"    inline ctl_vec4i_t( void ) : x( 0 ), y( 0 ), z( 0 ), w( 0 ) {}\n"
+"    inline ctl_vec4i_t( int a, int b, int c, int d ) : x( a ), y( b ), z( c ), w( d ) {}\n"
+"    inline int &operator[]( int i ) { return vals[i]; }\n"
+"    inline int operator[]( int i ) const { return vals[i]; }\n"
+"    union\n"
+"    {\n"
+"        int vals[4];\n"
+"        struct\n"
+"        {\n"
+"            int x;\n"
+"            int y;\n"
+"            int z;\n"
+"            int w;\n"
+"        };\n"
+"    };\n"
+"};", funcPref + "ctl_vec4i_t make_vec4i( int x, int y, int z, int w ) { return ctl_vec4i_t( x, y, z, w ); }" );
+
+	types[StdType::Mat3f] = TypeDefinition( "ctl_mat33f_t",
+"struct ctl_mat33f_t\n"
+"{\n"
+"    inline ctl_mat33f_t( void ) { identity(); }\n"
+"    inline ctl_mat33f_t( ctl_number_t m00, ctl_number_t m01, ctl_number_t m02, ctl_number_t m10, ctl_number_t m11, ctl_number_t m12, ctl_number_t m20, ctl_number_t m21, ctl_number_t m22 ) { vals[0][0] = m00; vals[0][1] = m01; vals[0][2] = m02; vals[1][0] = m10; vals[1][1] = m11; vals[1][2] = m12; vals[2][0] = m20; vals[2][1] = m21; vals[2][2] = m22; }\n"
+"    inline void identity( void ) { vals[0][0] = vals[1][1] = vals[2][2] = ctl_number_t(1); vals[0][1] = vals[0][2] = vals[1][0] = vals[1][2] = vals[2][0] = vals[2][1] = ctl_number_t(0); }\n"
+"    inline ctl_number_t *operator[]( int i ) { return vals[i]; }\n"
+"    inline const ctl_number_t *operator[]( int i ) const { return vals[i]; }\n"
+"    ctl_number_t vals[3][3];\n"
+"};", funcPref + "ctl_mat33f_t make_mat33f( ctl_number_t m00, ctl_number_t m01, ctl_number_t m02, ctl_number_t m10, ctl_number_t m11, ctl_number_t m12, ctl_number_t m20, ctl_number_t m21, ctl_number_t m22 ) { return ctl_mat33f_t( m00, m01, m02, m10, m11, m12, m20, m21, m22 ); }" );
+
+	types[StdType::Mat4f] = TypeDefinition( "ctl_mat44f_t",
+"struct ctl_mat44f_t\n"
+"{\n"
+"    inline ctl_mat44f_t( void ) { identity(); }\n"
+"    inline ctl_mat44f_t( ctl_number_t m00, ctl_number_t m01, ctl_number_t m02, ctl_number_t m03, ctl_number_t m10, ctl_number_t m11, ctl_number_t m12, ctl_number_t m13, ctl_number_t m20, ctl_number_t m21, ctl_number_t m22, ctl_number_t m23, ctl_number_t m30, ctl_number_t m31, ctl_number_t m32, ctl_number_t m33 ) { vals[0][0] = m00; vals[0][1] = m01; vals[0][2] = m02; vals[0][3] = m03; vals[1][0] = m10; vals[1][1] = m11; vals[1][2] = m12; vals[1][3] = m13; vals[2][0] = m20; vals[2][1] = m21; vals[2][2] = m22; vals[2][3] = m23; vals[3][0] = m30; vals[3][1] = m31; vals[3][2] = m32; vals[3][3] = m33; }\n"
+"    inline void identity( void )\n"
+"    {\n"
+"        for ( int i = 0; i < 4; ++i )\n"
+"            for ( int j = 0; j < 4; ++j )\n"
+"                vals[i][j] = (i == j) ? ctl_number_t(1) : ctl_number_t(0);\n"
+"    }\n"
+"    inline ctl_number_t *operator[]( int i ) { return vals[i]; }\n"
+"    inline const ctl_number_t *operator[]( int i ) const { return vals[i]; }\n"
+"    ctl_number_t vals[4][4];\n"
+"};", funcPref + "ctl_mat44f_t make_mat44f( ctl_number_t m00, ctl_number_t m01, ctl_number_t m02, ctl_number_t m03, ctl_number_t m10, ctl_number_t m11, ctl_number_t m12, ctl_number_t m13, ctl_number_t m20, ctl_number_t m21, ctl_number_t m22, ctl_number_t m23, ctl_number_t m30, ctl_number_t m31, ctl_number_t m32, ctl_number_t m33 ) { return ctl_mat44f_t( m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33 ); }" );
+
+	types[StdType::Chromaticities] = TypeDefinition( "Chromaticities", "struct Chromaticities { ctl_vec2f_t red; ctl_vec2f_t green; ctl_vec2f_t blue; ctl_vec2f_t white; };" );
+	types[StdType::Chromaticities].moduleUsage[NULL].types.insert( "ctl_vec2f_t" );
+
 //	types.push_back( TypeDefinition( "Box2i", "struct Box2i { ctl_vec2i_t min; ctl_vec2i_t max; };" ) );
 //	types.back().moduleUsage[NULL].types.insert( "ctl_vec2i_t" );
 //	types.push_back( TypeDefinition( "Box2f", "struct Box2f { ctl_vec2f_t min; ctl_vec2f_t max; };" ) );
 //	types.back().moduleUsage[NULL].types.insert( "ctl_vec2f_t" );
-//}
+}
 
 
 ////////////////////////////////////////
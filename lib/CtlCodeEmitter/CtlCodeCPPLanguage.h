@@ -62,10 +62,12 @@ public:
 	virtual bool supportsPrecision( Precision p ) const;
 
 	virtual std::string getDriver( void );
+	virtual std::string getTestHarness( void );
+	virtual std::string getBatchEntryPoint( const std::string &name );
 
 protected:
 	virtual void addStandardIncludes( void );
-//	virtual void defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string & precSuffix );
+	virtual void defineStandardTypes( std::map<StdType, TypeDefinition> &types, const std::string &funcPref, const std::string &precSuffix );
 	virtual void getStandardPrintBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
 
 	virtual bool usesFunctionInitializers( void ) const;
@@ -90,6 +92,15 @@ protected:
 	virtual const std::string &endComment( void ) const;
 
 private:
+	// planar batch_<name> functions for the main routines, used by
+	// both the driver and the test harness
+	std::string getBatchEntryPoints( void );
+	// batch_<name> for one main routine, throws std::logic_error
+	// for argument types it doesn't handle
+	std::string batchEntryPoint( const std::string &name,
+								 const std::string &nsName,
+								 const SymbolInfoPtr &fnInfo );
+
 	bool myCPP11Mode;
 };
 
@@ -68,12 +68,22 @@ CodeFunctionCall::CodeFunctionCall( CodeInterpreter &interpreter,
 									CodeInstAddrPtr addr,
 									SymbolTable &symbols )
 		: FunctionCall( name ),
+		  _interpreter( interpreter ),
+		  _type( type ),
+		  _addr( addr ),
 		  _entryPoint( addr->inst() ),
 		  _symbols( symbols )
 {
 }
 
 
+FunctionCallPtr
+CodeFunctionCall::clone( void ) const
+{
+    return new CodeFunctionCall( _interpreter, name(), _type, _addr, _symbols );
+}
+
+
 void	
 CodeFunctionCall::callFunction( size_t numSamples )
 {
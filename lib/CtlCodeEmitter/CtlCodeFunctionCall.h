@@ -75,8 +75,12 @@ public:
 					  SymbolTable &symbols );
 
     virtual void callFunction( size_t numSamples );
+    virtual FunctionCallPtr clone( void ) const;
 
 private:
+    CodeInterpreter &_interpreter;
+    FunctionTypePtr _type;
+    CodeInstAddrPtr _addr;
     const CodeInst *	_entryPoint;
     SymbolTable &_symbols;
 };
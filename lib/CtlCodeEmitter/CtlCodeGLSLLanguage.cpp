@@ -46,6 +46,7 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include "CtlCodeGLSLLanguage.h"
+#include <cassert>
 
 namespace Ctl
 {
@@ -58,6 +58,7 @@
 #include "CtlCodeFunctionCall.h"
 #include "CtlCodeStdLibrary.h"
 
+#include "CtlCodeC99Language.h"
 #include "CtlCodeCPPLanguage.h"
 #include "CtlCodeCUDALanguage.h"
 #include "CtlCodeGLSLLanguage.h"
@@ -76,9 +77,10 @@ namespace Ctl {
 
 CodeInterpreter::CodeInterpreter( void )
 		: Interpreter(), myLanguage( CPP03 ), myLanguageGenerator( NULL ),
-		  myCalledOnly( false )
+		  myCalledOnly( false ), myPrecalculate( true )
 {
 	myLanguageGenerator = new CPPGenerator( false );
+	myLanguageGenerator->setConstantInterpreter( &mySimdInterpreter );
 }
 
 
@@ -135,8 +137,10 @@ CodeInterpreter::setLanguage( Language l )
 	switch ( l )
 	{
 		case C89:
-		case C99:
 			throw std::logic_error( "Sorry, not implemented yet" );
+		case C99:
+			myLanguageGenerator = new C99Generator;
+			break;
 		case CPP03:
 			myLanguageGenerator = new CPPGenerator( false );
 			break;
@@ -158,6 +162,18 @@ CodeInterpreter::setLanguage( Language l )
 			break;
 	}
 	myLanguageGenerator->setPrecision( curPrec );
+	myLanguageGenerator->setConstantInterpreter( myPrecalculate ? &mySimdInterpreter : NULL );
+}
+
+
+////////////////////////////////////////
+
+
+void
+CodeInterpreter::setPrecalculateConstants( bool on_off )
+{
+	myPrecalculate = on_off;
+	myLanguageGenerator->setConstantInterpreter( myPrecalculate ? &mySimdInterpreter : NULL );
 }
 
 
@@ -169,6 +185,7 @@ CodeInterpreter::isDriverEnabledForLanguage( void ) const
 {
 	switch ( myLanguage )
 	{
+		case C99:
 		case CPP03:
 		case CPP11:
 			return true;
@@ -177,7 +194,6 @@ CodeInterpreter::isDriverEnabledForLanguage( void ) const
 			return true;
 
 		case C89:
-		case C99:
 		case OPENCL:
 		case GLSL:
 		case CUDA:
@@ -273,6 +289,16 @@ CodeInterpreter::emitDriverCode( std::ostream &out )
 ////////////////////////////////////////
 
 
+void
+CodeInterpreter::emitTestHarness( std::ostream &out )
+{
+	out << myLanguageGenerator->getTestHarness();
+}
+
+
+////////////////////////////////////////
+
+
 Module *
 CodeInterpreter::newModule( const std::string &moduleName,
 							const std::string &fileName )
@@ -113,6 +113,13 @@ public:
 	inline void setCalledOnly( bool on_off ) { myCalledOnly = on_off; }
 	inline bool isCalledOnly( void ) const { return myCalledOnly; }
 
+	// if set to true (the default), global constants computed in
+	// the modules are emitted as their values, as evaluated by the
+	// interpreter, instead of the code computing them. Must be set
+	// before the modules are loaded
+	void setPrecalculateConstants( bool on_off );
+	inline bool isPrecalculatingConstants( void ) const { return myPrecalculate; }
+
 	// emits function definitions suitable for
 	// compiling the generated code into a library
 	// if appropriate for the language
@@ -124,6 +131,22 @@ public:
 	// Utility driver code emission
 	void emitDriverCode( std::ostream &out );
 
+	// Test program checking the emitted code against the SIMD
+	// interpreter, emitted after the main body of code instead of
+	// the driver
+	void emitTestHarness( std::ostream &out );
+
+	// The main routines of the loaded modules, valid after
+	// code has been emitted
+	const LanguageGenerator::MainRoutineMap &getMainRoutines( void ) const
+	{ return myLanguageGenerator->getMainRoutines(); }
+
+	// Planar batch entry point for one of the main routines, see
+	// LanguageGenerator::getBatchEntryPoint.  Valid after code has
+	// been emitted
+	std::string getBatchEntryPoint( const std::string &name )
+	{ return myLanguageGenerator->getBatchEntryPoint( name ); }
+
 private:
     virtual FunctionCallPtr	newFunctionCallInternal( const SymbolInfoPtr info,
 													 const std::string &functionName );
@@ -138,6 +161,7 @@ private:
 	SimdInterpreter mySimdInterpreter;
 	LanguageGenerator *myLanguageGenerator;
 	bool myCalledOnly;
+	bool myPrecalculate;
 };
 
 } // namespace Ctl
@@ -53,7 +53,7 @@ namespace Ctl
 {
 
 LanguageGenerator::LanguageGenerator( void )
-		: myPrecision( FLOAT ), myCurIndent( 0 ), myIndent( "    " )
+		: myConstantInterpreter( NULL ), myPrecision( FLOAT ), myCurIndent( 0 ), myIndent( "    " )
 {
 }
 
@@ -121,6 +121,26 @@ LanguageGenerator::getDriver( void )
 ////////////////////////////////////////
 
 
+std::string
+LanguageGenerator::getTestHarness( void )
+{
+	return std::string();
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+LanguageGenerator::getBatchEntryPoint( const std::string &name )
+{
+	return std::string();
+}
+
+
+////////////////////////////////////////
+
+
 void
 LanguageGenerator::addIndent( void )
 {
@@ -60,6 +60,7 @@ namespace Ctl
 {
 
 class CodeLContext;
+class SimdInterpreter;
 
 class LanguageGenerator
 {
@@ -87,6 +88,12 @@ public:
 
 	inline const MainRoutineMap &getMainRoutines( void ) const { return myMainRoutines; }
 
+	// Interpreter that has loaded (and so initialized) the same
+	// modules. When set, constant data computed by the module
+	// initializers is emitted as literal values instead of the
+	// initializer code
+	inline void setConstantInterpreter( SimdInterpreter *interp ) { myConstantInterpreter = interp; }
+
 	// any necessary setup, i.e. ifdef __cplusplus extern "C" stuff
 	virtual std::string getHeaderPrefix( void ) const;
 	// Should just be the setup code (i.e. forward decls
@@ -104,6 +111,15 @@ public:
 
 	virtual std::string getDriver( void );
 
+	// Stand-alone program comparing the generated code against the
+	// SIMD interpreter, empty if the language doesn't provide one
+	virtual std::string getTestHarness( void );
+
+	// Planar batch_<name> function for the main routine name, looping
+	// over arrays of the varying arguments. Empty if the language or
+	// the routine's argument types don't provide one
+	virtual std::string getBatchEntryPoint( const std::string &name );
+
 	virtual void pushBlock( void ) = 0;
 	virtual void popBlock( void ) = 0;
 
@@ -142,8 +158,6 @@ public:
 
 	virtual void emitToken( Token t ) = 0;
 
-    virtual bool precalculate( const std::string&, const ExprNodeVector&) { return false; }
-
 protected:
 
 	void setIndentText( const std::string &i );
@@ -171,6 +185,7 @@ protected:
 							  const SymbolInfoPtr &fnInfo );
 
 	MainRoutineMap myMainRoutines;
+	SimdInterpreter *myConstantInterpreter;
 
 private:
 	Precision myPrecision;
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A world-wide, royalty-free, non-exclusive right to distribute, copy,
+// modify, create derivatives, and use, in source and binary forms, is
+// hereby granted, subject to acceptance of this license. Performance of
+// any of the aforementioned acts indicates acceptance to be bound by the
+// following terms and conditions:
+// 
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty.
+// 
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty
+//     in the documentation and/or other materials provided with the
+//     distribution.
+// 
+//   * Nothing in this license shall be deemed to grant any rights to
+//     trademarks, copyrights, patents, trade secrets or any other
+//     intellectual property of A.M.P.A.S. or any contributors, except
+//     as expressly stated herein, and neither the name of A.M.P.A.S.
+//     nor of any other contributors to this software, may be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission of A.M.P.A.S. or contributor,
+//     as appropriate.
+// 
+// This license shall be governed by the laws of the State of California,
+// and subject to the jurisdiction of the courts therein.
+// 
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO
+// EVENT SHALL A.M.P.A.S., ANY CONTRIBUTORS OR DISTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+// IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+//-----------------------------------------------------------------------------
+//
+//	class NativeFunctionCall
+//
+//-----------------------------------------------------------------------------
+
+#include "CtlCodeNativeFunctionCall.h"
+#include <CtlSimdInterpreter.h>
+#include <CtlType.h>
+#include <Iex.h>
+
+namespace Ctl
+{
+
+
+NativeFunctionCall::NativeFunctionCall( SimdInterpreter &interpreter,
+										const std::string &name,
+										FunctionTypePtr type,
+										SimdInstAddrPtr addr,
+										SymbolTable &symbols,
+										NativeEntryPoint entryPoint )
+		: SimdFunctionCall( interpreter, name, type, addr, symbols ),
+		  myEntryPoint( entryPoint )
+{
+	collectArgs();
+}
+
+
+NativeFunctionCall::NativeFunctionCall( const NativeFunctionCall &prototype )
+		: SimdFunctionCall( prototype ),
+		  myEntryPoint( prototype.myEntryPoint )
+{
+	collectArgs();
+}
+
+
+FunctionCallPtr
+NativeFunctionCall::clone( void ) const
+{
+	return new NativeFunctionCall( *this );
+}
+
+
+void
+NativeFunctionCall::collectArgs( void )
+{
+	const FunctionTypePtr &type = functionType();
+	const ParamVector &parameters = type->parameters();
+	for ( size_t i = 0, N = parameters.size(); i != N; ++i )
+	{
+		const Param &param = parameters[i];
+		bool isOutput = param.isWritable();
+		FunctionArgPtr arg = isOutput ? findOutputArg( param.name ) : findInputArg( param.name );
+		if ( ! arg )
+			THROW( Iex::LogicExc, "Unable to find argument " << param.name <<
+				   " of CTL function " << name() << "." );
+
+		myArgs.push_back( arg );
+		myArgIsOutput.push_back( isOutput );
+	}
+
+	if ( ! type->returnType().cast<VoidType>() )
+	{
+		myArgs.push_back( returnValue() );
+		myArgIsOutput.push_back( true );
+	}
+
+	myData.resize( myArgs.size(), NULL );
+	myStrides.resize( myArgs.size(), 0 );
+}
+
+
+////////////////////////////////////////
+
+
+void
+NativeFunctionCall::callFunction( size_t numSamples )
+{
+	if ( ! myEntryPoint )
+	{
+		SimdFunctionCall::callFunction( numSamples );
+		return;
+	}
+
+	for ( size_t i = 0, N = myArgs.size(); i != N; ++i )
+	{
+		SimdReg *reg = myArgs[i]->reg();
+		if ( myArgIsOutput[i] )
+		{
+			// a uniform output is only legal if the function doesn't
+			// produce a varying result, which only the interpreter
+			// can tell us
+			if ( ! myArgs[i]->isVarying() )
+			{
+				SimdFunctionCall::callFunction( numSamples );
+				return;
+			}
+			if ( ! reg->isVarying() )
+				reg->setVarying( true );
+		}
+
+		myData[i] = (*reg)[0];
+		if ( reg->isExternal() )
+			myStrides[i] = reg->externalStride();
+		else
+			myStrides[i] = reg->isVarying() ? reg->elementSize() : 0;
+	}
+
+	if ( numSamples > 0 )
+		myEntryPoint( myData.empty() ? NULL : &myData[0],
+					  myStrides.empty() ? NULL : &myStrides[0],
+					  numSamples );
+}
+
+} // namespace Ctl
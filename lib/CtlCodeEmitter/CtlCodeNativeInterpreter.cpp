@@ -0,0 +1,798 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A world-wide, royalty-free, non-exclusive right to distribute, copy,
+// modify, create derivatives, and use, in source and binary forms, is
+// hereby granted, subject to acceptance of this license. Performance of
+// any of the aforementioned acts indicates acceptance to be bound by the
+// following terms and conditions:
+// 
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty.
+// 
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty
+//     in the documentation and/or other materials provided with the
+//     distribution.
+// 
+//   * Nothing in this license shall be deemed to grant any rights to
+//     trademarks, copyrights, patents, trade secrets or any other
+//     intellectual property of A.M.P.A.S. or any contributors, except
+//     as expressly stated herein, and neither the name of A.M.P.A.S.
+//     nor of any other contributors to this software, may be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission of A.M.P.A.S. or contributor,
+//     as appropriate.
+// 
+// This license shall be governed by the laws of the State of California,
+// and subject to the jurisdiction of the courts therein.
+// 
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO
+// EVENT SHALL A.M.P.A.S., ANY CONTRIBUTORS OR DISTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+// IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+
+//-----------------------------------------------------------------------------
+//
+//	class NativeInterpreter
+//
+//-----------------------------------------------------------------------------
+
+#include "CtlCodeNativeInterpreter.h"
+#include "CtlCodeInterpreter.h"
+#include <CtlSymbolTable.h>
+#include <CtlModule.h>
+#include <CtlType.h>
+#include <Iex.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#ifndef WIN32
+# include <dlfcn.h>
+# include <errno.h>
+# include <pwd.h>
+# include <string.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
+using namespace IlmThread;
+
+namespace Ctl
+{
+
+namespace
+{
+
+std::string
+identifierName( const std::string &name )
+{
+	std::string ret = name;
+	for ( size_t i = 0, N = ret.size(); i != N; ++i )
+	{
+		char c = ret[i];
+		if ( ! ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) ||
+				 ( c >= '0' && c <= '9' ) || c == '_' ) )
+			ret[i] = '_';
+	}
+	if ( ret.empty() || ( ret[0] >= '0' && ret[0] <= '9' ) )
+		ret = "_" + ret;
+	return ret;
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+scalarTypeName( const DataTypePtr &t )
+{
+	if ( t.cast<BoolType>() )
+		return "bool";
+	if ( t.cast<IntType>() )
+		return "int";
+	if ( t.cast<UIntType>() )
+		return "unsigned int";
+	if ( t.cast<HalfType>() )
+		return "half";
+	if ( t.cast<FloatType>() )
+		return "ctl_number_t";
+	return std::string();
+}
+
+
+////////////////////////////////////////
+
+
+//
+// Declaration of a local that can hold a value of the given type
+// and is what the emitted C++ function expects for it.  Returns
+// an empty string for types the wrappers don't handle.
+//
+std::string
+nativeDeclaration( const DataTypePtr &t, const std::string &var )
+{
+	std::string scalar = scalarTypeName( t );
+	if ( ! scalar.empty() )
+		return scalar + " " + var;
+
+	// the only struct the emitted code declares somewhere we can
+	// name it from outside the module namespaces
+	StructTypePtr sType = t.cast<StructType>();
+	if ( sType )
+	{
+		if ( sType->name() == "::Chromaticities" || sType->name() == "Chromaticities" )
+			return "_ctlcc_::Chromaticities " + var;
+		return std::string();
+	}
+
+	ArrayTypePtr arrType = t.cast<ArrayType>();
+	if ( ! arrType )
+		return std::string();
+
+	SizeVector sizes;
+	arrType->sizes( sizes );
+	std::string core = scalarTypeName( arrType->coreType() );
+	if ( core != "ctl_number_t" && core != "int" )
+		return std::string();
+
+	for ( size_t i = 0; i != sizes.size(); ++i )
+	{
+		if ( sizes[i] == 0 )
+			return std::string();
+	}
+
+	char suffix = ( core == "int" ) ? 'i' : 'f';
+	if ( sizes.size() == 1 && sizes[0] >= 2 && sizes[0] <= 4 )
+	{
+		std::stringstream ret;
+		ret << "_ctlcc_::ctl_vec" << sizes[0] << suffix << "_t " << var;
+		return ret.str();
+	}
+	if ( sizes.size() == 2 && suffix == 'f' && sizes[0] == sizes[1] &&
+		 ( sizes[0] == 3 || sizes[0] == 4 ) )
+	{
+		std::stringstream ret;
+		ret << "_ctlcc_::ctl_mat" << sizes[0] << sizes[1] << "f_t " << var;
+		return ret.str();
+	}
+
+	std::stringstream ret;
+	ret << core << " " << var;
+	for ( size_t i = 0; i != sizes.size(); ++i )
+		ret << '[' << sizes[i] << ']';
+	return ret.str();
+}
+
+
+////////////////////////////////////////
+
+
+//
+// Body of a NativeEntryPoint shim calling the planar batch entry
+// point batchName.  The samples are gathered into blocks of
+// contiguous ctl_number_t, the layout the batch entry points take,
+// whatever the strides and types of the arguments, which also keeps
+// the batch's restrict-qualified arrays from aliasing
+//
+void
+emitBatchWrapper( std::ostream &out,
+				  const std::string &batchName,
+				  const FunctionTypePtr &type,
+				  const std::vector<std::string> &decls,
+				  const std::vector<size_t> &sizes )
+{
+	const ParamVector &params = type->parameters();
+	const size_t block = 256;
+
+	out << "    for ( size_t s = 0; s < numSamples; s += " << block << " )\n    {\n";
+	out << "        size_t n = numSamples - s < " << block << " ? numSamples - s : "
+		<< block << ";\n";
+	for ( size_t i = 0; i != params.size(); ++i )
+	{
+		out << "        " << decls[i] << ";\n";
+		out << "        static_assert( sizeof( p" << i << " ) == " << sizes[i]
+			<< ", \"native layout mismatch\" );\n";
+		if ( ! params[i].varying )
+		{
+			out << "        std::memcpy( &p" << i << ", args[" << i << "], sizeof( p"
+				<< i << " ) );\n";
+			continue;
+		}
+
+		out << "        ctl_number_t b" << i << "[" << block << "];\n";
+		if ( params[i].access == RWA_WRITE )
+			continue;
+		out << "        for ( size_t i = 0; i != n; ++i )\n        {\n";
+		out << "            std::memcpy( &p" << i << ", args[" << i << "] + ( s + i ) * strides["
+			<< i << "], sizeof( p" << i << " ) );\n";
+		out << "            b" << i << "[i] = p" << i << ";\n";
+		out << "        }\n";
+	}
+
+	out << "        " << batchName << "( n";
+	for ( size_t i = 0; i != params.size(); ++i )
+		out << ", " << ( params[i].varying ? "b" : "p" ) << i;
+	out << " );\n";
+
+	for ( size_t i = 0; i != params.size(); ++i )
+	{
+		if ( ! params[i].varying || params[i].access == RWA_READ )
+			continue;
+		out << "        for ( size_t i = 0; i != n; ++i )\n        {\n";
+		out << "            p" << i << " = b" << i << "[i];\n";
+		out << "            std::memcpy( args[" << i << "] + ( s + i ) * strides[" << i
+			<< "], &p" << i << ", sizeof( p" << i << " ) );\n";
+		out << "        }\n";
+	}
+	out << "    }\n}\n";
+}
+
+
+////////////////////////////////////////
+
+
+//
+// extern "C" shim around an emitted main routine matching
+// NativeEntryPoint, false if an argument type isn't supported.  If
+// batchName is given, the shim calls that planar batch entry point
+// instead of the main routine once per sample
+//
+bool
+emitWrapper( std::ostream &out,
+			 const std::string &wrapperName,
+			 const std::string &functionName,
+			 const std::string &batchName,
+			 const FunctionTypePtr &type )
+{
+	const ParamVector &params = type->parameters();
+	bool hasReturn = ! type->returnType().cast<VoidType>();
+	std::vector<std::string> decls;
+	std::vector<size_t> sizes;
+
+	for ( size_t i = 0; i != params.size(); ++i )
+	{
+		std::stringstream var;
+		var << "p" << i;
+		decls.push_back( nativeDeclaration( params[i].type, var.str() ) );
+		sizes.push_back( params[i].type->alignedObjectSize() );
+		if ( decls.back().empty() )
+			return false;
+	}
+	if ( hasReturn )
+	{
+		decls.push_back( nativeDeclaration( type->returnType(), "r" ) );
+		sizes.push_back( type->returnType()->alignedObjectSize() );
+		if ( decls.back().empty() )
+			return false;
+	}
+
+	out << "\nextern \"C\" void " << wrapperName
+		<< "( char * const *args, const size_t *strides, size_t numSamples )\n{\n";
+
+	// the batch entry points drop the return value and only take
+	// uniform arguments by value
+	bool batch = ! batchName.empty() && ! hasReturn;
+	for ( size_t i = 0; batch && i != params.size(); ++i )
+	{
+		if ( ! params[i].varying && params[i].isWritable() )
+			batch = false;
+	}
+	if ( batch )
+	{
+		emitBatchWrapper( out, batchName, type, decls, sizes );
+		return true;
+	}
+
+	out << "    for ( size_t i = 0; i != numSamples; ++i )\n    {\n";
+	for ( size_t i = 0; i != params.size(); ++i )
+	{
+		out << "        " << decls[i] << ";\n";
+		out << "        static_assert( sizeof( p" << i << " ) == " << sizes[i]
+			<< ", \"native layout mismatch\" );\n";
+		out << "        std::memcpy( &p" << i << ", args[" << i << "] + i * strides["
+			<< i << "], sizeof( p" << i << " ) );\n";
+	}
+
+	out << "        ";
+	if ( hasReturn )
+		out << decls.back() << " = ";
+	out << functionName << "(";
+	for ( size_t i = 0; i != params.size(); ++i )
+		out << ( i ? ", " : " " ) << "p" << i;
+	out << ( params.empty() ? ");\n" : " );\n" );
+
+	for ( size_t i = 0; i != params.size(); ++i )
+	{
+		if ( ! params[i].isWritable() )
+			continue;
+		out << "        std::memcpy( args[" << i << "] + i * strides[" << i
+			<< "], &p" << i << ", sizeof( p" << i << " ) );\n";
+	}
+	if ( hasReturn )
+	{
+		size_t r = params.size();
+		out << "        static_assert( sizeof( r ) == " << sizes.back()
+			<< ", \"native layout mismatch\" );\n";
+		out << "        std::memcpy( args[" << r << "] + i * strides[" << r
+			<< "], &r, sizeof( r ) );\n";
+	}
+	out << "    }\n}\n";
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+hashString( const std::string &s )
+{
+	// 64-bit FNV-1a
+	unsigned long long h = 14695981039346656037ULL;
+	for ( size_t i = 0, N = s.size(); i != N; ++i )
+	{
+		h ^= static_cast<unsigned char>( s[i] );
+		h *= 1099511628211ULL;
+	}
+
+	std::stringstream ret;
+	ret << std::hex << std::setw( 16 ) << std::setfill( '0' ) << h;
+	return ret.str();
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+getEnv( const char *name, const char *def, bool allowEmpty = false )
+{
+	const char *v = getenv( name );
+	if ( v && ( allowEmpty || *v != '\0' ) )
+		return std::string( v );
+	return def ? std::string( def ) : std::string();
+}
+
+
+#ifndef WIN32
+
+////////////////////////////////////////
+
+
+//
+// The cache directory: $CTL_JIT_CACHE, or ctl-jit in the user's
+// cache directory ($XDG_CACHE_HOME, or ~/.cache).  The cache must
+// not be shared with other users, since whatever shared objects it
+// contains get loaded into the process.
+//
+std::string
+cacheDirectory( void )
+{
+	std::string dir = getEnv( "CTL_JIT_CACHE", NULL );
+	if ( ! dir.empty() )
+		return dir;
+
+	std::string base = getEnv( "XDG_CACHE_HOME", NULL );
+	if ( base.empty() )
+	{
+		std::string home = getEnv( "HOME", NULL );
+		if ( home.empty() )
+		{
+			const struct passwd *pw = getpwuid( geteuid() );
+			if ( ! pw || ! pw->pw_dir )
+				return std::string();
+			home = pw->pw_dir;
+		}
+		base = home + "/.cache";
+		mkdir( base.c_str(), 0700 );
+	}
+
+	return base + "/ctl-jit";
+}
+
+
+////////////////////////////////////////
+
+
+// owned by us and not writable by anyone else
+bool
+isPrivate( const struct stat &st )
+{
+	return st.st_uid == geteuid() && ( st.st_mode & ( S_IWGRP | S_IWOTH ) ) == 0;
+}
+
+
+////////////////////////////////////////
+
+
+//
+// Creates the directory if it doesn't exist yet, and checks that
+// it is a real directory (not a symbolic link) that only we can
+// write to.
+//
+bool
+makePrivateDirectory( const std::string &dir, std::string &error )
+{
+	if ( mkdir( dir.c_str(), 0700 ) != 0 && errno != EEXIST )
+	{
+		error = "cannot create " + dir + ": " + strerror( errno );
+		return false;
+	}
+
+	struct stat st;
+	if ( lstat( dir.c_str(), &st ) != 0 )
+	{
+		error = "cannot access " + dir + ": " + strerror( errno );
+		return false;
+	}
+
+	if ( ! S_ISDIR( st.st_mode ) || ! isPrivate( st ) )
+	{
+		error = dir + " is not a directory that only the current user "
+			"can write to";
+		return false;
+	}
+
+	return true;
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+fileContents( const std::string &fileName )
+{
+	std::ifstream in( fileName.c_str() );
+	std::stringstream ret;
+	ret << in.rdbuf();
+	return ret.str();
+}
+
+#endif
+
+} // empty namespace
+
+
+////////////////////////////////////////
+
+
+NativeInterpreter::NativeInterpreter( void )
+		: myModulesChanged( false ), myHaveLibrary( false )
+{
+}
+
+
+////////////////////////////////////////
+
+
+NativeInterpreter::~NativeInterpreter( void )
+{
+#ifndef WIN32
+	for ( size_t i = 0; i != myLibraries.size(); ++i )
+		dlclose( myLibraries[i] );
+#endif
+}
+
+
+////////////////////////////////////////
+
+
+bool
+NativeInterpreter::compile( void )
+{
+	Lock lock( myMutex );
+
+	if ( myModulesChanged )
+		myHaveLibrary = buildLibrary();
+
+	return myHaveLibrary;
+}
+
+
+////////////////////////////////////////
+
+
+std::string
+NativeInterpreter::buildErrors( void )
+{
+	Lock lock( myMutex );
+	return myBuildErrors;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+NativeInterpreter::isNative( const std::string &functionName )
+{
+	SymbolInfoPtr info = getSymbol( functionName );
+	if ( ! info || ! info->isFunction() )
+		return false;
+
+	compile();
+
+	Lock lock( myMutex );
+	return findEntryPoint( info, functionName ) != NULL;
+}
+
+
+////////////////////////////////////////
+
+
+FunctionCallPtr
+NativeInterpreter::newFunctionCallInternal( const SymbolInfoPtr info,
+											const std::string &functionName )
+{
+	compile();
+
+	NativeEntryPoint entry = NULL;
+	{
+		Lock lock( myMutex );
+		entry = findEntryPoint( info, functionName );
+	}
+
+	FunctionTypePtr fType = info->type();
+	return new NativeFunctionCall( *this, functionName, fType,
+								   info->addr(), symtab(), entry );
+}
+
+
+////////////////////////////////////////
+
+
+Module *
+NativeInterpreter::newModule( const std::string &moduleName,
+							  const std::string &fileName )
+{
+	{
+		Lock lock( myMutex );
+		ModuleFile m;
+		m.name = moduleName;
+		m.fileName = fileName;
+		myModules.push_back( m );
+		myModulesChanged = true;
+	}
+
+	return SimdInterpreter::newModule( moduleName, fileName );
+}
+
+
+////////////////////////////////////////
+
+
+NativeEntryPoint
+NativeInterpreter::findEntryPoint( const SymbolInfoPtr &info,
+								   const std::string &functionName )
+{
+	const Module *module = info->module();
+	if ( ! module )
+		return NULL;
+
+	// only the main routines get an exported entry point
+	std::string baseName = functionName;
+	std::string::size_type pos = baseName.rfind( "::" );
+	if ( pos != std::string::npos )
+		baseName = baseName.substr( pos + 2 );
+	if ( baseName != "main" && baseName != identifierName( module->name() ) )
+		return NULL;
+
+	std::map<std::string, NativeEntryPoint>::const_iterator i =
+		myEntryPoints.find( module->name() );
+	return i == myEntryPoints.end() ? NULL : i->second;
+}
+
+
+////////////////////////////////////////
+
+
+bool
+NativeInterpreter::buildLibrary( void )
+{
+	myModulesChanged = false;
+	myEntryPoints.clear();
+	myBuildErrors.clear();
+
+#ifdef WIN32
+	myBuildErrors = "native code is not supported on this platform";
+	return false;
+#else
+	std::string compiler = getEnv( "CTL_JIT_CXX", NULL, true );
+	if ( ! getenv( "CTL_JIT_CXX" ) )
+		compiler = getEnv( "CXX", "c++" );
+	if ( compiler.empty() )
+	{
+		myBuildErrors = "no compiler (CTL_JIT_CXX is empty)";
+		return false;
+	}
+	if ( myModules.empty() )
+		return false;
+
+	// modules loaded from source strings can't be handed to the
+	// code emitter
+	for ( size_t i = 0; i != myModules.size(); ++i )
+	{
+		if ( myModules[i].fileName.empty() )
+		{
+			myBuildErrors = "module " + myModules[i].name +
+				" was not loaded from a file";
+			return false;
+		}
+	}
+
+	std::stringstream source;
+	std::map<std::string, std::string> wrappers;
+
+	try
+	{
+		std::map<std::string, std::string> moduleNames;
+		CodeInterpreter code;
+		code.setLanguage( CodeInterpreter::CPP11 );
+		code.initStdLibrary();
+		code.setCalledOnly( true );
+
+		// imports are recorded after the module importing them, but
+		// have to be emitted before it
+		for ( size_t i = myModules.size(); i > 0; --i )
+		{
+			const ModuleFile &m = myModules[i - 1];
+			std::string name = identifierName( m.name );
+			moduleNames[name] = m.name;
+			code.loadModule( name, m.fileName );
+		}
+
+		code.emitCode( source );
+		source << "\n#include <cstring>\n";
+
+		const LanguageGenerator::MainRoutineMap &mains = code.getMainRoutines();
+		for ( LanguageGenerator::MainRoutineMap::const_iterator i = mains.begin();
+			  i != mains.end(); ++i )
+		{
+			std::map<std::string, std::string>::const_iterator mod =
+				moduleNames.find( i->first );
+			if ( mod == moduleNames.end() )
+				continue;
+
+			FunctionTypePtr fType = i->second.second->type();
+			std::string wrapperName = "ctl_native_" + i->first;
+			std::string batch = code.getBatchEntryPoint( i->first );
+			source << batch;
+			if ( emitWrapper( source, wrapperName, i->second.first,
+							  batch.empty() ? std::string() : "batch_" + i->first,
+							  fType ) )
+				wrappers[mod->second] = wrapperName;
+		}
+	}
+	catch ( const std::exception &e )
+	{
+		myBuildErrors = std::string( "code generation failed: " ) + e.what();
+		return false;
+	}
+	catch ( ... )
+	{
+		myBuildErrors = "code generation failed";
+		return false;
+	}
+
+	if ( wrappers.empty() )
+	{
+		myBuildErrors = "no main routine that native code supports";
+		return false;
+	}
+
+	std::string flags = " -std=c++11 -fPIC -shared ";
+	flags += getEnv( "CTL_JIT_CXXFLAGS", "-O2" );
+#ifdef CTL_JIT_INCLUDE_DIR
+	flags += " -I\"" CTL_JIT_INCLUDE_DIR "\"";
+#endif
+
+	std::string cacheDir = cacheDirectory();
+	if ( cacheDir.empty() )
+	{
+		myBuildErrors = "no cache directory (set CTL_JIT_CACHE or HOME)";
+		return false;
+	}
+	if ( ! makePrivateDirectory( cacheDir, myBuildErrors ) )
+		return false;
+
+	std::string base = cacheDir + "/ctl_" +
+		hashString( compiler + flags + "\n" + source.str() );
+	std::string libName = base + ".so";
+
+	struct stat st;
+	if ( lstat( libName.c_str(), &st ) == 0 )
+	{
+		// never load anything someone else could have put there
+		if ( ! S_ISREG( st.st_mode ) || ! isPrivate( st ) )
+		{
+			myBuildErrors = libName + " is not a file that only the "
+				"current user can write to";
+			return false;
+		}
+	}
+	else if ( errno != ENOENT )
+	{
+		myBuildErrors = "cannot access " + libName + ": " + strerror( errno );
+		return false;
+	}
+	else
+	{
+		std::string srcName = base + ".cpp";
+		{
+			std::ofstream srcFile( srcName.c_str() );
+			srcFile << source.str();
+			if ( ! srcFile )
+			{
+				myBuildErrors = "cannot write " + srcName;
+				return false;
+			}
+		}
+
+		// several processes may be compiling the same code, so build
+		// under a unique name and move it in place when done
+		std::stringstream tmpName;
+		tmpName << base << "." << getpid() << ".tmp";
+		std::string logName = base + ".log";
+		std::string cmd = compiler + flags + " -o \"" + tmpName.str() +
+			"\" \"" + srcName + "\" > \"" + logName + "\" 2>&1";
+		if ( system( cmd.c_str() ) != 0 )
+		{
+			myBuildErrors = "compiling " + srcName + " failed:\n" +
+				fileContents( logName );
+			remove( tmpName.str().c_str() );
+			return false;
+		}
+		// whatever the umask, the check above has to accept it next time
+		if ( chmod( tmpName.str().c_str(), 0700 ) != 0 ||
+			 rename( tmpName.str().c_str(), libName.c_str() ) != 0 )
+		{
+			myBuildErrors = "cannot create " + libName + ": " + strerror( errno );
+			remove( tmpName.str().c_str() );
+			return false;
+		}
+	}
+
+	void *lib = dlopen( libName.c_str(), RTLD_NOW | RTLD_LOCAL );
+	if ( ! lib )
+	{
+		const char *err = dlerror();
+		myBuildErrors = err ? err : "cannot load " + libName;
+		return false;
+	}
+	myLibraries.push_back( lib );
+
+	for ( std::map<std::string, std::string>::const_iterator i = wrappers.begin();
+		  i != wrappers.end(); ++i )
+	{
+		void *sym = dlsym( lib, i->second.c_str() );
+		if ( sym )
+			myEntryPoints[i->first] = reinterpret_cast<NativeEntryPoint>( sym );
+	}
+
+	return ! myEntryPoints.empty();
+#endif
+}
+
+} // namespace Ctl
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A world-wide, royalty-free, non-exclusive right to distribute, copy,
+// modify, create derivatives, and use, in source and binary forms, is
+// hereby granted, subject to acceptance of this license. Performance of
+// any of the aforementioned acts indicates acceptance to be bound by the
+// following terms and conditions:
+// 
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty.
+// 
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the Disclaimer of Warranty
+//     in the documentation and/or other materials provided with the
+//     distribution.
+// 
+//   * Nothing in this license shall be deemed to grant any rights to
+//     trademarks, copyrights, patents, trade secrets or any other
+//     intellectual property of A.M.P.A.S. or any contributors, except
+//     as expressly stated herein, and neither the name of A.M.P.A.S.
+//     nor of any other contributors to this software, may be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission of A.M.P.A.S. or contributor,
+//     as appropriate.
+// 
+// This license shall be governed by the laws of the State of California,
+// and subject to the jurisdiction of the courts therein.
+// 
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO
+// EVENT SHALL A.M.P.A.S., ANY CONTRIBUTORS OR DISTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+// IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_CTL_CODE_NATIVE_INTERPRETER_H
+#define INCLUDED_CTL_CODE_NATIVE_INTERPRETER_H
+
+//-----------------------------------------------------------------------------
+//
+//	class NativeInterpreter
+//
+//	A SIMD interpreter that compiles the main routines of the loaded
+//	modules to native code.  The C++ emitted by the CodeInterpreter is
+//	handed to the system compiler, the resulting shared object is
+//	cached keyed by a hash of the source and loaded with dlopen.
+//	Function calls are regular SIMD function calls that jump to the
+//	native code instead of interpreting, so anything that can't be
+//	compiled (no compiler, unsupported constructs or argument types)
+//	silently runs on the SIMD interpreter instead.
+//	Main routines that have a planar batch entry point run through it,
+//	so the compiler can vectorize the loop over the samples; the others
+//	are called once per sample.
+//
+//	Environment variables:
+//
+//	  CTL_JIT_CXX       compiler to use (defaults to $CXX, then c++);
+//	                    set it to an empty string to disable compiling
+//	  CTL_JIT_CXXFLAGS  extra compiler flags (defaults to -O2)
+//	  CTL_JIT_CACHE     directory for the generated source and shared
+//	                    objects (defaults to $XDG_CACHE_HOME/ctl-jit or
+//	                    ~/.cache/ctl-jit).  The directory and the shared
+//	                    objects in it must belong to the current user and
+//	                    must not be writable by anyone else; otherwise
+//	                    they are not used.
+//
+//-----------------------------------------------------------------------------
+
+#include <CtlSimdInterpreter.h>
+#include "CtlCodeNativeFunctionCall.h"
+#include <IlmThreadMutex.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Ctl
+{
+
+class NativeInterpreter : public SimdInterpreter
+{
+public:
+	NativeInterpreter( void );
+	virtual ~NativeInterpreter( void );
+
+	// Compiles the currently loaded modules if that hasn't been
+	// done yet, returns true if native code is available
+	bool compile( void );
+
+	// True if calls to the given function will run natively
+	bool isNative( const std::string &functionName );
+
+	// Why the last attempt to compile produced no native code,
+	// including the compiler's output if it failed; empty if it
+	// succeeded
+	std::string buildErrors( void );
+
+protected:
+	virtual FunctionCallPtr newFunctionCallInternal( const SymbolInfoPtr info,
+													 const std::string &functionName );
+
+	virtual Module *newModule( const std::string &moduleName,
+							   const std::string &fileName );
+
+private:
+	NativeEntryPoint findEntryPoint( const SymbolInfoPtr &info,
+									 const std::string &functionName );
+	bool buildLibrary( void );
+
+	struct ModuleFile
+	{
+		std::string name;
+		std::string fileName;
+	};
+
+	// in the order the interpreter started loading them
+	std::vector<ModuleFile> myModules;
+	bool myModulesChanged;
+	bool myHaveLibrary;
+	std::string myBuildErrors;
+
+	IlmThread::Mutex myMutex;
+	std::vector<void *> myLibraries;
+	std::map<std::string, NativeEntryPoint> myEntryPoints;
+};
+
+} // namespace Ctl
+
+#endif
@@ -50,14 +50,15 @@
 #include <CtlSimdInterpreter.h>
 #include <CtlSimdType.h>
 #include <CtlSimdAddr.h>
+#include <cassert>
 
 namespace Ctl
 {
 
 OPENCLGenerator::OPENCLGenerator(SimdInterpreter& simdInterpreter)
 		: CPPGenerator( false )
-		, simdInterpreter( simdInterpreter )
 {
+    setConstantInterpreter( &simdInterpreter );
 }
 
 
@@ -66,121 +67,6 @@ OPENCLGenerator::OPENCLGenerator(SimdInterpreter& simdInterpreter)
 
 OPENCLGenerator::~OPENCLGenerator(void ) = default;
 
-bool OPENCLGenerator::precalculate(const std::string& name, const ExprNodeVector& args)
-{
-    try {
-        if (auto symbol = simdInterpreter.getSymbol(name)) {
-            auto addr = symbol->addr();
-            if (addr.is_subclass<SimdDataAddr>()) {
-                const auto& dataAddr = addr.cast<SimdDataAddr>();
-                const auto& dataType = symbol->type();
-                const auto& reg = *dataAddr->reg();
-                if (dataType.is_subclass<StructType>()) {
-                    auto structType = dataType.cast<StructType>();
-                    curStream() << " = { ";
-                    int index = 0;
-                    bool isFirst = true;
-                    for (const auto& member : structType->members()) {
-                        if (!isFirst) {
-                            curStream() << ", ";
-                        } else {
-                            isFirst = false;
-                        }
-                        const auto& memberType = member.type;
-                        if (memberType.is_subclass<ArrayType>()) {
-                            const auto& arrayType = memberType.cast<ArrayType>();
-                            curStream() << "{ ";
-                            for (auto i = 0u; i < arrayType->size(); ++i) {
-                                if (i > 0) {
-                                    curStream() << ", ";
-                                }
-                                curStream() << *(reinterpret_cast<const float*>(reg[0]) + index);
-                                ++index;
-                            }
-                            curStream() << " }";
-                        }
-                    }
-                    curStream() << " };";
-
-                    return true;
-                }
-                else if (dataType.is_subclass<ArrayType>()) {
-                    const auto& arrayInfo = collapseArray(dataType.cast<ArrayType>());
-                    const auto& arrayType = dataType.cast<ArrayType>();
-                    curStream() << " = { ";
-                    if (!arrayInfo.isCore) {
-                        curStream() << "{ ";
-                    }
-                    int index = 0;
-                    bool isFirst = true;
-                    for (auto i = 0u; i < arrayType->size(); ++i) {
-                        if (!isFirst) {
-                            curStream() << ", ";
-                        } else {
-                            isFirst = false;
-                        }
-                        const auto& elementType = arrayType->elementType();
-                        if (elementType.is_subclass<ArrayType>()) {
-                            const auto& subArrayType = elementType.cast<ArrayType>();
-                            curStream() << "{ ";
-                            for (auto j = 0u; j < subArrayType->size(); ++j) {
-                                if (j > 0) {
-                                    curStream() << ", ";
-                                }
-                                curStream() << *(reinterpret_cast<const float*>(reg[0]) + index);
-                                ++index;
-                            }
-                            curStream() << " }";
-                        }
-                        else if (elementType.is_subclass<FloatType>()) {
-                            curStream() << *(reinterpret_cast<const float*>(reg[0]) + index);
-                            ++index;
-                        }
-                    }
-                    if (!arrayInfo.isCore) {
-                        curStream() << " }";
-                    }
-                    curStream() << " };";
-
-                    return true;
-                }
-                else if (dataType.is_subclass<FloatType>()) {
-                    curStream() << " = " << *(reinterpret_cast<const float*>(reg[0])) << ";";
-
-                    return true;
-                }
-            }
-        }
-//        if (auto call = simdInterpreter.newFunctionCall("ctl" + name)) {
-//            for (const auto& arg : args) {
-//                if (arg.is_subclass<CodeNameNode>()) {
-//                    auto name = arg.cast<CodeNameNode>();
-////                    name->info->module()->
-//                }
-//            }
-//
-//            call->callFunction(1);
-//            const auto res = call->returnValue();
-//            if (res->type().is_subclass<SimdArrayType>()) {
-//                const auto array = res->type().cast<SimdArrayType>();
-//                SizeVector sizes, offsets;
-//                array->coreSizes(0, sizes, offsets);
-//                for (auto i = 0u; i < sizes.size(); ++i) {
-//                    const auto offset = offsets[i];
-//                    const auto* data = (float*)(res->data() + offset);
-//                    std::cout << (*data) << std::endl;
-//                }
-//            }
-//        }
-    }
-    catch (...)
-    {
-        return false;
-    }
-
-    return false;
-}
-
 const std::string &OPENCLGenerator::getFunctionPrefix() const
 {
     static std::string kPrefix = "";
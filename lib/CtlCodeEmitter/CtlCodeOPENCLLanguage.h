@@ -76,8 +76,6 @@ public:
     void initStdLibrary( void );
     std::string stdLibraryAndSetup( void ) override { return ""; }
 
-    bool precalculate(const std::string& name, const ExprNodeVector& args) override;
-
 protected:
     const std::string &getFunctionPrefix( void ) const override;
     const std::string &getInlineKeyword( void ) const override;
@@ -95,9 +93,6 @@ protected:
     virtual void getStandardPrintBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
     virtual void getStandardColorBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
     virtual void getStandardInterpBodies( FuncDeclList &d, const std::string &funcPref, const std::string &precSuffix );
-
-private:
-    SimdInterpreter& simdInterpreter;
 };
 
 } // namespace Ctl
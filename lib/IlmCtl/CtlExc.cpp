@@ -66,8 +66,12 @@ void CtlExc::_explain(const char *text, va_list _ap) {
 	int need_len;
 	va_list ap;
 
+	// BaseExc declares its own operator= and assign(), which hide the
+	// std::string ones; a plain operator=(ptr) would go through the
+	// CtlExc(const char *, ...) constructor and recurse.
 	if(text==NULL) {
-		operator=("no explanation given.");
+		std::string::assign("no explanation given.");
+		return;
 	}
 	while(1) {
 		va_copy(ap, _ap);
@@ -84,7 +88,7 @@ void CtlExc::_explain(const char *text, va_list _ap) {
 		}
 	}
 
-	operator=(ptr);
+	std::string::assign(ptr);
 }
 
 CtlExc::CtlExc(const char *format, ...) throw() {
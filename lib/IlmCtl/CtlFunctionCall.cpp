@@ -145,4 +145,18 @@ FunctionArg::~FunctionArg ()
     // empty
 }
 
+
+bool
+FunctionArg::bind (char *data, size_t stride)
+{
+    return false;
+}
+
+
+void
+FunctionArg::unbind ()
+{
+    // empty
+}
+
 } // namespace Ctl
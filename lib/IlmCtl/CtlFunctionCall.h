@@ -155,6 +155,19 @@ class FunctionCall: public RcObject
 
     virtual void		callFunction (size_t numSamples) = 0;
 
+
+    //-----------------------------------------------------------------
+    // Create a new FunctionCall object for the same CTL function.
+    // The new object has its own argument buffers, as if it had been
+    // returned by Interpreter::newFunctionCall(), but it reuses what
+    // was resolved when this object was created (symbol table lookups,
+    // entry point, default values).  clone() does not lock the
+    // interpreter, and several threads can clone the same object
+    // concurrently.  Argument values are not copied.
+    //-----------------------------------------------------------------
+
+    virtual FunctionCallPtr	clone () const = 0;
+
   protected:
 
     void		setInputArg (size_t i, const FunctionArgPtr &arg);
@@ -229,6 +242,25 @@ class FunctionArg: public TypeStorage {
     virtual bool		hasDefaultValue () = 0;
     virtual void		setDefaultValue () = 0;
 
+    //-----------------------------------------------------------------
+    // bind(d, s) lets a varying argument use memory owned by the
+    // application instead of its own buffer:  sample i is at d + i * s,
+    // and s must be at least the size of the argument's type.  Input
+    // values are read from, and output values written to, that memory
+    // directly.  The memory must hold as many samples as are passed to
+    // callFunction(), and stay valid until the argument is unbound or
+    // bound again.  While an argument is bound, data(), copy(), set()
+    // and get() must not be used.
+    //
+    // bind() returns false if the argument is uniform or the interpreter
+    // can't read and write external memory; the application must then
+    // copy values through data() as usual.  unbind() gives the argument
+    // back its own buffer, with undefined contents.
+    //-----------------------------------------------------------------
+
+    virtual bool		bind (char *data, size_t stride);
+    virtual void		unbind ();
+
   private:
     FunctionCall*		_func;
     bool                _varying;
@@ -74,6 +74,7 @@
 #include <cassert>
 #include <string.h>
 #include <memory>
+#include <chrono>
 
 #ifdef WIN32
     #include <io.h>
@@ -161,6 +162,14 @@ modulePathsInternal()
     return mpd;
 }
 
+double
+secondsSince (const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double>
+		(chrono::steady_clock::now() - start).count();
+}
+
+
 } // namespace
 
 
@@ -169,12 +178,16 @@ struct Interpreter::Data
     SymbolTable		symtab;
     ModuleSet		moduleSet;
     Mutex		mutex;
+
+    ModuleLoadStatisticsList		statistics;
+    double				importSeconds;
 };
 
 
 Interpreter::Interpreter (): _data (new Data)
 {
     set_module_path = false;
+    _data->importSeconds = 0;
 }
 
 
@@ -344,6 +357,20 @@ void Interpreter::_loadModule(const std::string &moduleName,
     Module *module = 0;
     LContext *lcontext = 0;
 
+    //
+    // Time spent loading the modules imported by this module is
+    // accumulated in _data->importSeconds; it is subtracted from
+    // the time spent parsing this module.
+    //
+
+    chrono::steady_clock::time_point loadStart = chrono::steady_clock::now();
+    double outerImportSeconds = _data->importSeconds;
+    _data->importSeconds = 0;
+
+    ModuleLoadStatistics stats;
+    stats.moduleName = moduleName;
+    stats.fileName = fileName;
+
     try
     {
 	//
@@ -364,12 +391,17 @@ void Interpreter::_loadModule(const std::string &moduleName,
 	SyntaxNodePtr syntaxTree = parser.parseInput ();
 //	syntaxTree->printTree();
 
+	stats.parseSeconds = secondsSince (loadStart) - _data->importSeconds;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
 	if (syntaxTree && lcontext->numErrors() == 0)
 	{
 	    debug ("\tgenerating code");
 	    syntaxTree->generateCode (*lcontext);
 	}
 
+	stats.generateSeconds = secondsSince (start);
+
 	if (lcontext->numErrors() > 0)
 	{
 	    lcontext->printDeclaredErrors();
@@ -382,7 +414,9 @@ void Interpreter::_loadModule(const std::string &moduleName,
 	//
 
 	debug ("\trunning module initialization code");
+	start = chrono::steady_clock::now();
 	module->runInitCode();
+	stats.initSeconds = secondsSince (start);
 
 	//
 	// Cleanup: the LContext and the module's local symbols
@@ -402,8 +436,13 @@ void Interpreter::_loadModule(const std::string &moduleName,
 	if(lcontext) delete lcontext;
 	_data->symtab.deleteAllSymbols (module);
 	_data->moduleSet.removeModule (moduleName);
+	_data->importSeconds = outerImportSeconds;
 	throw;
     }
+
+    stats.loadSeconds = secondsSince (loadStart);
+    _data->statistics.push_back (stats);
+    _data->importSeconds = outerImportSeconds + stats.loadSeconds;
 }
 
 void Interpreter::loadFile(const std::string &fileName,
@@ -460,6 +499,14 @@ Interpreter::loadModuleRecursive (const string &moduleName, const string &fileNa
 	_loadModule(moduleName, realFileName, moduleSource);
 }
 
+
+Interpreter::ModuleLoadStatisticsList
+Interpreter::moduleLoadStatistics () const
+{
+    Lock lock (_data->mutex);
+    return _data->statistics;
+}
+
 bool
 Interpreter::moduleIsLoaded (const std::string &moduleName) const
 {
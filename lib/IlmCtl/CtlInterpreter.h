@@ -168,6 +168,39 @@ class Interpreter
     static void setModulePaths(const std::vector<std::string>& newModPaths);
 
 
+    //---------------------------------------------------------------------
+    // Module load statistics:
+    //
+    // moduleLoadStatistics() returns timing information for the modules
+    // that have been loaded by this interpreter, in the order in which
+    // loading finished; imported modules finish before the modules that
+    // import them.  All times are wall-clock times in seconds:
+    //
+    //	parseSeconds	reading and parsing the module's source code,
+    //			excluding loading the modules that it imports
+    //
+    //	generateSeconds	generating executable code for the module
+    //
+    //	initSeconds	running the module's initialization code
+    //
+    //	loadSeconds	total time, including loading imported modules
+    //---------------------------------------------------------------------
+
+    struct ModuleLoadStatistics
+    {
+	std::string	moduleName;
+	std::string	fileName;
+	double		parseSeconds;
+	double		generateSeconds;
+	double		initSeconds;
+	double		loadSeconds;
+    };
+
+    typedef std::vector<ModuleLoadStatistics> ModuleLoadStatisticsList;
+
+    ModuleLoadStatisticsList	moduleLoadStatistics () const;
+
+
   protected:
 
     Interpreter ();
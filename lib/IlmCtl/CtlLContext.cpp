@@ -169,4 +169,19 @@ LContext::newArrayType (const DataTypePtr &baseType,
     return elementType;
 }
 
+
+ValueNodePtr
+LContext::newPackedValueNode
+    (int lineNumber,
+     const DataTypePtr &packedType,
+     const vector<char> &packedValues) const
+{
+    ExprNodeVector elements;
+
+    ValueNode::unpackValues
+	(*this, lineNumber, packedType, packedValues, elements);
+
+    return newValueNode (lineNumber, elements);
+}
+
 } // namespace Ctl
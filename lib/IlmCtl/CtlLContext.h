@@ -267,6 +267,20 @@ class LContext
 				     const ExprNodeVector &elements)
 				     const = 0;
 
+    //----------------------------------------------------------------
+    // newPackedValueNode() creates a ValueNode for an array initializer
+    // whose elements are stored as packed values (see ValueNode).
+    // The default implementation converts the values into LiteralNodes
+    // and calls newValueNode(); language contexts whose code generators
+    // can use the packed values directly should override it.
+    //----------------------------------------------------------------
+
+    virtual ValueNodePtr	newPackedValueNode
+				    (int lineNumber,
+				     const DataTypePtr &packedType,
+				     const std::vector<char> &packedValues)
+				     const;
+
     virtual VoidTypePtr		newVoidType () const = 0;
 
     virtual BoolTypePtr		newBoolType () const = 0;
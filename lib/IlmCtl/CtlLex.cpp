@@ -65,6 +65,7 @@
 #include <iomanip>
 #include <cassert>
 #include <cstdlib>
+#include <cfloat>
 
 
 #if 0
@@ -90,57 +91,121 @@ namespace {
 
 
 void
-getLine (istream &is, string &str)
+readText (istream &is, string &text)
 {
     //
-    // Read the next line from the input file and place in it str.
-    // The end of the line line may be represented according to
-    // Unix/Linux, Dos/Windows or Macintosh conventions:
+    // Read the entire contents of the input stream into text.
     //
-    // 	Unix	\n	(line feed)
-    // 	Dos	\r\n	(carriage return, line feed)
-    // 	Mac	\r	(carriage return)
+
+    text.clear();
+
+    char buf[65536];
+
+    while (is.read (buf, sizeof (buf)) || is.gcount() > 0)
+	text.append (buf, is.gcount());
+}
+
+
+inline bool
+isSpace (char c)
+{
+    //
+    // Same as isspace() in the "C" locale, but without a function call.
     //
 
-    str.clear();
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
 
-    char c;
 
-    while (is.get (c))
-    {
-	if (c == '\r')
-	{
-	    //
-	    // Mac or Dos end-of-line.
-	    //
+inline bool
+isDigit (char c)
+{
+    return c >= '0' && c <= '9';
+}
 
-	    char d;
 
-	    if (is.get (d) && d != '\n')
-	    {
-		//
-		// Mac end-of-line.  We've just read the first
-		// character of the following line; we must put
-		// it back into the input stream.
-		//
+bool
+fastFloatLiteral (const char *b, const char *e, double &value)
+{
+    //
+    // Convert a floating-point literal with at most 15 significant
+    // digits and a small decimal exponent, such as "0.25" or "1.5e3",
+    // without calling strtod().  The significand and the power of ten
+    // are both exactly representable as doubles, so a single multiply
+    // or divide yields the correctly rounded result, which is what
+    // strtod() would have returned.  Returns false if the literal
+    // does not qualify; the caller then falls back to strtod().
+    //
 
-		is.unget();			
-	    }
+#if defined (FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
 
-	    break;
-	}
+    static const double powersOfTen[] =
+    {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+	1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    unsigned long long significand = 0;
+    int numDigits = 0;
+    int scale = 0;
+
+    while (b < e && isDigit (*b))
+    {
+	significand = significand * 10 + (*b++ - '0');
+	numDigits += (significand != 0);
+    }
 
-	if (c == '\n')
+    if (b < e && *b == '.')
+    {
+	++b;
+
+	while (b < e && isDigit (*b))
 	{
-	    //
-	    // Unix end-of-line
-	    //
-	    
-	    break;
+	    significand = significand * 10 + (*b++ - '0');
+	    numDigits += (significand != 0);
+	    scale -= 1;
 	}
+    }
 
-	str += c;
+    if (numDigits > 15)
+	return false;
+
+    if (b < e && (*b == 'e' || *b == 'E'))
+    {
+	++b;
+
+	bool negative = false;
+
+	if (b < e && (*b == '+' || *b == '-'))
+	    negative = (*b++ == '-');
+
+	if (b == e)
+	    return false;
+
+	int exponent = 0;
+
+	while (b < e && isDigit (*b) && exponent < 1000)
+	    exponent = exponent * 10 + (*b++ - '0');
+
+	scale += negative? -exponent: exponent;
     }
+
+    if (b != e || scale < -22 || scale > 22)
+	return false;
+
+    if (scale >= 0)
+	value = double (significand) * powersOfTen[scale];
+    else
+	value = double (significand) / powersOfTen[-scale];
+
+    return true;
+
+#else
+
+    return false;
+
+#endif
 }
 
 
@@ -149,10 +214,13 @@ getLine (istream &is, string &str)
 
 Lex::Lex (LContext &lcontext, std::istream &file):
     _lcontext (lcontext),
-    _file(file),
-    _currentLine (""),
+    _text (""),
+    _lineBegin (0),
+    _lineEnd (0),
+    _nextLineBegin (0),
+    _currentPos (0),
+    _endOfText (!file),
     _currentChar (0),
-    _currentCharIndex (0),
     _currentLineNumber (0),
     _token (TK_END),
     _tokenIntValue (0),
@@ -163,6 +231,11 @@ Lex::Lex (LContext &lcontext, std::istream &file):
 	   "(this = " << this << ", "
 	   "lcontext = \"" << &lcontext << "\")");
 
+    if (file)
+	readText (file, _text);
+
+    _lineBegin = _lineEnd = _nextLineBegin = _currentPos = _text.c_str();
+
     next();
 }
 
@@ -192,41 +265,72 @@ Lex::nextLine ()
 {
     debug ("Lex::nextLine (this = " << this << ")");
 
-    if (_file)
+    if (_endOfText)
     {
-	//
-	// Read the next line, that is, all characters up to
-	// the next newline or up to the end of the input stream.
-	//
+	debug ("\treturn false");
+	return false;
+    }
 
-	_currentLineNumber += 1;
-	_currentChar = 0;
-	_currentCharIndex = 0;
+    //
+    // Find the end of the next line, that is, the next newline
+    // or the end of the program text.  The end of the line line
+    // may be represented according to Unix/Linux, Dos/Windows
+    // or Macintosh conventions:
+    //
+    // 	Unix	\n	(line feed)
+    // 	Dos	\r\n	(carriage return, line feed)
+    // 	Mac	\r	(carriage return)
+    //
+    // If the program text does not end with a newline, then the
+    // last line ends at the end of the text.  If it does, then
+    // the last line is empty.  A carriage return at the very end
+    // of the text counts as the end of the text.
+    //
 
-	getLine (_file, _currentLine);
+    const char *textEnd = _text.c_str() + _text.size();
+    const char *p = _nextLineBegin;
 
-	if (_currentLine.size() > 0)
-	    _currentChar = _currentLine[0];
+    while (p < textEnd && *p != '\n' && *p != '\r')
+	++p;
 
-	debug1 ("\t" << _currentLineNumber << "\t" << _currentLine);
+    _currentLineNumber += 1;
+    _lineBegin = _nextLineBegin;
+    _lineEnd = p;
+    _currentPos = _lineBegin;
+    _currentChar = (_currentPos < _lineEnd)? *_currentPos: 0;
 
-	debug ("\t\"" << _currentLine << "\"");
-	debug ("\treturn true");
+    if (p == textEnd)
+    {
+	_endOfText = true;
+    }
+    else if (*p == '\r')
+    {
+	++p;
 
-	return true;
+	if (p == textEnd)
+	    _endOfText = true;
+	else if (*p == '\n')
+	    ++p;
     }
     else
     {
-	debug ("\treturn false");
-	return false;
+	++p;
     }
+
+    _nextLineBegin = p;
+
+    debug1 ("\t" << _currentLineNumber << "\t" <<
+	    string (_lineBegin, _lineEnd));
+
+    debug ("\treturn true");
+    return true;
 }
 
 
 inline bool
 Lex::atEndOfLine () const
 {
-    return _currentCharIndex >= (int)_currentLine.size();
+    return _currentPos >= _lineEnd;
 }
 
 
@@ -240,17 +344,17 @@ Lex::currentChar () const
 inline void
 Lex::nextChar ()
 {
-    if (!atEndOfLine())
-	_currentCharIndex += 1;
+    if (_currentPos < _lineEnd)
+	_currentPos += 1;
 
-    _currentChar = atEndOfLine()? 0: _currentLine[_currentCharIndex];
+    _currentChar = (_currentPos < _lineEnd)? *_currentPos: 0;
 }
 
 
 void
 Lex::skipWhiteSpace ()
 {
-    while (isspace (currentChar()))
+    while (isSpace (currentChar()))
 	nextChar();
 }
 
@@ -645,13 +749,12 @@ Lex::getAtKeyword()
 bool
 Lex::getNameOrKeyword ()
 {
-    _tokenStringValue.clear();
+    const char *b = _currentPos;
 
     while (isalnum (currentChar()) || currentChar() == '_')
-    {
-	_tokenStringValue += currentChar();
 	nextChar();
-    }
+
+    _tokenStringValue.assign (b, _currentPos);
     
     if (_tokenStringValue == "bool")
 	_token = TK_BOOL;
@@ -718,7 +821,12 @@ Lex::getNameOrKeyword ()
 bool
 Lex::getIntOrFloatLiteral (bool decimalPointSeen)
 {
-    _tokenStringValue.clear();
+    //
+    // The literal is converted directly from the program text,
+    // from b up to the current position.
+    //
+
+    const char *b = _currentPos;
     bool isFloat = false;
 
     if (decimalPointSeen)
@@ -727,13 +835,12 @@ Lex::getIntOrFloatLiteral (bool decimalPointSeen)
 	// The caller has already seen, and advanced past, a decimal point.
 	//
 
-	_tokenStringValue += '.';
+	b -= 1;
 	isFloat = true;
     }
 
     if (!isFloat && currentChar() == '0')
     {
-	_tokenStringValue += currentChar();
 	nextChar();
 
 	if (currentChar() == 'x' || currentChar() == 'X')
@@ -742,21 +849,17 @@ Lex::getIntOrFloatLiteral (bool decimalPointSeen)
 	    // Base-16 integer, starts with 0x or 0X.
 	    //
 
-	    _tokenStringValue += currentChar();
 	    nextChar();
 
 	    while (isxdigit (currentChar()))
-	    {
-		_tokenStringValue += currentChar();
 		nextChar();
-	    }
 
-	    const char *b = _tokenStringValue.c_str();
-	    char *e;
+	    _tokenStringValue.assign (b, _currentPos);
 
+	    char *e;
 	    _tokenIntValue = strtol (b, &e, 0);
 
-	    if (e - b != (int)_tokenStringValue.size())
+	    if (e != _currentPos)
 	    {
 		_tokenIntValue = 0;
 
@@ -776,11 +879,8 @@ Lex::getIntOrFloatLiteral (bool decimalPointSeen)
     // Floating-point or decimal integer 
     //
 
-    while (isdigit (currentChar()))
-    {
-	_tokenStringValue += currentChar();
+    while (isDigit (currentChar()))
 	nextChar();
-    }
 
     if (currentChar() == '.' && !decimalPointSeen)
     {
@@ -788,15 +888,11 @@ Lex::getIntOrFloatLiteral (bool decimalPointSeen)
 	// Floating-point, get digits after the decimal point
 	//
 
-	_tokenStringValue += currentChar();
 	nextChar();
 	isFloat = true;
 
-	while (isdigit (currentChar()))
-	{
-	    _tokenStringValue += currentChar();
+	while (isDigit (currentChar()))
 	    nextChar();
-	}
     }
 
     if (currentChar() == 'e' || currentChar() == 'E')
@@ -805,39 +901,40 @@ Lex::getIntOrFloatLiteral (bool decimalPointSeen)
 	// Floating-point number in "scientific" notation, get exponent.
 	//
 
-	_tokenStringValue += currentChar();
 	nextChar();
 	isFloat = true;
 
 	if (currentChar() == '+' || currentChar() == '-')
-	{
-	    _tokenStringValue += currentChar();
 	    nextChar();
-	    isFloat = true;
-	}
 
-	while (isdigit (currentChar()))
-	{
-	    _tokenStringValue += currentChar();
+	while (isDigit (currentChar()))
 	    nextChar();
-	}
     }
 
+    _tokenStringValue.assign (b, _currentPos);
+
     if (isFloat)
     {
-	const char *b = _tokenStringValue.c_str();
-	char *e;
-
-	_tokenFloatValue = strtod (b, &e);
+	double value;
 
-	if (e - b != (int)_tokenStringValue.size())
+	if (fastFloatLiteral (b, _currentPos, value))
 	{
-	    _tokenFloatValue = 0;
+	    _tokenFloatValue = value;
+	}
+	else
+	{
+	    char *e;
+	    _tokenFloatValue = strtod (b, &e);
 
-	    printCurrentLine();
+	    if (e != _currentPos)
+	    {
+		_tokenFloatValue = 0;
+
+		printCurrentLine();
 
-	    MESSAGE_LE (_lcontext, ERR_FLOAT_SYNTAX, _currentLineNumber, 
-			"Invalid floating-point literal.");
+		MESSAGE_LE (_lcontext, ERR_FLOAT_SYNTAX, _currentLineNumber, 
+			    "Invalid floating-point literal.");
+	    }
 	}
 
 	if (currentChar() == 'h' || currentChar() == 'H')
@@ -862,19 +959,34 @@ Lex::getIntOrFloatLiteral (bool decimalPointSeen)
     }
     else
     {
-	const char *b = _tokenStringValue.c_str();
-	char *e;
+	if (*b != '0' && _currentPos - b <= 9)
+	{
+	    //
+	    // Short decimal integer without a leading zero (which
+	    // strtol() would interpret as octal); cannot overflow.
+	    //
+
+	    int value = 0;
 
-	_tokenIntValue = strtol (b, &e, 0);
+	    for (const char *p = b; p < _currentPos; ++p)
+		value = value * 10 + (*p - '0');
 
-	if (e - b != (int)_tokenStringValue.size())
+	    _tokenIntValue = value;
+	}
+	else
 	{
-	    _tokenIntValue = 0;
+	    char *e;
+	    _tokenIntValue = strtol (b, &e, 0);
 
-	    printCurrentLine();
+	    if (e != _currentPos)
+	    {
+		_tokenIntValue = 0;
 
-	    MESSAGE_LE (_lcontext, ERR_INT_SYNTAX, _currentLineNumber, 
-			"Invalid decimal integer literal.");
+		printCurrentLine();
+
+		MESSAGE_LE (_lcontext, ERR_INT_SYNTAX, _currentLineNumber, 
+			    "Invalid decimal integer literal.");
+	    }
 	}
 
 	_token = TK_INTLITERAL;
@@ -989,16 +1101,77 @@ Lex::printCurrentLine () const
 {
     string where;
 
-    for (int i = 0; i < _currentCharIndex; ++i)
-	where += (_currentLine[i] == '\t')? '\t': ' ';
+    for (const char *p = _lineBegin; p < _currentPos; ++p)
+	where += (*p == '\t')? '\t': ' ';
 
     where += '^';
 
-    MESSAGE (_currentLine);
+    MESSAGE (string (_lineBegin, _lineEnd));
     MESSAGE (where);
 }
 
 
+char
+Lex::peekChar () const
+{
+    //
+    // Look for the next non-blank character, first on the rest of
+    // the current line, then in the text that follows it.  The
+    // lexer's state is not changed.
+    //
+
+    for (const char *p = _currentPos; p < _lineEnd; ++p)
+	if (!isSpace (*p))
+	    return *p;
+
+    if (_endOfText)
+	return 0;
+
+    const char *textEnd = _text.c_str() + _text.size();
+
+    for (const char *p = _nextLineBegin; p < textEnd; ++p)
+	if (!isSpace (*p))
+	    return *p;
+
+    return 0;
+}
+
+
+Lex::Mark
+Lex::mark () const
+{
+    Mark m;
+
+    m.lineBegin = _lineBegin;
+    m.lineEnd = _lineEnd;
+    m.nextLineBegin = _nextLineBegin;
+    m.currentPos = _currentPos;
+    m.endOfText = _endOfText;
+    m.currentLineNumber = _currentLineNumber;
+    m.token = _token;
+    m.tokenIntValue = _tokenIntValue;
+    m.tokenFloatValue = _tokenFloatValue;
+
+    return m;
+}
+
+
+void
+Lex::reset (const Mark &m)
+{
+    _lineBegin = m.lineBegin;
+    _lineEnd = m.lineEnd;
+    _nextLineBegin = m.nextLineBegin;
+    _currentPos = m.currentPos;
+    _currentChar = (_currentPos < _lineEnd)? *_currentPos: 0;
+    _endOfText = m.endOfText;
+    _currentLineNumber = m.currentLineNumber;
+    _token = m.token;
+    _tokenIntValue = m.tokenIntValue;
+    _tokenFloatValue = m.tokenFloatValue;
+}
+
+
 void
 Lex::badToken (char c)
 {
@@ -76,9 +76,10 @@ class Lex
   public:
 
     //------------------------------------------------------------
-    // Constructor, opens the file that contains the program text,
-    // and calls next(), below.  The name of the file to be opened
-    // is found by querying the ErrorCound object.
+    // Constructor, reads the entire program text from file into
+    // memory, and calls next(), below.  The text is then scanned
+    // in place; file is not accessed again after the constructor
+    // returns.
     //------------------------------------------------------------
 
      Lex (LContext &lcontext, std::istream &file);
@@ -140,6 +141,40 @@ class Lex
     int			currentLineNumber () const {return _currentLineNumber;}
     void		printCurrentLine () const;
 
+
+    //-----------------------------------------------------------------
+    // Limited lookahead, for the parser's literal initializer fast path:
+    //
+    // peekChar() returns the first character after the current token
+    // that is not white space, or 0 if there is none.  Comments are
+    // not skipped; a comment after the current token makes peekChar()
+    // return '/'.
+    //
+    // mark() records the lexer's position, current token and numeric
+    // token value; reset() returns to a position recorded by mark().
+    // Tokens scanned between mark() and reset() are scanned again after
+    // the reset(), so the parser should only back up over tokens whose
+    // scanning has no side effects.
+    //-----------------------------------------------------------------
+
+    char		peekChar () const;
+
+    struct Mark
+    {
+	const char *	lineBegin;
+	const char *	lineEnd;
+	const char *	nextLineBegin;
+	const char *	currentPos;
+	bool		endOfText;
+	int		currentLineNumber;
+	Token		token;
+	int		tokenIntValue;
+	float		tokenFloatValue;
+    };
+
+    Mark		mark () const;
+    void		reset (const Mark &m);
+
   private:
 
     bool		nextLine ();
@@ -155,10 +190,13 @@ class Lex
     void		badToken (char c);
 
     LContext &	 _lcontext;
-    std::istream & _file;
-    std::string	_currentLine;
+    std::string		_text;
+    const char *	_lineBegin;
+    const char *	_lineEnd;
+    const char *	_nextLineBegin;
+    const char *	_currentPos;
+    bool		_endOfText;
     char		_currentChar;
-    int			_currentCharIndex;
     int			_currentLineNumber;
     Token		_token;
     int			_tokenIntValue;
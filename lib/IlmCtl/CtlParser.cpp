@@ -67,6 +67,7 @@
 #include <CtlVersion.h>
 #include <Iex.h>
 #include <cassert>
+#include <cstring>
 
 
 using namespace std;
@@ -141,6 +142,82 @@ findTailOfList (const Ptr &head)
 }
 
 
+DataTypePtr
+packedElementType (const DataTypePtr &dataType)
+{
+    //
+    // Initializers for arrays of ints, halfs or floats, including
+    // multi-dimensional arrays, can be stored as packed values.
+    // Returns the type of the packed values, or 0 if dataType is
+    // not such an array.
+    //
+
+    if (!dataType.cast<ArrayType>())
+	return 0;
+
+    DataTypePtr elementType = dataType;
+
+    while (ArrayTypePtr arrayType = elementType.cast<ArrayType>())
+	elementType = arrayType->elementType();
+
+    if (ValueNode::packedValueSize (elementType) == 0)
+	return 0;
+
+    return elementType;
+}
+
+
+template <class T>
+void
+appendValue (vector<char> &values, T x)
+{
+    size_t n = values.size();
+    values.resize (n + sizeof (x));
+    memcpy (&values[n], &x, sizeof (x));
+}
+
+
+void
+appendPackedValue
+    (vector<char> &values,
+     const DataTypePtr &packedType,
+     Token literal,
+     int intValue,
+     float floatValue)
+{
+    //
+    // Convert a literal to the type of the packed values, the
+    // same way as IntType::castValue(), HalfType::castValue() and
+    // FloatType::castValue() would, and append it to values.
+    //
+
+    if (literal == TK_HALFLITERAL)
+	floatValue = half (floatValue);
+
+    if (packedType.cast<IntType>())
+    {
+	if (literal == TK_INTLITERAL)
+	    appendValue (values, intValue);
+	else
+	    appendValue (values, int (floatValue));
+    }
+    else if (packedType.cast<HalfType>())
+    {
+	if (literal == TK_INTLITERAL)
+	    appendValue (values, half (intValue));
+	else
+	    appendValue (values, half (floatValue));
+    }
+    else
+    {
+	if (literal == TK_INTLITERAL)
+	    appendValue (values, float (intValue));
+	else
+	    appendValue (values, floatValue);
+    }
+}
+
+
 } // namespace
 
 
@@ -2129,10 +2206,27 @@ Parser::parseInitializer (ExprNodePtr &initialValue,
     //  array indices and goes out with actual sizes.  
     //  dataType is the type declared using sizes
 
+    //  Arrays of numbers whose initializers consist only of literals
+    //  are stored as packed values, without creating a LiteralNode
+    //  for each element.
+
     ExprNodeVector elements;
-    bool success = parseInitializerRecursive(dataType, elements, sizes, 0);
+    DataTypePtr packedType = packedElementType (dataType);
+    vector<char> packedValues;
+
+    bool success = parseInitializerRecursive (dataType, elements,
+					      packedType, packedValues,
+					      sizes, 0);
     if( success )
-	initialValue = _lcontext.newValueNode (currentLineNumber(), elements);
+    {
+	if (packedType)
+	    initialValue = _lcontext.newPackedValueNode (currentLineNumber(),
+							 packedType,
+							 packedValues);
+	else
+	    initialValue = _lcontext.newValueNode (currentLineNumber(),
+						   elements);
+    }
     return success;
 	
 }
@@ -2141,6 +2235,8 @@ Parser::parseInitializer (ExprNodePtr &initialValue,
 bool
 Parser::parseInitializerRecursive (DataTypePtr dataType, 
 				   ExprNodeVector& elements,
+				   DataTypePtr &packedType,
+				   vector<char> &packedValues,
 				   SizeVector& sizes,
 				   int depth)
 {
@@ -2151,6 +2247,11 @@ Parser::parseInitializerRecursive (DataTypePtr dataType,
     // Parses curly brace initializers, including structs and arrays
     // (and nested structs and arrays).  Recursively runs
     // on sub-elements.
+    //
+    // As long as packedType is not 0, literal elements are appended
+    // to packedValues.  The first element that is not a literal
+    // unpacks the values parsed so far into elements, and sets
+    // packedType to 0.
 
     if( StructTypePtr structType = dataType.cast<StructType>())
     {
@@ -2164,7 +2265,8 @@ Parser::parseInitializerRecursive (DataTypePtr dataType,
 	    SizeVector sub;
 	    if(ArrayTypePtr arrayType = it->type.cast<ArrayType>())
 		arrayType->sizes(sub);
-	    parseInitializerRecursive(it->type, elements, sub, 0);
+	    parseInitializerRecursive(it->type, elements,
+				      packedType, packedValues, sub, 0);
 
             if (token() == TK_COMMA)
             {
@@ -2206,7 +2308,8 @@ Parser::parseInitializerRecursive (DataTypePtr dataType,
 	{
 	    count ++;
 	    parseInitializerRecursive( arrayType->elementType(), 
-				       elements, sizes, depth+1 );
+				       elements, packedType, packedValues,
+				       sizes, depth+1 );
 
             if (token() == TK_COMMA)
             {
@@ -2249,12 +2352,127 @@ Parser::parseInitializerRecursive (DataTypePtr dataType,
 			"than the declared dimension.");
 	    success = false;
 	}
-	elements.push_back (parseExpression());
+
+	Token literal;
+	int intValue;
+	float floatValue;
+
+	if (parseLiteralElement (literal, intValue, floatValue))
+	{
+	    if (packedType)
+	    {
+		appendPackedValue (packedValues, packedType,
+				   literal, intValue, floatValue);
+	    }
+	    else if (literal == TK_INTLITERAL)
+	    {
+		elements.push_back (_lcontext.newIntLiteralNode
+					(currentLineNumber(), intValue));
+	    }
+	    else if (literal == TK_FLOATLITERAL)
+	    {
+		elements.push_back (_lcontext.newFloatLiteralNode
+					(currentLineNumber(), floatValue));
+	    }
+	    else
+	    {
+		elements.push_back (_lcontext.newHalfLiteralNode
+					(currentLineNumber(), floatValue));
+	    }
+	}
+	else
+	{
+	    if (packedType)
+	    {
+		ValueNode::unpackValues (_lcontext, currentLineNumber(),
+					 packedType, packedValues, elements);
+		packedType = 0;
+		vector<char>().swap (packedValues);
+	    }
+
+	    elements.push_back (parseExpression());
+	}
     }
     return success;
 }
 
 
+bool
+Parser::parseLiteralElement (Token &literal, int &intValue, float &floatValue)
+{
+    debugSyntax ("literalElement");
+
+    //
+    // Fast path for initializer elements that are numeric literals,
+    // optionally preceded by a minus sign: if the literal is followed
+    // by a comma or a closing brace, parseExpression() would return
+    // a LiteralNode (after evaluating the minus sign), so we skip the
+    // descent through the expression grammar.  Returns false, without
+    // consuming any tokens, for all other elements.
+    //
+
+    bool negate = false;
+    Lex::Mark mark;
+    int errors = 0;
+
+    if (token() == TK_MINUS)
+    {
+	//
+	// The minus sign is consumed only if a number follows.  Scanning
+	// a number has no side effects, except for reporting malformed
+	// numbers, so we can back up to the minus sign if the number is
+	// not followed by a comma or a closing brace.
+	//
+
+	char c = _lex.peekChar();
+
+	if (c < '0' || c > '9')
+	    return false;
+
+	mark = _lex.mark();
+	errors = numErrors();
+	negate = true;
+	next();
+    }
+
+    literal = token();
+    char c = _lex.peekChar();
+
+    if ((literal != TK_INTLITERAL &&
+	 literal != TK_FLOATLITERAL &&
+	 literal != TK_HALFLITERAL) ||
+	(c != ',' && c != '}'))
+    {
+	if (!negate)
+	    return false;
+
+	if (numErrors() == errors)
+	{
+	    _lex.reset (mark);
+	    return false;
+	}
+
+	//
+	// The number was malformed, and the error has been reported;
+	// don't report it again.  The caller will find a syntax error
+	// after the number.
+	//
+    }
+
+    intValue = tokenIntValue();
+    floatValue = tokenFloatValue();
+
+    if (negate)
+    {
+	intValue = -intValue;
+	floatValue = -floatValue;
+    }
+
+    next();
+    return true;
+}
+
+
 DataTypePtr
 Parser::parseBaseType ()
 {
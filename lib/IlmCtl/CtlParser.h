@@ -158,9 +158,16 @@ class Parser
     bool                parseInitializerRecursive
 				(DataTypePtr dataType,
 				 ExprNodeVector &elements,
+				 DataTypePtr &packedType,
+				 std::vector<char> &packedValues,
 				 SizeVector &s,
 				 int depth);
 
+    bool		parseLiteralElement
+				(Token &literal,
+				 int &intValue,
+				 float &floatValue);
+
     DataTypePtr		parseBaseType ();
     bool		parseVaryingHint ();
     void		parseArraySize (SizeVector &sizes);
@@ -61,6 +61,7 @@
 #include <CtlSymbolTable.h>
 #include <sstream>
 #include <cassert>
+#include <cctype>
 #include <iostream>
 #include <iomanip>
 
@@ -73,6 +74,16 @@ using namespace std;
 #endif
 
 namespace Ctl {
+namespace {
+
+//
+// Anonymous name space number i has scope id LOCAL_SCOPE | i.  Ids
+// of interned strings are always less than LOCAL_SCOPE.
+//
+
+const unsigned int LOCAL_SCOPE = 0x80000000u;
+
+} // namespace
 
 
 SymbolInfo::SymbolInfo
@@ -231,9 +242,103 @@ SymbolInfo::access () const
 }
 
 
+SymbolTable::NameTable::NameTable (): _slots (64, 0)
+{
+    // empty
+}
+
+
+size_t
+SymbolTable::NameTable::hash (const char *s, size_t n)
+{
+    //
+    // FNV-1a
+    //
+
+    size_t h = 2166136261u;
+
+    for (size_t i = 0; i < n; ++i)
+	h = (h ^ (unsigned char) s[i]) * 16777619u;
+
+    return h;
+}
+
+
+bool
+SymbolTable::NameTable::find (const char *s, size_t n, NameId &id) const
+{
+    size_t mask = _slots.size() - 1;
+
+    for (size_t i = hash (s, n) & mask; _slots[i]; i = (i + 1) & mask)
+    {
+	const string &str = _strings[_slots[i] - 1];
+
+	if (str.size() == n && str.compare (0, n, s, n) == 0)
+	{
+	    id = _slots[i] - 1;
+	    return true;
+	}
+    }
+
+    return false;
+}
+
+
+SymbolTable::NameId
+SymbolTable::NameTable::intern (const char *s, size_t n)
+{
+    NameId id;
+
+    if (find (s, n, id))
+	return id;
+
+    id = _strings.size();
+    assert (id < LOCAL_SCOPE);
+    _strings.push_back (string (s, n));
+
+    if (2 * _strings.size() > _slots.size())
+    {
+	grow();
+    }
+    else
+    {
+	size_t mask = _slots.size() - 1;
+	size_t i = hash (s, n) & mask;
+
+	while (_slots[i])
+	    i = (i + 1) & mask;
+
+	_slots[i] = id + 1;
+    }
+
+    return id;
+}
+
+
+void
+SymbolTable::NameTable::grow ()
+{
+    _slots.assign (_slots.size() * 2, 0);
+    size_t mask = _slots.size() - 1;
+
+    for (size_t id = 0; id < _strings.size(); ++id)
+    {
+	const string &str = _strings[id];
+	size_t i = hash (str.data(), str.size()) & mask;
+
+	while (_slots[i])
+	    i = (i + 1) & mask;
+
+	_slots[i] = id + 1;
+    }
+}
+
+
 SymbolTable::SymbolTable ()
 {
     _i = 0;
+    _rootScope = _names.intern ("", 0);
+    _globalScope = _rootScope;
 }
 
 
@@ -249,6 +354,7 @@ SymbolTable::setGlobalNamespace (const std::string &name)
     debug ("SymbolTable::setGlobalNamespace (name = " << name << ")");
 
     _globalNs = name;
+    _globalScope = _names.intern (name.data(), name.size());
 }
 
 
@@ -265,6 +371,9 @@ SymbolTable::pushLocalNamespace ()
 {
     debug ("SymbolTable::pushLocalNamespace()");
 
+    assert ((unsigned int) _i < LOCAL_SCOPE);
+    _localScopes.push_back (LOCAL_SCOPE | _i);
+
     stringstream ss;
     ss << "N" << _i++;
     _localNsStack.push_back (ss.str());
@@ -280,9 +389,54 @@ SymbolTable::popLocalNamespace ()
 
     assert (!_localNsStack.empty());
     _localNsStack.pop_back();
+    _localScopes.pop_back();
+}
+
+
+bool
+SymbolTable::localScope (const char *s, size_t n, NameId &scope)
+{
+    //
+    // If s is the scope of an anonymous name space, of the form
+    // namespace::Ni, set scope to the id of that name space.
+    //
+
+    size_t i = n;
+
+    while (i > 0 && isdigit ((unsigned char) s[i - 1]))
+	--i;
+
+    if (i == n || i < 3 || s[i - 1] != 'N' || s[i - 2] != ':' || s[i - 3] != ':')
+	return false;
+
+    NameId number = 0;
+
+    for (; i < n; ++i)
+	number = number * 10 + (s[i] - '0');
+
+    scope = LOCAL_SCOPE | number;
+    return true;
+}
+
+
+SymbolTable::NameId
+SymbolTable::findOrInternScope (const char *s, size_t n)
+{
+    NameId scope;
+
+    if (localScope (s, n, scope))
+	return scope;
+
+    return _names.intern (s, n);
 }
 
 
+bool
+SymbolTable::findScope (const char *s, size_t n, NameId &scope) const
+{
+    return localScope (s, n, scope) || _names.find (s, n, scope);
+}
+
 
 bool
 SymbolTable::defineSymbol (const string &name, const SymbolInfoPtr &info)
@@ -291,10 +445,28 @@ SymbolTable::defineSymbol (const string &name, const SymbolInfoPtr &info)
 
     string absName = getAbsoluteName(name);
 
-    if (_symbols.find (absName) != _symbols.end())
+    //
+    // Split the absolute name into scope and relative name.  If the
+    // scope itself contains "::", then the symbol is defined in a local
+    // name space.
+    //
+
+    size_t sep = absName.rfind ("::");
+    assert (sep != string::npos);
+
+    NameId scope = findOrInternScope (absName.data(), sep);
+
+    NameId relName = _names.intern (absName.data() + sep + 2,
+				    absName.size() - sep - 2);
+
+    Symbol &symbol = _symbols[symbolKey (scope, relName)];
+
+    if (symbol.info)
 	return false;
 
-    _symbols[absName] = info;
+    symbol.info = info;
+    symbol.absName = absName;
+    symbol.isLocal = (absName.find ("::") != sep);
     return true;
 }
 
@@ -328,100 +500,95 @@ SymbolTable::getAbsoluteName (const string &name)
 
 
 SymbolInfoPtr
-SymbolTable::lookupSymbol (const string &name, const string **absName) const
+SymbolTable::findSymbol
+    (NameId scope,
+     NameId name,
+     const string **absName) const
 {
-    debug ("SymbolTable::lookupSymbol (name = " << name << ")");
-
-    if (name.find ("::") != string::npos)
-    {
-	debug ("\ttrying " << name);
-	SymbolMap::const_iterator j = _symbols.find (name);
-
-	if (j != _symbols.end())
-	{
-	    debug ("\tfound");
+    SymbolMap::const_iterator j = _symbols.find (symbolKey (scope, name));
 
-	    if (absName)
-		*absName = &j->first;
+    if (j == _symbols.end())
+	return 0;
 
-	    return j->second;
-	}
-    }
-    else
-    {
-	for (StringStack::const_reverse_iterator i = _localNsStack.rbegin();
-	     i != _localNsStack.rend();
-	     ++i)
-	{
+    debug ("\tfound " << j->second.absName);
 
-	    string tmpName = _globalNs + "::" + *i + "::" + name;
-	    debug ("\ttrying " << tmpName);
-	    SymbolMap::const_iterator j = _symbols.find (tmpName);
+    if (absName)
+	*absName = &j->second.absName;
 
-	    if (j != _symbols.end())
-	    {
-		debug ("\tfound");
+    return j->second.info;
+}
 
-		if (absName)
-		    *absName = &j->first;
 
-		return j->second;
-	    }
-	}
+SymbolInfoPtr
+SymbolTable::lookupSymbol (const string &name, const string **absName) const
+{
+    debug ("SymbolTable::lookupSymbol (name = " << name << ")");
 
-	{
-	    string tmpName = _globalNs + "::" + name;
-	    debug ("\ttrying " << tmpName);
-	    SymbolMap::const_iterator j = _symbols.find (tmpName);
+    if (absName)
+	*absName = 0;
 
-	    if (j != _symbols.end())
-	    {
-		debug ("\tfound");
+    size_t sep = name.rfind ("::");
 
-		if (absName)
-		    *absName = &j->first;
+    if (sep != string::npos)
+    {
+	//
+	// Absolute name; the symbol can only be in the name's own scope.
+	// The id of an anonymous name space, namespace::Ni, does not
+	// depend on the namespace part, so compare the full name.
+	//
 
-		return j->second;
-	    }
-	}
+	NameId scope, relName;
+	const string *symbolName;
 
+	if (findScope (name.data(), sep, scope) &&
+	    _names.find (name.data() + sep + 2, name.size() - sep - 2, relName))
 	{
-	    string tmpName = "::" + name;
-	    debug ("\ttrying " << tmpName);
-	    SymbolMap::const_iterator j = _symbols.find (tmpName);
+	    SymbolInfoPtr info = findSymbol (scope, relName, &symbolName);
 
-	    if (j != _symbols.end())
+	    if (info && *symbolName == name)
 	    {
-		debug ("\tfound");
-
 		if (absName)
-		    *absName = &j->first;
+		    *absName = symbolName;
 
-		return j->second;
+		return info;
 	    }
 	}
+    }
+    else
+    {
+	//
+	// Relative name; search the local name spaces from the inside
+	// out, then the global name space and finally the root name
+	// space.  A name that has never been interned cannot be in the
+	// table.
+	//
 
+	NameId relName;
+
+	if (!_names.find (name.data(), name.size(), relName))
 	{
-	    debug ("\ttrying " << name);
-	    SymbolMap::const_iterator j = _symbols.find (name);
+	    debug ("\tnot found");
+	    return 0;
+	}
 
-	    if (j != _symbols.end())
-	    {
-		debug ("\tfound");
+	SymbolInfoPtr info;
 
-		if (absName)
-		    *absName = &j->first;
-
-		return j->second;
-	    }
+	for (ScopeStack::const_reverse_iterator i = _localScopes.rbegin();
+	     i != _localScopes.rend();
+	     ++i)
+	{
+	    if ((info = findSymbol (*i, relName, absName)))
+		return info;
 	}
-    }
 
-    debug ("\tnot found");
+	if ((info = findSymbol (_globalScope, relName, absName)))
+	    return info;
 
-    if (absName)
-	*absName = 0;
+	if ((info = findSymbol (_rootScope, relName, absName)))
+	    return info;
+    }
 
+    debug ("\tnot found");
     return 0;
 }
 
@@ -433,10 +600,10 @@ SymbolTable::deleteAllSymbols (const Module *module)
     
     while (i != _symbols.end())
     {
-	SymbolMap::iterator j = i++;
-
-	if (j->second->module() == module)
-	    _symbols.erase (j);
+	if (i->second.info->module() == module)
+	    i = _symbols.erase (i);
+	else
+	    ++i;
     }
 }
 
@@ -448,18 +615,10 @@ SymbolTable::deleteAllLocalSymbols (const Module *module)
     
     while (i != _symbols.end())
     {
-	SymbolMap::iterator j = i++;
-
-	//
-	// If the substring "::" occurs at least twice in a symbol's
-	// absolute name then the symbol is defined in a local name space.
-	//
-
-	if (j->second->module() == module &&
-	    j->first.find ("::") != j->first.rfind ("::"))
-	{
-	    _symbols.erase (j);
-	}
+	if (i->second.info->module() == module && i->second.isLocal)
+	    i = _symbols.erase (i);
+	else
+	    ++i;
     }
 }
 
@@ -91,6 +91,16 @@
 //	N1 are anonymous namespaces.)  The relative names x and y in line 7
 //	refer to the absolute names ilm::N0::x and ilm::N0::N1::y.
 //
+//	Internally, an absolute name is split into a scope (everything
+//	before the last "::") and a relative name, and both parts are
+//	converted to small integers.  Symbols are kept in a hash table
+//	keyed by the (scope, name) pair, so that looking up a relative
+//	name probes the table once per enclosing name space without
+//	building any strings.  Relative names and global name spaces are
+//	interned; anonymous name spaces are identified by their number,
+//	so that the interned strings do not grow with every block that
+//	the parser enters.
+//
 //-----------------------------------------------------------------------------
 
 #include <CtlType.h>
@@ -99,7 +109,8 @@
 #include <CtlAddr.h>
 #include <string>
 #include <vector>
-#include <map>
+#include <deque>
+#include <unordered_map>
 
 namespace Ctl {
 
@@ -271,11 +282,62 @@ class SymbolTable
 
   private:
 
-    typedef std::map <std::string, SymbolInfoPtr> SymbolMap;
+    typedef unsigned int NameId;
+
+    //
+    // NameTable -- interned strings.  Every distinct string is stored
+    // once and identified by a small integer.  Strings can be found
+    // by (pointer, length), without constructing a std::string.
+    //
+
+    class NameTable
+    {
+      public:
+
+	NameTable ();
+
+	NameId			intern (const char *s, size_t n);
+	bool			find (const char *s, size_t n, NameId &id) const;
+
+      private:
+
+	static size_t		hash (const char *s, size_t n);
+	void			grow ();
+
+	std::deque <std::string>	_strings;
+	std::vector <NameId>		_slots;		// id + 1, or 0 if empty
+    };
+
+    struct Symbol
+    {
+	SymbolInfoPtr	info;
+	std::string	absName;
+	bool		isLocal;
+    };
+
+    typedef unsigned long long SymbolKey;
+    typedef std::unordered_map <SymbolKey, Symbol> SymbolMap;
     typedef std::vector <std::string> StringStack;
+    typedef std::vector <NameId> ScopeStack;
+
+    static SymbolKey	symbolKey (NameId scope, NameId name)
+			    {return ((SymbolKey) scope << 32) | name;}
+
+    SymbolInfoPtr	findSymbol (NameId scope,
+				    NameId name,
+				    const std::string **absName) const;
+
+    static bool		localScope (const char *s, size_t n, NameId &scope);
+
+    NameId		findOrInternScope (const char *s, size_t n);
+    bool		findScope (const char *s, size_t n, NameId &scope) const;
 
     SymbolMap		_symbols;
+    NameTable		_names;
     StringStack		_localNsStack;
+    ScopeStack		_localScopes;	// ids of the scopes in _localNsStack
+    NameId		_globalScope;	// interned _globalNs
+    NameId		_rootScope;	// interned empty string
     std::string		_globalNs;
     int			_i;
 };
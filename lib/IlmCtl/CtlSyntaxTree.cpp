@@ -63,9 +63,11 @@
 #include <CtlSymbolTable.h>
 #include <CtlMessage.h>
 #include <CtlLContext.h>
+#include <CtlType.h>
 #include <iostream>
 #include <iomanip>
 #include <cassert>
+#include <cstring>
 #include <CtlErrors.h>
 
 using namespace std;
@@ -1558,11 +1560,32 @@ ValueNode::ValueNode
 }
 
 
+ValueNode::ValueNode
+    (int lineNumber,
+     const DataTypePtr &packedType,
+     const std::vector<char> &packedValues)
+:
+    ExprNode (lineNumber),
+    packedType (packedType),
+    packedValues (packedValues)
+{
+    // empty
+}
+
+
 void
 ValueNode::print (int indent) const
 {
     cout << setw (indent) << "" << lineNumber << " value initializer" << endl;
 
+    if (isPacked())
+    {
+	cout << setw (indent + 1) << "" <<
+		packedValues.size() / packedValueSize (packedType) <<
+		" packed " << packedType->asString() << " values" << endl;
+	return;
+    }
+
     if(elements.size() <= 20)
     {
 	for (int i = 0; i < (int)elements.size(); ++i)
@@ -1636,6 +1659,13 @@ bool
 ValueNode::checkElementTypes (const DataTypePtr &dataType,
 			      LContext &lcontext) const
 {
+    //
+    // Packed values have already been converted to the element type.
+    //
+
+    if (isPacked())
+	return true;
+
     int eIndex = 0;
     return checkElementTypesRec(dataType, lcontext, eIndex);
 }
@@ -1703,4 +1733,76 @@ ValueNode::isLvalue (const SymbolInfoPtr &initInfo) const
     return false;
 }
 
+
+void
+ValueNode::unpack (const LContext &lcontext)
+{
+    if (!isPacked())
+	return;
+
+    unpackValues (lcontext, lineNumber, packedType, packedValues, elements);
+
+    packedType = 0;
+    std::vector<char>().swap (packedValues);
+}
+
+
+void
+ValueNode::unpackValues
+    (const LContext &lcontext,
+     int lineNumber,
+     const DataTypePtr &packedType,
+     const std::vector<char> &packedValues,
+     ExprNodeVector &elements)
+{
+    const char *p = packedValues.empty()? 0: &packedValues[0];
+    const char *end = p + packedValues.size();
+
+    elements.reserve (elements.size() + 
+		      packedValues.size() / packedValueSize (packedType));
+
+    if (packedType.cast<IntType>())
+    {
+	for (int x; p < end; p += sizeof (x))
+	{
+	    memcpy (&x, p, sizeof (x));
+	    elements.push_back (lcontext.newIntLiteralNode (lineNumber, x));
+	}
+    }
+    else if (packedType.cast<HalfType>())
+    {
+	for (half x; p < end; p += sizeof (x))
+	{
+	    memcpy (&x, p, sizeof (x));
+	    elements.push_back (lcontext.newHalfLiteralNode (lineNumber, x));
+	}
+    }
+    else
+    {
+	assert (packedType.cast<FloatType>());
+
+	for (float x; p < end; p += sizeof (x))
+	{
+	    memcpy (&x, p, sizeof (x));
+	    elements.push_back (lcontext.newFloatLiteralNode (lineNumber, x));
+	}
+    }
+}
+
+
+size_t
+ValueNode::packedValueSize (const DataTypePtr &packedType)
+{
+    if (packedType.cast<IntType>())
+	return sizeof (int);
+
+    if (packedType.cast<HalfType>())
+	return sizeof (half);
+
+    if (packedType.cast<FloatType>())
+	return sizeof (float);
+
+    return 0;
+}
+
 } // namespace Ctl
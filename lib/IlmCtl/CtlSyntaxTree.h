@@ -646,10 +646,22 @@ struct ValueNode: public ExprNode
     //  values of the elements of a struct or array.  (In CTL an
     //  ValueNode corresponds to an struct initializer, for example 
     //  {1, 3, x/4, 2}.)
+    //
+    //  The elements of an array initializer that consists entirely
+    //  of numeric literals, for example {0.5, -1, 2.25}, can be
+    //  stored "packed" instead: packedValues holds the values of
+    //  the elements, already converted to type packedType, and laid
+    //  out in memory the same way as the array.  A packed ValueNode
+    //  has no LiteralNodes in elements; unpack() creates them for
+    //  code that needs them.
     //------------------------------------------------------------
 
     ValueNode (int lineNumber, const ExprNodeVector &elements);
 
+    ValueNode (int lineNumber,
+	       const DataTypePtr &packedType,
+	       const std::vector<char> &packedValues);
+
     virtual void	print (int indent) const;
 
 
@@ -691,7 +703,34 @@ struct ValueNode: public ExprNode
     virtual bool	isLvalue (const SymbolInfoPtr &initInfo = 0) const;
 
 
+    //-----------------------------------------------------------------
+    // Packed values:
+    //
+    // isPacked() returns true if the elements are stored in packedValues.
+    //
+    // unpack() converts packed values into LiteralNodes, and stores
+    // them in elements; unpackValues() does the same for values that
+    // are not (yet) stored in a ValueNode.
+    //
+    // packedValueSize() returns the size in bytes of one packed value
+    // of type packedType, or 0 if values of that type cannot be packed.
+    //-----------------------------------------------------------------
+
+    bool		isPacked () const	{return packedType;}
+
+    void		unpack (const LContext &lcontext);
+
+    static void		unpackValues (const LContext &lcontext,
+				      int lineNumber,
+				      const DataTypePtr &packedType,
+				      const std::vector<char> &packedValues,
+				      ExprNodeVector &elements);
+
+    static size_t	packedValueSize (const DataTypePtr &packedType);
+
     ExprNodeVector	elements;
+    DataTypePtr		packedType;
+    std::vector<char>	packedValues;
 };
 
 
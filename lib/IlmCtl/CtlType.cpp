@@ -112,7 +112,7 @@ void Type::childElementV(size_t *offset, TypePtr *type, const std::string &path,
 	segment=remainder;
 	start=remainder.find_first_of("/");
 	if(start!=(std::string::size_type)-1) {
-		segment=std::string(remainder.begin(), remainder.begin()+start-1);
+		segment=std::string(remainder.begin(), remainder.begin()+start);
 		remainder=std::string(remainder.begin()+start, remainder.end());
 	} else {
 		remainder="";
@@ -168,7 +168,7 @@ void Type::childElementV(size_t *offset, TypePtr *type, const std::string &path,
 		count=struct_type->members().size();
 		for(u=0; u<count; u++) {
 			if(struct_type->members()[u].name==segment) {
-				*offset=*offset+u*struct_type->objectSize();
+				*offset=*offset+struct_type->members()[u].offset;
 				*type=struct_type->members()[u].type;
 				childElementV(offset, type, remainder, ap);
 				return;
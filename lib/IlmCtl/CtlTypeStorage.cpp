@@ -248,6 +248,74 @@ void _convert(void *out, const void *in, CDataType_e out_type,
 	}
 }
 
+// Converts count samples of type S, in_stride bytes apart, into samples
+// of type D, out_stride bytes apart. Used by _set / _get for all pairs
+// of bool, int, unsigned int, half and float, so that the conversion
+// is picked once per call rather than once per sample. Densely packed
+// samples get a loop over plain arrays that the compiler can vectorize.
+template <class S, class D>
+static void _convert_samples(char *out, size_t out_stride, const char *in,
+                             size_t in_stride, size_t count) {
+	size_t u;
+
+	if(in_stride==sizeof(S) && out_stride==sizeof(D)) {
+		const S *typed_in=(const S *)in;
+		D *typed_out=(D *)out;
+
+		for(u=0; u<count; u++) {
+			typed_out[u]=(D)typed_in[u];
+		}
+		return;
+	}
+
+	for(u=0; u<count; u++) {
+		*((D *)out)=(D)*((const S *)in);
+		in=in+in_stride;
+		out=out+out_stride;
+	}
+}
+
+typedef void (*_ConvertSamples)(char *out, size_t out_stride, const char *in,
+                                size_t in_stride, size_t count);
+
+template <class S>
+static _ConvertSamples _convert_samples_from(CDataType_e out_type) {
+	switch(out_type) {
+		case BoolTypeEnum:
+			return _convert_samples<S, bool>;
+		case IntTypeEnum:
+			return _convert_samples<S, int>;
+		case UIntTypeEnum:
+			return _convert_samples<S, unsigned int>;
+		case HalfTypeEnum:
+			return _convert_samples<S, half>;
+		case FloatTypeEnum:
+			return _convert_samples<S, float>;
+		default:
+			return NULL;
+	}
+}
+
+// Returns the conversion kernel for a pair of PODish types, or NULL if
+// one of them is a string (those go through _convert one at a time).
+static _ConvertSamples _convert_samples_func(CDataType_e out_type,
+                                             CDataType_e in_type) {
+	switch(in_type) {
+		case BoolTypeEnum:
+			return _convert_samples_from<bool>(out_type);
+		case IntTypeEnum:
+			return _convert_samples_from<int>(out_type);
+		case UIntTypeEnum:
+			return _convert_samples_from<unsigned int>(out_type);
+		case HalfTypeEnum:
+			return _convert_samples_from<half>(out_type);
+		case FloatTypeEnum:
+			return _convert_samples_from<float>(out_type);
+		default:
+			return NULL;
+	}
+}
+
 // Zeros a type. Scalars are set to 0, Strings are set to '',
 // Arrays / structs have all of their entries zero'd
 void _clear(char *out, const DataTypePtr &type) {
@@ -386,31 +454,49 @@ void _set_spam(char *out, const char *in,
 	}
 }
 
+TypeStorage::Element TypeStorage::element(const std::string &path, ...) const {
+	Element e;
+	va_list ap;
+
+	va_start(ap, path);
+	e=elementv(path, ap);
+	va_end(ap);
+	return e;
+}
+
+// Resolves an element path once. Only the PODish types (and strings)
+// can be reached through the set / get functions, so that is checked
+// here rather than on every call.
+TypeStorage::Element TypeStorage::elementv(const std::string &path,
+                                           va_list ap) const {
+	Element e;
+	TypePtr _data_type;
+
+	_data_type=type();
+	Type::childElementV(&e._offset, &_data_type, path, ap);
+	e._type=_data_type;
+	if(e._type->cDataType()!=BoolTypeEnum &&
+	   e._type->cDataType()!=FloatTypeEnum &&
+	   e._type->cDataType()!=IntTypeEnum &&
+	   e._type->cDataType()!=UIntTypeEnum &&
+	   e._type->cDataType()!=HalfTypeEnum &&
+	   e._type->cDataType()!=StringTypeEnum) {
+		throw(DatatypeExc("unable to access type %s via direct C++ interface (bad element path perhaps?)", e._type->asString().c_str()));
+	}
+	return e;
+}
+
 void TypeStorage::_set(const char *src, CDataType_e src_type,
 	                   size_t src_stride, size_t dst_offset, size_t count,
-                       const std::string &path, va_list ap) {
+                       const Element &element) {
 	const char *in;
 	char *out;
 	size_t u;
-	size_t path_offset;
-	TypePtr _data_type;
-	DataTypePtr data_type;
-
-	_data_type=type();
-	path_offset=0;
-	Type::childElementV(&path_offset, &_data_type, path, ap);
-	data_type=_data_type;
-	if(data_type->cDataType()!=BoolTypeEnum &&
-	   data_type->cDataType()!=FloatTypeEnum &&
-	   data_type->cDataType()!=IntTypeEnum &&
-	   data_type->cDataType()!=UIntTypeEnum &&
-	   data_type->cDataType()!=HalfTypeEnum &&
-	   data_type->cDataType()!=StringTypeEnum) {
-		throw(DatatypeExc("unable to set type %s via direct C++ interface (bad element path perhaps?)", data_type->asString().c_str()));
-	}
+	const DataTypePtr &data_type=element.type();
+	_ConvertSamples convert_samples;
 
 	in=src;
-	out=data()+dst_offset*type()->objectSize()+path_offset;
+	out=data()+dst_offset*type()->objectSize()+element.offset();
 
 	// All of the simple copies which simply revolve around (possibly)
 	// just changing the stride.
@@ -424,7 +510,8 @@ void TypeStorage::_set(const char *src, CDataType_e src_type,
 			return;
 		}
 		if(data_type->objectSize()==src_stride &&
-		   data_type->alignedObjectSize()==src_stride) {
+		   data_type->alignedObjectSize()==src_stride &&
+		   type()->objectSize()==src_stride) {
 			memcpy(out, in, data_type->objectSize()*count);
 		} else if(data_type->objectSize()==sizeof(char)) {
 			for(u=0; u<count; u++) {
@@ -462,9 +549,14 @@ void TypeStorage::_set(const char *src, CDataType_e src_type,
 		return;
 	}
 
+	convert_samples=_convert_samples_func(data_type->cDataType(), src_type);
+	if(convert_samples!=NULL) {
+		convert_samples(out, type()->objectSize(), in, src_stride, count);
+		return;
+	}
+
 	for(u=0; u<count; u++) {
-		_convert(out, in, type()->cDataType(),
-		         src_type);
+		_convert(out, in, data_type->cDataType(), src_type);
 		in=in+src_stride;
 		out=out+type()->objectSize();
 	}
@@ -472,29 +564,15 @@ void TypeStorage::_set(const char *src, CDataType_e src_type,
 
 void TypeStorage::_get(char *dst, CDataType_e dst_type,
 	                   size_t dst_stride, size_t src_offset, size_t count,
-                       const std::string &path, va_list ap) {
+                       const Element &element) {
 	const char *in;
 	char *out;
 	size_t u;
-	size_t path_offset;
-	TypePtr _data_type;
-	DataTypePtr data_type;
-
-	_data_type=type();
-	path_offset=0;
-	Type::childElementV(&path_offset, &_data_type, path, ap);
-	data_type=_data_type;
-	if(data_type->cDataType()!=BoolTypeEnum &&
-	   data_type->cDataType()!=FloatTypeEnum &&
-	   data_type->cDataType()!=IntTypeEnum &&
-	   data_type->cDataType()!=UIntTypeEnum &&
-	   data_type->cDataType()!=HalfTypeEnum &&
-	   data_type->cDataType()!=StringTypeEnum) {
-		throw(DatatypeExc("unable to get type %s via direct C++ interface (bad element path perhaps?)", data_type->asString().c_str()));
-	}
+	const DataTypePtr &data_type=element.type();
+	_ConvertSamples convert_samples;
 
 	out=dst;
-	in=data()+src_offset*type()->objectSize()+path_offset;
+	in=data()+src_offset*type()->objectSize()+element.offset();
 
 	// All of the simple copies which simply revolve around (possibly)
 	// just changing the stride.
@@ -508,7 +586,8 @@ void TypeStorage::_get(char *dst, CDataType_e dst_type,
 			return;
 		}
 		if(data_type->objectSize()==dst_stride &&
-		   data_type->alignedObjectSize()==dst_stride) {
+		   data_type->alignedObjectSize()==dst_stride &&
+		   type()->objectSize()==dst_stride) {
 			memcpy(out, in, data_type->objectSize()*count);
 		} else if(data_type->objectSize()==sizeof(char)) {
 			for(u=0; u<count; u++) {
@@ -546,8 +625,14 @@ void TypeStorage::_get(char *dst, CDataType_e dst_type,
 		return;
 	}
 
+	convert_samples=_convert_samples_func(dst_type, data_type->cDataType());
+	if(convert_samples!=NULL) {
+		convert_samples(out, dst_stride, in, type()->objectSize(), count);
+		return;
+	}
+
 	for(u=0; u<count; u++) {
-		_convert(out, in, dst_type, type()->cDataType());
+		_convert(out, in, dst_type, data_type->cDataType());
 		out=out+dst_stride;
 		in=in+type()->objectSize();
 	}
@@ -652,10 +737,9 @@ void TypeStorage::copy(const TypeStoragePtr &src, size_t src_offset,
 	    src->type()->cDataType()==UIntTypeEnum ||
 	    src->type()->cDataType()==HalfTypeEnum ||
 	    src->type()->cDataType()==StringTypeEnum)) {
-        va_list empty;
 //		fprintf(stderr, "_set %p %d %d %d %d %d\n", out, src->type()->cDataType(), type()->cDataType(), type()->objectSize(), dst_offset, count);
 		_set(in, src->type()->cDataType(), src->type()->objectSize(),
-		     dst_offset, count, "", empty);
+		     dst_offset, count, element());
 		return;
 	}
 
@@ -678,8 +762,8 @@ void TypeStorage::set(const bool *src, size_t src_stride, size_t dst_offset,
 
 void TypeStorage::setv(const bool *src, size_t src_stride, size_t dst_offset,
                        size_t count, const std::string &path, va_list ap) {
-	_set((const char *)src, BoolTypeEnum, src_stride, dst_offset, count, path,
-	     ap);
+	_set((const char *)src, BoolTypeEnum, src_stride, dst_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::set(const int *src, size_t src_stride, size_t dst_offset,
@@ -693,8 +777,8 @@ void TypeStorage::set(const int *src, size_t src_stride, size_t dst_offset,
 
 void TypeStorage::setv(const int *src, size_t src_stride, size_t dst_offset,
                        size_t count, const std::string &path, va_list ap) {
-	_set((const char *)src, IntTypeEnum, src_stride, dst_offset, count, path,
-	     ap);
+	_set((const char *)src, IntTypeEnum, src_stride, dst_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::set(const unsigned int *src, size_t src_stride,
@@ -710,8 +794,8 @@ void TypeStorage::set(const unsigned int *src, size_t src_stride,
 void TypeStorage::setv(const unsigned int *src, size_t src_stride,
                        size_t dst_offset, size_t count,
                        const std::string &path, va_list ap) {
-	_set((const char *)src, UIntTypeEnum, src_stride, dst_offset, count, path,
-	     ap);
+	_set((const char *)src, UIntTypeEnum, src_stride, dst_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::set(const half *src, size_t src_stride, size_t dst_offset,
@@ -727,8 +811,8 @@ void TypeStorage::set(const half *src, size_t src_stride, size_t dst_offset,
 void TypeStorage::setv(const half *src, size_t src_stride, size_t dst_offset,
                        size_t count, const std::string &path,
                        va_list ap) {
-	_set((const char *)src, HalfTypeEnum, src_stride, dst_offset, count, path,
-	     ap);
+	_set((const char *)src, HalfTypeEnum, src_stride, dst_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::set(const float *src, size_t src_stride,
@@ -745,7 +829,7 @@ void TypeStorage::setv(const float *src, size_t src_stride,
                        size_t dst_offset, size_t count,
                        const std::string &path, va_list ap) {
 	_set((const char *)src, FloatTypeEnum, src_stride, dst_offset, count,
-	     path, ap);
+	     elementv(path, ap));
 }
 
 void TypeStorage::set(const std::string *src, size_t src_stride,
@@ -762,7 +846,7 @@ void TypeStorage::setv(const std::string *src, size_t src_stride,
                        size_t dst_offset, size_t count,
                        const std::string &path, va_list ap) {
 	_set((const char *)src, StringTypeEnum, src_stride, dst_offset, count,
-	     path, ap);
+	     elementv(path, ap));
 }
 
 
@@ -779,7 +863,8 @@ void TypeStorage::get(const bool *dst, size_t dst_stride, size_t src_offset,
 void TypeStorage::getv(const bool *dst, size_t dst_stride, size_t src_offset,
                        size_t count, const std::string &path,
                        va_list ap) {
-	_get((char *)dst, BoolTypeEnum, dst_stride, src_offset, count, path, ap);
+	_get((char *)dst, BoolTypeEnum, dst_stride, src_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::get(const int *dst, size_t dst_stride, size_t src_offset,
@@ -795,7 +880,8 @@ void TypeStorage::get(const int *dst, size_t dst_stride, size_t src_offset,
 void TypeStorage::getv(const int *dst, size_t dst_stride, size_t src_offset,
                        size_t count, const std::string &path,
                        va_list ap) {
-	_get((char *)dst, IntTypeEnum, dst_stride, src_offset, count, path, ap);
+	_get((char *)dst, IntTypeEnum, dst_stride, src_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::get(const unsigned int *dst, size_t dst_stride,
@@ -811,7 +897,8 @@ void TypeStorage::get(const unsigned int *dst, size_t dst_stride,
 void TypeStorage::getv(const unsigned int *dst, size_t dst_stride,
                        size_t src_offset, size_t count,
                        const std::string &path, va_list ap) {
-	_get((char *)dst, UIntTypeEnum, dst_stride, src_offset, count, path, ap);
+	_get((char *)dst, UIntTypeEnum, dst_stride, src_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::get(const half *dst, size_t dst_stride, size_t src_offset,
@@ -825,7 +912,8 @@ void TypeStorage::get(const half *dst, size_t dst_stride, size_t src_offset,
 
 void TypeStorage::getv(const half *dst, size_t dst_stride, size_t src_offset,
                        size_t count, const std::string &path, va_list ap) {
-	_get((char *)dst, HalfTypeEnum, dst_stride, src_offset, count, path, ap);
+	_get((char *)dst, HalfTypeEnum, dst_stride, src_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::get(const float *dst, size_t dst_stride,
@@ -841,7 +929,8 @@ void TypeStorage::get(const float *dst, size_t dst_stride,
 void TypeStorage::getv(const float *dst, size_t dst_stride,
                        size_t src_offset, size_t count,
                        const std::string &path, va_list ap) {
-	_get((char *)dst, FloatTypeEnum, dst_stride, src_offset, count, path, ap);
+	_get((char *)dst, FloatTypeEnum, dst_stride, src_offset, count,
+	     elementv(path, ap));
 }
 
 void TypeStorage::get(const std::string *dst, size_t dst_stride,
@@ -857,7 +946,74 @@ void TypeStorage::get(const std::string *dst, size_t dst_stride,
 void TypeStorage::getv(const std::string *dst, size_t dst_stride,
                        size_t src_offset, size_t count,
                        const std::string &path, va_list ap) {
-	_get((char *)dst, StringTypeEnum, dst_stride, src_offset, count, path, ap);
+	_get((char *)dst, StringTypeEnum, dst_stride, src_offset, count,
+	     elementv(path, ap));
+}
+
+void TypeStorage::set(const Element &element, const bool *src,
+                      size_t src_stride, size_t dst_offset, size_t count) {
+	_set((const char *)src, BoolTypeEnum, src_stride, dst_offset, count,
+	     element);
+}
+
+void TypeStorage::set(const Element &element, const int *src,
+                      size_t src_stride, size_t dst_offset, size_t count) {
+	_set((const char *)src, IntTypeEnum, src_stride, dst_offset, count,
+	     element);
+}
+
+void TypeStorage::set(const Element &element, const unsigned int *src,
+                      size_t src_stride, size_t dst_offset, size_t count) {
+	_set((const char *)src, UIntTypeEnum, src_stride, dst_offset, count,
+	     element);
+}
+
+void TypeStorage::set(const Element &element, const half *src,
+                      size_t src_stride, size_t dst_offset, size_t count) {
+	_set((const char *)src, HalfTypeEnum, src_stride, dst_offset, count,
+	     element);
+}
+
+void TypeStorage::set(const Element &element, const float *src,
+                      size_t src_stride, size_t dst_offset, size_t count) {
+	_set((const char *)src, FloatTypeEnum, src_stride, dst_offset, count,
+	     element);
+}
+
+void TypeStorage::set(const Element &element, const std::string *src,
+                      size_t src_stride, size_t dst_offset, size_t count) {
+	_set((const char *)src, StringTypeEnum, src_stride, dst_offset, count,
+	     element);
+}
+
+void TypeStorage::get(const Element &element, const bool *dst,
+                      size_t dst_stride, size_t src_offset, size_t count) {
+	_get((char *)dst, BoolTypeEnum, dst_stride, src_offset, count, element);
+}
+
+void TypeStorage::get(const Element &element, const int *dst,
+                      size_t dst_stride, size_t src_offset, size_t count) {
+	_get((char *)dst, IntTypeEnum, dst_stride, src_offset, count, element);
+}
+
+void TypeStorage::get(const Element &element, const unsigned int *dst,
+                      size_t dst_stride, size_t src_offset, size_t count) {
+	_get((char *)dst, UIntTypeEnum, dst_stride, src_offset, count, element);
+}
+
+void TypeStorage::get(const Element &element, const half *dst,
+                      size_t dst_stride, size_t src_offset, size_t count) {
+	_get((char *)dst, HalfTypeEnum, dst_stride, src_offset, count, element);
+}
+
+void TypeStorage::get(const Element &element, const float *dst,
+                      size_t dst_stride, size_t src_offset, size_t count) {
+	_get((char *)dst, FloatTypeEnum, dst_stride, src_offset, count, element);
+}
+
+void TypeStorage::get(const Element &element, const std::string *dst,
+                      size_t dst_stride, size_t src_offset, size_t count) {
+	_get((char *)dst, StringTypeEnum, dst_stride, src_offset, count, element);
 }
 
 } // namespace Ctl
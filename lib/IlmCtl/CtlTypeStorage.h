@@ -226,17 +226,65 @@ class TypeStorage: public RcObject {
 	                  size_t src_offset, size_t count,
 	                  const std::string &path, va_list ap);
 
+	// An Element is an element path (see CtlType.h) that has been
+	// resolved to a byte offset and a type once, so that it can be
+	// used for any number of set / get calls without parsing the path
+	// again. An Element stays valid as long as the type of the
+	// TypeStorage it came from doesn't change.
+	class Element {
+	  public:
+		Element() : _offset(0) {}
+
+		size_t              offset() const { return _offset; }
+		const DataTypePtr & type() const { return _type; }
+
+	  private:
+		friend class TypeStorage;
+
+		size_t              _offset;
+		DataTypePtr         _type;
+	};
+
+	Element      element(const std::string &path=std::string(), ...) const;
+	Element      elementv(const std::string &path, va_list ap) const;
+
+	void         set(const Element &element, const bool *src,
+	                 size_t src_stride=0, size_t dst_offset=0, size_t count=1);
+	void         set(const Element &element, const int *src,
+	                 size_t src_stride=0, size_t dst_offset=0, size_t count=1);
+	void         set(const Element &element, const unsigned int *src,
+	                 size_t src_stride=0, size_t dst_offset=0, size_t count=1);
+	void         set(const Element &element, const half *src,
+	                 size_t src_stride=0, size_t dst_offset=0, size_t count=1);
+	void         set(const Element &element, const float *src,
+	                 size_t src_stride=0, size_t dst_offset=0, size_t count=1);
+	void         set(const Element &element, const std::string *src,
+	                 size_t src_stride=0, size_t dst_offset=0, size_t count=1);
+
+	void         get(const Element &element, const bool *dst,
+	                 size_t dst_stride=0, size_t src_offset=0, size_t count=1);
+	void         get(const Element &element, const int *dst,
+	                 size_t dst_stride=0, size_t src_offset=0, size_t count=1);
+	void         get(const Element &element, const unsigned int *dst,
+	                 size_t dst_stride=0, size_t src_offset=0, size_t count=1);
+	void         get(const Element &element, const half *dst,
+	                 size_t dst_stride=0, size_t src_offset=0, size_t count=1);
+	void         get(const Element &element, const float *dst,
+	                 size_t dst_stride=0, size_t src_offset=0, size_t count=1);
+	void         get(const Element &element, const std::string *dst,
+	                 size_t dst_stride=0, size_t src_offset=0, size_t count=1);
+
   private:
     std::string 		_name;
     DataTypePtr			_type;
 
 	// Does heavy lifting of set / copy functions above.
 	void         _set(const char *src, CDataType_e src_type, size_t stride,
-	                  size_t dst_offset, size_t count, const std::string &,
-	                  va_list ap);
+	                  size_t dst_offset, size_t count,
+	                  const Element &element);
 	void         _get(char *dst, CDataType_e dst_type, size_t stride,
-	                  size_t src_offset, size_t count, const std::string &,
-	                  va_list ap);
+	                  size_t src_offset, size_t count,
+	                  const Element &element);
 };
 
 } // namespace Ctl
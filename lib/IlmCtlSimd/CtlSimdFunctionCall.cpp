@@ -80,24 +80,69 @@ SimdFunctionCall::SimdFunctionCall
 :
      FunctionCall (name),
      _xcontext (interpreter),
+     _type (type),
      _entryPoint (addr->inst()),
      _symbols(symbols)
+{
+    //
+    // Find the addresses of the parameters' default values.
+    //
+
+    const ParamVector &parameters = type->parameters();
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+	string staticName = name + "$" + parameters[i].name;
+	SymbolInfoPtr info = _symbols.lookupSymbol (staticName);
+
+	if (info)
+	    _defaultAddrs.push_back (SimdDataAddrPtr (info->addr()));
+	else
+	    _defaultAddrs.push_back (SimdDataAddrPtr());
+    }
+
+    createArgs();
+}
+
+
+SimdFunctionCall::SimdFunctionCall (const SimdFunctionCall &prototype)
+:
+     FunctionCall (prototype.name()),
+     _xcontext (prototype._xcontext.interpreter()),
+     _type (prototype._type),
+     _entryPoint (prototype._entryPoint),
+     _symbols (prototype._symbols),
+     _defaultAddrs (prototype._defaultAddrs)
+{
+    createArgs();
+}
+
+
+FunctionCallPtr
+SimdFunctionCall::clone () const
+{
+    return new SimdFunctionCall (*this);
+}
+
+
+void
+SimdFunctionCall::createArgs ()
 {
     {
 	SimdReg *returnReg =
-	    new SimdReg (type->returnVarying(),
-			 type->returnType()->alignedObjectSize());
+	    new SimdReg (_type->returnVarying(),
+			 _type->returnType()->alignedObjectSize());
 
 	_xcontext.stack().push (returnReg, TAKE_OWNERSHIP);
 
 	setReturnValue (new SimdFunctionArg ("",
 					     this,
-					     type->returnType(),
-					     type->returnVarying(),
+					     _type->returnType(),
+					     _type->returnVarying(),
 					     returnReg));
     }
 
-    const ParamVector &parameters = type->parameters();
+    const ParamVector &parameters = _type->parameters();
 
     vector<FunctionArgPtr> inputs;
     vector<FunctionArgPtr> outputs;
@@ -111,11 +156,17 @@ SimdFunctionCall::SimdFunctionCall
 
 	_xcontext.stack().push (paramReg, TAKE_OWNERSHIP);
 
+	SimdReg *defaultReg = 0;
+
+	if (_defaultAddrs[i])
+	    defaultReg = &_defaultAddrs[i]->reg (_xcontext);
+
 	FunctionArgPtr arg = new SimdFunctionArg (param.name,
 						  this,
 						  param.type,
 						  param.varying,
-						  paramReg);
+						  paramReg,
+						  defaultReg);
 	if (param.isWritable())
 	    outputs.push_back(arg);
 	else
@@ -187,21 +238,14 @@ SimdFunctionArg::SimdFunctionArg
      FunctionCall* func,
      const DataTypePtr &type,
      bool varying,
-     SimdReg *reg)
+     SimdReg *reg,
+     SimdReg *defaultReg /* = 0 */)
 :
     FunctionArg (name, func, type, varying),
     _reg (reg),
-    _defaultReg (0)
+    _defaultReg (defaultReg)
 {
-    // Find the register associated with the parameter default value
-    string staticName = func->name() + "$" + name;
-
-    SimdFunctionCall* sfunc = static_cast<SimdFunctionCall*>(func);
-    SymbolInfoPtr info = sfunc->symbols().lookupSymbol( staticName );
-    if( info )
-    {
-	_defaultReg = &SimdDataAddrPtr(info->addr())->reg(*sfunc->xContext());
-    }
+    // empty
 }
 
 
@@ -231,6 +275,9 @@ SimdFunctionArg::setDefaultValue ()
     assert(_reg);
     if( _defaultReg )
     {
+	// the default goes into the argument's own buffer
+	_reg->unbindExternal();
+
         // note: default values are never varying
         // Copy default value into the argument's register, replicating
         // if the argument is varying.
@@ -246,6 +293,26 @@ SimdFunctionArg::setDefaultValue ()
     }
 }
 
+bool
+SimdFunctionArg::bind (char *data, size_t stride)
+{
+    assert(_reg);
+    if( !isVarying() )
+	return false;
+
+    _reg->bindExternal (data, stride);
+    return true;
+}
+
+
+void
+SimdFunctionArg::unbind ()
+{
+    assert(_reg);
+    _reg->unbindExternal ();
+}
+
+
 void
 SimdFunctionArg::setVarying(bool varying)
 {
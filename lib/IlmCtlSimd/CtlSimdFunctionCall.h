@@ -86,14 +86,38 @@ class SimdFunctionCall: public FunctionCall
 		      SymbolTable &symbols);
 
     virtual void		callFunction (size_t numSamples);
+    virtual FunctionCallPtr	clone () const;
 
     virtual SimdXContext *	xContext()	{return &_xcontext;}
     virtual SymbolTable &	symbols()	{return _symbols;}
 
+  protected:
+
+    //------------------------------------------------------------
+    // Construct a call to the same function as prototype, with new
+    // registers for the arguments and the return value, but with
+    // the prototype's entry point and default value addresses.
+    //------------------------------------------------------------
+
+    SimdFunctionCall (const SimdFunctionCall &prototype);
+
+    const FunctionTypePtr &	functionType () const	{return _type;}
+
   private:
+
+    void		createArgs ();
+
     SimdXContext	_xcontext;
+    FunctionTypePtr	_type;
     const SimdInst *	_entryPoint;
     SymbolTable &	_symbols;
+
+    //
+    // Addresses of the parameters' default values, in the same
+    // order as the parameters; 0 if a parameter has no default.
+    //
+
+    std::vector<SimdDataAddrPtr> _defaultAddrs;
 };
 
 
@@ -105,7 +129,8 @@ class SimdFunctionArg: public FunctionArg
 		     FunctionCall* func,
 		     const DataTypePtr &type,
 		     bool varying,
-		     SimdReg *reg);
+		     SimdReg *reg,
+		     SimdReg *defaultReg = 0);
 
     virtual ~SimdFunctionArg ();
 
@@ -117,6 +142,9 @@ class SimdFunctionArg: public FunctionArg
     virtual bool	hasDefaultValue ();
     virtual void	setDefaultValue ();
 
+    virtual bool	bind (char *data, size_t stride);
+    virtual void	unbind ();
+
     SimdReg *	        reg () {return _reg;}
 
   private:
@@ -708,7 +708,12 @@ SimdInitializeInst::execute
 
     SimdReg &out = xcontext.stack().regSpRelative (-elements-1);
 
-    bool varying = false;
+    //
+    // External registers can't be made uniform, uniform values are
+    // written to every element instead.
+    //
+
+    bool varying = out.isExternal();
 
     for( int i = 0; i < elements; i++ )
     {
@@ -769,7 +774,7 @@ SimdAssignArrayInst::execute
     const SimdReg &in = xcontext.stack().regSpRelative(-1);
     SimdReg &out = xcontext.stack().regSpRelative(-2);
 
-    if (in.isVarying() || mask.isVarying())
+    if (in.isVarying() || mask.isVarying() || out.isExternal())
     {
 	out.setVarying (true);
 	for( int j = 0; j < xcontext.regSize(); j++)
@@ -83,7 +83,7 @@ class SimdInterpreter: public Interpreter
     unsigned long		abortCount();
     unsigned long		maxInstCount();
 
-  private:
+  protected:
 
     virtual FunctionCallPtr	newFunctionCallInternal 
                                     (const SymbolInfoPtr info,
@@ -97,6 +97,8 @@ class SimdInterpreter: public Interpreter
 				    (Module *module,
 				     SymbolTable &symtab) const;
 
+  private:
+
     class Data;
 
     Data *			_data;
@@ -413,6 +413,16 @@ SimdLContext::newValueNode
 }
 
 
+ValueNodePtr
+SimdLContext::newPackedValueNode
+    (int lineNumber,
+     const DataTypePtr &packedType,
+     const std::vector<char> &packedValues) const
+{
+    return new SimdValueNode (lineNumber, packedType, packedValues);
+}
+
+
 VoidTypePtr
 SimdLContext::newVoidType () const
 {
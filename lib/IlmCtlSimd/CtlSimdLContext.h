@@ -224,6 +224,12 @@ class SimdLContext: public LContext
 				    (int lineNumber,
 				     const ExprNodeVector &elements) const;
 
+    virtual ValueNodePtr	newPackedValueNode
+				    (int lineNumber,
+				     const DataTypePtr &packedType,
+				     const std::vector<char> &packedValues)
+				     const;
+
     virtual VoidTypePtr		newVoidType () const;
 
     virtual BoolTypePtr		newBoolType () const;
@@ -88,7 +88,9 @@ SimdReg::SimdReg (bool varying, size_t elementSize)
   _oVarying(false),
   _offsets(zeroOffset),
   _data (new char [ varying ? MAX_REG_SIZE * _eSize : _eSize]),
-  _ref(0)
+  _ref(0),
+  _external(false),
+  _stride(0)
 {
 }
 
@@ -106,8 +108,11 @@ SimdReg::SimdReg
 	 _varying(r._varying),
 	 _oVarying(indReg.isVarying() || r._oVarying),
 	 _offsets(new size_t [_oVarying ? MAX_REG_SIZE : 1]),
-	 _data(transferData && r._data ? r._data : 0),
-         _ref(transferData && r._data ? this : (r._ref ? r._ref : &r))
+	 _data(transferData && r._data && !r._external ? r._data : 0),
+         _ref(transferData && r._data && !r._external ? this
+                                                     : (r._ref ? r._ref : &r)),
+	 _external(false),
+	 _stride(0)
 {
     if( _oVarying )
     {
@@ -152,7 +157,7 @@ SimdReg::SimdReg
     //
     // If we are tranfering the ownership, complete the transfer
     //
-    if( transferData && r._data )
+    if( transferData && r._data && !r._external )
     {
 	r._data = 0;
     }
@@ -171,8 +176,11 @@ SimdReg::SimdReg
 	 _varying(r._varying),
 	 _oVarying(r._oVarying),
 	 _offsets(new size_t [_oVarying ? MAX_REG_SIZE : 1]),
-	 _data(transferData && r._data ? r._data : 0),
-         _ref(transferData && r._data ? this : (r._ref ? r._ref : &r))
+	 _data(transferData && r._data && !r._external ? r._data : 0),
+         _ref(transferData && r._data && !r._external ? this
+                                                     : (r._ref ? r._ref : &r)),
+	 _external(false),
+	 _stride(0)
 {
     if( _oVarying )
     {
@@ -190,7 +198,7 @@ SimdReg::SimdReg
     //
     // If we are tranfering the ownership, complete the transfer
     //
-    if( transferData && r._data )
+    if( transferData && r._data && !r._external )
     {
 	r._data = 0;
     }
@@ -205,7 +213,8 @@ SimdReg::~SimdReg ()
     if( _offsets != zeroOffset)
 	delete [] _offsets;
 
-    delete [] _data;
+    if( !_external )
+	delete [] _data;
 }
 
 
@@ -216,6 +225,18 @@ SimdReg::reference(SimdReg &r,
     _eSize = r._eSize;
     _varying = r._varying;
 
+    if( _external )
+    {
+	if( _offsets != zeroOffset )
+	    delete [] _offsets;
+	_offsets = zeroOffset;
+	_oVarying = false;
+	_data = 0;
+	_ref = 0;
+	_external = false;
+	_stride = 0;
+    }
+
     if( !_ref )
     {
 	_offsets = new size_t [_oVarying ? MAX_REG_SIZE : 1];
@@ -232,7 +253,7 @@ SimdReg::reference(SimdReg &r,
     //
     // If we are tranfering the ownership, and the original is not a reference
     //
-    if( transferData && r._data )
+    if( transferData && r._data && !r._external )
     {
 	_ref =  this;
 	_data =  r._data;
@@ -252,9 +273,79 @@ SimdReg::reference(SimdReg &r,
 }
 
 
+void
+SimdReg::bindExternal (char *data, size_t stride)
+{
+    if( _ref && !_external )
+    {
+	THROW (Iex::LogicExc, "Cannot bind a reference register to "
+			 "external memory.");
+    }
+
+    if( stride < _eSize )
+    {
+	THROW (Iex::ArgExc, "External memory stride (" << stride << ") is "
+		       "smaller than the register element size "
+		       "(" << _eSize << ").");
+    }
+
+    if( !_external )
+	delete [] _data;
+
+    if( stride != _stride )
+    {
+	if( stride == _eSize )
+	{
+	    if( _offsets != zeroOffset )
+		delete [] _offsets;
+	    _offsets = zeroOffset;
+	}
+	else
+	{
+	    if( _offsets == zeroOffset )
+		_offsets = new size_t [MAX_REG_SIZE];
+	    for( int i = 0; i < MAX_REG_SIZE; i++ )
+		_offsets[i] = i * (stride - _eSize);
+	}
+    }
+
+    _data = data;
+    _ref = this;
+    _varying = true;
+    _oVarying = stride != _eSize;
+    _external = true;
+    _stride = stride;
+}
+
+
+void
+SimdReg::unbindExternal ()
+{
+    if( !_external )
+	return;
+
+    if( _offsets != zeroOffset )
+	delete [] _offsets;
+
+    _offsets = zeroOffset;
+    _oVarying = false;
+    _data = new char [ _varying ? MAX_REG_SIZE * _eSize : _eSize];
+    _ref = 0;
+    _external = false;
+    _stride = 0;
+}
+
+
 void 
 SimdReg::setVarying (bool varying)
 {
+    //
+    // External registers are always varying; writing a uniform value
+    // to one writes it to every element.
+    //
+    if(_external)
+	return;
+
     if(_ref)
     {
 	_ref->setVarying (varying);
@@ -283,6 +374,9 @@ SimdReg::setVarying (bool varying)
 void 
 SimdReg::setVaryingDiscardData (bool varying)
 {
+    if(_external)
+	return;
+
     if(_ref)
     {
 	_ref->setVaryingDiscardData (varying);
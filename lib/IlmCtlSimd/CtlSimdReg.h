@@ -74,6 +74,11 @@
 //      also handles the logic to access elements of a register regardless
 //      of whether it is a value or ref register.
 //
+//      A varying register can also be bound to "external" memory owned
+//      by the caller, where element i lives at data + i * stride.  This
+//      lets function arguments be read from and written to an image
+//      buffer in place.
+//
 //-----------------------------------------------------------------------------
 
 namespace Ctl {
@@ -139,6 +144,21 @@ class SimdReg
     // 
     void reference(SimdReg &r, bool transferData = false);
 
+    //
+    // Bind this register to external memory:  the register becomes a
+    // varying register whose element i is at data + i * stride.  The
+    // memory is not owned (or ever reallocated) by the register, and
+    // stride must be at least elementSize().  Binding an already bound
+    // register just moves it.  unbindExternal() gives the register its
+    // own (uninitialized) storage back.  isExternal() is also true for
+    // references into an external register.
+    //
+
+    void		bindExternal (char *data, size_t stride);
+    void		unbindExternal ();
+    bool		isExternal () const {return _ref && _ref->_external;}
+    size_t		externalStride () const {return _stride;}
+
 
     void		setVarying (bool varying);
     void		setVaryingDiscardData (bool varying);
@@ -202,6 +222,16 @@ class SimdReg
     //        _offsets = 0 or not valid anymore - to be deleted
     //        _oVarying = true | false
     //        _Varying = true | false
+    //
+    //  5) A register bound to external memory.  Like 3), except that
+    //  _data is not owned by the register.
+    //        _ref = this
+    //        _data = the caller's memory
+    //        _offsets = i * (_stride - _eSize), or zeroOffset if the
+    //                   elements are contiguous
+    //        _oVarying = _stride != _eSize
+    //        _Varying = true
+    //        _external = true
 
 
     size_t              _eSize;        // Size of element in varying array
@@ -210,6 +240,8 @@ class SimdReg
     size_t*             _offsets;      // indexed offsets into a _data block
     char*               _data;
     SimdReg*            _ref;          // If a reference, points to original
+    bool                _external;     // _data is owned by the caller
+    size_t              _stride;       // Distance between external elements
 
   private:
     static size_t *zeroOffset;  // for reference registers,_offsets = zeroOffset
@@ -323,7 +323,28 @@ SimdVariableNode::generateCode (LContext &lcontext)
 	        // Initial value is assigned to the variable.
 	        //
 
-	        if( valuePtr && valuePtr->type && dataPtr  && dataPtr->reg())
+	        if( valuePtr && valuePtr->isPacked() && valuePtr->type &&
+		    dataPtr && dataPtr->reg())
+	        {
+				// The variable is static, and its value is an
+				// array of packed literals.  The packed values
+				// are laid out exactly like the variable; copy
+				// them all at once.
+
+		        DataTypePtr dataType = valuePtr->type;
+
+		        assert(!dataPtr->reg()->isVarying());
+		        assert(valuePtr->packedValues.size() ==
+		               dataType->objectSize());
+
+		        if (!valuePtr->packedValues.empty())
+		        {
+			        memcpy ((*dataPtr->reg())[0],
+			                &valuePtr->packedValues[0],
+			                valuePtr->packedValues.size());
+		        }
+	        }
+	        else if( valuePtr && valuePtr->type && dataPtr  && dataPtr->reg())
 	        {
 				// The variable is static, and its value is a literal
 				// or a collection of literals (for structs and arrays).
@@ -1234,9 +1255,27 @@ SimdValueNode::SimdValueNode
 }
 
 
+SimdValueNode::SimdValueNode
+    (int lineNumber,
+     const DataTypePtr &packedType,
+     const std::vector<char> &packedValues)
+:
+    ValueNode (lineNumber, packedType, packedValues)
+{
+    // empty
+}
+
+
 void
 SimdValueNode::generateCode (LContext &lcontext)
 {
+    //
+    // The generated code evaluates each element separately;
+    // it needs a LiteralNode for each packed value.
+    //
+
+    unpack (lcontext);
+
     int eIndex = 0;
     generateCodeRec(lcontext, type, eIndex);
 }
@@ -304,6 +304,10 @@ struct SimdValueNode: public ValueNode
 {
     SimdValueNode (int lineNumber, const ExprNodeVector &elements);
 
+    SimdValueNode (int lineNumber,
+		   const DataTypePtr &packedType,
+		   const std::vector<char> &packedValues);
+
     virtual void	generateCodeRec (LContext &lcontext, 
 					 const DataTypePtr &,
 					 int& eIndex);
@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+
+//-------------------------------------------------------------------------
+//
+//	A program that measures how long it takes the SIMD interpreter
+//	to load a CTL module and to set up calls to the module's
+//	functions.  The module is generated in memory; it contains
+//	numFunctions functions, each with a few nested local name spaces
+//	and a parameter with a default value, so that both loading and
+//	newFunctionCall() exercise the symbol table.  For comparison,
+//	the program also measures FunctionCall::clone().
+//
+//	usage: ctlSimdBench [numFunctions [numCalls]]
+//
+//-------------------------------------------------------------------------
+
+#include <CtlSimdInterpreter.h>
+#include <CtlFunctionCall.h>
+#include <Iex.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace Ctl;
+using namespace std;
+
+namespace {
+
+const int numRuns = 5;
+
+typedef chrono::steady_clock Clock;
+
+
+double
+seconds (Clock::time_point start)
+{
+    return chrono::duration<double> (Clock::now() - start).count();
+}
+
+
+string
+benchSource (int numFunctions)
+{
+    stringstream ss;
+
+    ss << "namespace bench\n"
+	  "{\n"
+	  "\n"
+	  "const float gain[] = {1.0, 0.5, 0.25, 0.125};\n"
+	  "\n";
+
+    for (int i = 0; i < numFunctions; ++i)
+    {
+	ss << "float\n"
+	      "func" << i << " (float x, int n, float scale = " << i << ".5)\n"
+	      "{\n"
+	      "    float y = x * scale;\n"
+	      "\n"
+	      "    for (int j = 0; j < n; j = j + 1)\n"
+	      "    {\n"
+	      "        float z = y * gain[j % 4];\n"
+	      "\n"
+	      "        if (z > 1.0)\n"
+	      "        {\n"
+	      "            float w = z - 1.0;\n"
+	      "            y = y - w;\n"
+	      "        }\n"
+	      "    }\n"
+	      "\n";
+
+	if (i > 0)
+	    ss << "    return y + func" << i - 1 << " (x, 0);\n";
+	else
+	    ss << "    return y;\n";
+
+	ss << "}\n"
+	      "\n";
+    }
+
+    ss << "}\n";
+    return ss.str();
+}
+
+
+double
+timeLoad (const string &source)
+{
+    double best = 0;
+
+    for (int i = 0; i < numRuns; ++i)
+    {
+	SimdInterpreter interp;
+
+	Clock::time_point start = Clock::now();
+	interp.loadSource (source.c_str(), "bench");
+	double t = seconds (start);
+
+	if (i == 0 || t < best)
+	    best = t;
+    }
+
+    return best;
+}
+
+
+double
+timeNewFunctionCall (SimdInterpreter &interp,
+		     const vector<string> &names,
+		     int numCalls)
+{
+    double best = 0;
+
+    for (int i = 0; i < numRuns; ++i)
+    {
+	Clock::time_point start = Clock::now();
+
+	for (int j = 0; j < numCalls; ++j)
+	{
+	    FunctionCallPtr call =
+		interp.newFunctionCall (names[j % names.size()]);
+	}
+
+	double t = seconds (start) / numCalls;
+
+	if (i == 0 || t < best)
+	    best = t;
+    }
+
+    return best;
+}
+
+
+double
+timeClone (SimdInterpreter &interp,
+	   const vector<string> &names,
+	   int numCalls)
+{
+    vector<FunctionCallPtr> prototypes;
+
+    for (size_t i = 0; i < names.size(); ++i)
+	prototypes.push_back (interp.newFunctionCall (names[i]));
+
+    double best = 0;
+
+    for (int i = 0; i < numRuns; ++i)
+    {
+	Clock::time_point start = Clock::now();
+
+	for (int j = 0; j < numCalls; ++j)
+	    FunctionCallPtr call = prototypes[j % prototypes.size()]->clone();
+
+	double t = seconds (start) / numCalls;
+
+	if (i == 0 || t < best)
+	    best = t;
+    }
+
+    return best;
+}
+
+} // namespace
+
+
+int
+main (int argc, char **argv)
+{
+    int numFunctions = (argc > 1)? atoi (argv[1]): 500;
+    int numCalls = (argc > 2)? atoi (argv[2]): 10000;
+
+    if (numFunctions < 1 || numCalls < 1)
+    {
+	cerr << "usage: " << argv[0] << " [numFunctions [numCalls]]" << endl;
+	return 1;
+    }
+
+    try
+    {
+	string source = benchSource (numFunctions);
+
+	cout << "module with " << numFunctions << " functions "
+		"(" << source.size() << " bytes)" << endl;
+
+	cout << "  load: " << timeLoad (source) << "s" << endl;
+
+	SimdInterpreter interp;
+	interp.loadSource (source.c_str(), "bench");
+
+	vector<string> names;
+
+	for (int i = 0; i < numFunctions; ++i)
+	{
+	    stringstream ss;
+	    ss << "bench::func" << i;
+	    names.push_back (ss.str());
+	}
+
+	double t = timeNewFunctionCall (interp, names, numCalls);
+
+	cout << "  newFunctionCall: " << t * 1e6 << "us "
+		"(best of " << numRuns << " x " << numCalls << " calls)" << endl;
+
+	t = timeClone (interp, names, numCalls);
+
+	cout << "  clone: " << t * 1e6 << "us" << endl;
+    }
+    catch (const exception &e)
+    {
+	cerr << e.what() << endl;
+	return 1;
+    }
+
+    return 0;
+}
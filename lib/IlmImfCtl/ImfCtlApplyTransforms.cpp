@@ -68,6 +68,7 @@
 #include <IlmThreadPool.h>
 #include <IlmThreadMutex.h>
 #include <Iex.h>
+#include <chrono>
 
 using namespace std;
 using namespace Iex;
@@ -98,37 +99,81 @@ namespace {
 typedef vector <FunctionCallPtr> FunctionList;
 
 
+//
+// How the arguments of one function in the chain are connected to
+// the previous function, the frame buffers and the headers.  The
+// connections are worked out by name once per task, in bindFunctions(),
+// so that callFunctions() only has to copy data for each packet.
+// Input arguments that get their value from a header attribute or
+// from their default value are set once in bindFunctions() and do
+// not appear in inputs.
+//
+
+struct InputBinding
+{
+    FunctionArgPtr	arg;
+    FunctionArgPtr	previousArg;	// previous function's output, or 0
+    const Slice *	slice;		// slice in inFb if previousArg is 0
+};
+
+struct OutputBinding
+{
+    FunctionArgPtr	arg;
+    const Slice *	slice;		// varying arg: slice in outFb
+    Attribute *		attribute;	// uniform arg: attribute in outHeader
+};
+
+struct FunctionBinding
+{
+    FunctionCallPtr		func;
+    vector <InputBinding>	inputs;
+    vector <OutputBinding>	outputs;
+};
+
+typedef vector <FunctionBinding> BindingList;
+
+
+FunctionArgPtr
+findPreviousArg (const FunctionCallPtr &previousFunc, const string &name)
+{
+    if (!previousFunc)
+	return 0;
+
+    FunctionArgPtr previousArg = previousFunc->findOutputArg (name);
+
+    if (!previousArg)
+	previousArg = previousFunc->findOutputArg (name + "Out");
+
+    return previousArg;
+}
+
+
 void
-callFunctions
+bindFunctions
     (const FunctionList &funcs,
-     const Box2i &transformWindow,
-     size_t firstSample,
-     size_t numSamples,
      const Header &envHeader,
      const Header &inHeader,
      const FrameBuffer &inFb,
      Header &outHeader,
-     const FrameBuffer &outFb)
+     const FrameBuffer &outFb,
+     BindingList &bindings)
 {
-    debug ("callFunctions (..., "
-	   "firstSample = " << firstSample << ", "
-	   "numSamples = " << numSamples << ", ...)");
+    debug ("bindFunctions (...)");
 
-    //
-    // For each function, provide input argument values,
-    // call the function, and return output argument values
-    // to the caller.
-    //
+    bindings.resize (funcs.size());
 
     FunctionCallPtr previousFunc = 0;
 
     for (size_t i = 0; i < funcs.size(); ++i)
     {
 	FunctionCallPtr func = funcs[i];
+	FunctionBinding &binding = bindings[i];
 	debug ("\tfunction " << func->name());
 
+	binding.func = func;
+
 	//
-	// Provide input argument values.
+	// Find the source of each input argument's value.
 	//
 
 	for (size_t j = 0; j < func->numInputArgs(); ++j)
@@ -136,35 +181,28 @@ callFunctions
 	    FunctionArgPtr arg = func->inputArg (j);
 	    debug ("\t\tinput arg " << arg->name());
 
+	    InputBinding input;
+	    input.arg = arg;
+	    input.previousArg = findPreviousArg (previousFunc, arg->name());
+	    input.slice = 0;
+
+	    if (input.previousArg)
+	    {
+		debug ("\t\t\tusing previous output arg");
+
+		binding.inputs.push_back (input);
+		continue;
+	    }
+
 	    if (arg->isVarying())
 	    {
 		//
 		// Varying input argument -- try to find a value in
-		// - the previous function's output arguments
+		// - the previous function's output arguments (above)
 		// - the slices in inFb
 		// - the argument's default value
 		//
 
-		if (previousFunc)
-		{
-		    FunctionArgPtr previousArg =
-			previousFunc->findOutputArg (arg->name());
-
-		    if (!previousArg)
-		    {
-			previousArg =
-			    previousFunc->findOutputArg (arg->name() + "Out");
-		    }
-
-		    if (previousArg)
-		    {
-			debug ("\t\t\tusing previous output arg");
-
-			copyFunctionArg (numSamples, previousArg, arg);
-			continue;
-		    }
-		}
-
 		FrameBuffer::ConstIterator inSlice =
 		    inFb.find (arg->name().c_str());
 
@@ -172,11 +210,8 @@ callFunctions
 		{
 		    debug ("\t\t\tusing input frame buffer");
 
-		    copyFunctionArg (transformWindow,
-				     firstSample,
-				     numSamples,
-				     inSlice.slice(),
-				     arg);
+		    input.slice = &inSlice.slice();
+		    binding.inputs.push_back (input);
 		    continue;
 		}
 
@@ -197,32 +232,12 @@ callFunctions
 	    {
 		//
 		// Uniform input argument -- try to find a value in
-		// - the previous function's output arguments
+		// - the previous function's output arguments (above)
 		// - the attributes in inHeader
 		// - the attributes in envHeader
 		// - the argument's default value
 		//
 
-		if (previousFunc)
-		{
-		    FunctionArgPtr previousArg =
-			previousFunc->findOutputArg (arg->name());
-
-		    if (!previousArg)
-		    {
-			previousArg =
-			    previousFunc->findOutputArg (arg->name() + "Out");
-		    }
-
-		    if (previousArg)
-		    {
-			debug ("\t\t\tusing previous output arg");
-
-			copyFunctionArg (1, previousArg, arg);
-			continue;
-		    }
-		}
-
 		Header::ConstIterator inAttr =
 		    inHeader.find (arg->name().c_str());
 
@@ -261,13 +276,8 @@ callFunctions
 	}
 
 	//
-	// Call the function
-	//
-
-	func->callFunction (numSamples);
-
-	//
-	// Return output argument values to the caller.
+	// Find the destination of each output argument's value.
+	// Output arguments without one are dropped.
 	//
 
 	for (size_t j = 0; j < func->numOutputArgs(); ++j)
@@ -275,18 +285,20 @@ callFunctions
 	    FunctionArgPtr arg = func->outputArg (j);
 	    debug ("\t\toutput arg " << arg->name());
 
+	    OutputBinding output;
+	    output.arg = arg;
+	    output.slice = 0;
+	    output.attribute = 0;
+
+	    bool hasOutSuffix = arg->name().size() > 3 &&
+		arg->name().substr (arg->name().size() - 3) == "Out";
+
 	    if (arg->isVarying())
 	    {
-		//
-		// Varying output value
-		//
-		
 		FrameBuffer::ConstIterator outSlice =
 		    outFb.find (arg->name().c_str());
 
-		if (outSlice == outFb.end() &&
-		    arg->name().size() > 3 &&
-		    arg->name().substr (arg->name().size() - 3) == "Out")
+		if (outSlice == outFb.end() && hasOutSuffix)
 		{
 		    outSlice = outFb.find
 			(arg->name().substr(0, arg->name().size() - 3).c_str());
@@ -296,27 +308,16 @@ callFunctions
 		{
 		    debug ("\t\t\tcopying to output frame buffer\n");
 
-		    copyFunctionArg (transformWindow,
-				     firstSample,
-				     numSamples,
-				     arg,
-				     outSlice.slice());
-		    continue;
+		    output.slice = &outSlice.slice();
+		    binding.outputs.push_back (output);
 		}
-
 	    }
 	    else
 	    {
-		//
-		// Uniform output value
-		//
-
 		Header::Iterator outAttr =
 		    outHeader.find (arg->name().c_str());
 
-		if (outAttr == outHeader.end() &&
-		    arg->name().size() > 3 &&
-		    arg->name().substr (arg->name().size() - 3) == "Out")
+		if (outAttr == outHeader.end() && hasOutSuffix)
 		{
 		    outAttr = outHeader.find
 			(arg->name().substr(0, arg->name().size() - 3).c_str());
@@ -326,8 +327,8 @@ callFunctions
 		{
 		    debug ("\t\t\tcopying to output header\n");
 
-		    copyFunctionArg (arg, outAttr.attribute());
-		    continue;
+		    output.attribute = &outAttr.attribute();
+		    binding.outputs.push_back (output);
 		}
 	    }
 	}
@@ -337,22 +338,135 @@ callFunctions
 }
 
 
+void
+callFunctions
+    (const BindingList &bindings,
+     const Box2i &transformWindow,
+     size_t firstSample,
+     size_t numSamples)
+{
+    debug ("callFunctions (..., "
+	   "firstSample = " << firstSample << ", "
+	   "numSamples = " << numSamples << ", ...)");
+
+    //
+    // For each function, provide input argument values,
+    // call the function, and return output argument values
+    // to the caller.
+    //
+
+    for (size_t i = 0; i < bindings.size(); ++i)
+    {
+	const FunctionBinding &binding = bindings[i];
+
+	for (size_t j = 0; j < binding.inputs.size(); ++j)
+	{
+	    const InputBinding &input = binding.inputs[j];
+
+	    if (input.previousArg)
+	    {
+		copyFunctionArg (input.arg->isVarying()? numSamples: 1,
+				 input.previousArg,
+				 input.arg);
+	    }
+	    else
+	    {
+		copyFunctionArg (transformWindow,
+				 firstSample,
+				 numSamples,
+				 *input.slice,
+				 input.arg);
+	    }
+	}
+
+	binding.func->callFunction (numSamples);
+
+	for (size_t j = 0; j < binding.outputs.size(); ++j)
+	{
+	    const OutputBinding &output = binding.outputs[j];
+
+	    if (output.slice)
+	    {
+		copyFunctionArg (transformWindow,
+				 firstSample,
+				 numSamples,
+				 output.arg,
+				 *output.slice);
+	    }
+	    else
+	    {
+		copyFunctionArg (output.arg, *output.attribute);
+	    }
+	}
+    }
+}
+
+
+//
+// The samples in the transform window are handed out to the tasks
+// in packets of at most maxSamples samples.  Each task pulls the
+// next packet from the shared SampleQueue when it is done with the
+// previous one, so that a task whose packets happen to be expensive
+// does not hold up the others.
+//
+
+class SampleQueue
+{
+  public:
+
+    SampleQueue (size_t totalSamples, size_t packetSize);
+
+    bool		nextPacket (size_t &firstSample, size_t &numSamples);
+
+  private:
+
+    Mutex		_mutex;
+    size_t		_nextSample;
+    size_t		_totalSamples;
+    size_t		_packetSize;
+};
+
+
+SampleQueue::SampleQueue (size_t totalSamples, size_t packetSize)
+:
+    _nextSample (0),
+    _totalSamples (totalSamples),
+    _packetSize (max (packetSize, size_t (1)))
+{
+    // empty
+}
+
+
+bool
+SampleQueue::nextPacket (size_t &firstSample, size_t &numSamples)
+{
+    Lock lock (_mutex);
+
+    if (_nextSample >= _totalSamples)
+	return false;
+
+    firstSample = _nextSample;
+    numSamples = min (_totalSamples - _nextSample, _packetSize);
+    _nextSample += numSamples;
+    return true;
+}
+
+
 class CallFunctionsTask: public Task
 {
   public:
 
     CallFunctionsTask
 	(TaskGroup *group,
-	 Interpreter &interpreter,
-	 const StringList &transformNames,
+	 const FunctionList &prototypes,
 	 const Box2i &transformWindow,
-	 size_t taskSamplesBegin,
-	 size_t taskSamplesEnd,
+	 SampleQueue &sampleQueue,
 	 const Header &envHeader,
 	 const Header &inHeader,
 	 const FrameBuffer &inFb,
 	 Header &outHeader,
 	 const FrameBuffer &outFb,
+	 TaskStatistics *statistics,
 	 Mutex &exceptionMutex,
 	 string &exceptionWhat);
 
@@ -360,16 +474,15 @@ class CallFunctionsTask: public Task
 
   private:
 
-    Interpreter &	_interpreter;
-    const StringList &	_transformNames;
+    const FunctionList &	_prototypes;
     const Box2i &	_transformWindow;
-    size_t		_taskSamplesBegin;
-    size_t		_taskSamplesEnd;
+    SampleQueue &	_sampleQueue;
     const Header &	_envHeader;
     const Header &	_inHeader;
     const FrameBuffer &	_inFb;
     Header &		_outHeader;
     const FrameBuffer &	_outFb;
+    TaskStatistics *	_statistics;
     Mutex &		_exceptionMutex;
     string &		_exceptionWhat;
 };
@@ -377,30 +490,28 @@ class CallFunctionsTask: public Task
 
 CallFunctionsTask::CallFunctionsTask
     (TaskGroup *group,
-     Interpreter &interpreter,
-     const StringList &transformNames,
+     const FunctionList &prototypes,
      const Box2i &transformWindow,
-     size_t taskSamplesBegin,
-     size_t taskSamplesEnd,
+     SampleQueue &sampleQueue,
      const Header &envHeader,
      const Header &inHeader,
      const FrameBuffer &inFb,
      Header &outHeader,
      const FrameBuffer &outFb,
+     TaskStatistics *statistics,
      Mutex &exceptionMutex,
      string &exceptionWhat)
 :
     Task (group),
-    _interpreter (interpreter),
-    _transformNames (transformNames),
+    _prototypes (prototypes),
     _transformWindow (transformWindow),
-    _taskSamplesBegin (taskSamplesBegin),
-    _taskSamplesEnd (taskSamplesEnd),
+    _sampleQueue (sampleQueue),
     _envHeader (envHeader),
     _inHeader (inHeader),
     _inFb (inFb),
     _outHeader (outHeader),
     _outFb (outFb),
+    _statistics (statistics),
     _exceptionMutex (exceptionMutex),
     _exceptionWhat (exceptionWhat)
 {
@@ -413,39 +524,48 @@ CallFunctionsTask::execute()
 {
     debug1 ("CallFunctionsTask::execute()");
 
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    size_t numPackets = 0;
+    size_t numSamplesDone = 0;
+
     try
     {
 	//
 	// Get function call objects for all transform functions
-	// that we want to call.
+	// that we want to call, by cloning the prototypes; this
+	// gives the task its own argument registers.  The function
+	// call objects are reused for all the packets that this
+	// task processes.
 	//
 
 	FunctionList funcs;
 
-	for (size_t i = 0; i < _transformNames.size(); ++i)
-	    funcs.push_back (_interpreter.newFunctionCall (_transformNames[i]));
+	for (size_t i = 0; i < _prototypes.size(); ++i)
+	    funcs.push_back (_prototypes[i]->clone());
+
+	BindingList bindings;
+
+	bindFunctions (funcs,
+		       _envHeader, _inHeader, _inFb,
+		       _outHeader, _outFb,
+		       bindings);
 
 	//
-	// Repeatedly call the transform functions, breaking the
-	// varying data into packets of at most maxSamples samples.
+	// Repeatedly take a packet of samples from the queue and
+	// call the transform functions, until the queue is empty.
 	//
 
-	size_t maxSamples = _interpreter.maxSamples();
-	size_t begin = _taskSamplesBegin;
-	size_t end = _taskSamplesEnd;
+	size_t begin;
+	size_t numSamples;
 
-	debug1 ("\tbegin = " << begin << ", end = " << end);
-	
-	while (begin < end)
+	while (_sampleQueue.nextPacket (begin, numSamples))
 	{
-	    size_t numSamples = min (end - begin, maxSamples);
+	    debug1 ("\tbegin = " << begin << ", numSamples = " << numSamples);
 
-	    callFunctions (funcs, _transformWindow,
-			   begin, numSamples,
-			   _envHeader, _inHeader, _inFb,
-			   _outHeader, _outFb);
+	    callFunctions (bindings, _transformWindow, begin, numSamples);
 
-	    begin += numSamples;
+	    numPackets += 1;
+	    numSamplesDone += numSamples;
 	}
     }
     catch (const std::exception &exc)
@@ -458,6 +578,15 @@ CallFunctionsTask::execute()
 	Lock lock (_exceptionMutex);
 	_exceptionWhat = "unrecognized exception";
     }
+
+    if (_statistics)
+    {
+	_statistics->numPackets = numPackets;
+	_statistics->numSamples = numSamplesDone;
+
+	_statistics->seconds = chrono::duration <double>
+	    (chrono::steady_clock::now() - startTime).count();
+    }
 }
 
 } // namespace
@@ -473,7 +602,8 @@ applyTransforms
      const FrameBuffer &inFb,
      Header &outHeader,
      const FrameBuffer &outFb,
-     int numThreads)
+     int numThreads,
+     TaskStatisticsList *statistics)
 {
     //
     // Load the CTL modules that we expect to contain the 
@@ -490,47 +620,60 @@ applyTransforms
     size_t totalSamples = (transformWindow.max.x - transformWindow.min.x + 1) *
 			  (transformWindow.max.y - transformWindow.min.y + 1);
 
+    numThreads = max (numThreads, 1);
+
+    if (statistics)
+    {
+	statistics->clear();
+	statistics->resize (numThreads, TaskStatistics());
+    }
+
     if (totalSamples <= 0)
 	return;
 
+    //
+    // Look up the transform functions once; each task clones the
+    // resulting function call objects instead of asking the
+    // interpreter for new ones.
+    //
+
+    FunctionList prototypes;
+
+    for (size_t i = 0; i < transformNames.size(); ++i)
+	prototypes.push_back (interpreter.newFunctionCall (transformNames[i]));
+
     //
     // Create tasks to be processed by the thread pool.
-    // The pixels in the transformWindow are are split into
-    // chunks of approximately equal size.  Each task will
-    // process one of of those chunks, breaking it down
-    // further into packets that are small enough for the
-    // interpreter.
+    // The pixels in the transformWindow are split into packets
+    // that are small enough for the interpreter.  Each task
+    // repeatedly takes the next unprocessed packet from
+    // sampleQueue, until all packets have been processed.
     //
     // If a task catches an exception, it locks the exceptionMutex,
     // below, stores the exception's what() string in exceptionWhat,
     // and releases the mutex.
     //
 
+    SampleQueue sampleQueue (totalSamples, interpreter.maxSamples());
     Mutex exceptionMutex;
     string exceptionWhat;
 
     {
 	TaskGroup taskGroup;
 
-	numThreads = max (numThreads, 1);
-
 	for (int i = 0; i < numThreads; ++i)
 	{
-	    size_t taskSamplesBegin = totalSamples * i / numThreads;
-	    size_t taskSamplesEnd = totalSamples * (i + 1) / numThreads;
-	    
 	    ThreadPool::addGlobalTask
 		(new CallFunctionsTask (&taskGroup,
-					interpreter,
-		                        transformNames,
+					prototypes,
 					transformWindow,
-					taskSamplesBegin,
-					taskSamplesEnd,
+					sampleQueue,
 					envHeader,
 					inHeader,
 					inFb,
 					outHeader,
 					outFb,
+					statistics? &(*statistics)[i]: 0,
 					exceptionMutex,
 					exceptionWhat));
 	}
@@ -99,6 +99,9 @@
 //	    numThreads		Number of threads that will be used to
 //				execute the CTL functions (see below).
 //
+//	    statistics		If not 0, receives per-thread statistics
+//				(see below).
+//
 //	applyTransforms() first loads the CTL modules that contain the
 //	functions listed in transformNames.  Each function is assumed to
 //	live in a module with the same name as the function.
@@ -156,7 +159,9 @@
 //
 //	In all cases, the type of the value used must match the type of the
 //	input parameter.  A type mismatch is an error; applyTransforms()
-//	throws an Iex::TypeExc.
+//	throws an Iex::TypeExc.  As an exception, HALF and FLOAT inFb
+//	slices can be used for both half and float input parameters;
+//	the pixels are converted as they are copied.
 //
 //	After the CTL function returns, the value of each output parameters,
 //	with name n, may be copied into outHeader or outFb, in addition to
@@ -182,7 +187,9 @@
 //
 //	The type of the output parameter must match the type of the frame
 //	buffer slice or header attribute.  A type mismatch is an error;
-//	applyTransforms() throws an Iex::TypeExc.
+//	applyTransforms() throws an Iex::TypeExc.  As with input
+//	parameters, half and float output parameters can be copied
+//	into both HALF and FLOAT outFb slices.
 //
 //	applyTransforms() does not add attributes to outHeader or slices
 //	to the outFb.  Only existing attributes or slices are used.
@@ -199,6 +206,19 @@
 //	code.  The default behavior is to try to occupy all threads in
 //	the thread pool.
 //
+//	The pixels in the transformWindow are not divided among the
+//	threads up front.  Instead, each thread repeatedly takes the
+//	next packet of at most interpreter.maxSamples() pixels that
+//	has not been processed yet.  Threads that happen to get pixels
+//	that are cheap to process take more packets than threads that
+//	get expensive ones, so all threads finish at about the same time.
+//	Each thread creates its own FunctionCall objects once, and
+//	reuses them for all packets it processes.
+//
+//	If statistics is not 0, applyTransforms() resizes *statistics
+//	to numThreads entries, and stores in each entry how many packets
+//	and pixels one of the threads processed, and how long it took.
+//
 //-----------------------------------------------------------------------------
 
 #include <string>
@@ -217,6 +237,17 @@ namespace ImfCtl
 {
     typedef std::vector <std::string> StringList;
 
+    struct TaskStatistics
+    {
+	TaskStatistics (): numPackets (0), numSamples (0), seconds (0) {}
+
+	size_t	numPackets;	// number of packets processed
+	size_t	numSamples;	// number of pixels processed
+	double	seconds;	// elapsed time, in seconds
+    };
+
+    typedef std::vector <TaskStatistics> TaskStatisticsList;
+
     void
     applyTransforms
 	(Ctl::Interpreter &interpreter,
@@ -227,7 +258,8 @@ namespace ImfCtl
 	 const Imf::FrameBuffer &inFb,
 	 Imf::Header &outHeader,
 	 const Imf::FrameBuffer &outFb,
-	 int numThreads = Imf::globalThreadCount());
+	 int numThreads = Imf::globalThreadCount(),
+	 TaskStatisticsList *statistics = 0);
 }
 
 #endif
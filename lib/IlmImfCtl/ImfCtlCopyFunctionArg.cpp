@@ -72,6 +72,7 @@
 #include <Iex.h>
 #include <cassert>
 #include <cstring>
+#include <type_traits>
 
 using namespace Imath;
 using namespace Imf;
@@ -180,6 +181,112 @@ throwSliceSampling ()
 	   "CTL function calls must have x and y sampling rate 1.");
 }
 
+
+//
+// Copy n samples of type S, spaced srcStride bytes apart, into
+// samples of type D, spaced dstStride bytes apart, converting
+// between half and float if necessary.  Densely packed samples
+// of the same type are copied with a single memcpy().
+//
+
+template <class S, class D>
+void
+copySamples
+    (const char *src,
+     size_t srcStride,
+     char *dst,
+     size_t dstStride,
+     size_t n)
+{
+    if (is_same <S, D>::value &&
+	srcStride == sizeof (S) &&
+	dstStride == sizeof (D))
+    {
+	memcpy (dst, src, n * sizeof (D));
+	return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	*(D *)dst = D (*(const S *)src);
+	src += srcStride;
+	dst += dstStride;
+    }
+}
+
+
+//
+// Copy the samples firstSample through firstSample + numSamples - 1
+// of the transform window between a frame buffer slice and the data
+// of a varying function argument.  The samples are copied one
+// scanline segment at a time, so that the slice address computation
+// and the end-of-scanline test are done once per segment rather
+// than once per sample.
+//
+
+template <class S, class D>
+void
+copySliceToArg
+    (const Box2i &transformWindow,
+     size_t firstSample,
+     size_t numSamples,
+     const Slice &src,
+     char *dstData,
+     size_t dstStride)
+{
+    long w = transformWindow.max.x - transformWindow.min.x + 1;
+    long x = transformWindow.min.x + modp (firstSample, w);
+    long y = transformWindow.min.y + divp (firstSample, w);
+
+    while (numSamples > 0)
+    {
+	size_t n = min (numSamples, size_t (transformWindow.max.x - x + 1));
+
+	copySamples <S, D> (src.base + x * src.xStride + y * src.yStride,
+			    src.xStride,
+			    dstData,
+			    dstStride,
+			    n);
+
+	dstData += n * dstStride;
+	numSamples -= n;
+	x = transformWindow.min.x;
+	y += 1;
+    }
+}
+
+
+template <class S, class D>
+void
+copyArgToSlice
+    (const Box2i &transformWindow,
+     size_t firstSample,
+     size_t numSamples,
+     const char *srcData,
+     size_t srcStride,
+     const Slice &dst)
+{
+    long w = transformWindow.max.x - transformWindow.min.x + 1;
+    long x = transformWindow.min.x + modp (firstSample, w);
+    long y = transformWindow.min.y + divp (firstSample, w);
+
+    while (numSamples > 0)
+    {
+	size_t n = min (numSamples, size_t (transformWindow.max.x - x + 1));
+
+	copySamples <S, D> (srcData,
+			    srcStride,
+			    dst.base + x * dst.xStride + y * dst.yStride,
+			    dst.xStride,
+			    n);
+
+	srcData += n * srcStride;
+	numSamples -= n;
+	x = transformWindow.min.x;
+	y += 1;
+    }
+}
+
 } // namespace
 
 
@@ -196,54 +303,54 @@ copyFunctionArg
     if (src.xSampling != 1 || src.ySampling != 1)
 	throwSliceSampling();
 
-    long w = transformWindow.max.x - transformWindow.min.x + 1;
-    long x = transformWindow.min.x + modp (firstSample, w);
-    long y = transformWindow.min.y + divp (firstSample, w);
     char *dstData = (dst->data());
     size_t dstStride = dst->type()->alignedObjectSize();
 
+    //
+    // HALF and FLOAT slices can be copied into both half and float
+    // arguments; the samples are converted on the fly.
+    //
+
     switch (src.type)
     {
       case HALF:
 
-	if (!dst->type().cast<HalfType>())
-	    throwSrcSliceTypeMismatch ("HALF", dst);
-
-	for (size_t i = 0; i < numSamples; ++i)
+	if (dst->type().cast<HalfType>())
 	{
-	    *(half *)dstData =
-		*(half *)(src.base + x * src.xStride + y * src.yStride);
-
-	    dstData += dstStride;
-	    x += 1;
-
-	    if (x > transformWindow.max.x)
-	    {
-		y += 1;
-		x = transformWindow.min.x;
-	    }
+	    copySliceToArg <half, half>
+		(transformWindow, firstSample, numSamples,
+		 src, dstData, dstStride);
+	}
+	else if (dst->type().cast<FloatType>())
+	{
+	    copySliceToArg <half, float>
+		(transformWindow, firstSample, numSamples,
+		 src, dstData, dstStride);
+	}
+	else
+	{
+	    throwSrcSliceTypeMismatch ("HALF", dst);
 	}
 
 	break;
 
 	  case Imf::FLOAT:
 
-	if (!dst->type().cast<FloatType>())
-	    throwSrcSliceTypeMismatch ("FLOAT", dst);
-
-	for (size_t i = 0; i < numSamples; ++i)
+	if (dst->type().cast<FloatType>())
 	{
-	    *(float *)dstData =
-		*(float *)(src.base + x * src.xStride + y * src.yStride);
-
-	    dstData += dstStride;
-	    x += 1;
-
-	    if (x > transformWindow.max.x)
-	    {
-		y += 1;
-		x = transformWindow.min.x;
-	    }
+	    copySliceToArg <float, float>
+		(transformWindow, firstSample, numSamples,
+		 src, dstData, dstStride);
+	}
+	else if (dst->type().cast<HalfType>())
+	{
+	    copySliceToArg <float, half>
+		(transformWindow, firstSample, numSamples,
+		 src, dstData, dstStride);
+	}
+	else
+	{
+	    throwSrcSliceTypeMismatch ("FLOAT", dst);
 	}
 
 	break;
@@ -253,20 +360,9 @@ copyFunctionArg
 	if (!dst->type().cast<UIntType>())
 	    throwSrcSliceTypeMismatch ("UINT", dst);
 
-	for (size_t i = 0; i < numSamples; ++i)
-	{
-	    *(unsigned int *)dstData =
-		*(unsigned int *)(src.base + x * src.xStride + y * src.yStride);
-
-	    dstData += dstStride;
-	    x += 1;
-
-	    if (x > transformWindow.max.x)
-	    {
-		y += 1;
-		x = transformWindow.min.x;
-	    }
-	}
+	copySliceToArg <unsigned int, unsigned int>
+	    (transformWindow, firstSample, numSamples,
+	     src, dstData, dstStride);
 
 	break;
 
@@ -289,54 +385,54 @@ copyFunctionArg
     if (dst.xSampling != 1 || dst.ySampling != 1)
 	throwSliceSampling();
 
-    long w = transformWindow.max.x - transformWindow.min.x + 1;
-    long x = transformWindow.min.x + modp (firstSample, w);
-    long y = transformWindow.min.y + divp (firstSample, w);
     const char *srcData = (src->data());
     size_t srcStride = src->type()->alignedObjectSize();
 
+    //
+    // Half and float arguments can be copied into both HALF and
+    // FLOAT slices; the samples are converted on the fly.
+    //
+
     switch (dst.type)
     {
       case HALF:
 
-	if (!src->type().cast<HalfType>())
-	    throwDstSliceTypeMismatch (src, "HALF");
-
-	for (size_t i = 0; i < numSamples; ++i)
+	if (src->type().cast<HalfType>())
 	{
-	    *(half *)(dst.base + x * dst.xStride + y * dst.yStride) =
-		*(half *)srcData;
-
-	    srcData += srcStride;
-	    x += 1;
-
-	    if (x > transformWindow.max.x)
-	    {
-		y += 1;
-		x = transformWindow.min.x;
-	    }
+	    copyArgToSlice <half, half>
+		(transformWindow, firstSample, numSamples,
+		 srcData, srcStride, dst);
+	}
+	else if (src->type().cast<FloatType>())
+	{
+	    copyArgToSlice <float, half>
+		(transformWindow, firstSample, numSamples,
+		 srcData, srcStride, dst);
+	}
+	else
+	{
+	    throwDstSliceTypeMismatch (src, "HALF");
 	}
 
 	break;
 
 	  case Imf::FLOAT:
 
-	if (!src->type().cast<FloatType>())
-	    throwDstSliceTypeMismatch (src, "FLOAT");
-
-	for (size_t i = 0; i < numSamples; ++i)
+	if (src->type().cast<FloatType>())
 	{
-	    *(float *)(dst.base + x * dst.xStride + y * dst.yStride) =
-		*(float *)srcData;
-
-	    srcData += srcStride;
-	    x += 1;
-
-	    if (x > transformWindow.max.x)
-	    {
-		y += 1;
-		x = transformWindow.min.x;
-	    }
+	    copyArgToSlice <float, float>
+		(transformWindow, firstSample, numSamples,
+		 srcData, srcStride, dst);
+	}
+	else if (src->type().cast<HalfType>())
+	{
+	    copyArgToSlice <half, float>
+		(transformWindow, firstSample, numSamples,
+		 srcData, srcStride, dst);
+	}
+	else
+	{
+	    throwDstSliceTypeMismatch (src, "FLOAT");
 	}
 
 	break;
@@ -346,20 +442,9 @@ copyFunctionArg
 	if (!src->type().cast<UIntType>())
 	    throwDstSliceTypeMismatch (src, "UINT");
 
-	for (size_t i = 0; i < numSamples; ++i)
-	{
-	    *(unsigned int *)(dst.base + x * dst.xStride + y * dst.yStride) =
-		*(unsigned int *)srcData;
-
-	    srcData += srcStride;
-	    x += 1;
-
-	    if (x > transformWindow.max.x)
-	    {
-		y += 1;
-		x = transformWindow.min.x;
-	    }
-	}
+	copyArgToSlice <unsigned int, unsigned int>
+	    (transformWindow, firstSample, numSamples,
+	     srcData, srcStride, dst);
 
 	break;
 
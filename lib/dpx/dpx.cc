@@ -70,6 +70,7 @@ namespace ctl
 dpx::dpx() {
 	endian_mode=default_endian_mode;
 	compliance=automatic;
+	packing_mode=fused;
 
 	clear();
 
@@ -59,6 +59,7 @@
 #include <istream>
 #include <ostream>
 #include <stdexcept>
+#include <mutex>
 #include <stdint.h>
 #include <math.h>
 
@@ -273,6 +274,23 @@ struct dpx {
 			dpx3      =0x20000000,
 		} compliance;
 
+		// Selects how unsigned integer samples are moved between the file
+		// and floating point frame buffers. In 'fused' mode (the default)
+		// the common 8, 10, 12 and 16 bit packings are byteswapped,
+		// unpacked and converted a scanline at a time in a single pass.
+		// In 'generic' mode the whole element is staged through the
+		// general purpose unpack and convertfb code, which is kept for
+		// comparison. Both produce identical results, except for 10 bit
+		// elements whose lines don't hold a multiple of three samples,
+		// which only 'fused' handles: it pads every line to a whole 32
+		// bit word, as the DPX specification requires. A short element
+		// makes the 'fused' read throw dpx::invalid.
+		//
+		enum packing_mode_e {
+			fused     =0,
+			generic   =1,
+		} packing_mode;
+
 		// Some helper functions to determine if a field is 'NULL' or
 		// to set a field to NULL.
 		static bool isnull(uint64_t v);
@@ -297,7 +315,7 @@ struct dpx {
 		compliance_e current_compliance;
 		endian_mode_e current_endian_mode;
 
-		std::istream::streampos header_start;
+		std::istream::pos_type header_start;
 
 	public:
 		virtual ~dpx();
@@ -624,6 +642,63 @@ struct dpx {
 		static std::string descriptor_to_string(uint8_t id);
 };
 
+// Read only access to a DPX file through a memory mapping of the whole
+// file (on platforms without mmap the file is read into memory instead).
+// Since each element lives at a fixed offset, element data is handed out
+// as a zero copy view of the mapping and scanline ranges are decoded
+// straight out of it on demand rather than through an istream.
+//
+// Once open() has returned, the const methods may be called from any
+// number of threads at once, e.g. each decoding a different range of
+// scanlines into its own buffer.
+class mapped_dpx {
+	public:
+		mapped_dpx();
+		~mapped_dpx();
+
+		// Maps the file and reads the header from it. Returns FALSE if
+		// the file can't be mapped or isn't a DPX file.
+		bool open(const char *filename);
+		void close(void);
+
+		// The header, as read by dpx::read(std::istream *).
+		const dpx &header(void) const;
+
+		// The number of interleaved channels in the element (as the
+		// buffers filled out by dpx::read use).
+		uint8_t channels(uint8_t element) const;
+
+		// A view of the element's data as it is stored in the file, and
+		// its length in bytes. The view is valid until close().
+		const uint8_t *data(uint8_t element) const;
+		uint64_t length(uint8_t element) const;
+
+		// Decodes scanlines [y, y+buffer->height()) of the element into
+		// buffer, which must already be initialized with the element's
+		// width and channel count. The conversion is the same as
+		// dpx::read. Throws dpx::outofrange for a bad element, scanline
+		// range or buffer size and dpx::invalid if the element runs off
+		// the end of the file. Elements in layouts that can't be decoded
+		// a scanline at a time are decoded whole on the first call, and
+		// kept until close() or a read of another element or scale.
+		void read(uint8_t element, uint32_t y, dpx::fb<float32_t> *buffer,
+		          float64_t scale=0.0) const;
+
+	private:
+		mapped_dpx(const mapped_dpx &);
+		mapped_dpx &operator=(const mapped_dpx &);
+
+		dpx _header;
+		const uint8_t *_data;
+		uint64_t _length;
+		bool _mapped;
+
+		mutable std::mutex _decoded_lock;
+		mutable dpx::fb<float32_t> _decoded;
+		mutable int _decoded_element;
+		mutable float64_t _decoded_scale;
+};
+
 #include <dpx.tcc>
 
 }
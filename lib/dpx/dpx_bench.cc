@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+// Times reading and writing float buffers through the fused and the
+// generic integer packing code on a DPX file tiled up to a 4K frame, and
+// makes sure that both produce the same bits. The frames are written to
+// scratch files in the current directory. Typically run as:
+//
+//   dpx_bench unittest/ctlrender/bars_nuke_*.dpx
+//
+
+#include <dpx.hh>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+
+const uint32_t bench_width=4096;
+const uint32_t bench_height=2160;
+const int bench_runs=5;
+const char *generic_name="dpx_bench_generic.dpx";
+const char *fused_name="dpx_bench_fused.dpx";
+
+float64_t seconds(clock_t start) {
+	return ((float64_t)(clock()-start))/CLOCKS_PER_SEC;
+}
+
+void tile(ctl::dpx::fb<float32_t> *out, const ctl::dpx::fb<float32_t> &in) {
+	uint32_t x, y, c;
+	float32_t *o;
+	const float32_t *i;
+
+	out->init(bench_width, bench_height, in.depth());
+
+	o=out->ptr();
+	for(y=0; y<bench_height; y++) {
+		for(x=0; x<bench_width; x++) {
+			i=in.ptr()+(((y%in.height())*in.width())+(x%in.width()))*in.depth();
+			for(c=0; c<in.depth(); c++) {
+				*(o++)=i[c];
+			}
+		}
+	}
+}
+
+float64_t time_write(const char *name, const ctl::dpx::fb<float32_t> &buf,
+                     uint8_t bps, ctl::dpx::packing_mode_e mode) {
+	float64_t best, t;
+	clock_t start;
+	int i;
+
+	best=0.0;
+	for(i=0; i<bench_runs; i++) {
+		std::ofstream o;
+		ctl::dpx header;
+
+		o.open(name, std::ios_base::out | std::ios_base::trunc |
+		             std::ios_base::binary);
+
+		header.packing_mode=mode;
+		header.elements[0].data_sign=0;
+		header.elements[0].bits_per_sample=bps;
+
+		start=clock();
+		header.write(&o, 0, buf, 0.0);
+		header.write(&o);
+		o.close();
+		t=seconds(start);
+
+		if(i==0 || t<best) {
+			best=t;
+		}
+	}
+
+	return best;
+}
+
+float64_t time_read(ctl::dpx::fb<float32_t> *buf, const char *name,
+                    ctl::dpx::packing_mode_e mode) {
+	float64_t best, t;
+	clock_t start;
+	int i;
+
+	best=0.0;
+	for(i=0; i<bench_runs; i++) {
+		std::ifstream is;
+		ctl::dpx header;
+
+		is.open(name, std::ios_base::in | std::ios_base::binary);
+
+		start=clock();
+		header.read(&is);
+		header.packing_mode=mode;
+		header.read(&is, 0, buf, 0.0);
+		t=seconds(start);
+
+		if(i==0 || t<best) {
+			best=t;
+		}
+	}
+
+	return best;
+}
+
+std::string contents(const char *name) {
+	std::ifstream is;
+	std::ostringstream s;
+
+	is.open(name, std::ios_base::in | std::ios_base::binary);
+	s << is.rdbuf();
+
+	return s.str();
+}
+
+bool bench(const char *name) {
+	ctl::dpx::fb<float32_t> source, frame, generic_in, fused_in;
+	float64_t generic_t, fused_t;
+	std::ifstream file;
+	ctl::dpx header;
+	uint8_t bps;
+	bool ok;
+
+	file.open(name, std::ios_base::in | std::ios_base::binary);
+	if(!file.good() || !ctl::dpx::check_magic(&file)) {
+		std::cerr << name << ": not a dpx file" << std::endl;
+		return false;
+	}
+	header.read(&file);
+	header.read(&file, 0, &source, 0.0);
+	bps=header.elements[0].bits_per_sample;
+
+	tile(&frame, source);
+
+	std::cout << name << " (" << frame.width() << "x" << frame.height()
+	          << "x" << frame.depth() << ", " << (int)bps << " bit)"
+	          << std::endl;
+
+	ok=true;
+
+	generic_t=time_write(generic_name, frame, bps, ctl::dpx::generic);
+	fused_t=time_write(fused_name, frame, bps, ctl::dpx::fused);
+	std::cout << "  write: generic " << generic_t << "s, fused " << fused_t
+	          << "s (" << generic_t/fused_t << "x)" << std::endl;
+	if(contents(generic_name)!=contents(fused_name)) {
+		std::cerr << "  write: fused output differs from generic" << std::endl;
+		ok=false;
+	}
+
+	generic_t=time_read(&generic_in, generic_name, ctl::dpx::generic);
+	fused_t=time_read(&fused_in, generic_name, ctl::dpx::fused);
+	std::cout << "  read:  generic " << generic_t << "s, fused " << fused_t
+	          << "s (" << generic_t/fused_t << "x)" << std::endl;
+	if(generic_in.count()!=fused_in.count() ||
+	   memcmp(generic_in.ptr(), fused_in.ptr(), generic_in.length())!=0) {
+		std::cerr << "  read: fused pixels differ from generic" << std::endl;
+		ok=false;
+	}
+
+	remove(generic_name);
+	remove(fused_name);
+
+	return ok;
+}
+
+}
+
+int main(int argc, const char **argv) {
+	bool ok;
+	int i;
+
+	if(argc<2) {
+		std::cerr << "usage: " << argv[0] << " file.dpx [file.dpx ...]"
+		          << std::endl;
+		return 1;
+	}
+
+	ok=true;
+	for(i=1; i<argc; i++) {
+		if(!bench(argv[i])) {
+			ok=false;
+		}
+	}
+
+	return ok ? 0 : 1;
+}
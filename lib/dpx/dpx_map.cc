@@ -0,0 +1,297 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <dpx.hh>
+#include "dpx_rw.hh"
+#include "dpx_pack.hh"
+#include <streambuf>
+#include <istream>
+#include <fstream>
+#include <string.h>
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ctl {
+
+namespace {
+
+// Just enough of a streambuf over the mapping to let the regular
+// istream based dpx::read methods parse a header (or an element we
+// can't decode directly) without copying the file.
+class memory_buf : public std::streambuf {
+	public:
+		memory_buf(const uint8_t *data, uint64_t length) {
+			char *p=(char *)data;
+
+			setg(p, p, p+length);
+		}
+
+	protected:
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+		                         std::ios_base::openmode which) {
+			char *p;
+
+			if(dir==std::ios_base::beg) {
+				p=eback()+off;
+			} else if(dir==std::ios_base::cur) {
+				p=gptr()+off;
+			} else {
+				p=egptr()+off;
+			}
+			if(p<eback() || p>egptr()) {
+				return pos_type(off_type(-1));
+			}
+
+			setg(eback(), p, egptr());
+			return pos_type(p-eback());
+		}
+
+		virtual pos_type seekpos(pos_type pos,
+		                         std::ios_base::openmode which) {
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+};
+
+}
+
+mapped_dpx::mapped_dpx() {
+	_data=NULL;
+	_length=0;
+	_mapped=FALSE;
+	_decoded_element=-1;
+	_decoded_scale=0.0;
+}
+
+mapped_dpx::~mapped_dpx() {
+	close();
+}
+
+bool mapped_dpx::open(const char *filename) {
+	uint32_t magic;
+
+	close();
+
+#if !defined(_WIN32)
+	struct stat st;
+	void *p;
+	int fd;
+
+	fd=::open(filename, O_RDONLY);
+	if(fd<0) {
+		return FALSE;
+	}
+	if(fstat(fd, &st)!=0 || st.st_size==0) {
+		::close(fd);
+		return FALSE;
+	}
+	p=mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(p==MAP_FAILED) {
+		return FALSE;
+	}
+	_data=(const uint8_t *)p;
+	_length=st.st_size;
+	_mapped=TRUE;
+#else
+	std::ifstream file;
+	uint8_t *d;
+
+	file.open(filename, std::ios_base::in | std::ios_base::binary);
+	if(!file.good()) {
+		return FALSE;
+	}
+	file.seekg(0, std::ios_base::end);
+	_length=file.tellg();
+	file.seekg(0, std::ios_base::beg);
+	d=new uint8_t[_length];
+	file.read((char *)d, _length);
+	_data=d;
+	_mapped=FALSE;
+#endif
+
+	if(_length<sizeof(magic)) {
+		close();
+		return FALSE;
+	}
+	memcpy(&magic, _data, sizeof(magic));
+	if(magic!=0x53445058 && magic!=0x58504453) {
+		close();
+		return FALSE;
+	}
+
+	memory_buf buf(_data, _length);
+	std::istream is(&buf);
+
+	_header.read(&is);
+
+	return TRUE;
+}
+
+void mapped_dpx::close(void) {
+	if(_data!=NULL) {
+#if !defined(_WIN32)
+		if(_mapped) {
+			munmap((void *)_data, _length);
+		}
+#endif
+		if(!_mapped) {
+			delete [] _data;
+		}
+	}
+	_data=NULL;
+	_length=0;
+	_mapped=FALSE;
+
+	std::lock_guard<std::mutex> lock(_decoded_lock);
+	_decoded.init(0, 0, 0);
+	_decoded_element=-1;
+}
+
+const dpx &mapped_dpx::header(void) const {
+	return _header;
+}
+
+uint8_t mapped_dpx::channels(uint8_t element) const {
+	dpxi::rwinfo ri(&_header, element, 0.0, dpx::normal, FALSE);
+
+	return ri.channels;
+}
+
+const uint8_t *mapped_dpx::data(uint8_t element) const {
+	uint32_t offset;
+
+	if(element>=_header.number_of_elements) {
+		return NULL;
+	}
+	offset=_header.elements[element].offset_to_data;
+	if(offset>=_length) {
+		return NULL;
+	}
+	return _data+offset;
+}
+
+uint64_t mapped_dpx::length(uint8_t element) const {
+	dpxi::rwinfo ri(&_header, element, 0.0, dpx::normal, FALSE);
+	dpxi::unpacker up(ri);
+	uint64_t length;
+
+	if(data(element)==NULL) {
+		return 0;
+	}
+
+	if(up.valid()) {
+		length=up.line_bytes()*ri.height;
+	} else {
+		length=ri.bytes_for_raw();
+	}
+	if(length>_length-ri.offset_to_data) {
+		length=_length-ri.offset_to_data;
+	}
+	return length;
+}
+
+void mapped_dpx::read(uint8_t element, uint32_t y, dpx::fb<float32_t> *buffer,
+                      float64_t scale) const {
+	uint64_t row;
+
+	if(element>=_header.number_of_elements ||
+	   (uint64_t)y+buffer->height()>_header.lines_per_element) {
+		throw dpx::outofrange();
+	}
+
+	dpxi::rwinfo ri(&_header, element, scale, dpx::normal, FALSE);
+	dpxi::unpacker up(ri);
+
+	if(buffer->width()!=ri.width || buffer->depth()!=ri.channels) {
+		throw dpx::outofrange();
+	}
+
+	if(up.valid()) {
+		if(ri.offset_to_data+up.line_bytes()*(y+buffer->height())>_length) {
+			throw dpx::invalid();
+		}
+		up.unpack(buffer->ptr(),
+		          _data+ri.offset_to_data+up.line_bytes()*y,
+		          buffer->height());
+		return;
+	}
+
+	// Anything else goes through the generic code, which only decodes
+	// whole elements. That happens once (on a private stream and header)
+	// and later calls copy out of the result.
+	std::lock_guard<std::mutex> lock(_decoded_lock);
+
+	if(_decoded_element!=element || _decoded_scale!=scale) {
+		memory_buf buf(_data, _length);
+		std::istream is(&buf);
+		dpx h(_header);
+
+		_decoded_element=-1;
+		h.read(&is, element, &_decoded, scale);
+		_decoded_element=element;
+		_decoded_scale=scale;
+	}
+
+	row=(uint64_t)_decoded.width()*_decoded.depth();
+	memcpy(buffer->ptr(), _decoded.ptr()+row*y,
+	       sizeof(float32_t)*row*buffer->height());
+}
+
+}
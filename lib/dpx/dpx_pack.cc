@@ -0,0 +1,469 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <dpx.hh>
+#include "dpx_raw.hh"
+#include <string.h>
+#include <vector>
+#include "dpx_bits.hh"
+#include "dpx_rw.hh"
+#include "dpx_pack.hh"
+
+namespace ctl {
+namespace dpxi {
+
+// Works out if the element is stored in one of the layouts we handle
+// here. The word size tests mirror what the generic read and write_fb
+// functions pick so that both paths agree on what is in the file.
+static layout_e packed_layout(const rwinfo &ri) {
+	if(ri.packing_mode!=dpx::fused || ri.mode!=dpx::normal ||
+	   ri.datatype!=0) {
+		return layout_none;
+	}
+
+	switch(ri.bps) {
+		case 8:
+			if(ri.bytes_per_swap==1 && (ri.pack&0x7)<=2) {
+				return layout_8_in_8;
+			}
+			break;
+
+		case 10:
+			if(ri.bytes_per_swap==4 &&
+			   ((ri.pack&0x7)==1 || (ri.pack&0x7)==2)) {
+				return layout_10_in_32;
+			}
+			break;
+
+		case 12:
+			if(ri.bytes_per_swap==2 &&
+			   ((ri.pack&0x7)==1 || (ri.pack&0x7)==2)) {
+				return layout_12_in_16;
+			}
+			break;
+
+		case 16:
+			if(ri.bytes_per_swap==2 && (ri.pack&0x7)<=2) {
+				return layout_16_in_16;
+			}
+			break;
+	}
+
+	return layout_none;
+}
+
+// Number of bits the samples are shifted up in their word. Method A
+// (packing 1) pads the bottom of the word, method B (packing 2) the top.
+static uint8_t packed_shift(layout_e layout, const rwinfo &ri) {
+	if((ri.pack&0x7)!=1) {
+		return 0;
+	}
+	if(layout==layout_10_in_32) {
+		return 2;
+	} else if(layout==layout_12_in_16) {
+		return 4;
+	}
+	return 0;
+}
+
+static uint64_t packed_line_bytes(layout_e layout, const rwinfo &ri) {
+	uint64_t samples_per_word;
+	uint64_t samples;
+
+	samples=(uint64_t)ri.width*ri.channels;
+	if(layout==layout_float32) {
+		return samples*sizeof(float32_t);
+	}
+
+	samples_per_word=(ri.bytes_per_swap*8)/ri.bps;
+
+	return ((samples+samples_per_word-1)/samples_per_word)*ri.bytes_per_swap;
+}
+
+static inline uint32_t load32(const uint8_t *p, bool swap) {
+	uint32_t w;
+
+	memcpy(&w, p, sizeof(w));
+	if(swap) {
+		swap32(&w);
+	}
+	return w;
+}
+
+static inline uint16_t load16(const uint8_t *p, bool swap) {
+	uint16_t w;
+
+	memcpy(&w, p, sizeof(w));
+	if(swap) {
+		swap16(&w);
+	}
+	return w;
+}
+
+static inline void store32(uint8_t *p, uint32_t w, bool swap) {
+	if(swap) {
+		swap32(&w);
+	}
+	memcpy(p, &w, sizeof(w));
+}
+
+static inline void store16(uint8_t *p, uint16_t w, bool swap) {
+	if(swap) {
+		swap16(&w);
+	}
+	memcpy(p, &w, sizeof(w));
+}
+
+// Three samples per word, the first one in the most significant bits.
+// A partially filled last word only holds the leading samples.
+static void unpack_10(float32_t *o, const uint8_t *in, uint64_t samples,
+                      uint8_t shift, bool swap, const float32_t *lut) {
+	uint64_t u, words;
+	uint32_t w;
+
+	words=samples/3;
+	for(u=0; u<words; u++) {
+		w=load32(in, swap)>>shift;
+		o[0]=lut[(w>>20)&0x3ff];
+		o[1]=lut[(w>>10)&0x3ff];
+		o[2]=lut[w&0x3ff];
+		in=in+4;
+		o=o+3;
+	}
+
+	samples=samples-words*3;
+	if(samples!=0) {
+		w=load32(in, swap)>>shift;
+		o[0]=lut[(w>>20)&0x3ff];
+		if(samples>1) {
+			o[1]=lut[(w>>10)&0x3ff];
+		}
+	}
+}
+
+// One sample per 16 bit word (12 and 16 bit).
+static void unpack_16(float32_t *o, const uint8_t *in, uint64_t samples,
+                      uint8_t shift, uint16_t mask, bool swap,
+                      const float32_t *lut) {
+	uint64_t u;
+
+	for(u=0; u<samples; u++) {
+		o[u]=lut[(load16(in, swap)>>shift)&mask];
+		in=in+2;
+	}
+}
+
+static void unpack_8(float32_t *o, const uint8_t *in, uint64_t samples,
+                     const float32_t *lut) {
+	uint64_t u;
+
+	for(u=0; u<samples; u++) {
+		o[u]=lut[in[u]];
+	}
+}
+
+// Same as ftf_one / ftf (in dpx.tcc).
+static void unpack_float32(float32_t *o, const uint8_t *in, uint64_t samples,
+                           bool swap, float64_t scale) {
+	uint64_t u;
+	uint32_t w;
+
+	for(u=0; u<samples; u++) {
+		w=load32(in, swap);
+		memcpy(o+u, &w, sizeof(w));
+		in=in+4;
+	}
+	if(scale!=0.0 && scale!=1.0) {
+		for(u=0; u<samples; u++) {
+			o[u]=o[u]*scale;
+		}
+	}
+}
+
+// Float to integer conversion for a scanline. This produces exactly what
+// ftu_zero, ftu_one and ftu (in dpx.tcc) do for a single sample, but
+// keeps the scale test out of the loop and rounds by adding and removing
+// 2^52 (round to nearest even, the same as llrint in the default rounding
+// mode) so that the compiler is free to vectorize it. NaN comes out as 0
+// as it does from llrint on the platforms we care about.
+static void quantize(uint16_t *q, const float32_t *in, uint64_t count,
+                     uint8_t bps, float64_t scale) {
+	const float64_t round=4503599627370496.0;
+	float64_t fmax;
+	float64_t d;
+	uint32_t imax;
+	uint64_t u;
+
+	imax=max_int_for_bits[bps];
+	fmax=imax;
+
+	if(scale==0.0) {
+		for(u=0; u<count; u++) {
+			d=in[u];
+			d=(d>1.0 ? 1.0 : d)*fmax;
+			q[u]=!(d>=0.0) ? 0 : (uint16_t)((d+round)-round);
+		}
+	} else if(scale==1.0) {
+		for(u=0; u<count; u++) {
+			d=in[u];
+			q[u]=!(d>=0.0) ? 0 : d>fmax ? imax : (uint16_t)((d+round)-round);
+		}
+	} else {
+		for(u=0; u<count; u++) {
+			d=(float32_t)(in[u]*scale);
+			q[u]=!(d>=0.0) ? 0 : d>fmax ? imax : (uint16_t)((d+round)-round);
+		}
+	}
+}
+
+static void pack_10(uint8_t *o, const uint16_t *q, uint64_t samples,
+                    uint8_t shift, bool swap) {
+	uint64_t u, words;
+	uint32_t w;
+
+	words=samples/3;
+	for(u=0; u<words; u++) {
+		w=((uint32_t)q[0]<<20) | ((uint32_t)q[1]<<10) | q[2];
+		store32(o, w<<shift, swap);
+		q=q+3;
+		o=o+4;
+	}
+
+	samples=samples-words*3;
+	if(samples!=0) {
+		w=(uint32_t)q[0]<<20;
+		if(samples>1) {
+			w=w | ((uint32_t)q[1]<<10);
+		}
+		store32(o, w<<shift, swap);
+	}
+}
+
+static void pack_16(uint8_t *o, const uint16_t *q, uint64_t samples,
+                    uint8_t shift, bool swap) {
+	uint64_t u;
+
+	for(u=0; u<samples; u++) {
+		store16(o, q[u]<<shift, swap);
+		o=o+2;
+	}
+}
+
+static void pack_8(uint8_t *o, const uint16_t *q, uint64_t samples) {
+	uint64_t u;
+
+	for(u=0; u<samples; u++) {
+		o[u]=q[u];
+	}
+}
+
+unpacker::unpacker(const rwinfo &ri) {
+	convert_fn fn;
+	uint32_t u;
+
+	_layout=packed_layout(ri);
+	if(_layout==layout_none && ri.mode==dpx::normal && ri.datatype==2 &&
+	   ri.bps==32) {
+		_layout=layout_float32;
+	}
+	_shift=packed_shift(_layout, ri);
+	_swap=ri.need_byteswap;
+	_scale=ri.scale;
+	_samples=(uint64_t)ri.width*ri.channels;
+	_line_bytes=0;
+
+	if(_layout==layout_none) {
+		return;
+	}
+	_line_bytes=packed_line_bytes(_layout, ri);
+
+	if(_layout==layout_float32) {
+		return;
+	}
+
+	// The same conversion the generic path builds its table from, but
+	// only over the range of values a sample can actually hold.
+	fn=find_convert_fn<float32_t, uint32_t>(32, ri.bps, ri.scale);
+	_lut.resize(max_int_for_bits[ri.bps]+1);
+	for(u=0; u<_lut.size(); u++) {
+		fn(&(_lut[u]), 32, &u, ri.bps, ri.scale);
+	}
+}
+
+bool unpacker::valid(void) const {
+	return _layout!=layout_none;
+}
+
+uint64_t unpacker::line_bytes(void) const {
+	return _line_bytes;
+}
+
+void unpacker::unpack(float32_t *o, const uint8_t *in, uint32_t lines) const {
+	uint32_t y;
+
+	for(y=0; y<lines; y++) {
+		switch(_layout) {
+			case layout_8_in_8:
+				unpack_8(o, in, _samples, &(_lut[0]));
+				break;
+
+			case layout_10_in_32:
+				unpack_10(o, in, _samples, _shift, _swap, &(_lut[0]));
+				break;
+
+			case layout_12_in_16:
+				unpack_16(o, in, _samples, _shift, 0xfff, _swap, &(_lut[0]));
+				break;
+
+			case layout_16_in_16:
+				unpack_16(o, in, _samples, 0, 0xffff, _swap, &(_lut[0]));
+				break;
+
+			case layout_float32:
+				unpack_float32(o, in, _samples, _swap, _scale);
+				break;
+
+			default:
+				break;
+		}
+
+		o=o+_samples;
+		in=in+_line_bytes;
+	}
+}
+
+bool read_packed(std::istream *i, dpx::fb<float32_t> *out,
+                 const rwinfo &ri) {
+	dpx::fb<uint8_t> line;
+	uint32_t y;
+	float32_t *o;
+
+	if(packed_layout(ri)==layout_none) {
+		return FALSE;
+	}
+
+	unpacker up(ri);
+
+	line.init(up.line_bytes(), 1, 1);
+
+	o=out->ptr();
+	for(y=0; y<ri.height; y++) {
+		// A short element is an error, the same as for mapped_dpx.
+		i->read((char *)line.ptr(), up.line_bytes());
+		if((uint64_t)i->gcount()!=up.line_bytes()) {
+			throw dpx::invalid();
+		}
+		up.unpack(o, line.ptr(), 1);
+		o=o+(uint64_t)ri.width*ri.channels;
+	}
+
+	return TRUE;
+}
+
+bool write_packed(std::ostream *o, const dpx::fb<float32_t> &buf,
+                  const rwinfo &wi) {
+	dpx::fb<uint16_t> q;
+	dpx::fb<uint8_t> line;
+	layout_e layout;
+	uint64_t samples;
+	uint64_t bytes;
+	uint32_t y;
+	uint8_t shift;
+	const float32_t *i;
+
+	layout=packed_layout(wi);
+	if(layout==layout_none || buf.width()!=wi.width ||
+	   buf.height()!=wi.height || buf.depth()!=wi.channels) {
+		return FALSE;
+	}
+
+	samples=(uint64_t)wi.width*wi.channels;
+	bytes=packed_line_bytes(layout, wi);
+	shift=packed_shift(layout, wi);
+	q.init(samples, 1, 1);
+	line.init(bytes, 1, 1);
+
+	i=buf.ptr();
+	for(y=0; y<wi.height; y++) {
+		quantize(q.ptr(), i, samples, wi.bps, wi.scale);
+
+		switch(layout) {
+			case layout_8_in_8:
+				pack_8(line.ptr(), q.ptr(), samples);
+				break;
+
+			case layout_10_in_32:
+				pack_10(line.ptr(), q.ptr(), samples, shift, wi.need_byteswap);
+				break;
+
+			case layout_12_in_16:
+			case layout_16_in_16:
+				pack_16(line.ptr(), q.ptr(), samples, shift, wi.need_byteswap);
+				break;
+
+			default:
+				break;
+		}
+
+		o->write((const char *)line.ptr(), bytes);
+		i=i+samples;
+	}
+
+	return TRUE;
+}
+
+};
+
+};
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(AMPAS_CTL_DPX_PACK_INCLUDE)
+#define AMPAS_CTL_DPX_PACK_INCLUDE
+
+#include <dpx.hh>
+#include <vector>
+#include "dpx_rw.hh"
+
+namespace ctl {
+namespace dpxi {
+
+enum layout_e {
+	layout_none=0,
+	layout_8_in_8,
+	layout_10_in_32,
+	layout_12_in_16,
+	layout_16_in_16,
+	layout_float32
+};
+
+// Single pass readers and writers for the integer packings that make up
+// nearly every DPX file in the wild (8 bit, 10 bit filled into 32 bit
+// words, 12 and 16 bit in 16 bit words) when going to or from a float
+// buffer. The byteswap, (un)packing and int<->float conversion all happen
+// while a single scanline is in cache instead of as separate passes over
+// the whole element.
+//
+// Both return FALSE (without touching the stream) if the element is not
+// in one of those layouts, or if the dpx::packing_mode is 'generic'. In
+// that case the caller is expected to fall back on the generic code.
+// read_packed throws dpx::invalid if the stream ends inside the element.
+bool read_packed(std::istream *i, dpx::fb<float32_t> *out, const rwinfo &ri);
+bool write_packed(std::ostream *o, const dpx::fb<float32_t> &buf,
+                  const rwinfo &wi);
+
+// Decodes whole scanlines of an element straight out of memory into a
+// float buffer. Besides the integer layouts above this also handles 32 bit
+// float elements. Once constructed it is only read from, so a single
+// unpacker can be shared by threads decoding different scanlines.
+class unpacker {
+	public:
+		unpacker(const rwinfo &ri);
+
+		// FALSE if the element is in a layout not handled here.
+		bool valid(void) const;
+
+		// The number of bytes a scanline takes up on disk.
+		uint64_t line_bytes(void) const;
+
+		// Decodes 'lines' scanlines starting at 'in' into 'out'.
+		void unpack(float32_t *out, const uint8_t *in, uint32_t lines) const;
+
+	private:
+		layout_e _layout;
+		uint8_t _shift;
+		bool _swap;
+		float64_t _scale;
+		uint64_t _samples;
+		uint64_t _line_bytes;
+		std::vector<float32_t> _lut;
+};
+
+// Other buffer types always go through the generic code.
+template <class T>
+bool read_packed(std::istream *i, dpx::fb<T> *out, const rwinfo &ri) {
+	return FALSE;
+}
+
+template <class T>
+bool write_packed(std::ostream *o, const dpx::fb<T> &buf, const rwinfo &wi) {
+	return FALSE;
+}
+
+};
+
+};
+
+#endif
@@ -58,6 +58,7 @@
 #include <math.h>
 #include "dpx_bits.hh"
 #include "dpx_rw.hh"
+#include "dpx_pack.hh"
 
 namespace ctl {
 namespace dpxi {
@@ -220,6 +221,12 @@ void read(std::istream *i, dpx::fb<T> *out, const rwinfo &ri) {
 	// ri.datatype==1 signed integer (unsupported)
 	// ri.datatype==2 floating point
 
+	// The common integer packings going into a float buffer are done in
+	// a single pass, a scanline at a time.
+	if(read_packed(i, out, ri)) {
+		return;
+	}
+
 	if(ri.version==0x30) {
 		// read size determined by packing...
 		if(ri.pack<8) {
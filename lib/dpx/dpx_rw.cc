@@ -83,6 +83,7 @@ void rwinfo::clear(void) {
 	scale=0;
 	need_byteswap=0;
 	mode=dpx::normal;
+	packing_mode=dpx::fused;
 }
 
 void rwinfo::set(const dpx *that, uint8_t e, float64_t _scale,
@@ -92,6 +93,7 @@ void rwinfo::set(const dpx *that, uint8_t e, float64_t _scale,
 	descriptor=that->elements[e].descriptor;
 	offset_to_data=that->elements[e].offset_to_data;
 	need_byteswap=that->_need_byteswap;
+	packing_mode=that->packing_mode;
 	width=that->pixels_per_line;
 	height=that->lines_per_element;
 	scale=_scale;
@@ -99,6 +99,7 @@ struct rwinfo {
 	float64_t scale;
 	bool need_byteswap;
 	dpx::intmode_e mode;
+	dpx::packing_mode_e packing_mode;
 
 	// If writing into type 'T', given the bps, width, and height
 	// how many words of type 'T' will be needed to actually store
@@ -60,6 +60,7 @@
 #include <math.h>
 #include "dpx_bits.hh"
 #include "dpx_rw.hh"
+#include "dpx_pack.hh"
 
 namespace ctl {
 namespace dpxi {
@@ -203,6 +204,12 @@ void write(std::ostream *o, const dpx::fb<T> &buf, const rwinfo &wi) {
 	dpx::fb<float32_t>   fbf32;
 	dpx::fb<float64_t>   fbf64;
 
+	// The mirror of read_packed, float buffers going into the common
+	// integer packings are converted and packed a scanline at a time.
+	if(write_packed(o, buf, wi)) {
+		return;
+	}
+
 	if(wi.datatype==0) {
 		if(wi.bps<=8) {
 			fbu8.init(buf.width(), buf.height(), buf.depth());
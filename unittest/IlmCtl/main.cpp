@@ -61,6 +61,9 @@
 #include <testVaryingReturn.h>
 #include <testVaryingLookup.h>
 #include <testExamples.h>
+#include <testCodeC99.h>
+#include <testCodeCpp.h>
+#include <testNative.h>
 
 #include <iostream>
 #include <string.h>
@@ -80,6 +83,9 @@ main (int argc, char *argv[])
     TEST (testVaryingReturn);
     TEST (testVaryingLookup);
     TEST (testHugeInit);
+    TEST (testCodeC99);
+    TEST (testCodeCpp);
+    TEST (testNative);
 
     return 0;
 }
@@ -0,0 +1,393 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <CtlSimdInterpreter.h>
+#include <CtlCodeInterpreter.h>
+#include <CtlFunctionCall.h>
+#include <CtlType.h>
+#include <testCodeC99.h>
+#include <testTempDir.h>
+#include <half.h>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <assert.h>
+#include <stdlib.h>
+#include <string>
+#include <math.h>
+
+using namespace Ctl;
+using namespace std;
+
+namespace {
+
+//
+// Runs one of the self checking test modules through the interpreter
+// and through the C99 code generator, compiled and executed with the
+// module initializers doing the checks. Returns false if the code
+// generator can't handle the module yet.
+//
+
+bool
+runModule (const string &compiler, const TempDir &dir, const string &moduleName)
+{
+    SimdInterpreter interp;
+    interp.loadModule (moduleName);
+
+    string source = dir.path() + "/" + moduleName + "_c99.c";
+    string program = dir.path() + "/" + moduleName + "_c99";
+
+    try
+    {
+	CodeInterpreter code;
+	code.setLanguage (CodeInterpreter::C99);
+	code.initStdLibrary();
+	code.setCalledOnly (true);
+	code.loadModule (moduleName);
+
+	ofstream out (source.c_str());
+	code.emitCode (out);
+	code.emitTestHarness (out);
+    }
+    catch (const std::exception &e)
+    {
+	//
+	// The code generator reports what it can't handle either
+	// with a logic_error or as an error loading the module.
+	//
+
+	cout << "    " << moduleName << ": not supported by the "
+		"code generator (" << e.what() << ")" << endl;
+	return false;
+    }
+
+    string build = compiler + " -std=c99 -o " + program + " " + source + " -lm";
+    if (system (build.c_str()) != 0)
+    {
+	cerr << "ERROR -- generated C99 code for " << moduleName <<
+		" does not compile: " << source << endl;
+	assert (false);
+    }
+
+    if (system (program.c_str()) != 0)
+    {
+	cerr << "ERROR -- generated C99 code for " << moduleName <<
+		" fails its checks" << endl;
+	assert (false);
+    }
+
+    cout << "    " << moduleName << ": ok" << endl;
+    return true;
+}
+
+
+bool
+isHalf (const FunctionArgPtr &arg)
+{
+    return arg->type().cast<HalfType>();
+}
+
+
+void
+setSample (const FunctionArgPtr &arg, size_t i, float value)
+{
+    if (isHalf (arg))
+	((half *) arg->data())[i] = value;
+    else
+	((float *) arg->data())[i] = value;
+}
+
+
+float
+getSample (const FunctionArgPtr &arg, size_t i)
+{
+    if (isHalf (arg))
+	return ((half *) arg->data())[i];
+    else
+	return ((float *) arg->data())[i];
+}
+
+
+//
+// Calls the batch entry point for the main routine of a module that
+// runModule() has built, through the test harness, and compares the
+// results with the interpreter's for the same random inputs.
+//
+
+void
+checkBatch (const TempDir &dir, const string &moduleName)
+{
+    SimdInterpreter interp;
+    interp.loadModule (moduleName);
+
+    FunctionCallPtr call = interp.newFunctionCall ("main");
+    size_t numSamples = min (size_t (1000), interp.maxSamples());
+
+    string program = dir.path() + "/" + moduleName + "_c99";
+    string inName = dir.path() + "/" + moduleName + ".in";
+    string outName = dir.path() + "/" + moduleName + ".out";
+
+    //
+    // The input file holds the sample count followed by the input
+    // arguments in declaration order; the values are written after
+    // they have been stored in the interpreter's arguments, so that
+    // both sides see the same, possibly rounded, inputs.
+    //
+
+    float tolerance = 1e-5f;
+
+    {
+	ofstream in (inName.c_str());
+	in.precision (9);
+	in << numSamples << "\n";
+
+	srand (1);
+
+	for (size_t i = 0; i < call->numInputArgs(); ++i)
+	{
+	    const FunctionArgPtr &arg = call->inputArg (i);
+
+	    if (!arg->isVarying())
+	    {
+		arg->setDefaultValue();
+
+		if (arg->type().cast<BoolType>())
+		    in << int (*(bool *) arg->data()) << "\n";
+		else
+		    in << *(float *) arg->data() << "\n";
+
+		continue;
+	    }
+
+	    //
+	    // The interpreter may do arithmetic on half
+	    // inputs at half precision.
+	    //
+
+	    if (isHalf (arg))
+		tolerance = 1e-3f;
+
+	    for (size_t j = 0; j < numSamples; ++j)
+	    {
+		setSample (arg, j, float (rand()) / RAND_MAX * 1.2f - 0.1f);
+		in << getSample (arg, j) << "\n";
+	    }
+	}
+    }
+
+    call->callFunction (numSamples);
+
+    string run = program + " " + moduleName + " " + inName + " " + outName;
+    if (system (run.c_str()) != 0)
+    {
+	cerr << "ERROR -- batch entry point for " << moduleName <<
+		" failed" << endl;
+	assert (false);
+    }
+
+    ifstream out (outName.c_str());
+
+    for (size_t i = 0; i < call->numOutputArgs(); ++i)
+    {
+	const FunctionArgPtr &arg = call->outputArg (i);
+
+	for (size_t j = 0; j < numSamples; ++j)
+	{
+	    float value;
+	    out >> value;
+	    assert (out);
+
+	    float expected = getSample (arg, j);
+
+	    if (fabs (value - expected) > tolerance * max (1.0f, fabsf (expected)))
+	    {
+		cerr << "ERROR -- batch entry point for " << moduleName <<
+			": output " << i << ", sample " << j << " is " <<
+			value << ", expected " << expected << endl;
+		assert (false);
+	    }
+	}
+    }
+
+    cout << "    " << moduleName << " batch entry point: ok" << endl;
+}
+
+} // namespace
+
+
+void
+testCodeC99 ()
+{
+    try
+    {
+	cout << "Testing C99 code generation" << endl;
+
+	const char *cc = getenv ("CTL_TEST_CC");
+	string compiler = cc ? cc : "cc";
+
+	if (system ((compiler + " --version > /dev/null 2>&1").c_str()) != 0)
+	{
+	    cout << "no C compiler found, skipped\n" << endl;
+	    return;
+	}
+
+	//
+	// Every module in this directory.  The code generator has to
+	// handle the ones marked PASS; UNSUPPORTED ones have to be
+	// rejected by it, so that the list is updated when support is
+	// added.  testDos, testMac and testUnix are written by
+	// testEndOfLine and differ from test only in their line endings.
+	//
+
+	enum Expect { PASS, UNSUPPORTED, SKIP };
+
+	struct Case
+	{
+	    const char *name;
+	    Expect expect;
+	    const char *why;
+	};
+
+	static const Case modules[] =
+	{
+	    {"common",			PASS,		0},
+	    {"example",			PASS,		0},
+	    {"test",			PASS,		0},
+	    {"testArray",		UNSUPPORTED,	"array subscripts"},
+	    {"testBatch",		PASS,		0},
+	    {"testBatchHalf",		PASS,		0},
+	    {"testCast",		PASS,		0},
+	    {"testComments",		PASS,		0},
+	    {"testCppCall",		UNSUPPORTED,	"varying return values"},
+	    {"testCtlVersion",		PASS,		0},
+	    {"testDefaults",		UNSUPPORTED,	"functions not implemented"},
+	    {"testEmpty",		PASS,		0},
+	    {"testExamples",		UNSUPPORTED,	"functions not implemented"},
+	    {"testExamplesNamespace",	PASS,		0},
+	    {"testExpr",		PASS,		0},
+	    {"testFunc",		PASS,		0},
+	    {"testHugeInit",		SKIP,		"imports the three million "
+						"element module that "
+						"testHugeInit writes"},
+	    {"testInterpolator",	UNSUPPORTED,	"array subscripts"},
+	    {"testLiterals",		PASS,		0},
+	    {"testLookupTables",	UNSUPPORTED,	"array subscripts"},
+	    {"testLoops",		PASS,		0},
+	    {"testName",		PASS,		0},
+	    {"testName2",		PASS,		0},
+	    {"testNameSpace",		PASS,		0},
+	    {"testNameSpace2",		PASS,		0},
+	    {"testNoName",		PASS,		0},
+	    {"testParse",		PASS,		0},
+	    {"testScope",		UNSUPPORTED,	"code with errors in it"},
+	    {"testScope2",		PASS,		0},
+	    {"testStdLibrary",		PASS,		0},
+	    {"testStruct",		PASS,		0},
+	    {"testTypes",		PASS,		0},
+	    {"testVSArrays",		UNSUPPORTED,	"variable size arrays"},
+	    {"testVarying",		PASS,		0},
+	    {"testVaryingLookup",	PASS,		0},
+	    {"testVaryingReturn",	PASS,		0},
+	};
+
+	TempDir dir;
+
+	int nRun = 0;
+	int nModules = sizeof (modules) / sizeof (modules[0]);
+	for (int i = 0; i < nModules; ++i)
+	{
+	    const Case &m = modules[i];
+
+	    if (m.expect == SKIP)
+	    {
+		cout << "    " << m.name << ": skipped, " << m.why << endl;
+		continue;
+	    }
+
+	    bool supported = runModule (compiler, dir, m.name);
+
+	    if (supported && m.expect == UNSUPPORTED)
+	    {
+		cerr << "ERROR -- " << m.name << " is expected to be "
+			"unsupported (" << m.why << "), but passes; "
+			"update the module list" << endl;
+		assert (false);
+	    }
+
+	    if (!supported && m.expect == PASS)
+	    {
+		cerr << "ERROR -- the code generator does not "
+			"handle " << m.name << endl;
+		assert (false);
+	    }
+
+	    if (supported)
+		++nRun;
+	}
+
+	checkBatch (dir, "testBatch");
+	checkBatch (dir, "testBatchHalf");
+
+	cout << nRun << " of " << nModules << " modules compiled and "
+		"checked\nok\n" << endl;
+    }
+    catch (const std::exception &e)
+    {
+	cerr << "ERROR -- caught exception: " << endl << e.what() << endl;
+	assert (false);
+    }
+}
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+#include <CtlCodeInterpreter.h>
+#include <testCodeCpp.h>
+#include <testTempDir.h>
+#include <iostream>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <assert.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace Ctl;
+using namespace std;
+
+namespace {
+
+//
+// Emits C++ code and the test harness for a module with main routines,
+// builds it, and runs it.  The harness calls the batch entry points and
+// the SIMD interpreter with the same random inputs and fails if the
+// results differ by more than the given tolerance.
+//
+
+void
+runModule (const string &compiler,
+	   const TempDir &dir,
+	   const string &moduleName,
+	   const string &tolerance)
+{
+    string source = dir.path() + "/" + moduleName + "_cpp.cpp";
+    string program = dir.path() + "/" + moduleName + "_cpp";
+
+    {
+	CodeInterpreter code;
+	code.setLanguage (CodeInterpreter::CPP11);
+	code.initStdLibrary();
+	code.setCalledOnly (true);
+	code.loadModule (moduleName);
+
+	ofstream out (source.c_str());
+	code.emitCode (out);
+	code.emitTestHarness (out);
+    }
+
+    string build = compiler + " -std=c++11 " CTL_TEST_CXXFLAGS " -o " +
+		   program + " " + source + " " CTL_TEST_CXXLIBS;
+
+    if (system (build.c_str()) != 0)
+    {
+	cerr << "ERROR -- generated C++ code for " << moduleName <<
+		" does not compile" << endl;
+	assert (false);
+    }
+
+    //
+    // The harness finds the module through CTL_MODULE_PATH,
+    // or in the current directory.
+    //
+
+    string run = program + " 10000 " + tolerance + " > /dev/null";
+
+    if (system (run.c_str()) != 0)
+    {
+	cerr << "ERROR -- generated C++ code for " << moduleName <<
+		" does not match the interpreter" << endl;
+	assert (false);
+    }
+
+    cout << "    " << moduleName << ": ok" << endl;
+}
+
+} // namespace
+
+
+void
+testCodeCpp ()
+{
+    try
+    {
+	cout << "Testing C++ code generation" << endl;
+
+	const char *cxx = getenv ("CTL_TEST_CXX");
+	string compiler = cxx ? cxx : "c++";
+
+	if (system ((compiler + " --version > /dev/null 2>&1").c_str()) != 0)
+	{
+	    cout << "no C++ compiler found, skipped\n" << endl;
+	    return;
+	}
+
+	TempDir dir;
+
+	runModule (compiler, dir, "testBatch", "1e-5");
+
+	//
+	// The harness hands the batch entry points full float
+	// values and the interpreter the same values rounded to half.
+	//
+
+	runModule (compiler, dir, "testBatchHalf", "2e-3");
+
+	cout << "ok\n" << endl;
+    }
+    catch (const std::exception &e)
+    {
+	cerr << "ERROR -- caught exception: " << endl << e.what() << endl;
+	assert (false);
+    }
+}
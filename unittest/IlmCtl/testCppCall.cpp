@@ -257,6 +257,61 @@ testVariable(SimdInterpreter &interp)
 
 }
 
+void
+testClone(SimdInterpreter &interp)
+{
+    interp.loadModule ("testCppCall");
+
+    // a clone has its own arguments and keeps the default values
+    {
+	FunctionCallPtr func = interp.newFunctionCall("cppCall::funcINifbRETfD");
+	FunctionCallPtr copy = func->clone();
+
+	assert(copy->name() == func->name());
+	assert(copy->numInputArgs() == func->numInputArgs());
+	assert(copy->numOutputArgs() == func->numOutputArgs());
+
+	FunctionArgPtr arg2 = func->inputArg(2);
+	FunctionArgPtr copyArg2 = copy->inputArg(2);
+	assert(copyArg2->data() != arg2->data());
+	assert(copyArg2->hasDefaultValue());
+
+	((float*)(arg2->data()))[0] = 1.2345;
+	copyArg2->setDefaultValue();
+
+	func->callFunction(1);
+	copy->callFunction(1);
+
+	assert(*(float*)(func->returnValue()->data()) == 1.2345f);
+	assert(*(float*)(copy->returnValue()->data()) == 2.0);
+    }
+
+    // varying arguments of a clone
+    {
+	FunctionCallPtr func = interp.newFunctionCall("cppCall::funcINifbRETfD2");
+	FunctionCallPtr copy = func->clone();
+
+	FunctionArgPtr arg2 = copy->inputArg(2);
+	assert(arg2->isVarying());
+	float * data = (float*)(arg2->data());
+
+	int dataSize = 30;
+
+	for(int i = 0; i < dataSize; i++)
+	{
+	    data[i] = i + .1;
+	}
+
+	copy->callFunction(dataSize);
+
+	data = (float*)(copy->returnValue()->data());
+	for(int i = 0; i < dataSize; i++)
+	{
+	    assert (equalWithRelError (data[i], i + .2f, 0.00001f));
+	}
+    }
+}
+
 void
 testCppCall()
 {
@@ -266,6 +321,7 @@ testCppCall()
 	SimdInterpreter interp;
 	testSimple(interp);
         testVariable(interp);
+	testClone(interp);
 	cout << "ok\n" << endl;
     }
     catch (const std::exception &e)
@@ -54,6 +54,7 @@
 
 
 #include <CtlSimdInterpreter.h>
+#include <testTempDir.h>
 #include <Iex.h>
 #include <iostream>
 #include <fstream>
@@ -99,10 +100,11 @@ const char testMac[] =
     "const int testMacDummy = testMac();\r";
 
 
-void
-writeSourceFile (const char fileName[], const char text[])
+string
+writeSourceFile (const TempDir &dir, const char moduleName[], const char text[])
 {
-    ofstream file (fileName, ios_base::binary);
+    string fileName = dir.path() + "/" + moduleName + ".ctl";
+    ofstream file (fileName.c_str(), ios_base::binary);
 
     if (!file)
 	THROW_ERRNO ("Cannot open file " << fileName << " (%T).");
@@ -111,6 +113,8 @@ writeSourceFile (const char fileName[], const char text[])
 
     if (!file)
 	THROW_ERRNO ("Write to file " << fileName << " failed (%T).");
+
+    return fileName;
 }
 
 } //namespace
@@ -123,14 +127,15 @@ testEndOfLine ()
     {
 	cout << "Testing end-of-line conventions" << endl;
 
-	writeSourceFile ("testDos.ctl", testDos);
-	writeSourceFile ("testUnix.ctl", testUnix);
-	writeSourceFile ("testMac.ctl", testMac);
+	TempDir dir;
+	string dosFile = writeSourceFile (dir, "testDos", testDos);
+	string unixFile = writeSourceFile (dir, "testUnix", testUnix);
+	string macFile = writeSourceFile (dir, "testMac", testMac);
 
 	SimdInterpreter interp;
-        interp.loadModule ("testDos");
-        interp.loadModule ("testUnix");
-        interp.loadModule ("testMac");
+        interp.loadModule ("testDos", dosFile);
+        interp.loadModule ("testUnix", unixFile);
+        interp.loadModule ("testMac", macFile);
 
 	cout << "ok\n" << endl;
     }
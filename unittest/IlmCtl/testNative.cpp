@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//
+//	Run main routines through the NativeInterpreter, which compiles
+//	them to native code, and through the SimdInterpreter with the
+//	same random inputs, and compare the results.
+//
+//-----------------------------------------------------------------------------
+
+#include <CtlSimdInterpreter.h>
+#include <CtlCodeNativeInterpreter.h>
+#include <CtlFunctionCall.h>
+#include <CtlType.h>
+#include <testNative.h>
+#include <testTempDir.h>
+#include <half.h>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+
+using namespace Ctl;
+using namespace std;
+
+namespace {
+
+const char *
+jitCompiler ()
+{
+    if (const char *cxx = getenv ("CTL_JIT_CXX"))
+	return cxx;
+
+    if (const char *cxx = getenv ("CXX"))
+	return cxx;
+
+    return "c++";
+}
+
+
+bool
+isHalf (const FunctionArgPtr &arg)
+{
+    return arg->type().cast<HalfType>();
+}
+
+
+void
+setSample (const FunctionArgPtr &arg, size_t i, float value)
+{
+    if (isHalf (arg))
+	((half *) arg->data())[i] = value;
+    else
+	((float *) arg->data())[i] = value;
+}
+
+
+float
+getSample (const FunctionArgPtr &arg, size_t i)
+{
+    if (isHalf (arg))
+	return ((half *) arg->data())[i];
+    else
+	return ((float *) arg->data())[i];
+}
+
+
+void
+compareModule (const string &moduleName)
+{
+    SimdInterpreter simd;
+    NativeInterpreter native;
+
+    simd.loadModule (moduleName);
+    native.loadModule (moduleName);
+
+    FunctionCallPtr simdCall = simd.newFunctionCall ("main");
+    FunctionCallPtr nativeCall = native.newFunctionCall ("main");
+
+    if (!native.isNative ("main"))
+    {
+	cout << "native code for " << moduleName << " was not built:\n" <<
+		native.buildErrors() << endl;
+
+	assert (false);
+    }
+
+    assert (simdCall->numInputArgs() == nativeCall->numInputArgs());
+    assert (simdCall->numOutputArgs() == nativeCall->numOutputArgs());
+
+    size_t numSamples = min (simd.maxSamples(), native.maxSamples());
+
+    //
+    // Inputs cover [-0.1, 1.1] so that both sides of the
+    // branches in the modules are taken.
+    //
+
+    srand (1);
+
+    for (size_t i = 0; i < simdCall->numInputArgs(); ++i)
+    {
+	const FunctionArgPtr &simdArg = simdCall->inputArg (i);
+	const FunctionArgPtr &nativeArg = nativeCall->inputArg (i);
+
+	if (!simdArg->isVarying())
+	{
+	    simdArg->setDefaultValue();
+	    nativeArg->setDefaultValue();
+	    continue;
+	}
+
+	for (size_t j = 0; j < numSamples; ++j)
+	{
+	    float value = float (rand()) / RAND_MAX * 1.2f - 0.1f;
+	    setSample (simdArg, j, value);
+	    setSample (nativeArg, j, value);
+	}
+    }
+
+    //
+    // Arithmetic on half inputs may be done at half precision
+    // by one interpreter and at float precision by the other.
+    //
+
+    float tolerance = 1e-5f;
+
+    for (size_t i = 0; i < simdCall->numInputArgs(); ++i)
+    {
+	if (isHalf (simdCall->inputArg (i)))
+	    tolerance = 1e-3f;
+    }
+
+    simdCall->callFunction (numSamples);
+    nativeCall->callFunction (numSamples);
+
+    for (size_t i = 0; i < simdCall->numOutputArgs(); ++i)
+    {
+	const FunctionArgPtr &simdArg = simdCall->outputArg (i);
+	const FunctionArgPtr &nativeArg = nativeCall->outputArg (i);
+
+	for (size_t j = 0; j < numSamples; ++j)
+	{
+	    float s = getSample (simdArg, j);
+	    float n = getSample (nativeArg, j);
+
+	    if (fabs (s - n) > tolerance * max (1.0f, fabsf (s)))
+	    {
+		cout << moduleName << ": output " << i << ", sample " <<
+			j << " is " << n << ", expected " << s << endl;
+
+		assert (false);
+	    }
+	}
+    }
+
+    cout << "    " << moduleName << ": ok" << endl;
+}
+
+} // namespace
+
+
+void
+testNative ()
+{
+    cout << "Testing native code against the SIMD interpreter" << endl;
+
+    string check = string (jitCompiler()) + " --version > /dev/null 2>&1";
+
+    if (system (check.c_str()) != 0)
+    {
+	cout << "    no C++ compiler, skipped" << endl;
+	return;
+    }
+
+    //
+    // Keep the libraries that the NativeInterpreter builds
+    // out of the user's cache.
+    //
+
+    TempDir cache;
+    setenv ("CTL_JIT_CACHE", cache.path().c_str(), 1);
+
+    compareModule ("testBatch");
+    compareModule ("testBatchHalf");
+
+    unsetenv ("CTL_JIT_CACHE");
+
+    cout << "ok\n" << endl;
+}
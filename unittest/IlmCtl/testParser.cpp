@@ -62,6 +62,68 @@
 using namespace Ctl;
 using namespace std;
 
+namespace {
+
+int
+findStatistics
+    (const Interpreter::ModuleLoadStatisticsList &stats,
+     const string &moduleName)
+{
+    int index = -1;
+
+    for (int i = 0; i < (int) stats.size(); ++i)
+    {
+	if (stats[i].moduleName == moduleName)
+	{
+	    assert (index < 0);		// each module is loaded only once
+	    index = i;
+	}
+    }
+
+    assert (index >= 0);
+    return index;
+}
+
+
+void
+testLoadStatistics (const Interpreter &interp)
+{
+    cout << "Testing module load statistics" << endl;
+
+    Interpreter::ModuleLoadStatisticsList stats =
+	interp.moduleLoadStatistics();
+
+    for (int i = 0; i < (int) stats.size(); ++i)
+    {
+	assert (stats[i].parseSeconds >= 0);
+	assert (stats[i].generateSeconds >= 0);
+	assert (stats[i].initSeconds >= 0);
+	assert (stats[i].loadSeconds >= stats[i].parseSeconds);
+    }
+
+    //
+    // Imported modules finish loading before the modules that
+    // import them, and their load times are included in the load
+    // times of the importing modules.
+    //
+
+    int testName = findStatistics (stats, "testName");
+    int testName2 = findStatistics (stats, "testName2");
+    int testNoName = findStatistics (stats, "testNoName");
+    int testNameSpace = findStatistics (stats, "testNameSpace");
+
+    assert (testName < testName2);
+    assert (testNoName < testNameSpace);
+
+    assert (stats[testName2].loadSeconds >= stats[testName].loadSeconds);
+    assert (stats[testNameSpace].loadSeconds >= stats[testNoName].loadSeconds);
+
+    cout << "ok\n" << endl;
+}
+
+} // namespace
+
+
 void
 testParser ()
 {
@@ -98,6 +160,8 @@ testParser ()
         interp.loadModule ("testExamples");
 
 	cout << "ok\n" << endl;
+
+	testLoadStatistics (interp);
     }
     catch (const std::exception &e)
     {
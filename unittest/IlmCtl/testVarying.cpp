@@ -62,6 +62,7 @@
 #include <assert.h>
 #include <sstream>
 #include <limits>
+#include <vector>
 #include <half.h>
 #include <testVarying.h>
 
@@ -752,6 +753,65 @@ testFunctionCalls (Interpreter &interp, size_t nSamples)
 }
 
 
+void
+testBoundFunctionCalls (Interpreter &interp, size_t nSamples)
+{
+    FunctionCallPtr func =
+	interp.newFunctionCall ("testVarying::functionCalls");
+
+    //
+    // Inputs and outputs interleaved in one buffer, one pixel
+    // (x, y, z, w, a, b, c) per sample.
+    //
+
+    const size_t depth = 7;
+    vector<float> pixels (nSamples * depth, -1.0f);
+
+    for (size_t i = 0; i < nSamples; ++i)
+    {
+	pixels[i * depth + 0] = float (i);
+	pixels[i * depth + 1] = float (i + 1);
+	pixels[i * depth + 2] = float (i % 4 + 2);
+	pixels[i * depth + 3] = float (i % 5 + 2);
+    }
+
+    const char *names[] = {"x", "y", "z", "w", "a", "b", "c"};
+
+    for (size_t j = 0; j < depth; ++j)
+    {
+	FunctionArgPtr arg = j < 4 ? func->findInputArg (names[j])
+				   : func->findOutputArg (names[j]);
+
+	bool bound = arg->bind ((char *)&pixels[j], depth * sizeof (float));
+	assert (bound);
+    }
+
+    func->callFunction (nSamples);
+
+    for (size_t i = 0; i < nSamples; ++i)
+    {
+	const float *p = &pixels[i * depth];
+
+	assert (equalWithRelError (p[4], float (sqrt (p[0])), 0.0001f));
+	assert (equalWithRelError (p[5], p[1] * p[1], 0.0001f));
+	assert (equalWithRelError (p[6], float (pow (p[2], p[3])), 0.0001f));
+    }
+
+    //
+    // Once unbound, the arguments have their own storage again.
+    //
+
+    for (size_t j = 0; j < depth; ++j)
+    {
+	FunctionArgPtr arg = j < 4 ? func->findInputArg (names[j])
+				   : func->findOutputArg (names[j]);
+	arg->unbind();
+    }
+
+    testFunctionCalls (interp, nSamples);
+}
+
+
 void
 testVarying()
 {
@@ -770,6 +830,11 @@ testVarying()
 	if (interp.maxSamples() >= 2)
 	    testFunctionCalls(interp, interp.maxSamples() / 2);
 
+	testBoundFunctionCalls(interp, interp.maxSamples());
+
+	if (interp.maxSamples() >= 2)
+	    testBoundFunctionCalls(interp, interp.maxSamples() / 2 + 1);
+
 	cout << "ok\n" << endl;
     }
     catch (const std::exception &e)
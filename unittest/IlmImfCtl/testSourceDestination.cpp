@@ -125,13 +125,25 @@ runTest (Interpreter &interp, int numThreads)
     size_t yStride    = sizeof (half) * twWidth;
     size_t baseOffset = tw.min.y * yStride + tw.min.x * xStride;
 
+    //
+    // Slices p2 and p3 are FLOAT, while the corresponding CTL
+    // function arguments are half, to test conversion between
+    // half and float.
+    //
+
+    size_t fxStride    = sizeof (float);
+    size_t fyStride    = sizeof (float) * twWidth;
+    size_t fBaseOffset = tw.min.y * fyStride + tw.min.x * fxStride;
+
     Array <half> d1 (nPixels);
     Array <half> h2 (nPixels);
+    Array <float> p2 (nPixels);
 
     for (size_t i = 0; i < nPixels; ++i)
     {
 	d1[i] = rand.nextf();
 	h2[i] = rand.nextf();
+	p2[i] = rand.nextf();
     }
 
     FrameBuffer inFb;
@@ -142,12 +154,16 @@ runTest (Interpreter &interp, int numThreads)
     inFb.insert
 	("h2", Slice (HALF, (char *)&h2[0] - baseOffset, xStride, yStride));
 
+    inFb.insert
+	("p2", Slice (FLOAT, (char *)&p2[0] - fBaseOffset, fxStride, fyStride));
+
     Array <half> d2 (nPixels);
     Array <half> d3 (nPixels);
     Array <half> e3 (nPixels);
     Array <half> h3 (nPixels);
     Array <half> j3 (nPixels);
     Array <half> l2 (nPixels);
+    Array <float> p3 (nPixels);
 
     FrameBuffer outFb;
 
@@ -169,10 +185,15 @@ runTest (Interpreter &interp, int numThreads)
     outFb.insert
 	("l2", Slice (HALF, (char *)&l2[0] - baseOffset, xStride, yStride));
 
+    outFb.insert
+	("p3", Slice (FLOAT, (char *)&p3[0] - fBaseOffset, fxStride, fyStride));
+
     //
     // Call functions
     //
 
+    TaskStatisticsList statistics;
+
     applyTransforms (interp,
 		     transformNames,
 		     tw,
@@ -180,7 +201,22 @@ runTest (Interpreter &interp, int numThreads)
 		     inHeader,
 		     inFb,
 		     outHeader,
-		     outFb);
+		     outFb,
+		     globalThreadCount(),
+		     &statistics);
+
+    //
+    // Check that every pixel was processed exactly once
+    //
+
+    assert (statistics.size() == size_t (max (numThreads, 1)));
+
+    size_t numSamples = 0;
+
+    for (size_t i = 0; i < statistics.size(); ++i)
+	numSamples += statistics[i].numSamples;
+
+    assert (numSamples == nPixels);
 
     //
     // Check data in outHeader
@@ -219,6 +255,7 @@ runTest (Interpreter &interp, int numThreads)
 	assert (h3[i] == h2[i]);
 	assert (j3[i] == 2.0);
 	assert (l2[i] == 234.0);
+	assert (p3[i] == float (half (p2[i])));
     }
 }
 
@@ -54,6 +54,9 @@
 
 #include <ImfCtlApplyTransforms.h>
 #include <CtlSimdInterpreter.h>
+#include <CtlSimdType.h>
+#include <CtlStdType.h>
+#include <CtlExc.h>
 #include <ImfHeader.h>
 #include <ImfFrameBuffer.h>
 #include <ImfArray.h>
@@ -313,6 +316,241 @@ runTest (Interpreter &interp)
 }
 
 
+void
+runConversionTest ()
+{
+    //
+    // Copy samples between host arrays and a varying float[3] argument,
+    // converting between bool, int, unsigned int, half and float.  The
+    // host arrays are interleaved with a stride of two samples; the
+    // argument's samples are one float[3] apart.
+    //
+
+    const size_t n = 37;
+
+    DataTypePtr type = new StdArrayType (new StdFloatType(), 3);
+    TypeStoragePtr arg = new DataArg ("conv", type, n);
+    TypeStorage::Element e = arg->element ("%d", 1);
+
+    int ints[2 * n];
+    unsigned int uints[2 * n];
+    half halfs[2 * n];
+    float floats[2 * n];
+    bool bools[2 * n];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	ints[2 * i] = int (i) - 18;
+	uints[2 * i] = i * 3;
+	halfs[2 * i] = float (i) + 0.5f;
+	floats[2 * i] = float (i) - 0.25f;
+	bools[2 * i] = (i % 3 == 0);
+    }
+
+    arg->set (e, ints, 2 * sizeof (int), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	assert (((float *) arg->data())[3 * i + 1] == float (int (i) - 18));
+	assert (((float *) arg->data())[3 * i + 0] == 0);
+    }
+
+    arg->set (e, uints, 2 * sizeof (unsigned int), 0, n);
+    arg->get (e, floats + 1, 2 * sizeof (float), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+	assert (floats[2 * i + 1] == float (i * 3));
+
+    arg->set (e, halfs, 2 * sizeof (half), 0, n);
+    arg->get (e, ints + 1, 2 * sizeof (int), 0, n);
+    arg->get (e, bools + 1, 2 * sizeof (bool), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	assert (ints[2 * i + 1] == int (i));
+	assert (bools[2 * i + 1]);
+    }
+
+    arg->set (e, floats, 2 * sizeof (float), 0, n);
+    arg->get (e, halfs + 1, 2 * sizeof (half), 0, n);
+    arg->get (e, uints + 1, 2 * sizeof (unsigned int), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	assert (halfs[2 * i + 1] == half (float (i) - 0.25f));
+
+	if (i > 0)
+	    assert (uints[2 * i + 1] == i - 1);
+    }
+
+    arg->set (e, bools, 2 * sizeof (bool), 0, n);
+    arg->get (e, ints + 1, 2 * sizeof (int), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+	assert (ints[2 * i + 1] == (i % 3 == 0? 1: 0));
+
+    //
+    // Densely packed samples of a scalar argument
+    //
+
+    TypeStoragePtr scalar = new DataArg ("scalar", new StdHalfType(), n);
+
+    for (size_t i = 0; i < n; ++i)
+	floats[i] = float (i) * 0.5f;
+
+    scalar->set (floats, sizeof (float), 0, n);
+    scalar->get (ints, sizeof (int), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	assert (((half *) scalar->data())[i] == half (float (i) * 0.5f));
+	assert (ints[i] == int (float (i) * 0.5f));
+    }
+}
+
+void
+runElementTest ()
+{
+    //
+    // Resolve element paths of a varying struct argument once, and
+    // use them for set() and get().  The struct's members have
+    // different types, and none of them has the size of the struct.
+    //
+
+    const size_t n = 21;
+
+    MemberVector members;
+    members.push_back (Member ("i", new StdIntType()));
+    members.push_back (Member ("h", new StdHalfType()));
+    members.push_back (Member ("f", new StdArrayType (new StdFloatType(), 3)));
+
+    DataTypePtr type = new SimdStructType ("S", members);
+    TypeStoragePtr arg = new DataArg ("s", type, n);
+    size_t size = type->objectSize();
+
+    TypeStorage::Element ei = arg->element ("i");
+    TypeStorage::Element eh = arg->element ("%s", "h");
+    TypeStorage::Element ef0 = arg->element ("f/%d", 0);
+    TypeStorage::Element ef1 = arg->element ("f/%d", 1);
+    TypeStorage::Element ef2 = arg->element ("f/2");
+
+    assert (ei.type()->cDataType() == IntTypeEnum);
+    assert (eh.type()->cDataType() == HalfTypeEnum);
+    assert (ef1.type()->cDataType() == FloatTypeEnum);
+    assert (ef1.offset() == ef0.offset() + sizeof (float));
+    assert (ef2.offset() == ef0.offset() + 2 * sizeof (float));
+
+    //
+    // Paths that don't lead to a single value are rejected.
+    //
+
+    bool caught = false;
+
+    try
+    {
+	arg->element ("f");
+    }
+    catch (const DatatypeExc &)
+    {
+	caught = true;
+    }
+
+    assert (caught);
+
+    //
+    // Densely packed floats into the middle of f[3].  The samples in
+    // the argument are a whole struct apart, so the neighbouring
+    // elements must be left alone.
+    //
+
+    float floats[n];
+    float zeros[n];
+    int ints[n];
+    half halfs[n];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	floats[i] = float (i) + 0.5f;
+	zeros[i] = -1;
+    }
+
+    arg->set (ef0, zeros, sizeof (float), 0, n);
+    arg->set (ef2, zeros, sizeof (float), 0, n);
+    arg->set (ef1, floats, sizeof (float), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	const char *sample = arg->data() + i * size;
+
+	assert (*(const float *) (sample + ef0.offset()) == -1);
+	assert (*(const float *) (sample + ef1.offset()) == float (i) + 0.5f);
+	assert (*(const float *) (sample + ef2.offset()) == -1);
+    }
+
+    //
+    // Conversions go to and from the type of the element, not the
+    // type of the struct.
+    //
+
+    arg->set (ei, floats, sizeof (float), 0, n);
+    arg->set (eh, floats, sizeof (float), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	const char *sample = arg->data() + i * size;
+
+	assert (*(const int *) (sample + ei.offset()) == int (i));
+	assert (*(const half *) (sample + eh.offset()) == half (float (i) + 0.5f));
+    }
+
+    arg->get (eh, ints, sizeof (int), 0, n);
+    arg->get (ef1, halfs, sizeof (half), 0, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	assert (ints[i] == int (i));
+	assert (halfs[i] == half (float (i) + 0.5f));
+    }
+
+    //
+    // The path-based set() and get() reach the same elements.
+    //
+
+    for (size_t i = 0; i < n; ++i)
+	ints[i] = int (i) * 7;
+
+    arg->set (ints, sizeof (int), 0, n, "i");
+    arg->get (ef2, zeros, sizeof (float), 0, n);
+    arg->set (zeros, sizeof (float), 0, n, "f/%d", 1);
+
+    for (size_t i = 0; i < n; ++i)
+	ints[i] = 0;
+
+    arg->get (ei, ints, sizeof (int), 0, n);
+    arg->get (floats, sizeof (float), 0, n, "f/1");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+	assert (ints[i] == int (i) * 7);
+	assert (floats[i] == -1);
+    }
+
+    //
+    // A single uniform sample in the middle of the argument.
+    //
+
+    int seven = 7;
+    int got = 0;
+
+    arg->set (ei, &seven, 0, 5);
+    arg->get (ei, &got, 0, 5);
+
+    assert (got == 7);
+    assert (*(const int *) (arg->data() + 4 * size + ei.offset()) == 4 * 7);
+    assert (*(const int *) (arg->data() + 6 * size + ei.offset()) == 6 * 7);
+}
+
+
 } // namespace
 
 
@@ -325,6 +563,8 @@ testTypes ()
 
 	SimdInterpreter interp;
 	runTest (interp);
+	runConversionTest ();
+	runElementTest ();
 
 	cout << "ok\n" << endl;
     }
@@ -0,0 +1,499 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+// Runs ctlrender on EXR files written here and checks the pixels that come
+// back. Half input is either widened by the reader with the input scale
+// applied (scripts that take floats) or handed to the script as halfs, with
+// the scale applied when they are bound; output is written as half or
+// float with the output scale. Bands don't divide the image evenly.
+//
+// A file with layers, channels that aren't R, G, B or A, no alpha and a
+// subsampled channel checks that scripts can read any channel by its CTL
+// name (diffuse.R as diffuse_RIn) or by its position (c06In), and that
+// channels the file lacks are filled in.
+//
+// If ctlrender was built with the AcesContainer library, ACES output,
+// which is converted to half a scanline at a time with the reciprocal of
+// the output scale, is read back the same way.
+//
+// usage: exr_test <ctlrender> <directory with the ctl scripts>
+
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfHeader.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <half.h>
+#include <Iex.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+namespace
+{
+
+const int width = 14;
+const int height = 10;
+
+std::string ctlrender;
+std::string scripts;
+
+struct channel_t
+{
+	std::string name;
+	Imf::PixelType type;
+	int sampling;
+	std::vector<float> values;
+};
+
+typedef std::vector<channel_t> channels_t;
+
+channel_t make_channel(const char *name, Imf::PixelType type, float offset)
+{
+	channel_t channel;
+
+	channel.name = name;
+	channel.type = type;
+	channel.sampling = 1;
+	for (int i = 0; i < width * height; i++)
+	{
+		// halfs get values they hold exactly, negative and above
+		// one among them; floats get values no half can hold
+		if (type == Imf::HALF)
+		{
+			channel.values.push_back((i % 37 - 9) * 0.0625f + offset);
+		}
+		else
+		{
+			channel.values.push_back((i - 40) / 7.0f + offset);
+		}
+	}
+	return channel;
+}
+
+void write_exr(const std::string &name, const channels_t &channels)
+{
+	Imf::Header header(width, height);
+	Imf::FrameBuffer frameBuffer;
+	std::vector<std::vector<half> > halfs(channels.size());
+
+	for (size_t c = 0; c < channels.size(); c++)
+	{
+		const channel_t &channel = channels[c];
+		char *base = (char *) &channel.values[0];
+		size_t sample = sizeof(float);
+		int sampling = channel.sampling;
+
+		if (channel.type == Imf::HALF)
+		{
+			halfs[c].assign(channel.values.begin(), channel.values.end());
+			base = (char *) &halfs[c][0];
+			sample = sizeof(half);
+		}
+
+		header.channels().insert(channel.name.c_str(),
+		                         Imf::Channel(channel.type, sampling, sampling));
+		frameBuffer.insert(channel.name.c_str(),
+		                   Imf::Slice(channel.type, base, sample,
+		                              sample * (width / sampling),
+		                              sampling, sampling));
+	}
+
+	Imf::OutputFile file(name.c_str(), header);
+	file.setFrameBuffer(frameBuffer);
+	file.writePixels(height);
+}
+
+// Reads every channel of an image as float, which holds any half exactly.
+channels_t read_exr(const std::string &name)
+{
+	Imf::InputFile file(name.c_str());
+	const Imf::ChannelList &list = file.header().channels();
+	channels_t channels;
+
+	for (Imf::ChannelList::ConstIterator i = list.begin(); i != list.end(); ++i)
+	{
+		channel_t channel;
+
+		channel.name = i.name();
+		channel.type = i.channel().type;
+		channel.sampling = 1;
+		channel.values.resize(width * height);
+		channels.push_back(channel);
+	}
+
+	Imf::FrameBuffer frameBuffer;
+	for (size_t c = 0; c < channels.size(); c++)
+	{
+		frameBuffer.insert(channels[c].name.c_str(),
+		                   Imf::Slice(Imf::FLOAT, (char *) &channels[c].values[0],
+		                              sizeof(float), sizeof(float) * width));
+	}
+
+	file.setFrameBuffer(frameBuffer);
+	file.readPixels(0, height - 1);
+	return channels;
+}
+
+bool run(const std::string &arguments)
+{
+	std::string command = "\"" + ctlrender + "\" -force " + arguments;
+
+	std::cout << command << std::endl;
+	return system(command.c_str()) == 0;
+}
+
+std::string script(const char *name)
+{
+	return "-ctl \"" + scripts + "/" + name + "\" ";
+}
+
+// Compares the channels of file with expected, names, types and values.
+size_t check(const std::string &file, const channels_t &expected)
+{
+	channels_t channels = read_exr(file);
+	size_t failures = 0;
+
+	if (channels.size() != expected.size())
+	{
+		std::cerr << file << ": " << channels.size() << " channels, expected "
+		          << expected.size() << std::endl;
+		return 1;
+	}
+
+	for (size_t c = 0; c < expected.size(); c++)
+	{
+		if (channels[c].name != expected[c].name ||
+		    channels[c].type != expected[c].type)
+		{
+			std::cerr << file << ": channel " << channels[c].name << " type "
+			          << channels[c].type << ", expected " << expected[c].name
+			          << " type " << expected[c].type << std::endl;
+			failures++;
+			continue;
+		}
+
+		for (int i = 0; i < width * height; i++)
+		{
+			if (channels[c].values[i] == expected[c].values[i])
+			{
+				continue;
+			}
+			if (failures++ < 10)
+			{
+				std::cerr << file << ": " << channels[c].name << "[" << i
+				          << "] = " << channels[c].values[i] << ", expected "
+				          << expected[c].values[i] << std::endl;
+			}
+		}
+	}
+	return failures;
+}
+
+// The R, G and B channels of input as an output file of the given type
+// has them, with each value v replaced by f(v).
+template <class F>
+channels_t expect_rgb(const channels_t &input, Imf::PixelType type, F f)
+{
+	static const char *names[] = { "B", "G", "R" };
+	channels_t channels;
+
+	for (int n = 0; n < 3; n++)
+	{
+		for (size_t c = 0; c < input.size(); c++)
+		{
+			if (input[c].name != names[n])
+			{
+				continue;
+			}
+
+			channel_t channel = input[c];
+			channel.type = type;
+			for (size_t i = 0; i < channel.values.size(); i++)
+			{
+				channel.values[i] = f(channel.values[i]);
+				if (type == Imf::HALF)
+				{
+					channel.values[i] = half(channel.values[i]);
+				}
+			}
+			channels.push_back(channel);
+		}
+	}
+	return channels;
+}
+
+const channel_t &find_channel(const channels_t &channels, const char *name)
+{
+	for (size_t c = 0; c < channels.size(); c++)
+	{
+		if (channels[c].name == name)
+		{
+			return channels[c];
+		}
+	}
+	THROW(Iex::ArgExc, "No channel " << name << ".");
+}
+
+// Channel name of the output with the values of input scaled and
+// converted to type.
+channel_t output_channel(const char *name, Imf::PixelType type,
+                         const channel_t &input, float scale)
+{
+	channel_t channel = input;
+
+	channel.name = name;
+	channel.type = type;
+	for (size_t i = 0; i < channel.values.size(); i++)
+	{
+		channel.values[i] = input.values[i] * scale;
+		if (type == Imf::HALF)
+		{
+			channel.values[i] = half(channel.values[i]);
+		}
+	}
+	return channel;
+}
+
+float times2_over_half(float v) { return (v * 2.0f) / 0.5f; }
+float times2_as_half_over4(float v) { return (float) half(v * 2.0f) / 4.0f; }
+float same(float v) { return v; }
+float times3(float v) { return v * 3.0f; }
+
+size_t test_scale()
+{
+	channels_t halfs;
+	halfs.push_back(make_channel("A", Imf::HALF, 0.75f));
+	halfs.push_back(make_channel("B", Imf::HALF, 0.5f));
+	halfs.push_back(make_channel("G", Imf::HALF, 0.25f));
+	halfs.push_back(make_channel("R", Imf::HALF, 0.0f));
+	write_exr("exr_test_half.exr", halfs);
+
+	channels_t floats;
+	floats.push_back(make_channel("B", Imf::FLOAT, 2.0f));
+	floats.push_back(make_channel("G", Imf::FLOAT, 1.0f));
+	floats.push_back(make_channel("R", Imf::FLOAT, 0.0f));
+	write_exr("exr_test_float.exr", floats);
+
+	size_t failures = 0;
+
+	// half channels widened by the reader, with the input scale
+	if (!run("-input_scale 2 -output_scale 0.5 -format exr32 -band 4 " +
+	         script("unity_float.ctl") + "exr_test_half.exr exr_test_out1.exr"))
+	{
+		return 1;
+	}
+	failures += check("exr_test_out1.exr", expect_rgb(halfs, Imf::FLOAT, times2_over_half));
+
+	// half channels bound to half arguments, scaled as they are bound
+	if (!run("-input_scale 2 -output_scale 4 -format exr16 -band 4 " +
+	         script("unity.ctl") + "exr_test_half.exr exr_test_out2.exr"))
+	{
+		return 1;
+	}
+	failures += check("exr_test_out2.exr", expect_rgb(halfs, Imf::HALF, times2_as_half_over4));
+
+	// half channels bound to half arguments as they are
+	if (!run("-format exr16 -band 4 " +
+	         script("unity.ctl") + "exr_test_half.exr exr_test_out3.exr"))
+	{
+		return 1;
+	}
+	failures += check("exr_test_out3.exr", expect_rgb(halfs, Imf::HALF, same));
+
+	// float channels, scaled after they are read
+	if (!run("-input_scale 3 -format exr32 -band 4 " +
+	         script("unity_float.ctl") + "exr_test_float.exr exr_test_out4.exr"))
+	{
+		return 1;
+	}
+	failures += check("exr_test_out4.exr", expect_rgb(floats, Imf::FLOAT, times3));
+
+	return failures;
+}
+
+size_t test_channels()
+{
+	channels_t layers;
+	layers.push_back(make_channel("1st", Imf::HALF, 1.0f));
+	layers.push_back(make_channel("B", Imf::HALF, 0.5f));
+	layers.push_back(make_channel("G", Imf::HALF, 0.25f));
+	layers.push_back(make_channel("R", Imf::HALF, 0.0f));
+	layers.push_back(make_channel("depth.Z", Imf::FLOAT, 10.0f));
+	layers.push_back(make_channel("diffuse.G", Imf::HALF, -0.5f));
+	layers.push_back(make_channel("diffuse.R", Imf::HALF, -0.25f));
+
+	// not offered to scripts, only full resolution channels are
+	channel_t subsampled = make_channel("C", Imf::HALF, 2.0f);
+	subsampled.sampling = 2;
+	subsampled.values.resize((width / 2) * (height / 2));
+	layers.push_back(subsampled);
+
+	write_exr("exr_test_layers.exr", layers);
+
+	channel_t alpha = make_channel("A", Imf::HALF, 0.0f);
+	alpha.values.assign(alpha.values.size(), 1.0f);
+
+	size_t failures = 0;
+
+	// Halfs only, so the channels are read as halfs and bound as they
+	// are, scaled; the missing alpha comes out as 1 (before scaling).
+	if (!run("-input_scale 2 -format exr16 -band 4 " +
+	         script("layers_half.ctl") + "exr_test_layers.exr exr_test_out5.exr"))
+	{
+		return 1;
+	}
+	channels_t expected;
+	expected.push_back(output_channel("A", Imf::HALF, alpha, 2.0f));
+	expected.push_back(output_channel("B", Imf::HALF, find_channel(layers, "diffuse.G"), 2.0f));
+	expected.push_back(output_channel("G", Imf::HALF, find_channel(layers, "1st"), 2.0f));
+	expected.push_back(output_channel("R", Imf::HALF, find_channel(layers, "diffuse.R"), 2.0f));
+	failures += check("exr_test_out5.exr", expected);
+
+	// A float argument, so every channel is read as float, a float
+	// channel among them.
+	if (!run("-input_scale 0.5 -format exr32 -band 4 " +
+	         script("layers_float.ctl") + "exr_test_layers.exr exr_test_out6.exr"))
+	{
+		return 1;
+	}
+	expected.clear();
+	expected.push_back(output_channel("B", Imf::FLOAT, find_channel(layers, "G"), 0.5f));
+	expected.push_back(output_channel("G", Imf::FLOAT, find_channel(layers, "diffuse.R"), 0.5f));
+	expected.push_back(output_channel("R", Imf::FLOAT, find_channel(layers, "depth.Z"), 0.5f));
+	failures += check("exr_test_out6.exr", expected);
+
+	return failures;
+}
+
+#if defined(HAVE_ACESFILE)
+
+size_t test_aces()
+{
+	channels_t floats;
+	floats.push_back(make_channel("A", Imf::FLOAT, 3.0f));
+	floats.push_back(make_channel("B", Imf::FLOAT, 2.0f));
+	floats.push_back(make_channel("G", Imf::FLOAT, 1.0f));
+	floats.push_back(make_channel("R", Imf::FLOAT, 0.0f));
+	write_exr("exr_test_aces.exr", floats);
+
+	size_t failures = 0;
+
+	// RGB, floats straight from the script
+	if (!run("-output_scale 4 -format aces -band 4 " +
+	         script("unity_float.ctl") + "exr_test_aces.exr exr_test_out7.exr"))
+	{
+		return 1;
+	}
+	channels_t expected;
+	expected.push_back(output_channel("B", Imf::HALF, find_channel(floats, "B"), 0.25f));
+	expected.push_back(output_channel("G", Imf::HALF, find_channel(floats, "G"), 0.25f));
+	expected.push_back(output_channel("R", Imf::HALF, find_channel(floats, "R"), 0.25f));
+	failures += check("exr_test_out7.exr", expected);
+
+	// RGBA, halfs from the script and a scale without an exact
+	// reciprocal
+	if (!run("-output_scale 3 -format aces -band 4 " +
+	         script("unity_rgba.ctl") + "exr_test_aces.exr exr_test_out8.exr"))
+	{
+		return 1;
+	}
+	expected.clear();
+	static const char *names[] = { "A", "B", "G", "R" };
+	for (int c = 0; c < 4; c++)
+	{
+		channel_t halfs = output_channel(names[c], Imf::HALF,
+		                                 find_channel(floats, names[c]), 1.0f);
+		expected.push_back(output_channel(names[c], Imf::HALF, halfs, 1.0f / 3.0f));
+	}
+	failures += check("exr_test_out8.exr", expected);
+
+	return failures;
+}
+
+#endif
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		std::cerr << "usage: " << argv[0] << " <ctlrender> <script directory>" << std::endl;
+		return 1;
+	}
+	ctlrender = argv[1];
+	scripts = argv[2];
+
+	size_t failures = 0;
+
+	try
+	{
+		failures += test_scale();
+		failures += test_channels();
+#if defined(HAVE_ACESFILE)
+		failures += test_aces();
+#endif
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		failures++;
+	}
+
+	std::cout << "exr: " << failures << " failures" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+// Checks that half_row(), which converts with F16C instructions when the
+// CPU has them, gives the same bits as the half(float) constructor for
+// every half value, the ties and near ties between neighbouring halfs,
+// values that overflow or underflow and a sweep over all floats.
+
+#include "half_row.hh"
+#include <half.h>
+#include <iostream>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+
+float from_bits(uint32_t bits)
+{
+	float f;
+
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+bool is_nan(uint16_t bits)
+{
+	return (bits & 0x7c00) == 0x7c00 && (bits & 0x03ff) != 0;
+}
+
+void add_inputs(std::vector<float> *in)
+{
+	for (uint32_t h = 0; h < 0x10000; h++)
+	{
+		half a, b;
+
+		a.setBits(h);
+		b.setBits(h + 1);
+		if ((h & 0x7fff) >= 0x7c00)
+		{
+			in->push_back(a);
+			continue;
+		}
+
+		// the value itself and the halfway point to the next half
+		// (the last finite half is followed by infinity), each with
+		// its neighbouring floats
+		float v = a;
+		float mid = ((double) v + (double) (float) b) / 2;
+
+		in->push_back(v);
+		in->push_back(nextafterf(v, -INFINITY));
+		in->push_back(nextafterf(v, INFINITY));
+		in->push_back(mid);
+		in->push_back(nextafterf(mid, -INFINITY));
+		in->push_back(nextafterf(mid, INFINITY));
+	}
+
+	for (uint64_t bits = 0; bits < 0x100000000ULL; bits += 9973)
+	{
+		in->push_back(from_bits((uint32_t) bits));
+	}
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	static const float scales[] = { 1.0f, 0.5f, 3.0f / 7.0f, 1024.0f };
+	std::vector<float> in;
+	std::vector<uint16_t> out;
+	size_t failures = 0;
+
+	add_inputs(&in);
+	out.resize(in.size());
+
+	for (size_t s = 0; s < sizeof(scales) / sizeof(scales[0]); s++)
+	{
+		// Uneven pieces so that both the vector loop and the
+		// scalar tail see every kind of value.
+		for (size_t i = 0, n = 1; i < in.size(); i += n, n = n % 19 + 1)
+		{
+			size_t count = n < in.size() - i ? n : in.size() - i;
+
+			half_row(&out[i], &in[i], scales[s], count);
+		}
+
+		for (size_t i = 0; i < in.size(); i++)
+		{
+			half expected(in[i] * scales[s]);
+
+			if (out[i] == expected.bits() ||
+			    (is_nan(out[i]) && is_nan(expected.bits())))
+			{
+				continue;
+			}
+
+			if (failures++ < 10)
+			{
+				std::cerr << in[i] << " * " << scales[s] << ": got 0x"
+				          << std::hex << out[i] << ", expected 0x"
+				          << expected.bits() << std::dec << std::endl;
+			}
+		}
+	}
+
+	std::cout << "half_row (F16C " << (half_row_f16c() ? "yes" : "no")
+	          << "): " << in.size() << " values, " << failures
+	          << " failures" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
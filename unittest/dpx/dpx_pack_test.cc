@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2013 Academy of Motion Picture Arts and Sciences 
+// ("A.M.P.A.S."). Portions contributed by others as indicated.
+// All rights reserved.
+// 
+// A worldwide, royalty-free, non-exclusive right to copy, modify, create
+// derivatives, and use, in source and binary forms, is hereby granted, 
+// subject to acceptance of this license. Performance of any of the 
+// aforementioned acts indicates acceptance to be bound by the following 
+// terms and conditions:
+//
+//  * Copies of source code, in whole or in part, must retain the 
+//    above copyright notice, this list of conditions and the 
+//    Disclaimer of Warranty.
+//
+//  * Use in binary form must retain the above copyright notice, 
+//    this list of conditions and the Disclaimer of Warranty in the
+//    documentation and/or other materials provided with the distribution.
+//
+//  * Nothing in this license shall be deemed to grant any rights to 
+//    trademarks, copyrights, patents, trade secrets or any other 
+//    intellectual property of A.M.P.A.S. or any contributors, except 
+//    as expressly stated herein.
+//
+//  * Neither the name "A.M.P.A.S." nor the name of any other 
+//    contributors to this software may be used to endorse or promote 
+//    products derivative of or based on this software without express 
+//    prior written permission of A.M.P.A.S. or the contributors, as 
+//    appropriate.
+// 
+// This license shall be construed pursuant to the laws of the State of 
+// California, and any disputes related thereto shall be subject to the 
+// jurisdiction of the courts therein.
+//
+// Disclaimer of Warranty: THIS SOFTWARE IS PROVIDED BY A.M.P.A.S. AND 
+// CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS 
+// FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT ARE DISCLAIMED. IN NO 
+// EVENT SHALL A.M.P.A.S., OR ANY CONTRIBUTORS OR DISTRIBUTORS, BE LIABLE 
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, RESITUTIONARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF 
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+// WITHOUT LIMITING THE GENERALITY OF THE FOREGOING, THE ACADEMY 
+// SPECIFICALLY DISCLAIMS ANY REPRESENTATIONS OR WARRANTIES WHATSOEVER 
+// RELATED TO PATENT OR OTHER INTELLECTUAL PROPERTY RIGHTS IN THE ACADEMY 
+// COLOR ENCODING SYSTEM, OR APPLICATIONS THEREOF, HELD BY PARTIES OTHER 
+// THAN A.M.P.A.S., WHETHER DISCLOSED OR UNDISCLOSED.
+///////////////////////////////////////////////////////////////////////////
+
+
+// Round trips frame buffers through the integer layouts that the fused
+// packing code handles (8, 10, 12 and 16 bits, packing methods A and B)
+// and checks that
+//
+//   - the fused and the generic code write the same bytes,
+//   - both read back exactly the values that were written,
+//   - 10 bit lines that don't fill their last word are padded to a word
+//     boundary by the fused code, and read back,
+//   - a truncated element makes the fused read throw dpx::invalid.
+//
+
+#include <dpx.hh>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+const char *scratch_name="dpx_pack_test.dpx";
+
+// Values that are exactly representable at the given bit depth, so
+// that they survive the round trip unchanged.
+void fill(ctl::dpx::fb<float32_t> *buf, uint32_t width, uint32_t height,
+          uint8_t depth, uint8_t bps) {
+	uint64_t u;
+	uint32_t max;
+	float32_t *o;
+
+	buf->init(width, height, depth);
+
+	max=(1<<bps)-1;
+	o=buf->ptr();
+	for(u=0; u<buf->count(); u++) {
+		o[u]=(float32_t)(rand()%(max+1))/max;
+	}
+}
+
+// The writer seeks past the end of what it has written so far, which
+// a stringstream doesn't allow, so this goes through a scratch file in
+// the current directory.
+std::string write(const ctl::dpx::fb<float32_t> &buf, uint8_t bps,
+                  uint16_t packing, ctl::dpx::packing_mode_e mode) {
+	std::ostringstream s;
+	std::ifstream i;
+	std::ofstream o;
+	ctl::dpx header;
+
+	o.open(scratch_name, std::ios_base::out | std::ios_base::trunc |
+	                     std::ios_base::binary);
+
+	header.packing_mode=mode;
+	header.elements[0].data_sign=0;
+	header.elements[0].bits_per_sample=bps;
+	header.elements[0].packing=packing;
+	header.write(&o, 0, buf, 0.0);
+	header.write(&o);
+	o.close();
+
+	i.open(scratch_name, std::ios_base::in | std::ios_base::binary);
+	s << i.rdbuf();
+	i.close();
+	remove(scratch_name);
+
+	return s.str();
+}
+
+void read(ctl::dpx::fb<float32_t> *buf, const std::string &file,
+          ctl::dpx::packing_mode_e mode) {
+	std::istringstream s(file);
+	ctl::dpx header;
+
+	header.read(&s);
+	header.packing_mode=mode;
+	header.read(&s, 0, buf, 0.0);
+}
+
+bool same(const ctl::dpx::fb<float32_t> &a, const ctl::dpx::fb<float32_t> &b) {
+	return a.width()==b.width() && a.height()==b.height() &&
+	       a.depth()==b.depth() &&
+	       memcmp(a.ptr(), b.ptr(), a.length())==0;
+}
+
+bool check(bool ok, const char *what, uint8_t bps, uint16_t packing,
+           uint8_t depth) {
+	if(!ok) {
+		std::cerr << (int)bps << " bit, packing " << packing << ", "
+		          << (int)depth << " channel(s): " << what << std::endl;
+	}
+	return ok;
+}
+
+// Both packing modes on buffers whose lines fill whole words.
+bool round_trip(uint8_t bps, uint16_t packing) {
+	ctl::dpx::fb<float32_t> source, fused_in, generic_in;
+	std::string fused, generic;
+	bool ok;
+
+	fill(&source, 7, 5, 3, bps);
+
+	fused=write(source, bps, packing, ctl::dpx::fused);
+	generic=write(source, bps, packing, ctl::dpx::generic);
+
+	read(&fused_in, fused, ctl::dpx::fused);
+	read(&generic_in, fused, ctl::dpx::generic);
+
+	ok=check(fused==generic, "fused and generic write differ", bps,
+	         packing, 3);
+	ok=check(same(source, fused_in), "fused read differs", bps, packing,
+	         3) && ok;
+	ok=check(same(source, generic_in), "generic read differs", bps,
+	         packing, 3) && ok;
+
+	return ok;
+}
+
+// Single channel lines of 7 samples, so every 10 bit line ends in a
+// partially filled word.
+bool padded_lines(uint8_t bps, uint16_t packing) {
+	ctl::dpx::fb<float32_t> source, in;
+	std::string file;
+	ctl::dpx header;
+	uint64_t line;
+	bool ok;
+
+	fill(&source, 7, 5, 1, bps);
+
+	file=write(source, bps, packing, ctl::dpx::fused);
+	read(&in, file, ctl::dpx::fused);
+
+	std::istringstream s(file);
+	header.read(&s);
+	if(bps==10) {
+		line=3*4;
+	} else if(bps==8) {
+		line=7;
+	} else {
+		line=7*2;
+	}
+
+	ok=check(same(source, in), "fused read differs", bps, packing, 1);
+	ok=check(file.size()==header.elements[0].offset_to_data+line*5,
+	         "unexpected element size", bps, packing, 1) && ok;
+
+	return ok;
+}
+
+bool truncated(uint8_t bps, uint16_t packing) {
+	ctl::dpx::fb<float32_t> source, in;
+	std::string file;
+
+	fill(&source, 7, 5, 3, bps);
+
+	file=write(source, bps, packing, ctl::dpx::fused);
+	file.resize(file.size()-1);
+
+	try {
+		read(&in, file, ctl::dpx::fused);
+	} catch(ctl::dpx::invalid &) {
+		return true;
+	}
+
+	return check(false, "truncated element read without an error", bps,
+	             packing, 3);
+}
+
+}
+
+int main(int argc, const char **argv) {
+	static const uint8_t depths[]={ 8, 10, 12, 16 };
+	uint16_t method, packing;
+	bool ok;
+	int i;
+
+	srand(1);
+
+	ok=true;
+	for(i=0; i<4; i++) {
+		for(method=1; method<=2; method++) {
+			// The packing code also selects the word size: 32 bit
+			// words for 10 bit, 16 bit words for 12 and 16 bit and
+			// bytes for 8 bit samples.
+			if(depths[i]==8) {
+				packing=16+method;
+			} else if(depths[i]==10) {
+				packing=method;
+			} else {
+				packing=8+method;
+			}
+
+			ok=round_trip(depths[i], packing) && ok;
+			ok=padded_lines(depths[i], packing) && ok;
+			ok=truncated(depths[i], packing) && ok;
+		}
+	}
+
+	std::cout << (ok ? "ok" : "FAILED") << std::endl;
+
+	return ok ? 0 : 1;
+}